@@ -0,0 +1,99 @@
+/**
+ * decoder.h
+ * This header declares the host side decoder for Remote radio frames.
+ * 
+ * Plain C99 for the gateway. Frame format is shared with the firmware,
+ * compile with Remote/Inc in the include path.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* User headers */
+#include "frame.h"
+
+/* Global defines */
+#define DECODER_OK                      (0L)
+#define DECODER_TOO_SHORT               (-1L)
+#define DECODER_BAD_CRC                 (-2L)
+#define DECODER_BAD_VERSION             (-3L)
+#define DECODER_BAD_FIELD               (-4L)
+#define DECODER_BAD_TYPE                (-5L)
+#define DECODER_NO_BASE                 (-6L)   /* Delta frame without previous frame */
+#define DECODER_STALE                   (-7L)   /* Duplicate or older than decoded frames */
+
+/* Delta frame of unchanged samples has most samples */
+#define DECODER_MAX_SAMPLES             ((FRAME_MAX_SIZE - FRAME_SIZE(0)) / FRAME_RECORD_MIN_SIZE)
+
+/* Delta frames held while waiting for a late previous frame */
+#define DECODER_PENDING_FRAMES          (4UL)
+
+/* Sensor of a field */
+struct Decoder_Field
+{
+    uint32_t ulType;                    /* enum Frame_Field_Types */
+    uint32_t ulIndex;                   /* Probe number for soil moisture */
+};
+
+/* Values of one reading, in field order */
+struct Decoder_Sample
+{
+    uint32_t ulTimestamp;               /* Seconds since node boot modulo 65536 */
+    int32_t lValues[FRAME_MAX_FIELDS];
+};
+
+/* Sample periods of FRAME_TYPE_SCHEDULE, fields of the frame */
+struct Decoder_Schedule
+{
+    uint32_t ulWakeups;                 /* Sensor task wake-ups since node boot */
+    uint32_t ulPeriodMs[FRAME_MAX_FIELDS];
+};
+
+/* Decoded frame */
+struct Decoder_Frame
+{
+    uint32_t ulType;                    /* FRAME_TYPE_SAMPLE...FRAME_TYPE_SCHEDULE */
+    uint32_t ulNode;
+    uint32_t ulSequence;
+    uint32_t ulFieldCount;
+    struct Decoder_Field xFields[FRAME_MAX_FIELDS];
+    uint32_t ulSampleCount;
+    struct Decoder_Sample xSamples[DECODER_MAX_SAMPLES];    /* Timestamp only for FRAME_TYPE_SCHEDULE */
+    struct Decoder_Schedule xSchedule;  /* FRAME_TYPE_SCHEDULE only */
+};
+
+/* Received frame waiting for decoding */
+struct Decoder_Pending
+{
+    uint8_t ucFrame[FRAME_MAX_SIZE];
+    uint32_t ulLength;                  /* 0 when free */
+};
+
+/* Decoder state of one node */
+struct Decoder_Node
+{
+    uint32_t ulSynced;                  /* Nonzero when xLast is valid */
+    struct Decoder_Frame xLast;         /* Base of next delta frame */
+    struct Decoder_Pending xPending[DECODER_PENDING_FRAMES];
+    uint32_t ulFrames;                  /* Decoded frames */
+    uint32_t ulLostFrames;              /* Frames skipped by decoding */
+    uint32_t ulStaleFrames;
+    uint32_t ulResyncs;                 /* Key frames behind with earlier timestamp, node rebooted */
+    uint32_t ulErrors;                  /* Frames with decode error */
+    uint32_t ulSchedules;               /* Schedule frames, not counted in ulFrames */
+};
+
+/* Called with each decoded frame in sequence order */
+typedef void (*Decoder_Output)(const struct Decoder_Frame *const pxFrame, void *const pvContext);
+
+
+/* Global function prototypes */
+int32_t DECODER_lDecode(const uint8_t *const pucFrame, const uint32_t ulLength, const struct Decoder_Frame *const pxBase,
+                        struct Decoder_Frame *const pxFrame);
+void DECODER_vNodeInit(struct Decoder_Node *const pxNode);
+int32_t DECODER_lPush(struct Decoder_Node *const pxNode, const uint8_t *const pucFrame, const uint32_t ulLength,
+                      const Decoder_Output pxOutput, void *const pvContext);
+uint32_t DECODER_ulLostFrames(const uint32_t ulPrevious, const uint32_t ulSequence);
+const char *DECODER_pcFieldName(const uint32_t ulType);
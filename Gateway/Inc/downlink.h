@@ -0,0 +1,49 @@
+/**
+ * downlink.h
+ * This header declares the gateway side of the downlink command channel.
+ * 
+ * Plain C99 for the gateway. Command format is shared with the firmware,
+ * compile with Remote/Inc in the include path.
+ * 
+ * Gateway keeps one state per node. Commands are queued with
+ * DOWNLINK_lQueue() and encoded to a payload by DOWNLINK_ulLoad(), which
+ * the gateway writes with W_ACK_PAYLOAD to pipe COMMAND_PIPE(node). The
+ * nRF24L01 sends it with the ACK of the next frame from the node, so
+ * DOWNLINK_vUplink() is called for every frame received from the node.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* User headers */
+#include "command.h"
+
+/* Global defines */
+#define DOWNLINK_OK                     (0L)
+#define DOWNLINK_FULL                   (-1L)
+#define DOWNLINK_BAD_COMMAND            (-2L)
+
+/* Downlink state of one node */
+struct Downlink_Node
+{
+    uint32_t ulNode;
+    uint32_t ulSequence;                /* Of next payload */
+    struct Command xPending[COMMAND_MAX_COUNT];
+    uint32_t ulPending;                 /* Commands waiting for a payload */
+    uint8_t ucLoaded[COMMAND_PAYLOAD_MAX_SIZE];
+    uint32_t ulLoadedLength;            /* 0 when no payload is waiting for an uplink */
+    uint32_t ulPayloads;                /* Payloads sent with ACKs */
+    uint32_t ulCommands;
+    uint32_t ulBytes;
+};
+
+
+/* Global function prototypes */
+void DOWNLINK_vNodeInit(struct Downlink_Node *const pxNode, const uint32_t ulNode);
+int32_t DOWNLINK_lQueue(struct Downlink_Node *const pxNode, const struct Command *const pxCommand);
+uint32_t DOWNLINK_ulLoad(struct Downlink_Node *const pxNode, uint8_t *const pucPayload);
+void DOWNLINK_vUplink(struct Downlink_Node *const pxNode);
+uint32_t DOWNLINK_ulEncode(const uint32_t ulNode, const uint32_t ulSequence, const struct Command *const pxCommands,
+                           const uint32_t ulCount, uint8_t *const pucPayload);
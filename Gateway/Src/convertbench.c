@@ -0,0 +1,198 @@
+/**
+ * convertbench.c
+ * This file checks the firmware sensor conversion kernels against the
+ * integer division formulas for every 16-bit ADC code and times both.
+ * 
+ * Plain C99 host program, build with Remote/Inc in the include path:
+ *  cc -std=c99 -O2 -IRemote/Inc Gateway/Src/convertbench.c
+ * 
+ * Usage: convertbench
+ * Exit status is 1 if any code converts differently. Host compilers turn
+ * constant divisions into multiplies too, so timings only show the
+ * kernels cost about the same there. On Cortex-M0+ the divisions go
+ * through the libgcc software divider.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "convert.h"
+
+
+/* Local defines */
+#define ADC_CODES                       (65536UL)
+#define TIMING_ROUNDS                   (2000UL)
+
+/* Reference formulas, truncating towards zero */
+#define REFERENCE_CELSIUS(adc)          \
+    ((((TEMP_SENSOR_VREF_MV * (adc)) / TEMP_SENSOR_ADC_STEPS) - TEMP_SENSOR_OFFSET_MV) / TEMP_SENSOR_MV_PER_DEGREE)
+#define REFERENCE_SOIL_MOISTURE(adc)    \
+    (100 - (((adc) - SOIL_MOISTURE_ADC_WET) * 100) / (SOIL_MOISTURE_ADC_DRY - SOIL_MOISTURE_ADC_WET))
+
+/* Conversions compared */
+enum Bench_Conversions
+{
+    BENCH_CELSIUS,
+    BENCH_SOIL_MOISTURE,
+    BENCH_CONVERSION_COUNT
+};
+
+
+/* Local variables */
+static const char *const pcConversionNames[BENCH_CONVERSION_COUNT] =
+{
+    [BENCH_CELSIUS]         = "celsius",
+    [BENCH_SOIL_MOISTURE]   = "soil moisture",
+};
+
+/* Timed loops read codes through this, so the compiler can't fold them */
+static volatile int32_t lCodeLimit = (int32_t)ADC_CODES;
+
+
+/* Local function prototypes */
+static int32_t lReference(const uint32_t ulConversion, const int32_t lAdc);
+static int32_t lKernel(const uint32_t ulConversion, const uint32_t ulAdc);
+static uint32_t ulCheck(const uint32_t ulConversion);
+static void vTime(const uint32_t ulConversion);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Check and time each conversion.
+ * 
+ * @param   None
+ * 
+ * @return  0, or 1 on a mismatch.
+ */
+int main(void)
+{
+    uint32_t ulMismatches = 0;
+    
+    for (uint32_t i = 0; i < BENCH_CONVERSION_COUNT; i++)
+    {
+        ulMismatches += ulCheck(i);
+        vTime(i);
+    }
+    
+    return (ulMismatches == 0) ? 0 : 1;
+}
+
+
+/**
+ * @brief   Convert with the division formula.
+ * 
+ * @param   ulConversion    enum Bench_Conversions
+ * 
+ * @param   lAdc            16-bit ADC value.
+ * 
+ * @return  Converted value.
+ */
+static int32_t lReference(const uint32_t ulConversion, const int32_t lAdc)
+{
+    if (ulConversion == BENCH_CELSIUS)
+    {
+        return (int32_t)REFERENCE_CELSIUS(lAdc);
+    }
+    
+    return (int32_t)REFERENCE_SOIL_MOISTURE(lAdc);
+}
+
+
+/**
+ * @brief   Convert with the firmware kernel.
+ * 
+ * @param   ulConversion    enum Bench_Conversions
+ * 
+ * @param   ulAdc           16-bit ADC value.
+ * 
+ * @return  Converted value.
+ */
+static int32_t lKernel(const uint32_t ulConversion, const uint32_t ulAdc)
+{
+    if (ulConversion == BENCH_CELSIUS)
+    {
+        return CONVERT_lCelsius(ulAdc);
+    }
+    
+    return (int32_t)CONVERT_ulSoilMoisture(ulAdc);
+}
+
+
+/**
+ * @brief   Compare kernel to reference for every ADC code.
+ * 
+ * @param   ulConversion    enum Bench_Conversions
+ * 
+ * @return  Number of mismatching codes.
+ */
+static uint32_t ulCheck(const uint32_t ulConversion)
+{
+    uint32_t ulMismatches = 0;
+    int32_t lExpected;
+    int32_t lResult;
+    
+    for (uint32_t ulAdc = 0; ulAdc < ADC_CODES; ulAdc++)
+    {
+        lExpected = lReference(ulConversion, (int32_t)ulAdc);
+        lResult = lKernel(ulConversion, ulAdc);
+        
+        if (lResult != lExpected)
+        {
+            /* First few are enough to see the pattern */
+            if (ulMismatches < 10)
+            {
+                printf("  %s: ADC %lu gives %ld, expected %ld\n", pcConversionNames[ulConversion], (unsigned long)ulAdc,
+                       (long)lResult, (long)lExpected);
+            }
+            ulMismatches++;
+        }
+    }
+    
+    printf("%s: %lu codes, %lu mismatches\n", pcConversionNames[ulConversion], (unsigned long)ADC_CODES,
+           (unsigned long)ulMismatches);
+    
+    return ulMismatches;
+}
+
+
+/**
+ * @brief   Time reference and kernel over all ADC codes.
+ * 
+ * @param   ulConversion    enum Bench_Conversions
+ * 
+ * @return  None
+ */
+static void vTime(const uint32_t ulConversion)
+{
+    const int32_t lLimit = lCodeLimit;
+    const double dConversions = (double)ADC_CODES * TIMING_ROUNDS;
+    uint32_t ulCheckSum = 0;
+    clock_t xStart;
+    double dReference;
+    double dKernel;
+    
+    /* Results are summed so the compiler can't drop the conversions */
+    xStart = clock();
+    for (uint32_t ulRound = 0; ulRound < TIMING_ROUNDS; ulRound++)
+    {
+        for (int32_t lAdc = 0; lAdc < lLimit; lAdc++)
+        {
+            ulCheckSum += (uint32_t)lReference(ulConversion, lAdc);
+        }
+    }
+    dReference = (double)(clock() - xStart) / CLOCKS_PER_SEC;
+    
+    xStart = clock();
+    for (uint32_t ulRound = 0; ulRound < TIMING_ROUNDS; ulRound++)
+    {
+        for (int32_t lAdc = 0; lAdc < lLimit; lAdc++)
+        {
+            ulCheckSum -= (uint32_t)lKernel(ulConversion, (uint32_t)lAdc);
+        }
+    }
+    dKernel = (double)(clock() - xStart) / CLOCKS_PER_SEC;
+    
+    printf("  division %.2f ns, kernel %.2f ns per conversion (check %lu)\n", (1e9 * dReference) / dConversions,
+           (1e9 * dKernel) / dConversions, (unsigned long)ulCheckSum);
+}
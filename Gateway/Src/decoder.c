@@ -0,0 +1,693 @@
+/**
+ * decoder.c
+ * This file decodes Remote radio frames on the gateway.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "decoder.h"
+
+
+/* Local defines */
+
+/* Sequence numbers wrap at 256, later half of the range is behind */
+#define SEQUENCE_DISTANCE(from, to)     (((uint32_t)(to) - (uint32_t)(from)) & 0xFFUL)
+#define SEQUENCE_AHEAD(distance)        (((distance) > 0) && ((distance) < 0x80UL))
+
+/* Timestamps wrap at 65536 s, later half of the range is behind */
+#define TIMESTAMP_BEHIND(from, to)      ((((uint32_t)(to) - (uint32_t)(from)) & 0xFFFFUL) >= 0x8000UL)
+
+
+/* Local function prototypes */
+static int32_t lDecodeValue(const uint32_t ulType, const uint8_t ucValue, int32_t *const plValue);
+static int32_t lDecodeFields(const uint8_t *pucField, const uint32_t ulFields, struct Decoder_Frame *const pxFrame);
+static int32_t lDecodeKey(const uint8_t *pucData, const uint8_t *const pucEnd, struct Decoder_Frame *const pxFrame);
+static int32_t lDecodeTag(const uint8_t ucTag, struct Decoder_Field *const pxField);
+static int32_t lDecodeSchedule(const uint8_t *pucData, const uint8_t *const pucEnd, struct Decoder_Frame *const pxFrame);
+static int32_t lDecodeRecords(const uint8_t *pucRecord, const uint8_t *const pucEnd, const struct Decoder_Sample *pxPrevious,
+                              struct Decoder_Frame *const pxFrame);
+static uint32_t ulGetVarint(const uint8_t **const ppucData, const uint8_t *const pucEnd, uint32_t *const pulValue);
+static void vNodeAccept(struct Decoder_Node *const pxNode, const struct Decoder_Frame *const pxFrame,
+                        const Decoder_Output pxOutput, void *const pvContext);
+static void vNodeHold(struct Decoder_Node *const pxNode, const uint8_t *const pucFrame, const uint32_t ulLength);
+static uint32_t ulNodeDrain(struct Decoder_Node *const pxNode, const Decoder_Output pxOutput, void *const pvContext);
+static void vNodeResync(struct Decoder_Node *const pxNode);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Decode a frame received from a node.
+ * 
+ * @param   pucFrame    Received payload.
+ * 
+ * @param   ulLength    Payload length.
+ * 
+ * @param   pxBase      Previous frame of the node for FRAME_TYPE_DELTA,
+ *                      may be NULL.
+ * 
+ * @param   pxFrame     Decoded frame, valid only on DECODER_OK. Must not
+ *                      be pxBase.
+ * 
+ * @return  DECODER_OK or negative error code.
+ */
+int32_t DECODER_lDecode(const uint8_t *const pucFrame, const uint32_t ulLength, const struct Decoder_Frame *const pxBase,
+                        struct Decoder_Frame *const pxFrame)
+{
+    const uint8_t *pucEnd;
+    uint32_t ulFields;
+    uint16_t usCrc;
+    
+    if ((pucFrame == NULL) || (pxFrame == NULL) || (ulLength < FRAME_SIZE(0)) || (ulLength > FRAME_MAX_SIZE))
+    {
+        return DECODER_TOO_SHORT;
+    }
+    
+    usCrc = (uint16_t)(pucFrame[ulLength - 2] | (pucFrame[ulLength - 1] << 8));
+    if (FRAME_usChecksum(pucFrame, ulLength - FRAME_CRC_SIZE) != usCrc)
+    {
+        return DECODER_BAD_CRC;
+    }
+    
+    if ((pucFrame[0] >> 4) != FRAME_VERSION)
+    {
+        return DECODER_BAD_VERSION;
+    }
+    
+    pucEnd = &pucFrame[ulLength - FRAME_CRC_SIZE];
+    pxFrame->ulType = pucFrame[0] & 0x0F;
+    pxFrame->ulNode = pucFrame[1];
+    pxFrame->ulSequence = pucFrame[2];
+    pxFrame->ulSampleCount = 1;
+    pxFrame->xSamples[0].ulTimestamp = (uint32_t)(pucFrame[3] | (pucFrame[4] << 8));
+    
+    switch (pxFrame->ulType)
+    {
+        case FRAME_TYPE_SAMPLE:
+            ulFields = (ulLength - FRAME_HEADER_SIZE - FRAME_CRC_SIZE) / FRAME_FIELD_SIZE;
+            if (FRAME_SIZE(ulFields) != ulLength)
+            {
+                return DECODER_BAD_FIELD;
+            }
+            return lDecodeFields(&pucFrame[FRAME_HEADER_SIZE], ulFields, pxFrame);
+        
+        case FRAME_TYPE_KEY:
+            return lDecodeKey(&pucFrame[FRAME_HEADER_SIZE], pucEnd, pxFrame);
+        
+        case FRAME_TYPE_DELTA:
+            if ((pxBase == NULL) || (pxBase->ulType == FRAME_TYPE_SAMPLE) || (pxBase->ulNode != pxFrame->ulNode)
+                || (SEQUENCE_DISTANCE(pxBase->ulSequence, pxFrame->ulSequence) != 1))
+            {
+                return DECODER_NO_BASE;
+            }
+            
+            pxFrame->ulFieldCount = pxBase->ulFieldCount;
+            for (uint32_t i = 0; i < pxBase->ulFieldCount; i++)
+            {
+                pxFrame->xFields[i] = pxBase->xFields[i];
+            }
+            
+            pxFrame->ulSampleCount = 0;
+            if (&pucFrame[FRAME_HEADER_SIZE] == pucEnd)
+            {
+                return DECODER_BAD_FIELD; /* Delta frame has at least one sample */
+            }
+            return lDecodeRecords(&pucFrame[FRAME_HEADER_SIZE], pucEnd, &pxBase->xSamples[pxBase->ulSampleCount - 1], pxFrame);
+        
+        case FRAME_TYPE_SCHEDULE:
+            return lDecodeSchedule(&pucFrame[FRAME_HEADER_SIZE], pucEnd, pxFrame);
+        
+        default:
+            return DECODER_BAD_TYPE;
+    }
+}
+
+
+/**
+ * @brief   Initialize decoder state of a node.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @return  None
+ */
+void DECODER_vNodeInit(struct Decoder_Node *const pxNode)
+{
+    memset(pxNode, 0, sizeof(*pxNode));
+}
+
+
+/**
+ * @brief   Decode frames of one node in sequence order. Frames may arrive
+ *          late or get lost. Delta frames are held until their previous
+ *          frame arrives, or dropped when a later key frame arrives
+ *          first. Caller selects node state by node ID, frame byte 1.
+ * 
+ * @note    Schedule frames are passed to pxOutput as they arrive, they
+ *          are not part of the sequence.
+ * 
+ * @note    Sequence numbers start over when the node reboots. A key
+ *          frame behind the last one with an earlier timestamp starts
+ *          decoding over from it, other frames behind are stale. A key
+ *          frame delayed past later frames looks the same.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @param   pucFrame    Received payload.
+ * 
+ * @param   ulLength    Payload length.
+ * 
+ * @param   pxOutput    Called with each decoded frame.
+ * 
+ * @param   pvContext   Passed to pxOutput.
+ * 
+ * @return  Number of decoded frames, 0 when frame is held, or negative
+ *          error code of this frame.
+ */
+int32_t DECODER_lPush(struct Decoder_Node *const pxNode, const uint8_t *const pucFrame, const uint32_t ulLength,
+                      const Decoder_Output pxOutput, void *const pvContext)
+{
+    struct Decoder_Frame xFrame;
+    const struct Decoder_Sample *pxLastSample;
+    int32_t lStatus;
+    uint32_t ulBehind = 0;
+    
+    /* Schedule frame repeats the sequence number of the previous data frame */
+    if ((pucFrame != NULL) && (ulLength >= FRAME_SIZE(0)) && ((pucFrame[0] & 0x0F) == FRAME_TYPE_SCHEDULE))
+    {
+        lStatus = DECODER_lDecode(pucFrame, ulLength, NULL, &xFrame);
+        if (lStatus != DECODER_OK)
+        {
+            pxNode->ulErrors++;
+            return lStatus;
+        }
+        
+        pxNode->ulSchedules++;
+        if (pxOutput != NULL)
+        {
+            pxOutput(&xFrame, pvContext);
+        }
+        return 1;
+    }
+    
+    if ((pucFrame != NULL) && (ulLength >= FRAME_SIZE(0)) && (pxNode->ulSynced != 0)
+        && !SEQUENCE_AHEAD(SEQUENCE_DISTANCE(pxNode->xLast.ulSequence, pucFrame[2])))
+    {
+        ulBehind = 1;
+        
+        /* Key frame is checked for a reboot after decoding */
+        if ((pucFrame[0] & 0x0F) != FRAME_TYPE_KEY)
+        {
+            pxNode->ulStaleFrames++;
+            return DECODER_STALE;
+        }
+    }
+    
+    lStatus = DECODER_lDecode(pucFrame, ulLength, (pxNode->ulSynced != 0) ? &pxNode->xLast : NULL, &xFrame);
+    if (lStatus == DECODER_NO_BASE)
+    {
+        vNodeHold(pxNode, pucFrame, ulLength);
+        return 0;
+    }
+    else if (lStatus != DECODER_OK)
+    {
+        pxNode->ulErrors++;
+        return lStatus;
+    }
+    
+    if (ulBehind != 0)
+    {
+        /* Duplicate or late key frame has a timestamp at or after the last sample */
+        pxLastSample = &pxNode->xLast.xSamples[pxNode->xLast.ulSampleCount - 1];
+        if (!TIMESTAMP_BEHIND(pxLastSample->ulTimestamp, xFrame.xSamples[0].ulTimestamp))
+        {
+            pxNode->ulStaleFrames++;
+            return DECODER_STALE;
+        }
+        
+        vNodeResync(pxNode);
+    }
+    
+    vNodeAccept(pxNode, &xFrame, pxOutput, pvContext);
+    
+    return (int32_t)(1 + ulNodeDrain(pxNode, pxOutput, pvContext));
+}
+
+
+/**
+ * @brief   Count frames lost between two received sequence numbers.
+ * 
+ * @param   ulPrevious  Sequence number of previous frame from the node.
+ * 
+ * @param   ulSequence  Sequence number of this frame.
+ * 
+ * @return  Number of missing frames.
+ */
+uint32_t DECODER_ulLostFrames(const uint32_t ulPrevious, const uint32_t ulSequence)
+{
+    return (ulSequence - ulPrevious - 1) & 0xFF;
+}
+
+
+/**
+ * @brief   Get printable name of a field type.
+ * 
+ * @param   ulType      enum Frame_Field_Types.
+ * 
+ * @return  Name, "unknown" for unknown types.
+ */
+const char *DECODER_pcFieldName(const uint32_t ulType)
+{
+    switch (ulType)
+    {
+        case FRAME_FIELD_TEMPERATURE:
+            return "temperature";
+        case FRAME_FIELD_HUMIDITY:
+            return "humidity";
+        case FRAME_FIELD_SOIL_MOISTURE:
+            return "soil moisture";
+        default:
+            return "unknown";
+    }
+}
+
+
+/**
+ * @brief   Convert value byte of a field.
+ * 
+ * @param   ulType      enum Frame_Field_Types.
+ * 
+ * @param   ucValue     Value byte.
+ * 
+ * @param   plValue     Converted value.
+ * 
+ * @return  DECODER_OK or DECODER_BAD_FIELD for unknown types.
+ */
+static int32_t lDecodeValue(const uint32_t ulType, const uint8_t ucValue, int32_t *const plValue)
+{
+    switch (ulType)
+    {
+        case FRAME_FIELD_TEMPERATURE:
+            *plValue = (int8_t)ucValue;
+            return DECODER_OK;
+        case FRAME_FIELD_HUMIDITY:
+        case FRAME_FIELD_SOIL_MOISTURE:
+            *plValue = ucValue;
+            return DECODER_OK;
+        default:
+            return DECODER_BAD_FIELD;
+    }
+}
+
+
+/**
+ * @brief   Decode tag and value pairs of a sample frame.
+ * 
+ * @param   pucField    First tag.
+ * 
+ * @param   ulFields    Number of pairs.
+ * 
+ * @param   pxFrame     Frame being decoded.
+ * 
+ * @return  DECODER_OK or DECODER_BAD_FIELD.
+ */
+static int32_t lDecodeFields(const uint8_t *pucField, const uint32_t ulFields, struct Decoder_Frame *const pxFrame)
+{
+    struct Decoder_Field *pxField;
+    
+    pxFrame->ulFieldCount = ulFields;
+    
+    for (uint32_t i = 0; i < ulFields; i++, pucField += FRAME_FIELD_SIZE)
+    {
+        pxField = &pxFrame->xFields[i];
+        pxField->ulType = pucField[0] >> 4;
+        pxField->ulIndex = pucField[0] & 0x0F;
+        
+        if (lDecodeValue(pxField->ulType, pucField[1], &pxFrame->xSamples[0].lValues[i]) != DECODER_OK)
+        {
+            return DECODER_BAD_FIELD;
+        }
+    }
+    
+    return DECODER_OK;
+}
+
+
+/**
+ * @brief   Decode key frame body.
+ * 
+ * @param   pucData     Field count.
+ * 
+ * @param   pucEnd      CRC of the frame.
+ * 
+ * @param   pxFrame     Frame with header decoded.
+ * 
+ * @return  DECODER_OK or DECODER_BAD_FIELD.
+ */
+static int32_t lDecodeKey(const uint8_t *pucData, const uint8_t *const pucEnd, struct Decoder_Frame *const pxFrame)
+{
+    struct Decoder_Sample *const pxSample = &pxFrame->xSamples[0];
+    uint32_t ulFields;
+    uint32_t ulValue;
+    
+    if (pucData == pucEnd)
+    {
+        return DECODER_BAD_FIELD;
+    }
+    
+    ulFields = *pucData++;
+    if ((ulFields > FRAME_BATCH_MAX_FIELDS) || (ulFields > (uint32_t)(pucEnd - pucData)))
+    {
+        return DECODER_BAD_FIELD;
+    }
+    
+    pxFrame->ulFieldCount = ulFields;
+    for (uint32_t i = 0; i < ulFields; i++, pucData++)
+    {
+        if (lDecodeTag(*pucData, &pxFrame->xFields[i]) != DECODER_OK)
+        {
+            return DECODER_BAD_FIELD;
+        }
+    }
+    
+    for (uint32_t i = 0; i < ulFields; i++)
+    {
+        if (ulGetVarint(&pucData, pucEnd, &ulValue) == 0)
+        {
+            return DECODER_BAD_FIELD;
+        }
+        pxSample->lValues[i] = FRAME_lUnZigZag(ulValue);
+    }
+    
+    return lDecodeRecords(pucData, pucEnd, pxSample, pxFrame);
+}
+
+
+/**
+ * @brief   Decode field tag of a key or schedule frame.
+ * 
+ * @param   ucTag       Type in high nibble, index in low nibble.
+ * 
+ * @param   pxField     Decoded field.
+ * 
+ * @return  DECODER_OK or DECODER_BAD_FIELD for unknown types.
+ */
+static int32_t lDecodeTag(const uint8_t ucTag, struct Decoder_Field *const pxField)
+{
+    pxField->ulType = ucTag >> 4;
+    pxField->ulIndex = ucTag & 0x0F;
+    
+    if ((pxField->ulType == 0) || (pxField->ulType >= FRAME_FIELD_COUNT))
+    {
+        return DECODER_BAD_FIELD;
+    }
+    
+    return DECODER_OK;
+}
+
+
+/**
+ * @brief   Decode schedule frame body.
+ * 
+ * @param   pucData     Wake-up count.
+ * 
+ * @param   pucEnd      CRC of the frame.
+ * 
+ * @param   pxFrame     Frame with header decoded.
+ * 
+ * @return  DECODER_OK or DECODER_BAD_FIELD.
+ */
+static int32_t lDecodeSchedule(const uint8_t *pucData, const uint8_t *const pucEnd, struct Decoder_Frame *const pxFrame)
+{
+    uint32_t ulFields;
+    uint32_t ulPeriod;
+    
+    if ((ulGetVarint(&pucData, pucEnd, &pxFrame->xSchedule.ulWakeups) == 0) || (pucData == pucEnd))
+    {
+        return DECODER_BAD_FIELD;
+    }
+    
+    ulFields = *pucData++;
+    if (ulFields > FRAME_BATCH_MAX_FIELDS)
+    {
+        return DECODER_BAD_FIELD;
+    }
+    
+    pxFrame->ulFieldCount = ulFields;
+    for (uint32_t i = 0; i < ulFields; i++)
+    {
+        if ((pucData == pucEnd) || (lDecodeTag(*pucData++, &pxFrame->xFields[i]) != DECODER_OK)
+            || (ulGetVarint(&pucData, pucEnd, &ulPeriod) == 0))
+        {
+            return DECODER_BAD_FIELD;
+        }
+        pxFrame->xSchedule.ulPeriodMs[i] = ulPeriod * FRAME_PERIOD_UNIT_MS;
+    }
+    
+    return (pucData == pucEnd) ? DECODER_OK : DECODER_BAD_FIELD;
+}
+
+
+/**
+ * @brief   Decode records following a sample.
+ * 
+ * @param   pucRecord   First record.
+ * 
+ * @param   pucEnd      CRC of the frame.
+ * 
+ * @param   pxPrevious  Sample before the first record.
+ * 
+ * @param   pxFrame     Frame with fields decoded.
+ * 
+ * @return  DECODER_OK or DECODER_BAD_FIELD for truncated records.
+ */
+static int32_t lDecodeRecords(const uint8_t *pucRecord, const uint8_t *const pucEnd, const struct Decoder_Sample *pxPrevious,
+                              struct Decoder_Frame *const pxFrame)
+{
+    struct Decoder_Sample *pxSample;
+    uint32_t ulElapsed;
+    uint32_t ulChange;
+    uint32_t ulMask;
+    
+    while (pucRecord < pucEnd)
+    {
+        if (pxFrame->ulSampleCount >= DECODER_MAX_SAMPLES)
+        {
+            return DECODER_BAD_FIELD;
+        }
+        
+        if ((ulGetVarint(&pucRecord, pucEnd, &ulElapsed) == 0) || (pucRecord == pucEnd))
+        {
+            return DECODER_BAD_FIELD;
+        }
+        
+        ulMask = *pucRecord++;
+        if (ulMask >> pxFrame->ulFieldCount)
+        {
+            return DECODER_BAD_FIELD;
+        }
+        
+        pxSample = &pxFrame->xSamples[pxFrame->ulSampleCount++];
+        pxSample->ulTimestamp = (pxPrevious->ulTimestamp + ulElapsed) & 0xFFFF;
+        
+        for (uint32_t i = 0; i < pxFrame->ulFieldCount; i++)
+        {
+            pxSample->lValues[i] = pxPrevious->lValues[i];
+            if (ulMask & (1UL << i))
+            {
+                if (ulGetVarint(&pucRecord, pucEnd, &ulChange) == 0)
+                {
+                    return DECODER_BAD_FIELD;
+                }
+                pxSample->lValues[i] += FRAME_lUnZigZag(ulChange);
+            }
+        }
+        
+        pxPrevious = pxSample;
+    }
+    
+    return DECODER_OK;
+}
+
+
+/**
+ * @brief   Read varint.
+ * 
+ * @param   ppucData    Read position, advanced past the varint.
+ * 
+ * @param   pucEnd      End of data.
+ * 
+ * @param   pulValue    Value read.
+ * 
+ * @return  1 on success, 0 if truncated or too long.
+ */
+static uint32_t ulGetVarint(const uint8_t **const ppucData, const uint8_t *const pucEnd, uint32_t *const pulValue)
+{
+    const uint8_t *pucData = *ppucData;
+    uint32_t ulValue = 0;
+    
+    for (uint32_t ulShift = 0; (pucData < pucEnd) && (ulShift < 7 * FRAME_VARINT_MAX_SIZE); ulShift += 7)
+    {
+        ulValue |= (uint32_t)(*pucData & 0x7F) << ulShift;
+        if ((*pucData++ & 0x80) == 0)
+        {
+            *ppucData = pucData;
+            *pulValue = ulValue;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+
+/**
+ * @brief   Make decoded frame the base of the next one and output it.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @param   pxFrame     Decoded frame ahead of the last one.
+ * 
+ * @param   pxOutput    Called with frame.
+ * 
+ * @param   pvContext   Passed to pxOutput.
+ * 
+ * @return  None
+ */
+static void vNodeAccept(struct Decoder_Node *const pxNode, const struct Decoder_Frame *const pxFrame,
+                        const Decoder_Output pxOutput, void *const pvContext)
+{
+    if (pxNode->ulSynced != 0)
+    {
+        pxNode->ulLostFrames += DECODER_ulLostFrames(pxNode->xLast.ulSequence, pxFrame->ulSequence);
+    }
+    
+    pxNode->xLast = *pxFrame;
+    pxNode->ulSynced = 1;
+    pxNode->ulFrames++;
+    
+    if (pxOutput != NULL)
+    {
+        pxOutput(pxFrame, pvContext);
+    }
+}
+
+
+/**
+ * @brief   Hold delta frame until its previous frame is decoded. Oldest
+ *          held frame is dropped when all slots are in use.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @param   pucFrame    Frame with valid CRC.
+ * 
+ * @param   ulLength    Frame length.
+ * 
+ * @return  None
+ */
+static void vNodeHold(struct Decoder_Node *const pxNode, const uint8_t *const pucFrame, const uint32_t ulLength)
+{
+    struct Decoder_Pending *pxSlot = &pxNode->xPending[0];
+    uint32_t ulAge;
+    uint32_t ulOldest = 0;
+    
+    for (uint32_t i = 0; i < DECODER_PENDING_FRAMES; i++)
+    {
+        if (pxNode->xPending[i].ulLength == 0)
+        {
+            pxSlot = &pxNode->xPending[i];
+            break;
+        }
+        
+        ulAge = SEQUENCE_DISTANCE(pxNode->xPending[i].ucFrame[2], pucFrame[2]);
+        if (ulAge == 0)
+        {
+            return; /* Duplicate */
+        }
+        else if (ulAge > ulOldest)
+        {
+            ulOldest = ulAge;
+            pxSlot = &pxNode->xPending[i];
+        }
+    }
+    
+    memcpy(pxSlot->ucFrame, pucFrame, ulLength);
+    pxSlot->ulLength = ulLength;
+}
+
+
+/**
+ * @brief   Decode held frames that follow the last decoded frame, and
+ *          drop held frames older than it.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @param   pxOutput    Called with each decoded frame.
+ * 
+ * @param   pvContext   Passed to pxOutput.
+ * 
+ * @return  Number of decoded frames.
+ */
+static uint32_t ulNodeDrain(struct Decoder_Node *const pxNode, const Decoder_Output pxOutput, void *const pvContext)
+{
+    struct Decoder_Frame xFrame;
+    struct Decoder_Pending *pxSlot;
+    uint32_t ulDecoded = 0;
+    uint32_t ulDistance;
+    uint32_t ulFound;
+    
+    do
+    {
+        ulFound = 0;
+        for (uint32_t i = 0; i < DECODER_PENDING_FRAMES; i++)
+        {
+            pxSlot = &pxNode->xPending[i];
+            if (pxSlot->ulLength == 0)
+            {
+                continue;
+            }
+            
+            ulDistance = SEQUENCE_DISTANCE(pxNode->xLast.ulSequence, pxSlot->ucFrame[2]);
+            if (ulDistance == 1)
+            {
+                if (DECODER_lDecode(pxSlot->ucFrame, pxSlot->ulLength, &pxNode->xLast, &xFrame) == DECODER_OK)
+                {
+                    vNodeAccept(pxNode, &xFrame, pxOutput, pvContext);
+                    ulDecoded++;
+                    ulFound = 1;
+                }
+                else
+                {
+                    pxNode->ulErrors++;
+                }
+                pxSlot->ulLength = 0;
+            }
+            else if (!SEQUENCE_AHEAD(ulDistance))
+            {
+                pxSlot->ulLength = 0; /* Skipped, counted as lost */
+            }
+        }
+    } while (ulFound != 0);
+    
+    return ulDecoded;
+}
+
+
+/**
+ * @brief   Forget decoder state of a rebooted node. Held frames are
+ *          from before the reboot and are dropped.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @return  None
+ */
+static void vNodeResync(struct Decoder_Node *const pxNode)
+{
+    pxNode->ulSynced = 0;
+    pxNode->ulResyncs++;
+    
+    for (uint32_t i = 0; i < DECODER_PENDING_FRAMES; i++)
+    {
+        pxNode->xPending[i].ulLength = 0;
+    }
+}
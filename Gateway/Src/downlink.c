@@ -0,0 +1,168 @@
+/**
+ * downlink.c
+ * This file queues and encodes commands sent to nodes with ACK payloads.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "downlink.h"
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Initialize downlink state of a node.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @param   ulNode      Node ID.
+ * 
+ * @return  None
+ */
+void DOWNLINK_vNodeInit(struct Downlink_Node *const pxNode, const uint32_t ulNode)
+{
+    memset(pxNode, 0, sizeof(*pxNode));
+    pxNode->ulNode = ulNode;
+}
+
+
+/**
+ * @brief   Queue command for the next payload. Command replaces a queued
+ *          one of the same type and target, so only the latest setting
+ *          is sent.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @param   pxCommand   Command to send.
+ * 
+ * @return  DOWNLINK_OK or negative error code.
+ */
+int32_t DOWNLINK_lQueue(struct Downlink_Node *const pxNode, const struct Command *const pxCommand)
+{
+    if ((pxCommand == NULL) || (pxCommand->ucType == 0) || (pxCommand->ucType >= COMMAND_TYPE_COUNT))
+    {
+        return DOWNLINK_BAD_COMMAND;
+    }
+    
+    for (uint32_t i = 0; i < pxNode->ulPending; i++)
+    {
+        if ((pxNode->xPending[i].ucType == pxCommand->ucType) && (pxNode->xPending[i].ucTarget == pxCommand->ucTarget))
+        {
+            pxNode->xPending[i].usValue = pxCommand->usValue;
+            return DOWNLINK_OK;
+        }
+    }
+    
+    if (pxNode->ulPending == COMMAND_MAX_COUNT)
+    {
+        return DOWNLINK_FULL;
+    }
+    
+    pxNode->xPending[pxNode->ulPending] = *pxCommand;
+    pxNode->ulPending++;
+    
+    return DOWNLINK_OK;
+}
+
+
+/**
+ * @brief   Encode queued commands to a payload, unless the previous one
+ *          still waits for an uplink.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @param   pucPayload  Room for COMMAND_PAYLOAD_MAX_SIZE bytes, to be
+ *                      written with W_ACK_PAYLOAD to COMMAND_PIPE(node).
+ * 
+ * @return  Payload length, 0 if there is nothing new to write.
+ */
+uint32_t DOWNLINK_ulLoad(struct Downlink_Node *const pxNode, uint8_t *const pucPayload)
+{
+    uint32_t ulLength;
+    
+    if ((pxNode->ulLoadedLength != 0) || (pxNode->ulPending == 0))
+    {
+        return 0;
+    }
+    
+    ulLength = DOWNLINK_ulEncode(pxNode->ulNode, pxNode->ulSequence, pxNode->xPending, pxNode->ulPending, pxNode->ucLoaded);
+    pxNode->ulLoadedLength = ulLength;
+    pxNode->ulSequence = (pxNode->ulSequence + 1) & 0xFFUL;
+    pxNode->ulCommands += pxNode->ulPending;
+    pxNode->ulPending = 0;
+    
+    memcpy(pucPayload, pxNode->ucLoaded, ulLength);
+    
+    return ulLength;
+}
+
+
+/**
+ * @brief   Frame received from the node. Its ACK carried the loaded
+ *          payload, so the next one can be loaded.
+ * 
+ * @note    A lost ACK makes the node retransmit and the nRF24L01 send
+ *          the payload again, node drops the copy by its sequence number.
+ * 
+ * @param   pxNode      Node state.
+ * 
+ * @return  None
+ */
+void DOWNLINK_vUplink(struct Downlink_Node *const pxNode)
+{
+    if (pxNode->ulLoadedLength != 0)
+    {
+        pxNode->ulPayloads++;
+        pxNode->ulBytes += pxNode->ulLoadedLength;
+        pxNode->ulLoadedLength = 0;
+    }
+}
+
+
+/**
+ * @brief   Encode commands to an ACK payload, see command.h.
+ * 
+ * @param   ulNode      Node ID.
+ * 
+ * @param   ulSequence  Payload sequence number.
+ * 
+ * @param   pxCommands  Commands to encode.
+ * 
+ * @param   ulCount     Number of commands, max COMMAND_MAX_COUNT.
+ * 
+ * @param   pucPayload  Room for COMMAND_SIZE(ulCount) bytes.
+ * 
+ * @return  Payload length, 0 if there are too many commands.
+ */
+uint32_t DOWNLINK_ulEncode(const uint32_t ulNode, const uint32_t ulSequence, const struct Command *const pxCommands,
+                           const uint32_t ulCount, uint8_t *const pucPayload)
+{
+    const uint32_t ulLength = COMMAND_SIZE(ulCount);
+    uint16_t usCrc;
+    
+    if (ulCount > COMMAND_MAX_COUNT)
+    {
+        return 0;
+    }
+    
+    pucPayload[0] = (uint8_t)((COMMAND_VERSION << 4) | ulCount);
+    pucPayload[1] = (uint8_t)ulNode;
+    pucPayload[2] = (uint8_t)ulSequence;
+    
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        uint8_t *const pucRecord = &pucPayload[COMMAND_HEADER_SIZE + i * COMMAND_RECORD_SIZE];
+        
+        pucRecord[0] = pxCommands[i].ucType;
+        pucRecord[1] = pxCommands[i].ucTarget;
+        pucRecord[2] = (uint8_t)(pxCommands[i].usValue & 0xFF);
+        pucRecord[3] = (uint8_t)(pxCommands[i].usValue >> 8);
+    }
+    
+    usCrc = FRAME_usChecksum(pucPayload, ulLength - COMMAND_CRC_SIZE);
+    pucPayload[ulLength - 2] = (uint8_t)(usCrc & 0xFF);
+    pucPayload[ulLength - 1] = (uint8_t)(usCrc >> 8);
+    
+    return ulLength;
+}
@@ -0,0 +1,243 @@
+/**
+ * filterbench.c
+ * This file replays soil moisture traces through the firmware sample
+ * filters and reports their cost and the dry decisions they make.
+ * 
+ * Plain C99 host program, build with Remote/Inc in the include path:
+ *  cc -std=c99 -O2 -IRemote/Inc Gateway/Src/filterbench.c Remote/Src/filter.c
+ * 
+ * Usage: filterbench [threshold trace...]
+ * A trace has one sample in % per line, lines starting with # are
+ * skipped. Without arguments a generated trace of a wet probe with dry
+ * spikes is replayed, so every dry decision on it is false.
+ * 
+ * Sensor task waters when the median is below threshold, raw and the
+ * other outputs are shown for comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "filter.h"
+
+
+/* Local defines */
+#define TRACE_MAX_SAMPLES               (1000000UL)
+#define TIMING_ROUNDS                   (20UL)
+
+/* Generated trace */
+#define GENERATED_SAMPLES               (1000000UL)
+#define GENERATED_THRESHOLD             (30L)   /* SOIL_MOISTURE_THRESHOLD */
+#define GENERATED_WET                   (60L)
+#define GENERATED_NOISE                 (2L)    /* Uniform +-% */
+#define GENERATED_DRY                   (10L)
+#define GENERATED_SPIKE_PER_MILLE       (20UL)
+
+/* Outputs compared */
+enum Bench_Outputs
+{
+    BENCH_RAW,
+    BENCH_MEDIAN,
+    BENCH_TRIMMED_MEAN,
+    BENCH_SMOOTHED,
+    BENCH_OUTPUT_COUNT
+};
+
+
+/* Local variables */
+static int32_t lTrace[TRACE_MAX_SAMPLES];
+static uint32_t ulRandom = 1;
+
+static const char *const pcOutputNames[BENCH_OUTPUT_COUNT] =
+{
+    [BENCH_RAW]             = "raw",
+    [BENCH_MEDIAN]          = "median",
+    [BENCH_TRIMMED_MEAN]    = "trimmed mean",
+    [BENCH_SMOOTHED]        = "smoothed",
+};
+
+
+/* Local function prototypes */
+static uint32_t ulRead(const char *const pcPath, int32_t *const plTrace, const uint32_t ulMax);
+static uint32_t ulGenerate(int32_t *const plTrace, const uint32_t ulCount);
+static uint32_t ulNextRandom(void);
+static void vReplay(const char *const pcName, const int32_t *const plTrace, const uint32_t ulCount, const int32_t lThreshold);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Replay traces given as arguments, or a generated one.
+ * 
+ * @param   argc        Argument count.
+ * 
+ * @param   argv        Threshold and trace paths.
+ * 
+ * @return  0, or 1 if a trace can't be read.
+ */
+int main(int argc, char *argv[])
+{
+    uint32_t ulCount;
+    
+    if (argc < 3)
+    {
+        ulCount = ulGenerate(lTrace, GENERATED_SAMPLES);
+        vReplay("generated wet probe", lTrace, ulCount, GENERATED_THRESHOLD);
+        return 0;
+    }
+    
+    for (int i = 2; i < argc; i++)
+    {
+        ulCount = ulRead(argv[i], lTrace, TRACE_MAX_SAMPLES);
+        if (ulCount == 0)
+        {
+            fprintf(stderr, "%s: no samples\n", argv[i]);
+            return 1;
+        }
+        vReplay(argv[i], lTrace, ulCount, atol(argv[1]));
+    }
+    
+    return 0;
+}
+
+
+/**
+ * @brief   Read trace file.
+ * 
+ * @param   pcPath      Trace path.
+ * 
+ * @param   plTrace     Room for samples.
+ * 
+ * @param   ulMax       Max samples read.
+ * 
+ * @return  Number of samples, 0 if file can't be opened.
+ */
+static uint32_t ulRead(const char *const pcPath, int32_t *const plTrace, const uint32_t ulMax)
+{
+    FILE *pxFile = fopen(pcPath, "r");
+    char cLine[64];
+    uint32_t ulCount = 0;
+    
+    if (pxFile == NULL)
+    {
+        return 0;
+    }
+    
+    while ((ulCount < ulMax) && (fgets(cLine, sizeof(cLine), pxFile) != NULL))
+    {
+        if ((cLine[0] != '#') && (cLine[0] != '\n'))
+        {
+            plTrace[ulCount++] = (int32_t)atol(cLine);
+        }
+    }
+    
+    fclose(pxFile);
+    
+    return ulCount;
+}
+
+
+/**
+ * @brief   Generate wet probe trace with noise and single dry spikes.
+ * 
+ * @param   plTrace     Room for samples.
+ * 
+ * @param   ulCount     Number of samples.
+ * 
+ * @return  Number of samples.
+ */
+static uint32_t ulGenerate(int32_t *const plTrace, const uint32_t ulCount)
+{
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        plTrace[i] = GENERATED_WET + (int32_t)(ulNextRandom() % (2 * GENERATED_NOISE + 1)) - GENERATED_NOISE;
+        
+        if ((ulNextRandom() % 1000) < GENERATED_SPIKE_PER_MILLE)
+        {
+            plTrace[i] = GENERATED_DRY;
+        }
+    }
+    
+    return ulCount;
+}
+
+
+/**
+ * @brief   Linear congruential generator, same trace on every host.
+ * 
+ * @param   None
+ * 
+ * @return  Pseudo random number 0...32767.
+ */
+static uint32_t ulNextRandom(void)
+{
+    ulRandom = ulRandom * 1103515245UL + 12345UL;
+    
+    return (ulRandom >> 16) & 0x7FFF;
+}
+
+
+/**
+ * @brief   Count dry decisions of each filter output and time
+ *          FILTER_vUpdate().
+ * 
+ * @param   pcName      Trace name for report.
+ * 
+ * @param   plTrace     Samples.
+ * 
+ * @param   ulCount     Number of samples.
+ * 
+ * @param   lThreshold  Dry below.
+ * 
+ * @return  None
+ */
+static void vReplay(const char *const pcName, const int32_t *const plTrace, const uint32_t ulCount, const int32_t lThreshold)
+{
+    struct Filter xFilter;
+    struct Filter_Output xOutput;
+    int32_t lValues[BENCH_OUTPUT_COUNT];
+    uint32_t ulDry[BENCH_OUTPUT_COUNT] = { 0 };
+    uint32_t ulCheck = 0;
+    clock_t xStart;
+    double dSeconds;
+    
+    FILTER_vInit(&xFilter);
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        FILTER_vUpdate(&xFilter, plTrace[i], &xOutput);
+        
+        lValues[BENCH_RAW] = plTrace[i];
+        lValues[BENCH_MEDIAN] = xOutput.lMedian;
+        lValues[BENCH_TRIMMED_MEAN] = xOutput.lTrimmedMean;
+        lValues[BENCH_SMOOTHED] = xOutput.lSmoothed;
+        
+        for (uint32_t j = 0; j < BENCH_OUTPUT_COUNT; j++)
+        {
+            ulDry[j] += (lValues[j] < lThreshold) ? 1 : 0;
+        }
+    }
+    
+    /* Outputs are summed so the compiler can't drop the updates */
+    xStart = clock();
+    for (uint32_t ulRound = 0; ulRound < TIMING_ROUNDS; ulRound++)
+    {
+        FILTER_vInit(&xFilter);
+        for (uint32_t i = 0; i < ulCount; i++)
+        {
+            FILTER_vUpdate(&xFilter, plTrace[i], &xOutput);
+            ulCheck += (uint32_t)xOutput.lSmoothed;
+        }
+    }
+    dSeconds = (double)(clock() - xStart) / CLOCKS_PER_SEC;
+    
+    printf("%s: %lu samples, threshold %ld, window %lu\n", pcName, (unsigned long)ulCount, (long)lThreshold,
+           (unsigned long)FILTER_WINDOW);
+    for (uint32_t j = 0; j < BENCH_OUTPUT_COUNT; j++)
+    {
+        printf("  %-13s %8lu dry decisions, %7.2f per 1000 samples\n", pcOutputNames[j], (unsigned long)ulDry[j],
+               (1000.0 * ulDry[j]) / ulCount);
+    }
+    printf("  FILTER_vUpdate %.1f ns per sample (check %lu)\n", (1e9 * dSeconds) / ((double)ulCount * TIMING_ROUNDS),
+           (unsigned long)ulCheck);
+}
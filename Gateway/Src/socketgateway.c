@@ -0,0 +1,278 @@
+/**
+ * socketgateway.c
+ * This file is a gateway for the virtual nRF24L01+ of the host build. It
+ * takes frames from the UNIX-domain socket of Host/Src/vradio.c, decodes
+ * them and answers with the ACK payload of the pipe, like a gateway
+ * radio with W_ACK_PAYLOAD.
+ * 
+ * POSIX C99 host program, build with Remote/Inc and Host/Inc in the
+ * include path:
+ *  cc -std=gnu99 -O2 -IRemote/Inc -IGateway/Inc -IHost/Inc Gateway/Src/socketgateway.c Gateway/Src/decoder.c
+ *     Gateway/Src/downlink.c -o socketgateway
+ * 
+ * Usage: socketgateway socket [command interval] [-v]
+ * Serves one node program, e.g. radiosoak -u socket, until it
+ * disconnects. Every command interval:th frame of a node queues a
+ * threshold command for it, 0 for none. -v prints decoded frames.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "decoder.h"
+#include "downlink.h"
+#include "vradio.h"
+
+
+/* Local defines */
+#define GATEWAY_NODES                   (256UL) /* Node ID is one byte */
+#define GATEWAY_COMMAND_INTERVAL        (4UL)
+
+/* Gateway state of one node */
+struct Gateway_Node
+{
+    struct Decoder_Node xDecoder;
+    struct Downlink_Node xDownlink;
+    uint32_t ulUplinks;
+};
+
+
+/* Local variables */
+static struct Gateway_Node *pxNodes[GATEWAY_NODES];
+static uint32_t ulCommandInterval = GATEWAY_COMMAND_INTERVAL;
+static uint32_t ulVerbose = 0;
+static uint8_t ucLoaded[VRADIO_PIPES][VRADIO_DATAGRAM_MAX];   /* Pipe and ACK payload */
+
+
+/* Local function prototypes */
+static int32_t lListen(const char *const pcPath);
+static uint32_t ulReceive(const uint32_t ulPipe, const uint8_t *const pucFrame, const uint32_t ulLength);
+static void vOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext);
+static void vReport(void);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Serve one connection, then print node counters.
+ * 
+ * @param   argc        Argument count.
+ * 
+ * @param   argv        Socket path, command interval and -v.
+ * 
+ * @return  0, or 1 if the socket failed.
+ */
+int main(int argc, char *argv[])
+{
+    uint8_t ucDatagram[VRADIO_DATAGRAM_MAX];
+    int32_t lListener;
+    int32_t lSocket;
+    ssize_t lReceived;
+    uint32_t ulPipe;
+    uint32_t ulLength;
+    
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s socket [command interval] [-v]\n", argv[0]);
+        return 1;
+    }
+    
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+        {
+            ulVerbose = 1;
+        }
+        else
+        {
+            ulCommandInterval = (uint32_t)strtoul(argv[i], NULL, 0);
+        }
+    }
+    
+    lListener = lListen(argv[1]);
+    if (lListener < 0)
+    {
+        return 1;
+    }
+    
+    lSocket = accept(lListener, NULL, NULL);
+    if (lSocket < 0)
+    {
+        perror("accept");
+        return 1;
+    }
+    
+    /* Node program waits for the answer to each frame */
+    while ((lReceived = recv(lSocket, ucDatagram, sizeof(ucDatagram), 0)) > 1)
+    {
+        ulPipe = ucDatagram[0];
+        if (ulPipe >= VRADIO_PIPES)
+        {
+            fprintf(stderr, "bad pipe %lu\n", (unsigned long)ulPipe);
+            break;
+        }
+        
+        ulLength = ulReceive(ulPipe, &ucDatagram[1], (uint32_t)(lReceived - 1));
+        
+        ucLoaded[ulPipe][0] = (uint8_t)ulPipe;
+        if (send(lSocket, ucLoaded[ulPipe], ulLength + 1, 0) < 0)
+        {
+            perror("send");
+            break;
+        }
+    }
+    
+    close(lSocket);
+    close(lListener);
+    unlink(argv[1]);
+    
+    vReport();
+    
+    return 0;
+}
+
+
+/**
+ * @brief   Create listening socket.
+ * 
+ * @param   pcPath      Socket path, replaced if it exists.
+ * 
+ * @return  Socket, or -1 on error.
+ */
+static int32_t lListen(const char *const pcPath)
+{
+    struct sockaddr_un xAddress = { .sun_family = AF_UNIX };
+    int32_t lSocket;
+    
+    if (strlen(pcPath) >= sizeof(xAddress.sun_path))
+    {
+        fprintf(stderr, "%s: path too long\n", pcPath);
+        return -1;
+    }
+    strcpy(xAddress.sun_path, pcPath);
+    (void)unlink(pcPath);
+    
+    lSocket = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if ((lSocket < 0) || (bind(lSocket, (struct sockaddr *)&xAddress, sizeof(xAddress)) != 0) || (listen(lSocket, 1) != 0))
+    {
+        perror(pcPath);
+        return -1;
+    }
+    
+    return lSocket;
+}
+
+
+/**
+ * @brief   Decode frame and load the next ACK payload of the pipe.
+ * 
+ * @param   ulPipe      Pipe of the frame.
+ * 
+ * @param   pucFrame    Frame.
+ * 
+ * @param   ulLength    Frame length.
+ * 
+ * @return  Length of ACK payload, written after the pipe byte of
+ *          ucLoaded[ulPipe].
+ */
+static uint32_t ulReceive(const uint32_t ulPipe, const uint8_t *const pucFrame, const uint32_t ulLength)
+{
+    const uint32_t ulNode = (ulLength >= FRAME_SIZE(0)) ? pucFrame[1] : 0;
+    struct Gateway_Node *pxNode = pxNodes[ulNode];
+    const struct Command xCommand =
+    {
+        .ucType = COMMAND_THRESHOLD,
+        .ucTarget = 0,
+        .usValue = 30,
+    };
+    
+    if (pxNode == NULL)
+    {
+        pxNode = calloc(1, sizeof(*pxNode));
+        if (pxNode == NULL)
+        {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        DECODER_vNodeInit(&pxNode->xDecoder);
+        DOWNLINK_vNodeInit(&pxNode->xDownlink, ulNode);
+        pxNodes[ulNode] = pxNode;
+    }
+    
+    (void)DECODER_lPush(&pxNode->xDecoder, pucFrame, ulLength, vOutput, NULL);
+    
+    /* Node of another pipe would get the commands */
+    if (COMMAND_PIPE(ulNode) != ulPipe)
+    {
+        return 0;
+    }
+    
+    pxNode->ulUplinks++;
+    DOWNLINK_vUplink(&pxNode->xDownlink);
+    if ((ulCommandInterval != 0) && ((pxNode->ulUplinks % ulCommandInterval) == 0))
+    {
+        (void)DOWNLINK_lQueue(&pxNode->xDownlink, &xCommand);
+    }
+    
+    return DOWNLINK_ulLoad(&pxNode->xDownlink, &ucLoaded[ulPipe][1]);
+}
+
+
+/**
+ * @brief   Print decoded frame with -v.
+ * 
+ * @param   pxFrame     Decoded frame.
+ * 
+ * @param   pvContext   Unused.
+ * 
+ * @return  None
+ */
+static void vOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext)
+{
+    (void)pvContext;
+    
+    if (ulVerbose == 0)
+    {
+        return;
+    }
+    
+    printf("node %lu seq %3lu type %lu:", (unsigned long)pxFrame->ulNode, (unsigned long)pxFrame->ulSequence,
+           (unsigned long)pxFrame->ulType);
+    for (uint32_t i = 0; (i < pxFrame->ulFieldCount) && (pxFrame->ulSampleCount > 0); i++)
+    {
+        printf(" %s %ld", DECODER_pcFieldName(pxFrame->xFields[i].ulType),
+               (long)pxFrame->xSamples[pxFrame->ulSampleCount - 1].lValues[i]);
+    }
+    printf("\n");
+}
+
+
+/**
+ * @brief   Print counters of the nodes heard.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vReport(void)
+{
+    for (uint32_t i = 0; i < GATEWAY_NODES; i++)
+    {
+        const struct Gateway_Node *const pxNode = pxNodes[i];
+        
+        if (pxNode == NULL)
+        {
+            continue;
+        }
+        
+        printf("node %lu: frames %lu, lost %lu, stale %lu, resyncs %lu, errors %lu, command payloads %lu, commands %lu\n",
+               (unsigned long)i, (unsigned long)pxNode->xDecoder.ulFrames, (unsigned long)pxNode->xDecoder.ulLostFrames,
+               (unsigned long)pxNode->xDecoder.ulStaleFrames, (unsigned long)pxNode->xDecoder.ulResyncs,
+               (unsigned long)pxNode->xDecoder.ulErrors, (unsigned long)pxNode->xDownlink.ulPayloads,
+               (unsigned long)pxNode->xDownlink.ulCommands);
+    }
+}
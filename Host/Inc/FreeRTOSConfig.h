@@ -0,0 +1,98 @@
+/**
+ * FreeRTOSConfig.h
+ * Kernel configuration of the host build, same as the target one in
+ * FreeRTOS/config/KL25Z4/gcc apart from the port specific settings.
+ * 
+ * Tickless idle is off, idle hook of the host program sleeps with
+ * __WFI() until the next interrupt instead. Asserts are always on and
+ * stop the program.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* System headers */
+#include <stdint.h>
+
+/* Processor Expert switches of the kernel sources, see target config */
+#define configGENERATE_STATIC_SOURCES             1
+#define configPEX_KINETIS_SDK                     1
+#define configSYSTICK_USE_LOW_POWER_TIMER         0
+#define configFRTOS_MEMORY_SCHEME                 3
+#define configUSE_HEAP_SECTION_NAME               0
+#define configCOMPILER_ARM_GCC                    1
+#define configCOMPILER_ARM_IAR                    2
+#define configCOMPILER                            configCOMPILER_ARM_GCC
+
+#define configUSE_PREEMPTION                      1
+#define configUSE_IDLE_HOOK                       1
+#define configUSE_TICK_HOOK                       0
+#define configUSE_MALLOC_FAILED_HOOK              0
+#define configTICK_RATE_HZ                        ((TickType_t)200)
+#define configCPU_CLOCK_HZ                        SystemCoreClock
+#define configBUS_CLOCK_HZ                        SystemCoreClock
+#define configMINIMAL_STACK_SIZE                  ((unsigned short)200)
+#define configTOTAL_HEAP_SIZE                     ((size_t)(0x2000))
+#define configMAX_TASK_NAME_LEN                   12
+#define configUSE_TRACE_FACILITY                  0
+#define configUSE_16_BIT_TICKS                    1
+#define configIDLE_SHOULD_YIELD                   1
+#define configUSE_CO_ROUTINES                     0
+#define configUSE_MUTEXES                         1
+#define configCHECK_FOR_STACK_OVERFLOW            0
+#define configUSE_RECURSIVE_MUTEXES               1
+#define configQUEUE_REGISTRY_SIZE                 0
+#define configUSE_QUEUE_SETS                      0
+#define configUSE_COUNTING_SEMAPHORES             1
+#define configUSE_APPLICATION_TASK_TAG            0
+#define configUSE_TICKLESS_IDLE                   0
+
+#define configMAX_PRIORITIES                      ((unsigned long)18)
+#define configMAX_CO_ROUTINE_PRIORITIES           2
+
+#define configUSE_TIMERS                          1
+#define configTIMER_TASK_PRIORITY                 (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH                  10
+#define configTIMER_TASK_STACK_DEPTH              (configMINIMAL_STACK_SIZE * 2)
+
+#define INCLUDE_vTaskPrioritySet                  1
+#define INCLUDE_uxTaskPriorityGet                 1
+#define INCLUDE_vTaskDelete                       1
+#define INCLUDE_vTaskCleanUpResources             1
+#define INCLUDE_vTaskSuspend                      1
+#define INCLUDE_vTaskDelayUntil                   1
+#define INCLUDE_vTaskDelay                        1
+#define INCLUDE_uxTaskGetStackHighWaterMark       1
+#define INCLUDE_xTaskGetSchedulerState            1
+#define INCLUDE_xQueueGetMutexHolder              1
+#define INCLUDE_xTaskGetCurrentTaskHandle         0
+#define INCLUDE_xTaskGetIdleTaskHandle            0
+#define INCLUDE_eTaskGetState                     0
+#define INCLUDE_pcTaskGetTaskName                 0
+#define INCLUDE_xEventGroupSetBitFromISR          1
+#define INCLUDE_xTimerPendFunctionCall            1
+
+/* Same priority levels as Cortex-M0+ */
+#define configPRIO_BITS                           2
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY   3
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 1
+#define configKERNEL_INTERRUPT_PRIORITY           (configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY      (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+
+/* Assert stops the program, see port.c */
+void vPortAssertCalled(const uint32_t ulLine, const char *const pcFile);
+#define configASSERT(x) if ((x) == 0) vPortAssertCalled(__LINE__, __FILE__)
+
+/* Idle time measurement, see benchmark.c */
+void BENCH_vTaskSwitchedIn(void *const pvTask);
+void BENCH_vTaskSwitchedOut(void *const pvTask);
+#define traceTASK_SWITCHED_IN()                   BENCH_vTaskSwitchedIn(pxCurrentTCB)
+#define traceTASK_SWITCHED_OUT()                  BENCH_vTaskSwitchedOut(pxCurrentTCB)
+
+extern uint32_t SystemCoreClock;
+
+#define portINLINE __inline
+
+#include "stdbool.h"
+
+#endif /* FREERTOS_CONFIG_H */
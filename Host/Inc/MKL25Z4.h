@@ -0,0 +1,999 @@
+/**
+ * MKL25Z4.h
+ * Host stand-in for the MKL25Z4 device header of the Kinetis SDK.
+ * 
+ * Register blocks are plain memory owned by the models in Host/Src,
+ * field macros are the same as in the vendor header. Block macros go
+ * through SOC_pvAccess(), which advances virtual time by a bus access
+ * and lets the models update the block first. PORTx and FGPIOx are
+ * constant addresses, SPI1 driver keeps them in a static table, so the
+ * port model picks up their writes on the next access of any block.
+ * 
+ * Differences to the target layout, models need them to see writes:
+ *  PORT_Type ISFR      64 bits, model keeps bit 32 set, so a write
+ *                      of any flag clears it
+ *  SPI_Type D          16 bits, model keeps upper byte at 0x5A, so a
+ *                      write of any byte, sign extended or not,
+ *                      changes it
+ * Read-only registers are writable, models set them.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* User headers */
+#include "soc.h"
+
+/* Global defines */
+#define __IO                            volatile
+#define __I                             volatile
+#define __O                             volatile
+#define __STATIC_INLINE                 static inline
+#define __NVIC_PRIO_BITS                (SOC_PRIORITY_BITS)
+
+/* Core intrinsics */
+#define __WFI()                         SOC_vWaitForInterrupt()
+#define __disable_irq()                 ((void)SOC_ulDisableInterrupts())
+#define __enable_irq()                  SOC_vRestoreInterrupts(0)
+#define __get_PRIMASK()                 SOC_ulInterruptsMasked()
+#define __BKPT(value)                   __builtin_trap()
+#define __DSB()                         ((void)0)
+#define __ISB()                         ((void)0)
+#define __NOP()                         ((void)0)
+
+/* Exception and interrupt numbers */
+typedef enum IRQn
+{
+    NonMaskableInt_IRQn         = -14,
+    HardFault_IRQn              = -13,
+    SVCall_IRQn                 = -5,
+    PendSV_IRQn                 = -2,
+    SysTick_IRQn                = -1,
+    DMA0_IRQn                   = 0,
+    DMA1_IRQn                   = 1,
+    DMA2_IRQn                   = 2,
+    DMA3_IRQn                   = 3,
+    FTFA_IRQn                   = 5,
+    LVD_LVW_IRQn                = 6,
+    LLW_IRQn                    = 7,
+    I2C0_IRQn                   = 8,
+    I2C1_IRQn                   = 9,
+    SPI0_IRQn                   = 10,
+    SPI1_IRQn                   = 11,
+    UART0_IRQn                  = 12,
+    UART1_IRQn                  = 13,
+    UART2_IRQn                  = 14,
+    ADC0_IRQn                   = 15,
+    CMP0_IRQn                   = 16,
+    TPM0_IRQn                   = 17,
+    TPM1_IRQn                   = 18,
+    TPM2_IRQn                   = 19,
+    RTC_IRQn                    = 20,
+    RTC_Seconds_IRQn            = 21,
+    PIT_IRQn                    = 22,
+    USB0_IRQn                   = 24,
+    DAC0_IRQn                   = 25,
+    TSI0_IRQn                   = 26,
+    MCG_IRQn                    = 27,
+    LPTimer_IRQn                = 28,
+    PORTA_IRQn                  = 30,
+    PORTD_IRQn                  = 31
+} IRQn_Type;
+
+/* Register blocks */
+typedef struct
+{
+    __IO uint32_t SC1[2];
+    __IO uint32_t CFG1;
+    __IO uint32_t CFG2;
+    __I  uint32_t R[2];
+    __IO uint32_t CV1;
+    __IO uint32_t CV2;
+    __IO uint32_t SC2;
+    __IO uint32_t SC3;
+    __IO uint32_t OFS;
+    __IO uint32_t PG;
+    __IO uint32_t MG;
+    __IO uint32_t CLPD;
+    __IO uint32_t CLPS;
+    __IO uint32_t CLP4;
+    __IO uint32_t CLP3;
+    __IO uint32_t CLP2;
+    __IO uint32_t CLP1;
+    __IO uint32_t CLP0;
+    __IO uint32_t CLMD;
+    __IO uint32_t CLMS;
+    __IO uint32_t CLM4;
+    __IO uint32_t CLM3;
+    __IO uint32_t CLM2;
+    __IO uint32_t CLM1;
+    __IO uint32_t CLM0;
+} ADC_Type;
+
+typedef struct
+{
+    __IO uint8_t CR0;
+    __IO uint8_t CR1;
+    __IO uint8_t FPR;
+    __IO uint8_t SCR;
+    __IO uint8_t DACCR;
+    __IO uint8_t MUXCR;
+} CMP_Type;
+
+typedef struct
+{
+    struct
+    {
+        __IO uint32_t SAR;
+        __IO uint32_t DAR;
+        __IO uint32_t DSR_BCR;
+        __IO uint32_t DCR;
+    } DMA[4];
+} DMA_Type;
+
+typedef struct
+{
+    __IO uint8_t CHCFG[4];
+} DMAMUX_Type;
+
+typedef struct
+{
+    __IO uint32_t PDOR;
+    __O  uint32_t PSOR;
+    __O  uint32_t PCOR;
+    __O  uint32_t PTOR;
+    __I  uint32_t PDIR;
+    __IO uint32_t PDDR;
+} FGPIO_Type;
+
+typedef FGPIO_Type GPIO_Type;
+
+typedef struct
+{
+    __IO uint32_t PCR[32];
+    __O  uint32_t GPCLR;
+    __O  uint32_t GPCHR;
+    __IO uint64_t ISFR;
+} PORT_Type;
+
+typedef struct
+{
+    __IO uint32_t SOPT1;
+    __IO uint32_t SOPT2;
+    __IO uint32_t SOPT4;
+    __IO uint32_t SOPT5;
+    __IO uint32_t SOPT7;
+    __I  uint32_t SDID;
+    __IO uint32_t SCGC4;
+    __IO uint32_t SCGC5;
+    __IO uint32_t SCGC6;
+    __IO uint32_t SCGC7;
+    __IO uint32_t CLKDIV1;
+    __IO uint32_t COPC;
+} SIM_Type;
+
+typedef struct
+{
+    __IO uint8_t C1;
+    __IO uint8_t C2;
+    __IO uint8_t BR;
+    __IO uint8_t S;
+    __IO uint16_t D;
+    __IO uint8_t M;
+} SPI_Type;
+
+typedef struct
+{
+    __IO uint32_t SC;
+    __IO uint32_t CNT;
+    __IO uint32_t MOD;
+    struct
+    {
+        __IO uint32_t CnSC;
+        __IO uint32_t CnV;
+    } CONTROLS[6];
+    __IO uint32_t STATUS;
+    __IO uint32_t CONF;
+} TPM_Type;
+
+typedef struct
+{
+    __IO uint32_t MCR;
+    __I  uint32_t LTMR64H;
+    __I  uint32_t LTMR64L;
+    struct
+    {
+        __IO uint32_t LDVAL;
+        __I  uint32_t CVAL;
+        __IO uint32_t TCTRL;
+        __IO uint32_t TFLG;
+    } CHANNEL[2];
+} PIT_Type;
+
+typedef struct
+{
+    __IO uint32_t CSR;
+    __IO uint32_t PSR;
+    __IO uint32_t CMR;
+    __I  uint32_t CNR;
+} LPTMR_Type;
+
+typedef struct
+{
+    __IO uint8_t FSTAT;
+    __IO uint8_t FCNFG;
+    __I  uint8_t FSEC;
+    __I  uint8_t FOPT;
+    __IO uint8_t FCCOB3;
+    __IO uint8_t FCCOB2;
+    __IO uint8_t FCCOB1;
+    __IO uint8_t FCCOB0;
+    __IO uint8_t FCCOB7;
+    __IO uint8_t FCCOB6;
+    __IO uint8_t FCCOB5;
+    __IO uint8_t FCCOB4;
+    __IO uint8_t FCCOBB;
+    __IO uint8_t FCCOBA;
+    __IO uint8_t FCCOB9;
+    __IO uint8_t FCCOB8;
+} FTFA_Type;
+
+/* Register block memory, see Host/Src/peripherals.c */
+extern ADC_Type xSocAdc0;
+extern CMP_Type xSocCmp0;
+extern DMA_Type xSocDma0;
+extern DMAMUX_Type xSocDmamux0;
+extern FGPIO_Type xSocGpio[SOC_PORT_COUNT];
+extern PORT_Type xSocPort[SOC_PORT_COUNT];
+extern SIM_Type xSocSim;
+extern SPI_Type xSocSpi1;
+extern TPM_Type xSocTpm[3];
+extern PIT_Type xSocPit;
+extern LPTMR_Type xSocLptmr0;
+extern FTFA_Type xSocFtfa;
+
+extern uint32_t SystemCoreClock;
+
+#define ADC0                            ((ADC_Type *)SOC_pvAccess(&xSocAdc0))
+#define CMP0                            ((CMP_Type *)SOC_pvAccess(&xSocCmp0))
+#define DMA0                            ((DMA_Type *)SOC_pvAccess(&xSocDma0))
+#define DMAMUX0                         ((DMAMUX_Type *)SOC_pvAccess(&xSocDmamux0))
+#define SIM                             ((SIM_Type *)SOC_pvAccess(&xSocSim))
+#define SPI1                            ((SPI_Type *)SOC_pvAccess(&xSocSpi1))
+#define TPM0                            ((TPM_Type *)SOC_pvAccess(&xSocTpm[0]))
+#define TPM1                            ((TPM_Type *)SOC_pvAccess(&xSocTpm[1]))
+#define TPM2                            ((TPM_Type *)SOC_pvAccess(&xSocTpm[2]))
+#define PIT                             ((PIT_Type *)SOC_pvAccess(&xSocPit))
+#define LPTMR0                          ((LPTMR_Type *)SOC_pvAccess(&xSocLptmr0))
+#define FTFA                            ((FTFA_Type *)SOC_pvAccess(&xSocFtfa))
+
+#define FGPIOA                          (&xSocGpio[SOC_PORT_A])
+#define FGPIOB                          (&xSocGpio[SOC_PORT_B])
+#define FGPIOC                          (&xSocGpio[SOC_PORT_C])
+#define FGPIOD                          (&xSocGpio[SOC_PORT_D])
+#define FGPIOE                          (&xSocGpio[SOC_PORT_E])
+#define GPIOA                           FGPIOA
+#define GPIOB                           FGPIOB
+#define GPIOC                           FGPIOC
+#define GPIOD                           FGPIOD
+#define GPIOE                           FGPIOE
+#define PORTA                           (&xSocPort[SOC_PORT_A])
+#define PORTB                           (&xSocPort[SOC_PORT_B])
+#define PORTC                           (&xSocPort[SOC_PORT_C])
+#define PORTD                           (&xSocPort[SOC_PORT_D])
+#define PORTE                           (&xSocPort[SOC_PORT_E])
+#define PORTA_ISFR                      (PORTA->ISFR)
+
+#define DMAMUX_CHCFG_COUNT              (4u)
+
+
+/* Global function prototypes */
+void NVIC_SetPriority(const IRQn_Type xIRQn, const uint32_t ulPriority);
+uint32_t NVIC_GetPriority(const IRQn_Type xIRQn);
+void NVIC_EnableIRQ(const IRQn_Type xIRQn);
+void NVIC_DisableIRQ(const IRQn_Type xIRQn);
+void NVIC_SetPendingIRQ(const IRQn_Type xIRQn);
+void NVIC_ClearPendingIRQ(const IRQn_Type xIRQn);
+uint32_t NVIC_GetPendingIRQ(const IRQn_Type xIRQn);
+
+/* Field macros, names and values of the vendor header */
+
+/* ADC */
+#define ADC_SC1_COCO_MASK                        (0x80u)
+#define ADC_SC1_COCO_SHIFT                       (7u)
+#define ADC_SC1_COCO_WIDTH                       (1u)
+#define ADC_SC1_COCO(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC1_COCO_SHIFT)) & ADC_SC1_COCO_MASK)
+#define ADC_SC1_AIEN_MASK                        (0x40u)
+#define ADC_SC1_AIEN_SHIFT                       (6u)
+#define ADC_SC1_AIEN_WIDTH                       (1u)
+#define ADC_SC1_AIEN(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC1_AIEN_SHIFT)) & ADC_SC1_AIEN_MASK)
+#define ADC_SC1_DIFF_MASK                        (0x20u)
+#define ADC_SC1_DIFF_SHIFT                       (5u)
+#define ADC_SC1_DIFF_WIDTH                       (1u)
+#define ADC_SC1_DIFF(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC1_DIFF_SHIFT)) & ADC_SC1_DIFF_MASK)
+#define ADC_SC1_ADCH_MASK                        (0x1Fu)
+#define ADC_SC1_ADCH_SHIFT                       (0u)
+#define ADC_SC1_ADCH_WIDTH                       (5u)
+#define ADC_SC1_ADCH(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC1_ADCH_SHIFT)) & ADC_SC1_ADCH_MASK)
+#define ADC_CFG1_ADLPC_MASK                      (0x80u)
+#define ADC_CFG1_ADLPC_SHIFT                     (7u)
+#define ADC_CFG1_ADLPC_WIDTH                     (1u)
+#define ADC_CFG1_ADLPC(x)                        (((uint32_t)(((uint32_t)(x)) << ADC_CFG1_ADLPC_SHIFT)) & ADC_CFG1_ADLPC_MASK)
+#define ADC_CFG1_ADIV_MASK                       (0x60u)
+#define ADC_CFG1_ADIV_SHIFT                      (5u)
+#define ADC_CFG1_ADIV_WIDTH                      (2u)
+#define ADC_CFG1_ADIV(x)                         (((uint32_t)(((uint32_t)(x)) << ADC_CFG1_ADIV_SHIFT)) & ADC_CFG1_ADIV_MASK)
+#define ADC_CFG1_ADLSMP_MASK                     (0x10u)
+#define ADC_CFG1_ADLSMP_SHIFT                    (4u)
+#define ADC_CFG1_ADLSMP_WIDTH                    (1u)
+#define ADC_CFG1_ADLSMP(x)                       (((uint32_t)(((uint32_t)(x)) << ADC_CFG1_ADLSMP_SHIFT)) & ADC_CFG1_ADLSMP_MASK)
+#define ADC_CFG1_MODE_MASK                       (0xCu)
+#define ADC_CFG1_MODE_SHIFT                      (2u)
+#define ADC_CFG1_MODE_WIDTH                      (2u)
+#define ADC_CFG1_MODE(x)                         (((uint32_t)(((uint32_t)(x)) << ADC_CFG1_MODE_SHIFT)) & ADC_CFG1_MODE_MASK)
+#define ADC_CFG1_ADICLK_MASK                     (0x3u)
+#define ADC_CFG1_ADICLK_SHIFT                    (0u)
+#define ADC_CFG1_ADICLK_WIDTH                    (2u)
+#define ADC_CFG1_ADICLK(x)                       (((uint32_t)(((uint32_t)(x)) << ADC_CFG1_ADICLK_SHIFT)) & ADC_CFG1_ADICLK_MASK)
+#define ADC_CFG2_MUXSEL_MASK                     (0x10u)
+#define ADC_CFG2_MUXSEL_SHIFT                    (4u)
+#define ADC_CFG2_MUXSEL_WIDTH                    (1u)
+#define ADC_CFG2_MUXSEL(x)                       (((uint32_t)(((uint32_t)(x)) << ADC_CFG2_MUXSEL_SHIFT)) & ADC_CFG2_MUXSEL_MASK)
+#define ADC_CFG2_ADACKEN_MASK                    (0x8u)
+#define ADC_CFG2_ADACKEN_SHIFT                   (3u)
+#define ADC_CFG2_ADACKEN_WIDTH                   (1u)
+#define ADC_CFG2_ADACKEN(x)                      (((uint32_t)(((uint32_t)(x)) << ADC_CFG2_ADACKEN_SHIFT)) & ADC_CFG2_ADACKEN_MASK)
+#define ADC_CFG2_ADHSC_MASK                      (0x4u)
+#define ADC_CFG2_ADHSC_SHIFT                     (2u)
+#define ADC_CFG2_ADHSC_WIDTH                     (1u)
+#define ADC_CFG2_ADHSC(x)                        (((uint32_t)(((uint32_t)(x)) << ADC_CFG2_ADHSC_SHIFT)) & ADC_CFG2_ADHSC_MASK)
+#define ADC_CFG2_ADLSTS_MASK                     (0x3u)
+#define ADC_CFG2_ADLSTS_SHIFT                    (0u)
+#define ADC_CFG2_ADLSTS_WIDTH                    (2u)
+#define ADC_CFG2_ADLSTS(x)                       (((uint32_t)(((uint32_t)(x)) << ADC_CFG2_ADLSTS_SHIFT)) & ADC_CFG2_ADLSTS_MASK)
+#define ADC_SC2_ADACT_MASK                       (0x80u)
+#define ADC_SC2_ADACT_SHIFT                      (7u)
+#define ADC_SC2_ADACT_WIDTH                      (1u)
+#define ADC_SC2_ADACT(x)                         (((uint32_t)(((uint32_t)(x)) << ADC_SC2_ADACT_SHIFT)) & ADC_SC2_ADACT_MASK)
+#define ADC_SC2_ADTRG_MASK                       (0x40u)
+#define ADC_SC2_ADTRG_SHIFT                      (6u)
+#define ADC_SC2_ADTRG_WIDTH                      (1u)
+#define ADC_SC2_ADTRG(x)                         (((uint32_t)(((uint32_t)(x)) << ADC_SC2_ADTRG_SHIFT)) & ADC_SC2_ADTRG_MASK)
+#define ADC_SC2_ACFE_MASK                        (0x20u)
+#define ADC_SC2_ACFE_SHIFT                       (5u)
+#define ADC_SC2_ACFE_WIDTH                       (1u)
+#define ADC_SC2_ACFE(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC2_ACFE_SHIFT)) & ADC_SC2_ACFE_MASK)
+#define ADC_SC2_ACFGT_MASK                       (0x10u)
+#define ADC_SC2_ACFGT_SHIFT                      (4u)
+#define ADC_SC2_ACFGT_WIDTH                      (1u)
+#define ADC_SC2_ACFGT(x)                         (((uint32_t)(((uint32_t)(x)) << ADC_SC2_ACFGT_SHIFT)) & ADC_SC2_ACFGT_MASK)
+#define ADC_SC2_ACREN_MASK                       (0x8u)
+#define ADC_SC2_ACREN_SHIFT                      (3u)
+#define ADC_SC2_ACREN_WIDTH                      (1u)
+#define ADC_SC2_ACREN(x)                         (((uint32_t)(((uint32_t)(x)) << ADC_SC2_ACREN_SHIFT)) & ADC_SC2_ACREN_MASK)
+#define ADC_SC2_DMAEN_MASK                       (0x4u)
+#define ADC_SC2_DMAEN_SHIFT                      (2u)
+#define ADC_SC2_DMAEN_WIDTH                      (1u)
+#define ADC_SC2_DMAEN(x)                         (((uint32_t)(((uint32_t)(x)) << ADC_SC2_DMAEN_SHIFT)) & ADC_SC2_DMAEN_MASK)
+#define ADC_SC2_REFSEL_MASK                      (0x3u)
+#define ADC_SC2_REFSEL_SHIFT                     (0u)
+#define ADC_SC2_REFSEL_WIDTH                     (2u)
+#define ADC_SC2_REFSEL(x)                        (((uint32_t)(((uint32_t)(x)) << ADC_SC2_REFSEL_SHIFT)) & ADC_SC2_REFSEL_MASK)
+#define ADC_SC3_CAL_MASK                         (0x80u)
+#define ADC_SC3_CAL_SHIFT                        (7u)
+#define ADC_SC3_CAL_WIDTH                        (1u)
+#define ADC_SC3_CAL(x)                           (((uint32_t)(((uint32_t)(x)) << ADC_SC3_CAL_SHIFT)) & ADC_SC3_CAL_MASK)
+#define ADC_SC3_CALF_MASK                        (0x40u)
+#define ADC_SC3_CALF_SHIFT                       (6u)
+#define ADC_SC3_CALF_WIDTH                       (1u)
+#define ADC_SC3_CALF(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC3_CALF_SHIFT)) & ADC_SC3_CALF_MASK)
+#define ADC_SC3_ADCO_MASK                        (0x8u)
+#define ADC_SC3_ADCO_SHIFT                       (3u)
+#define ADC_SC3_ADCO_WIDTH                       (1u)
+#define ADC_SC3_ADCO(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC3_ADCO_SHIFT)) & ADC_SC3_ADCO_MASK)
+#define ADC_SC3_AVGE_MASK                        (0x4u)
+#define ADC_SC3_AVGE_SHIFT                       (2u)
+#define ADC_SC3_AVGE_WIDTH                       (1u)
+#define ADC_SC3_AVGE(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC3_AVGE_SHIFT)) & ADC_SC3_AVGE_MASK)
+#define ADC_SC3_AVGS_MASK                        (0x3u)
+#define ADC_SC3_AVGS_SHIFT                       (0u)
+#define ADC_SC3_AVGS_WIDTH                       (2u)
+#define ADC_SC3_AVGS(x)                          (((uint32_t)(((uint32_t)(x)) << ADC_SC3_AVGS_SHIFT)) & ADC_SC3_AVGS_MASK)
+#define ADC_CV1_CV_MASK                          (0xFFFFu)
+#define ADC_CV1_CV_SHIFT                         (0u)
+#define ADC_CV1_CV_WIDTH                         (16u)
+#define ADC_CV1_CV(x)                            (((uint32_t)(((uint32_t)(x)) << ADC_CV1_CV_SHIFT)) & ADC_CV1_CV_MASK)
+#define ADC_CV2_CV_MASK                          (0xFFFFu)
+#define ADC_CV2_CV_SHIFT                         (0u)
+#define ADC_CV2_CV_WIDTH                         (16u)
+#define ADC_CV2_CV(x)                            (((uint32_t)(((uint32_t)(x)) << ADC_CV2_CV_SHIFT)) & ADC_CV2_CV_MASK)
+
+/* CMP */
+#define CMP_CR0_HYSTCTR_MASK                     (0x3u)
+#define CMP_CR0_HYSTCTR_SHIFT                    (0u)
+#define CMP_CR0_HYSTCTR_WIDTH                    (2u)
+#define CMP_CR0_HYSTCTR(x)                       (((uint32_t)(((uint32_t)(x)) << CMP_CR0_HYSTCTR_SHIFT)) & CMP_CR0_HYSTCTR_MASK)
+#define CMP_CR0_FILTER_CNT_MASK                  (0x70u)
+#define CMP_CR0_FILTER_CNT_SHIFT                 (4u)
+#define CMP_CR0_FILTER_CNT_WIDTH                 (3u)
+#define CMP_CR0_FILTER_CNT(x)                    (((uint32_t)(((uint32_t)(x)) << CMP_CR0_FILTER_CNT_SHIFT)) & CMP_CR0_FILTER_CNT_MASK)
+#define CMP_CR1_EN_MASK                          (0x1u)
+#define CMP_CR1_EN_SHIFT                         (0u)
+#define CMP_CR1_EN_WIDTH                         (1u)
+#define CMP_CR1_EN(x)                            (((uint32_t)(((uint32_t)(x)) << CMP_CR1_EN_SHIFT)) & CMP_CR1_EN_MASK)
+#define CMP_CR1_OPE_MASK                         (0x2u)
+#define CMP_CR1_OPE_SHIFT                        (1u)
+#define CMP_CR1_OPE_WIDTH                        (1u)
+#define CMP_CR1_OPE(x)                           (((uint32_t)(((uint32_t)(x)) << CMP_CR1_OPE_SHIFT)) & CMP_CR1_OPE_MASK)
+#define CMP_CR1_COS_MASK                         (0x4u)
+#define CMP_CR1_COS_SHIFT                        (2u)
+#define CMP_CR1_COS_WIDTH                        (1u)
+#define CMP_CR1_COS(x)                           (((uint32_t)(((uint32_t)(x)) << CMP_CR1_COS_SHIFT)) & CMP_CR1_COS_MASK)
+#define CMP_CR1_INV_MASK                         (0x8u)
+#define CMP_CR1_INV_SHIFT                        (3u)
+#define CMP_CR1_INV_WIDTH                        (1u)
+#define CMP_CR1_INV(x)                           (((uint32_t)(((uint32_t)(x)) << CMP_CR1_INV_SHIFT)) & CMP_CR1_INV_MASK)
+#define CMP_CR1_PMODE_MASK                       (0x10u)
+#define CMP_CR1_PMODE_SHIFT                      (4u)
+#define CMP_CR1_PMODE_WIDTH                      (1u)
+#define CMP_CR1_PMODE(x)                         (((uint32_t)(((uint32_t)(x)) << CMP_CR1_PMODE_SHIFT)) & CMP_CR1_PMODE_MASK)
+#define CMP_CR1_TRIGM_MASK                       (0x20u)
+#define CMP_CR1_TRIGM_SHIFT                      (5u)
+#define CMP_CR1_TRIGM_WIDTH                      (1u)
+#define CMP_CR1_TRIGM(x)                         (((uint32_t)(((uint32_t)(x)) << CMP_CR1_TRIGM_SHIFT)) & CMP_CR1_TRIGM_MASK)
+#define CMP_CR1_WE_MASK                          (0x40u)
+#define CMP_CR1_WE_SHIFT                         (6u)
+#define CMP_CR1_WE_WIDTH                         (1u)
+#define CMP_CR1_WE(x)                            (((uint32_t)(((uint32_t)(x)) << CMP_CR1_WE_SHIFT)) & CMP_CR1_WE_MASK)
+#define CMP_CR1_SE_MASK                          (0x80u)
+#define CMP_CR1_SE_SHIFT                         (7u)
+#define CMP_CR1_SE_WIDTH                         (1u)
+#define CMP_CR1_SE(x)                            (((uint32_t)(((uint32_t)(x)) << CMP_CR1_SE_SHIFT)) & CMP_CR1_SE_MASK)
+#define CMP_SCR_COUT_MASK                        (0x1u)
+#define CMP_SCR_COUT_SHIFT                       (0u)
+#define CMP_SCR_COUT_WIDTH                       (1u)
+#define CMP_SCR_COUT(x)                          (((uint32_t)(((uint32_t)(x)) << CMP_SCR_COUT_SHIFT)) & CMP_SCR_COUT_MASK)
+#define CMP_SCR_CFF_MASK                         (0x2u)
+#define CMP_SCR_CFF_SHIFT                        (1u)
+#define CMP_SCR_CFF_WIDTH                        (1u)
+#define CMP_SCR_CFF(x)                           (((uint32_t)(((uint32_t)(x)) << CMP_SCR_CFF_SHIFT)) & CMP_SCR_CFF_MASK)
+#define CMP_SCR_CFR_MASK                         (0x4u)
+#define CMP_SCR_CFR_SHIFT                        (2u)
+#define CMP_SCR_CFR_WIDTH                        (1u)
+#define CMP_SCR_CFR(x)                           (((uint32_t)(((uint32_t)(x)) << CMP_SCR_CFR_SHIFT)) & CMP_SCR_CFR_MASK)
+#define CMP_SCR_IEF_MASK                         (0x8u)
+#define CMP_SCR_IEF_SHIFT                        (3u)
+#define CMP_SCR_IEF_WIDTH                        (1u)
+#define CMP_SCR_IEF(x)                           (((uint32_t)(((uint32_t)(x)) << CMP_SCR_IEF_SHIFT)) & CMP_SCR_IEF_MASK)
+#define CMP_SCR_IER_MASK                         (0x10u)
+#define CMP_SCR_IER_SHIFT                        (4u)
+#define CMP_SCR_IER_WIDTH                        (1u)
+#define CMP_SCR_IER(x)                           (((uint32_t)(((uint32_t)(x)) << CMP_SCR_IER_SHIFT)) & CMP_SCR_IER_MASK)
+#define CMP_SCR_DMAEN_MASK                       (0x40u)
+#define CMP_SCR_DMAEN_SHIFT                      (6u)
+#define CMP_SCR_DMAEN_WIDTH                      (1u)
+#define CMP_SCR_DMAEN(x)                         (((uint32_t)(((uint32_t)(x)) << CMP_SCR_DMAEN_SHIFT)) & CMP_SCR_DMAEN_MASK)
+#define CMP_DACCR_VOSEL_MASK                     (0x3Fu)
+#define CMP_DACCR_VOSEL_SHIFT                    (0u)
+#define CMP_DACCR_VOSEL_WIDTH                    (6u)
+#define CMP_DACCR_VOSEL(x)                       (((uint32_t)(((uint32_t)(x)) << CMP_DACCR_VOSEL_SHIFT)) & CMP_DACCR_VOSEL_MASK)
+#define CMP_DACCR_VRSEL_MASK                     (0x40u)
+#define CMP_DACCR_VRSEL_SHIFT                    (6u)
+#define CMP_DACCR_VRSEL_WIDTH                    (1u)
+#define CMP_DACCR_VRSEL(x)                       (((uint32_t)(((uint32_t)(x)) << CMP_DACCR_VRSEL_SHIFT)) & CMP_DACCR_VRSEL_MASK)
+#define CMP_DACCR_DACEN_MASK                     (0x80u)
+#define CMP_DACCR_DACEN_SHIFT                    (7u)
+#define CMP_DACCR_DACEN_WIDTH                    (1u)
+#define CMP_DACCR_DACEN(x)                       (((uint32_t)(((uint32_t)(x)) << CMP_DACCR_DACEN_SHIFT)) & CMP_DACCR_DACEN_MASK)
+#define CMP_MUXCR_MSEL_MASK                      (0x7u)
+#define CMP_MUXCR_MSEL_SHIFT                     (0u)
+#define CMP_MUXCR_MSEL_WIDTH                     (3u)
+#define CMP_MUXCR_MSEL(x)                        (((uint32_t)(((uint32_t)(x)) << CMP_MUXCR_MSEL_SHIFT)) & CMP_MUXCR_MSEL_MASK)
+#define CMP_MUXCR_PSEL_MASK                      (0x38u)
+#define CMP_MUXCR_PSEL_SHIFT                     (3u)
+#define CMP_MUXCR_PSEL_WIDTH                     (3u)
+#define CMP_MUXCR_PSEL(x)                        (((uint32_t)(((uint32_t)(x)) << CMP_MUXCR_PSEL_SHIFT)) & CMP_MUXCR_PSEL_MASK)
+
+/* DMA */
+#define DMA_SAR_SAR_MASK                         (0xFFFFFFFFu)
+#define DMA_SAR_SAR_SHIFT                        (0u)
+#define DMA_SAR_SAR_WIDTH                        (32u)
+#define DMA_SAR_SAR(x)                           (((uint32_t)(((uint32_t)(x)) << DMA_SAR_SAR_SHIFT)) & DMA_SAR_SAR_MASK)
+#define DMA_DAR_DAR_MASK                         (0xFFFFFFFFu)
+#define DMA_DAR_DAR_SHIFT                        (0u)
+#define DMA_DAR_DAR_WIDTH                        (32u)
+#define DMA_DAR_DAR(x)                           (((uint32_t)(((uint32_t)(x)) << DMA_DAR_DAR_SHIFT)) & DMA_DAR_DAR_MASK)
+#define DMA_DSR_BCR_BCR_MASK                     (0xFFFFFFu)
+#define DMA_DSR_BCR_BCR_SHIFT                    (0u)
+#define DMA_DSR_BCR_BCR_WIDTH                    (24u)
+#define DMA_DSR_BCR_BCR(x)                       (((uint32_t)(((uint32_t)(x)) << DMA_DSR_BCR_BCR_SHIFT)) & DMA_DSR_BCR_BCR_MASK)
+#define DMA_DSR_BCR_DONE_MASK                    (0x1000000u)
+#define DMA_DSR_BCR_DONE_SHIFT                   (24u)
+#define DMA_DSR_BCR_DONE_WIDTH                   (1u)
+#define DMA_DSR_BCR_DONE(x)                      (((uint32_t)(((uint32_t)(x)) << DMA_DSR_BCR_DONE_SHIFT)) & DMA_DSR_BCR_DONE_MASK)
+#define DMA_DSR_BCR_BSY_MASK                     (0x2000000u)
+#define DMA_DSR_BCR_BSY_SHIFT                    (25u)
+#define DMA_DSR_BCR_BSY_WIDTH                    (1u)
+#define DMA_DSR_BCR_BSY(x)                       (((uint32_t)(((uint32_t)(x)) << DMA_DSR_BCR_BSY_SHIFT)) & DMA_DSR_BCR_BSY_MASK)
+#define DMA_DSR_BCR_REQ_MASK                     (0x4000000u)
+#define DMA_DSR_BCR_REQ_SHIFT                    (26u)
+#define DMA_DSR_BCR_REQ_WIDTH                    (1u)
+#define DMA_DSR_BCR_REQ(x)                       (((uint32_t)(((uint32_t)(x)) << DMA_DSR_BCR_REQ_SHIFT)) & DMA_DSR_BCR_REQ_MASK)
+#define DMA_DSR_BCR_BED_MASK                     (0x10000000u)
+#define DMA_DSR_BCR_BED_SHIFT                    (28u)
+#define DMA_DSR_BCR_BED_WIDTH                    (1u)
+#define DMA_DSR_BCR_BED(x)                       (((uint32_t)(((uint32_t)(x)) << DMA_DSR_BCR_BED_SHIFT)) & DMA_DSR_BCR_BED_MASK)
+#define DMA_DSR_BCR_BES_MASK                     (0x20000000u)
+#define DMA_DSR_BCR_BES_SHIFT                    (29u)
+#define DMA_DSR_BCR_BES_WIDTH                    (1u)
+#define DMA_DSR_BCR_BES(x)                       (((uint32_t)(((uint32_t)(x)) << DMA_DSR_BCR_BES_SHIFT)) & DMA_DSR_BCR_BES_MASK)
+#define DMA_DSR_BCR_CE_MASK                      (0x40000000u)
+#define DMA_DSR_BCR_CE_SHIFT                     (30u)
+#define DMA_DSR_BCR_CE_WIDTH                     (1u)
+#define DMA_DSR_BCR_CE(x)                        (((uint32_t)(((uint32_t)(x)) << DMA_DSR_BCR_CE_SHIFT)) & DMA_DSR_BCR_CE_MASK)
+#define DMA_DCR_LCH2_MASK                        (0x3u)
+#define DMA_DCR_LCH2_SHIFT                       (0u)
+#define DMA_DCR_LCH2_WIDTH                       (2u)
+#define DMA_DCR_LCH2(x)                          (((uint32_t)(((uint32_t)(x)) << DMA_DCR_LCH2_SHIFT)) & DMA_DCR_LCH2_MASK)
+#define DMA_DCR_LCH1_MASK                        (0xCu)
+#define DMA_DCR_LCH1_SHIFT                       (2u)
+#define DMA_DCR_LCH1_WIDTH                       (2u)
+#define DMA_DCR_LCH1(x)                          (((uint32_t)(((uint32_t)(x)) << DMA_DCR_LCH1_SHIFT)) & DMA_DCR_LCH1_MASK)
+#define DMA_DCR_LINKCC_MASK                      (0x30u)
+#define DMA_DCR_LINKCC_SHIFT                     (4u)
+#define DMA_DCR_LINKCC_WIDTH                     (2u)
+#define DMA_DCR_LINKCC(x)                        (((uint32_t)(((uint32_t)(x)) << DMA_DCR_LINKCC_SHIFT)) & DMA_DCR_LINKCC_MASK)
+#define DMA_DCR_D_REQ_MASK                       (0x80u)
+#define DMA_DCR_D_REQ_SHIFT                      (7u)
+#define DMA_DCR_D_REQ_WIDTH                      (1u)
+#define DMA_DCR_D_REQ(x)                         (((uint32_t)(((uint32_t)(x)) << DMA_DCR_D_REQ_SHIFT)) & DMA_DCR_D_REQ_MASK)
+#define DMA_DCR_DMOD_MASK                        (0xF00u)
+#define DMA_DCR_DMOD_SHIFT                       (8u)
+#define DMA_DCR_DMOD_WIDTH                       (4u)
+#define DMA_DCR_DMOD(x)                          (((uint32_t)(((uint32_t)(x)) << DMA_DCR_DMOD_SHIFT)) & DMA_DCR_DMOD_MASK)
+#define DMA_DCR_SMOD_MASK                        (0xF000u)
+#define DMA_DCR_SMOD_SHIFT                       (12u)
+#define DMA_DCR_SMOD_WIDTH                       (4u)
+#define DMA_DCR_SMOD(x)                          (((uint32_t)(((uint32_t)(x)) << DMA_DCR_SMOD_SHIFT)) & DMA_DCR_SMOD_MASK)
+#define DMA_DCR_START_MASK                       (0x10000u)
+#define DMA_DCR_START_SHIFT                      (16u)
+#define DMA_DCR_START_WIDTH                      (1u)
+#define DMA_DCR_START(x)                         (((uint32_t)(((uint32_t)(x)) << DMA_DCR_START_SHIFT)) & DMA_DCR_START_MASK)
+#define DMA_DCR_DSIZE_MASK                       (0x60000u)
+#define DMA_DCR_DSIZE_SHIFT                      (17u)
+#define DMA_DCR_DSIZE_WIDTH                      (2u)
+#define DMA_DCR_DSIZE(x)                         (((uint32_t)(((uint32_t)(x)) << DMA_DCR_DSIZE_SHIFT)) & DMA_DCR_DSIZE_MASK)
+#define DMA_DCR_DINC_MASK                        (0x80000u)
+#define DMA_DCR_DINC_SHIFT                       (19u)
+#define DMA_DCR_DINC_WIDTH                       (1u)
+#define DMA_DCR_DINC(x)                          (((uint32_t)(((uint32_t)(x)) << DMA_DCR_DINC_SHIFT)) & DMA_DCR_DINC_MASK)
+#define DMA_DCR_SSIZE_MASK                       (0x300000u)
+#define DMA_DCR_SSIZE_SHIFT                      (20u)
+#define DMA_DCR_SSIZE_WIDTH                      (2u)
+#define DMA_DCR_SSIZE(x)                         (((uint32_t)(((uint32_t)(x)) << DMA_DCR_SSIZE_SHIFT)) & DMA_DCR_SSIZE_MASK)
+#define DMA_DCR_SINC_MASK                        (0x400000u)
+#define DMA_DCR_SINC_SHIFT                       (22u)
+#define DMA_DCR_SINC_WIDTH                       (1u)
+#define DMA_DCR_SINC(x)                          (((uint32_t)(((uint32_t)(x)) << DMA_DCR_SINC_SHIFT)) & DMA_DCR_SINC_MASK)
+#define DMA_DCR_EADREQ_MASK                      (0x800000u)
+#define DMA_DCR_EADREQ_SHIFT                     (23u)
+#define DMA_DCR_EADREQ_WIDTH                     (1u)
+#define DMA_DCR_EADREQ(x)                        (((uint32_t)(((uint32_t)(x)) << DMA_DCR_EADREQ_SHIFT)) & DMA_DCR_EADREQ_MASK)
+#define DMA_DCR_AA_MASK                          (0x10000000u)
+#define DMA_DCR_AA_SHIFT                         (28u)
+#define DMA_DCR_AA_WIDTH                         (1u)
+#define DMA_DCR_AA(x)                            (((uint32_t)(((uint32_t)(x)) << DMA_DCR_AA_SHIFT)) & DMA_DCR_AA_MASK)
+#define DMA_DCR_CS_MASK                          (0x20000000u)
+#define DMA_DCR_CS_SHIFT                         (29u)
+#define DMA_DCR_CS_WIDTH                         (1u)
+#define DMA_DCR_CS(x)                            (((uint32_t)(((uint32_t)(x)) << DMA_DCR_CS_SHIFT)) & DMA_DCR_CS_MASK)
+#define DMA_DCR_ERQ_MASK                         (0x40000000u)
+#define DMA_DCR_ERQ_SHIFT                        (30u)
+#define DMA_DCR_ERQ_WIDTH                        (1u)
+#define DMA_DCR_ERQ(x)                           (((uint32_t)(((uint32_t)(x)) << DMA_DCR_ERQ_SHIFT)) & DMA_DCR_ERQ_MASK)
+#define DMA_DCR_EINT_MASK                        (0x80000000u)
+#define DMA_DCR_EINT_SHIFT                       (31u)
+#define DMA_DCR_EINT_WIDTH                       (1u)
+#define DMA_DCR_EINT(x)                          (((uint32_t)(((uint32_t)(x)) << DMA_DCR_EINT_SHIFT)) & DMA_DCR_EINT_MASK)
+
+/* DMAMUX */
+#define DMAMUX_CHCFG_SOURCE_MASK                 (0x3Fu)
+#define DMAMUX_CHCFG_SOURCE_SHIFT                (0u)
+#define DMAMUX_CHCFG_SOURCE_WIDTH                (6u)
+#define DMAMUX_CHCFG_SOURCE(x)                   (((uint32_t)(((uint32_t)(x)) << DMAMUX_CHCFG_SOURCE_SHIFT)) & DMAMUX_CHCFG_SOURCE_MASK)
+#define DMAMUX_CHCFG_TRIG_MASK                   (0x40u)
+#define DMAMUX_CHCFG_TRIG_SHIFT                  (6u)
+#define DMAMUX_CHCFG_TRIG_WIDTH                  (1u)
+#define DMAMUX_CHCFG_TRIG(x)                     (((uint32_t)(((uint32_t)(x)) << DMAMUX_CHCFG_TRIG_SHIFT)) & DMAMUX_CHCFG_TRIG_MASK)
+#define DMAMUX_CHCFG_ENBL_MASK                   (0x80u)
+#define DMAMUX_CHCFG_ENBL_SHIFT                  (7u)
+#define DMAMUX_CHCFG_ENBL_WIDTH                  (1u)
+#define DMAMUX_CHCFG_ENBL(x)                     (((uint32_t)(((uint32_t)(x)) << DMAMUX_CHCFG_ENBL_SHIFT)) & DMAMUX_CHCFG_ENBL_MASK)
+
+/* PORT */
+#define PORT_PCR_PS_MASK                         (0x1u)
+#define PORT_PCR_PS_SHIFT                        (0u)
+#define PORT_PCR_PS_WIDTH                        (1u)
+#define PORT_PCR_PS(x)                           (((uint32_t)(((uint32_t)(x)) << PORT_PCR_PS_SHIFT)) & PORT_PCR_PS_MASK)
+#define PORT_PCR_PE_MASK                         (0x2u)
+#define PORT_PCR_PE_SHIFT                        (1u)
+#define PORT_PCR_PE_WIDTH                        (1u)
+#define PORT_PCR_PE(x)                           (((uint32_t)(((uint32_t)(x)) << PORT_PCR_PE_SHIFT)) & PORT_PCR_PE_MASK)
+#define PORT_PCR_SRE_MASK                        (0x4u)
+#define PORT_PCR_SRE_SHIFT                       (2u)
+#define PORT_PCR_SRE_WIDTH                       (1u)
+#define PORT_PCR_SRE(x)                          (((uint32_t)(((uint32_t)(x)) << PORT_PCR_SRE_SHIFT)) & PORT_PCR_SRE_MASK)
+#define PORT_PCR_PFE_MASK                        (0x10u)
+#define PORT_PCR_PFE_SHIFT                       (4u)
+#define PORT_PCR_PFE_WIDTH                       (1u)
+#define PORT_PCR_PFE(x)                          (((uint32_t)(((uint32_t)(x)) << PORT_PCR_PFE_SHIFT)) & PORT_PCR_PFE_MASK)
+#define PORT_PCR_DSE_MASK                        (0x40u)
+#define PORT_PCR_DSE_SHIFT                       (6u)
+#define PORT_PCR_DSE_WIDTH                       (1u)
+#define PORT_PCR_DSE(x)                          (((uint32_t)(((uint32_t)(x)) << PORT_PCR_DSE_SHIFT)) & PORT_PCR_DSE_MASK)
+#define PORT_PCR_MUX_MASK                        (0x700u)
+#define PORT_PCR_MUX_SHIFT                       (8u)
+#define PORT_PCR_MUX_WIDTH                       (3u)
+#define PORT_PCR_MUX(x)                          (((uint32_t)(((uint32_t)(x)) << PORT_PCR_MUX_SHIFT)) & PORT_PCR_MUX_MASK)
+#define PORT_PCR_IRQC_MASK                       (0xF0000u)
+#define PORT_PCR_IRQC_SHIFT                      (16u)
+#define PORT_PCR_IRQC_WIDTH                      (4u)
+#define PORT_PCR_IRQC(x)                         (((uint32_t)(((uint32_t)(x)) << PORT_PCR_IRQC_SHIFT)) & PORT_PCR_IRQC_MASK)
+#define PORT_PCR_ISF_MASK                        (0x1000000u)
+#define PORT_PCR_ISF_SHIFT                       (24u)
+#define PORT_PCR_ISF_WIDTH                       (1u)
+#define PORT_PCR_ISF(x)                          (((uint32_t)(((uint32_t)(x)) << PORT_PCR_ISF_SHIFT)) & PORT_PCR_ISF_MASK)
+
+/* SIM */
+#define SIM_SOPT2_TPMSRC_MASK                    (0x3000000u)
+#define SIM_SOPT2_TPMSRC_SHIFT                   (24u)
+#define SIM_SOPT2_TPMSRC_WIDTH                   (2u)
+#define SIM_SOPT2_TPMSRC(x)                      (((uint32_t)(((uint32_t)(x)) << SIM_SOPT2_TPMSRC_SHIFT)) & SIM_SOPT2_TPMSRC_MASK)
+#define SIM_SOPT2_PLLFLLSEL_MASK                 (0x10000u)
+#define SIM_SOPT2_PLLFLLSEL_SHIFT                (16u)
+#define SIM_SOPT2_PLLFLLSEL_WIDTH                (1u)
+#define SIM_SOPT2_PLLFLLSEL(x)                   (((uint32_t)(((uint32_t)(x)) << SIM_SOPT2_PLLFLLSEL_SHIFT)) & SIM_SOPT2_PLLFLLSEL_MASK)
+#define SIM_SOPT7_ADC0TRGSEL_MASK                (0xFu)
+#define SIM_SOPT7_ADC0TRGSEL_SHIFT               (0u)
+#define SIM_SOPT7_ADC0TRGSEL_WIDTH               (4u)
+#define SIM_SOPT7_ADC0TRGSEL(x)                  (((uint32_t)(((uint32_t)(x)) << SIM_SOPT7_ADC0TRGSEL_SHIFT)) & SIM_SOPT7_ADC0TRGSEL_MASK)
+#define SIM_SOPT7_ADC0PRETRGSEL_MASK             (0x10u)
+#define SIM_SOPT7_ADC0PRETRGSEL_SHIFT            (4u)
+#define SIM_SOPT7_ADC0PRETRGSEL_WIDTH            (1u)
+#define SIM_SOPT7_ADC0PRETRGSEL(x)               (((uint32_t)(((uint32_t)(x)) << SIM_SOPT7_ADC0PRETRGSEL_SHIFT)) & SIM_SOPT7_ADC0PRETRGSEL_MASK)
+#define SIM_SOPT7_ADC0ALTTRGEN_MASK              (0x80u)
+#define SIM_SOPT7_ADC0ALTTRGEN_SHIFT             (7u)
+#define SIM_SOPT7_ADC0ALTTRGEN_WIDTH             (1u)
+#define SIM_SOPT7_ADC0ALTTRGEN(x)                (((uint32_t)(((uint32_t)(x)) << SIM_SOPT7_ADC0ALTTRGEN_SHIFT)) & SIM_SOPT7_ADC0ALTTRGEN_MASK)
+#define SIM_SCGC4_SPI1_MASK                      (0x800000u)
+#define SIM_SCGC4_SPI1_SHIFT                     (23u)
+#define SIM_SCGC4_SPI1_WIDTH                     (1u)
+#define SIM_SCGC4_SPI1(x)                        (((uint32_t)(((uint32_t)(x)) << SIM_SCGC4_SPI1_SHIFT)) & SIM_SCGC4_SPI1_MASK)
+#define SIM_SCGC4_CMP_MASK                       (0x80000u)
+#define SIM_SCGC4_CMP_SHIFT                      (19u)
+#define SIM_SCGC4_CMP_WIDTH                      (1u)
+#define SIM_SCGC4_CMP(x)                         (((uint32_t)(((uint32_t)(x)) << SIM_SCGC4_CMP_SHIFT)) & SIM_SCGC4_CMP_MASK)
+#define SIM_SCGC5_LPTMR_MASK                     (0x1u)
+#define SIM_SCGC5_LPTMR_SHIFT                    (0u)
+#define SIM_SCGC5_LPTMR_WIDTH                    (1u)
+#define SIM_SCGC5_LPTMR(x)                       (((uint32_t)(((uint32_t)(x)) << SIM_SCGC5_LPTMR_SHIFT)) & SIM_SCGC5_LPTMR_MASK)
+#define SIM_SCGC5_PORTA_MASK                     (0x200u)
+#define SIM_SCGC5_PORTA_SHIFT                    (9u)
+#define SIM_SCGC5_PORTA_WIDTH                    (1u)
+#define SIM_SCGC5_PORTA(x)                       (((uint32_t)(((uint32_t)(x)) << SIM_SCGC5_PORTA_SHIFT)) & SIM_SCGC5_PORTA_MASK)
+#define SIM_SCGC5_PORTB_MASK                     (0x400u)
+#define SIM_SCGC5_PORTB_SHIFT                    (10u)
+#define SIM_SCGC5_PORTB_WIDTH                    (1u)
+#define SIM_SCGC5_PORTB(x)                       (((uint32_t)(((uint32_t)(x)) << SIM_SCGC5_PORTB_SHIFT)) & SIM_SCGC5_PORTB_MASK)
+#define SIM_SCGC5_PORTC_MASK                     (0x800u)
+#define SIM_SCGC5_PORTC_SHIFT                    (11u)
+#define SIM_SCGC5_PORTC_WIDTH                    (1u)
+#define SIM_SCGC5_PORTC(x)                       (((uint32_t)(((uint32_t)(x)) << SIM_SCGC5_PORTC_SHIFT)) & SIM_SCGC5_PORTC_MASK)
+#define SIM_SCGC5_PORTD_MASK                     (0x1000u)
+#define SIM_SCGC5_PORTD_SHIFT                    (12u)
+#define SIM_SCGC5_PORTD_WIDTH                    (1u)
+#define SIM_SCGC5_PORTD(x)                       (((uint32_t)(((uint32_t)(x)) << SIM_SCGC5_PORTD_SHIFT)) & SIM_SCGC5_PORTD_MASK)
+#define SIM_SCGC5_PORTE_MASK                     (0x2000u)
+#define SIM_SCGC5_PORTE_SHIFT                    (13u)
+#define SIM_SCGC5_PORTE_WIDTH                    (1u)
+#define SIM_SCGC5_PORTE(x)                       (((uint32_t)(((uint32_t)(x)) << SIM_SCGC5_PORTE_SHIFT)) & SIM_SCGC5_PORTE_MASK)
+#define SIM_SCGC6_FTF_MASK                       (0x1u)
+#define SIM_SCGC6_FTF_SHIFT                      (0u)
+#define SIM_SCGC6_FTF_WIDTH                      (1u)
+#define SIM_SCGC6_FTF(x)                         (((uint32_t)(((uint32_t)(x)) << SIM_SCGC6_FTF_SHIFT)) & SIM_SCGC6_FTF_MASK)
+#define SIM_SCGC6_DMAMUX_MASK                    (0x2u)
+#define SIM_SCGC6_DMAMUX_SHIFT                   (1u)
+#define SIM_SCGC6_DMAMUX_WIDTH                   (1u)
+#define SIM_SCGC6_DMAMUX(x)                      (((uint32_t)(((uint32_t)(x)) << SIM_SCGC6_DMAMUX_SHIFT)) & SIM_SCGC6_DMAMUX_MASK)
+#define SIM_SCGC6_PIT_MASK                       (0x800000u)
+#define SIM_SCGC6_PIT_SHIFT                      (23u)
+#define SIM_SCGC6_PIT_WIDTH                      (1u)
+#define SIM_SCGC6_PIT(x)                         (((uint32_t)(((uint32_t)(x)) << SIM_SCGC6_PIT_SHIFT)) & SIM_SCGC6_PIT_MASK)
+#define SIM_SCGC6_TPM0_MASK                      (0x1000000u)
+#define SIM_SCGC6_TPM0_SHIFT                     (24u)
+#define SIM_SCGC6_TPM0_WIDTH                     (1u)
+#define SIM_SCGC6_TPM0(x)                        (((uint32_t)(((uint32_t)(x)) << SIM_SCGC6_TPM0_SHIFT)) & SIM_SCGC6_TPM0_MASK)
+#define SIM_SCGC6_TPM1_MASK                      (0x2000000u)
+#define SIM_SCGC6_TPM1_SHIFT                     (25u)
+#define SIM_SCGC6_TPM1_WIDTH                     (1u)
+#define SIM_SCGC6_TPM1(x)                        (((uint32_t)(((uint32_t)(x)) << SIM_SCGC6_TPM1_SHIFT)) & SIM_SCGC6_TPM1_MASK)
+#define SIM_SCGC6_TPM2_MASK                      (0x4000000u)
+#define SIM_SCGC6_TPM2_SHIFT                     (26u)
+#define SIM_SCGC6_TPM2_WIDTH                     (1u)
+#define SIM_SCGC6_TPM2(x)                        (((uint32_t)(((uint32_t)(x)) << SIM_SCGC6_TPM2_SHIFT)) & SIM_SCGC6_TPM2_MASK)
+#define SIM_SCGC6_ADC0_MASK                      (0x8000000u)
+#define SIM_SCGC6_ADC0_SHIFT                     (27u)
+#define SIM_SCGC6_ADC0_WIDTH                     (1u)
+#define SIM_SCGC6_ADC0(x)                        (((uint32_t)(((uint32_t)(x)) << SIM_SCGC6_ADC0_SHIFT)) & SIM_SCGC6_ADC0_MASK)
+#define SIM_SCGC7_DMA_MASK                       (0x100u)
+#define SIM_SCGC7_DMA_SHIFT                      (8u)
+#define SIM_SCGC7_DMA_WIDTH                      (1u)
+#define SIM_SCGC7_DMA(x)                         (((uint32_t)(((uint32_t)(x)) << SIM_SCGC7_DMA_SHIFT)) & SIM_SCGC7_DMA_MASK)
+
+/* SPI */
+#define SPI_S_SPRF_MASK                          (0x80u)
+#define SPI_S_SPRF_SHIFT                         (7u)
+#define SPI_S_SPRF_WIDTH                         (1u)
+#define SPI_S_SPRF(x)                            (((uint32_t)(((uint32_t)(x)) << SPI_S_SPRF_SHIFT)) & SPI_S_SPRF_MASK)
+#define SPI_S_SPMF_MASK                          (0x40u)
+#define SPI_S_SPMF_SHIFT                         (6u)
+#define SPI_S_SPMF_WIDTH                         (1u)
+#define SPI_S_SPMF(x)                            (((uint32_t)(((uint32_t)(x)) << SPI_S_SPMF_SHIFT)) & SPI_S_SPMF_MASK)
+#define SPI_S_SPTEF_MASK                         (0x20u)
+#define SPI_S_SPTEF_SHIFT                        (5u)
+#define SPI_S_SPTEF_WIDTH                        (1u)
+#define SPI_S_SPTEF(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_S_SPTEF_SHIFT)) & SPI_S_SPTEF_MASK)
+#define SPI_S_MODF_MASK                          (0x10u)
+#define SPI_S_MODF_SHIFT                         (4u)
+#define SPI_S_MODF_WIDTH                         (1u)
+#define SPI_S_MODF(x)                            (((uint32_t)(((uint32_t)(x)) << SPI_S_MODF_SHIFT)) & SPI_S_MODF_MASK)
+#define SPI_BR_SPR_MASK                          (0xFu)
+#define SPI_BR_SPR_SHIFT                         (0u)
+#define SPI_BR_SPR_WIDTH                         (4u)
+#define SPI_BR_SPR(x)                            (((uint32_t)(((uint32_t)(x)) << SPI_BR_SPR_SHIFT)) & SPI_BR_SPR_MASK)
+#define SPI_BR_SPPR_MASK                         (0x70u)
+#define SPI_BR_SPPR_SHIFT                        (4u)
+#define SPI_BR_SPPR_WIDTH                        (3u)
+#define SPI_BR_SPPR(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_BR_SPPR_SHIFT)) & SPI_BR_SPPR_MASK)
+#define SPI_C1_LSBFE_MASK                        (0x1u)
+#define SPI_C1_LSBFE_SHIFT                       (0u)
+#define SPI_C1_LSBFE_WIDTH                       (1u)
+#define SPI_C1_LSBFE(x)                          (((uint32_t)(((uint32_t)(x)) << SPI_C1_LSBFE_SHIFT)) & SPI_C1_LSBFE_MASK)
+#define SPI_C1_SSOE_MASK                         (0x2u)
+#define SPI_C1_SSOE_SHIFT                        (1u)
+#define SPI_C1_SSOE_WIDTH                        (1u)
+#define SPI_C1_SSOE(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_C1_SSOE_SHIFT)) & SPI_C1_SSOE_MASK)
+#define SPI_C1_CPHA_MASK                         (0x4u)
+#define SPI_C1_CPHA_SHIFT                        (2u)
+#define SPI_C1_CPHA_WIDTH                        (1u)
+#define SPI_C1_CPHA(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_C1_CPHA_SHIFT)) & SPI_C1_CPHA_MASK)
+#define SPI_C1_CPOL_MASK                         (0x8u)
+#define SPI_C1_CPOL_SHIFT                        (3u)
+#define SPI_C1_CPOL_WIDTH                        (1u)
+#define SPI_C1_CPOL(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_C1_CPOL_SHIFT)) & SPI_C1_CPOL_MASK)
+#define SPI_C1_MSTR_MASK                         (0x10u)
+#define SPI_C1_MSTR_SHIFT                        (4u)
+#define SPI_C1_MSTR_WIDTH                        (1u)
+#define SPI_C1_MSTR(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_C1_MSTR_SHIFT)) & SPI_C1_MSTR_MASK)
+#define SPI_C1_SPTIE_MASK                        (0x20u)
+#define SPI_C1_SPTIE_SHIFT                       (5u)
+#define SPI_C1_SPTIE_WIDTH                       (1u)
+#define SPI_C1_SPTIE(x)                          (((uint32_t)(((uint32_t)(x)) << SPI_C1_SPTIE_SHIFT)) & SPI_C1_SPTIE_MASK)
+#define SPI_C1_SPE_MASK                          (0x40u)
+#define SPI_C1_SPE_SHIFT                         (6u)
+#define SPI_C1_SPE_WIDTH                         (1u)
+#define SPI_C1_SPE(x)                            (((uint32_t)(((uint32_t)(x)) << SPI_C1_SPE_SHIFT)) & SPI_C1_SPE_MASK)
+#define SPI_C1_SPIE_MASK                         (0x80u)
+#define SPI_C1_SPIE_SHIFT                        (7u)
+#define SPI_C1_SPIE_WIDTH                        (1u)
+#define SPI_C1_SPIE(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_C1_SPIE_SHIFT)) & SPI_C1_SPIE_MASK)
+#define SPI_C2_SPC0_MASK                         (0x1u)
+#define SPI_C2_SPC0_SHIFT                        (0u)
+#define SPI_C2_SPC0_WIDTH                        (1u)
+#define SPI_C2_SPC0(x)                           (((uint32_t)(((uint32_t)(x)) << SPI_C2_SPC0_SHIFT)) & SPI_C2_SPC0_MASK)
+#define SPI_C2_RXDMAE_MASK                       (0x4u)
+#define SPI_C2_RXDMAE_SHIFT                      (2u)
+#define SPI_C2_RXDMAE_WIDTH                      (1u)
+#define SPI_C2_RXDMAE(x)                         (((uint32_t)(((uint32_t)(x)) << SPI_C2_RXDMAE_SHIFT)) & SPI_C2_RXDMAE_MASK)
+#define SPI_C2_MODFEN_MASK                       (0x10u)
+#define SPI_C2_MODFEN_SHIFT                      (4u)
+#define SPI_C2_MODFEN_WIDTH                      (1u)
+#define SPI_C2_MODFEN(x)                         (((uint32_t)(((uint32_t)(x)) << SPI_C2_MODFEN_SHIFT)) & SPI_C2_MODFEN_MASK)
+#define SPI_C2_TXDMAE_MASK                       (0x20u)
+#define SPI_C2_TXDMAE_SHIFT                      (5u)
+#define SPI_C2_TXDMAE_WIDTH                      (1u)
+#define SPI_C2_TXDMAE(x)                         (((uint32_t)(((uint32_t)(x)) << SPI_C2_TXDMAE_SHIFT)) & SPI_C2_TXDMAE_MASK)
+#define SPI_C2_SPMIE_MASK                        (0x80u)
+#define SPI_C2_SPMIE_SHIFT                       (7u)
+#define SPI_C2_SPMIE_WIDTH                       (1u)
+#define SPI_C2_SPMIE(x)                          (((uint32_t)(((uint32_t)(x)) << SPI_C2_SPMIE_SHIFT)) & SPI_C2_SPMIE_MASK)
+
+/* TPM */
+#define TPM_SC_PS_MASK                           (0x7u)
+#define TPM_SC_PS_SHIFT                          (0u)
+#define TPM_SC_PS_WIDTH                          (3u)
+#define TPM_SC_PS(x)                             (((uint32_t)(((uint32_t)(x)) << TPM_SC_PS_SHIFT)) & TPM_SC_PS_MASK)
+#define TPM_SC_CMOD_MASK                         (0x18u)
+#define TPM_SC_CMOD_SHIFT                        (3u)
+#define TPM_SC_CMOD_WIDTH                        (2u)
+#define TPM_SC_CMOD(x)                           (((uint32_t)(((uint32_t)(x)) << TPM_SC_CMOD_SHIFT)) & TPM_SC_CMOD_MASK)
+#define TPM_SC_CPWMS_MASK                        (0x20u)
+#define TPM_SC_CPWMS_SHIFT                       (5u)
+#define TPM_SC_CPWMS_WIDTH                       (1u)
+#define TPM_SC_CPWMS(x)                          (((uint32_t)(((uint32_t)(x)) << TPM_SC_CPWMS_SHIFT)) & TPM_SC_CPWMS_MASK)
+#define TPM_SC_TOIE_MASK                         (0x40u)
+#define TPM_SC_TOIE_SHIFT                        (6u)
+#define TPM_SC_TOIE_WIDTH                        (1u)
+#define TPM_SC_TOIE(x)                           (((uint32_t)(((uint32_t)(x)) << TPM_SC_TOIE_SHIFT)) & TPM_SC_TOIE_MASK)
+#define TPM_SC_TOF_MASK                          (0x80u)
+#define TPM_SC_TOF_SHIFT                         (7u)
+#define TPM_SC_TOF_WIDTH                         (1u)
+#define TPM_SC_TOF(x)                            (((uint32_t)(((uint32_t)(x)) << TPM_SC_TOF_SHIFT)) & TPM_SC_TOF_MASK)
+#define TPM_SC_DMA_MASK                          (0x100u)
+#define TPM_SC_DMA_SHIFT                         (8u)
+#define TPM_SC_DMA_WIDTH                         (1u)
+#define TPM_SC_DMA(x)                            (((uint32_t)(((uint32_t)(x)) << TPM_SC_DMA_SHIFT)) & TPM_SC_DMA_MASK)
+#define TPM_CnSC_DMA_MASK                        (0x1u)
+#define TPM_CnSC_DMA_SHIFT                       (0u)
+#define TPM_CnSC_DMA_WIDTH                       (1u)
+#define TPM_CnSC_DMA(x)                          (((uint32_t)(((uint32_t)(x)) << TPM_CnSC_DMA_SHIFT)) & TPM_CnSC_DMA_MASK)
+#define TPM_CnSC_ELSA_MASK                       (0x4u)
+#define TPM_CnSC_ELSA_SHIFT                      (2u)
+#define TPM_CnSC_ELSA_WIDTH                      (1u)
+#define TPM_CnSC_ELSA(x)                         (((uint32_t)(((uint32_t)(x)) << TPM_CnSC_ELSA_SHIFT)) & TPM_CnSC_ELSA_MASK)
+#define TPM_CnSC_ELSB_MASK                       (0x8u)
+#define TPM_CnSC_ELSB_SHIFT                      (3u)
+#define TPM_CnSC_ELSB_WIDTH                      (1u)
+#define TPM_CnSC_ELSB(x)                         (((uint32_t)(((uint32_t)(x)) << TPM_CnSC_ELSB_SHIFT)) & TPM_CnSC_ELSB_MASK)
+#define TPM_CnSC_MSA_MASK                        (0x10u)
+#define TPM_CnSC_MSA_SHIFT                       (4u)
+#define TPM_CnSC_MSA_WIDTH                       (1u)
+#define TPM_CnSC_MSA(x)                          (((uint32_t)(((uint32_t)(x)) << TPM_CnSC_MSA_SHIFT)) & TPM_CnSC_MSA_MASK)
+#define TPM_CnSC_MSB_MASK                        (0x20u)
+#define TPM_CnSC_MSB_SHIFT                       (5u)
+#define TPM_CnSC_MSB_WIDTH                       (1u)
+#define TPM_CnSC_MSB(x)                          (((uint32_t)(((uint32_t)(x)) << TPM_CnSC_MSB_SHIFT)) & TPM_CnSC_MSB_MASK)
+#define TPM_CnSC_CHIE_MASK                       (0x40u)
+#define TPM_CnSC_CHIE_SHIFT                      (6u)
+#define TPM_CnSC_CHIE_WIDTH                      (1u)
+#define TPM_CnSC_CHIE(x)                         (((uint32_t)(((uint32_t)(x)) << TPM_CnSC_CHIE_SHIFT)) & TPM_CnSC_CHIE_MASK)
+#define TPM_CnSC_CHF_MASK                        (0x80u)
+#define TPM_CnSC_CHF_SHIFT                       (7u)
+#define TPM_CnSC_CHF_WIDTH                       (1u)
+#define TPM_CnSC_CHF(x)                          (((uint32_t)(((uint32_t)(x)) << TPM_CnSC_CHF_SHIFT)) & TPM_CnSC_CHF_MASK)
+#define TPM_STATUS_CH0F_MASK                     (0x1u)
+#define TPM_STATUS_CH0F_SHIFT                    (0u)
+#define TPM_STATUS_CH0F_WIDTH                    (1u)
+#define TPM_STATUS_CH0F(x)                       (((uint32_t)(((uint32_t)(x)) << TPM_STATUS_CH0F_SHIFT)) & TPM_STATUS_CH0F_MASK)
+#define TPM_STATUS_CH1F_MASK                     (0x2u)
+#define TPM_STATUS_CH1F_SHIFT                    (1u)
+#define TPM_STATUS_CH1F_WIDTH                    (1u)
+#define TPM_STATUS_CH1F(x)                       (((uint32_t)(((uint32_t)(x)) << TPM_STATUS_CH1F_SHIFT)) & TPM_STATUS_CH1F_MASK)
+#define TPM_STATUS_TOF_MASK                      (0x100u)
+#define TPM_STATUS_TOF_SHIFT                     (8u)
+#define TPM_STATUS_TOF_WIDTH                     (1u)
+#define TPM_STATUS_TOF(x)                        (((uint32_t)(((uint32_t)(x)) << TPM_STATUS_TOF_SHIFT)) & TPM_STATUS_TOF_MASK)
+#define TPM_CONF_DBGMODE_MASK                    (0xC0u)
+#define TPM_CONF_DBGMODE_SHIFT                   (6u)
+#define TPM_CONF_DBGMODE_WIDTH                   (2u)
+#define TPM_CONF_DBGMODE(x)                      (((uint32_t)(((uint32_t)(x)) << TPM_CONF_DBGMODE_SHIFT)) & TPM_CONF_DBGMODE_MASK)
+#define TPM_CONF_CSOO_MASK                       (0x10000u)
+#define TPM_CONF_CSOO_SHIFT                      (16u)
+#define TPM_CONF_CSOO_WIDTH                      (1u)
+#define TPM_CONF_CSOO(x)                         (((uint32_t)(((uint32_t)(x)) << TPM_CONF_CSOO_SHIFT)) & TPM_CONF_CSOO_MASK)
+#define TPM_CONF_CSOT_MASK                       (0x20000u)
+#define TPM_CONF_CSOT_SHIFT                      (17u)
+#define TPM_CONF_CSOT_WIDTH                      (1u)
+#define TPM_CONF_CSOT(x)                         (((uint32_t)(((uint32_t)(x)) << TPM_CONF_CSOT_SHIFT)) & TPM_CONF_CSOT_MASK)
+#define TPM_CONF_CROT_MASK                       (0x40000u)
+#define TPM_CONF_CROT_SHIFT                      (18u)
+#define TPM_CONF_CROT_WIDTH                      (1u)
+#define TPM_CONF_CROT(x)                         (((uint32_t)(((uint32_t)(x)) << TPM_CONF_CROT_SHIFT)) & TPM_CONF_CROT_MASK)
+#define TPM_CONF_TRGSEL_MASK                     (0xF000000u)
+#define TPM_CONF_TRGSEL_SHIFT                    (24u)
+#define TPM_CONF_TRGSEL_WIDTH                    (4u)
+#define TPM_CONF_TRGSEL(x)                       (((uint32_t)(((uint32_t)(x)) << TPM_CONF_TRGSEL_SHIFT)) & TPM_CONF_TRGSEL_MASK)
+#define TPM_CNT_COUNT_MASK                       (0xFFFFu)
+#define TPM_CNT_COUNT_SHIFT                      (0u)
+#define TPM_CNT_COUNT_WIDTH                      (16u)
+#define TPM_CNT_COUNT(x)                         (((uint32_t)(((uint32_t)(x)) << TPM_CNT_COUNT_SHIFT)) & TPM_CNT_COUNT_MASK)
+#define TPM_MOD_MOD_MASK                         (0xFFFFu)
+#define TPM_MOD_MOD_SHIFT                        (0u)
+#define TPM_MOD_MOD_WIDTH                        (16u)
+#define TPM_MOD_MOD(x)                           (((uint32_t)(((uint32_t)(x)) << TPM_MOD_MOD_SHIFT)) & TPM_MOD_MOD_MASK)
+
+/* PIT */
+#define PIT_MCR_FRZ_MASK                         (0x1u)
+#define PIT_MCR_FRZ_SHIFT                        (0u)
+#define PIT_MCR_FRZ_WIDTH                        (1u)
+#define PIT_MCR_FRZ(x)                           (((uint32_t)(((uint32_t)(x)) << PIT_MCR_FRZ_SHIFT)) & PIT_MCR_FRZ_MASK)
+#define PIT_MCR_MDIS_MASK                        (0x2u)
+#define PIT_MCR_MDIS_SHIFT                       (1u)
+#define PIT_MCR_MDIS_WIDTH                       (1u)
+#define PIT_MCR_MDIS(x)                          (((uint32_t)(((uint32_t)(x)) << PIT_MCR_MDIS_SHIFT)) & PIT_MCR_MDIS_MASK)
+#define PIT_TCTRL_TEN_MASK                       (0x1u)
+#define PIT_TCTRL_TEN_SHIFT                      (0u)
+#define PIT_TCTRL_TEN_WIDTH                      (1u)
+#define PIT_TCTRL_TEN(x)                         (((uint32_t)(((uint32_t)(x)) << PIT_TCTRL_TEN_SHIFT)) & PIT_TCTRL_TEN_MASK)
+#define PIT_TCTRL_TIE_MASK                       (0x2u)
+#define PIT_TCTRL_TIE_SHIFT                      (1u)
+#define PIT_TCTRL_TIE_WIDTH                      (1u)
+#define PIT_TCTRL_TIE(x)                         (((uint32_t)(((uint32_t)(x)) << PIT_TCTRL_TIE_SHIFT)) & PIT_TCTRL_TIE_MASK)
+#define PIT_TCTRL_CHN_MASK                       (0x4u)
+#define PIT_TCTRL_CHN_SHIFT                      (2u)
+#define PIT_TCTRL_CHN_WIDTH                      (1u)
+#define PIT_TCTRL_CHN(x)                         (((uint32_t)(((uint32_t)(x)) << PIT_TCTRL_CHN_SHIFT)) & PIT_TCTRL_CHN_MASK)
+#define PIT_TFLG_TIF_MASK                        (0x1u)
+#define PIT_TFLG_TIF_SHIFT                       (0u)
+#define PIT_TFLG_TIF_WIDTH                       (1u)
+#define PIT_TFLG_TIF(x)                          (((uint32_t)(((uint32_t)(x)) << PIT_TFLG_TIF_SHIFT)) & PIT_TFLG_TIF_MASK)
+
+/* LPTMR */
+#define LPTMR_CSR_TEN_MASK                       (0x1u)
+#define LPTMR_CSR_TEN_SHIFT                      (0u)
+#define LPTMR_CSR_TEN_WIDTH                      (1u)
+#define LPTMR_CSR_TEN(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_CSR_TEN_SHIFT)) & LPTMR_CSR_TEN_MASK)
+#define LPTMR_CSR_TMS_MASK                       (0x2u)
+#define LPTMR_CSR_TMS_SHIFT                      (1u)
+#define LPTMR_CSR_TMS_WIDTH                      (1u)
+#define LPTMR_CSR_TMS(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_CSR_TMS_SHIFT)) & LPTMR_CSR_TMS_MASK)
+#define LPTMR_CSR_TFC_MASK                       (0x4u)
+#define LPTMR_CSR_TFC_SHIFT                      (2u)
+#define LPTMR_CSR_TFC_WIDTH                      (1u)
+#define LPTMR_CSR_TFC(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_CSR_TFC_SHIFT)) & LPTMR_CSR_TFC_MASK)
+#define LPTMR_CSR_TPP_MASK                       (0x8u)
+#define LPTMR_CSR_TPP_SHIFT                      (3u)
+#define LPTMR_CSR_TPP_WIDTH                      (1u)
+#define LPTMR_CSR_TPP(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_CSR_TPP_SHIFT)) & LPTMR_CSR_TPP_MASK)
+#define LPTMR_CSR_TPS_MASK                       (0x30u)
+#define LPTMR_CSR_TPS_SHIFT                      (4u)
+#define LPTMR_CSR_TPS_WIDTH                      (2u)
+#define LPTMR_CSR_TPS(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_CSR_TPS_SHIFT)) & LPTMR_CSR_TPS_MASK)
+#define LPTMR_CSR_TIE_MASK                       (0x40u)
+#define LPTMR_CSR_TIE_SHIFT                      (6u)
+#define LPTMR_CSR_TIE_WIDTH                      (1u)
+#define LPTMR_CSR_TIE(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_CSR_TIE_SHIFT)) & LPTMR_CSR_TIE_MASK)
+#define LPTMR_CSR_TCF_MASK                       (0x80u)
+#define LPTMR_CSR_TCF_SHIFT                      (7u)
+#define LPTMR_CSR_TCF_WIDTH                      (1u)
+#define LPTMR_CSR_TCF(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_CSR_TCF_SHIFT)) & LPTMR_CSR_TCF_MASK)
+#define LPTMR_PSR_PCS_MASK                       (0x3u)
+#define LPTMR_PSR_PCS_SHIFT                      (0u)
+#define LPTMR_PSR_PCS_WIDTH                      (2u)
+#define LPTMR_PSR_PCS(x)                         (((uint32_t)(((uint32_t)(x)) << LPTMR_PSR_PCS_SHIFT)) & LPTMR_PSR_PCS_MASK)
+#define LPTMR_PSR_PBYP_MASK                      (0x4u)
+#define LPTMR_PSR_PBYP_SHIFT                     (2u)
+#define LPTMR_PSR_PBYP_WIDTH                     (1u)
+#define LPTMR_PSR_PBYP(x)                        (((uint32_t)(((uint32_t)(x)) << LPTMR_PSR_PBYP_SHIFT)) & LPTMR_PSR_PBYP_MASK)
+#define LPTMR_PSR_PRESCALE_MASK                  (0x78u)
+#define LPTMR_PSR_PRESCALE_SHIFT                 (3u)
+#define LPTMR_PSR_PRESCALE_WIDTH                 (4u)
+#define LPTMR_PSR_PRESCALE(x)                    (((uint32_t)(((uint32_t)(x)) << LPTMR_PSR_PRESCALE_SHIFT)) & LPTMR_PSR_PRESCALE_MASK)
+#define LPTMR_CMR_COMPARE_MASK                   (0xFFFFu)
+#define LPTMR_CMR_COMPARE_SHIFT                  (0u)
+#define LPTMR_CMR_COMPARE_WIDTH                  (16u)
+#define LPTMR_CMR_COMPARE(x)                     (((uint32_t)(((uint32_t)(x)) << LPTMR_CMR_COMPARE_SHIFT)) & LPTMR_CMR_COMPARE_MASK)
+
+/* FTFA */
+#define FTFA_FSTAT_MGSTAT0_MASK                  (0x1u)
+#define FTFA_FSTAT_MGSTAT0_SHIFT                 (0u)
+#define FTFA_FSTAT_MGSTAT0_WIDTH                 (1u)
+#define FTFA_FSTAT_MGSTAT0(x)                    (((uint32_t)(((uint32_t)(x)) << FTFA_FSTAT_MGSTAT0_SHIFT)) & FTFA_FSTAT_MGSTAT0_MASK)
+#define FTFA_FSTAT_FPVIOL_MASK                   (0x10u)
+#define FTFA_FSTAT_FPVIOL_SHIFT                  (4u)
+#define FTFA_FSTAT_FPVIOL_WIDTH                  (1u)
+#define FTFA_FSTAT_FPVIOL(x)                     (((uint32_t)(((uint32_t)(x)) << FTFA_FSTAT_FPVIOL_SHIFT)) & FTFA_FSTAT_FPVIOL_MASK)
+#define FTFA_FSTAT_ACCERR_MASK                   (0x20u)
+#define FTFA_FSTAT_ACCERR_SHIFT                  (5u)
+#define FTFA_FSTAT_ACCERR_WIDTH                  (1u)
+#define FTFA_FSTAT_ACCERR(x)                     (((uint32_t)(((uint32_t)(x)) << FTFA_FSTAT_ACCERR_SHIFT)) & FTFA_FSTAT_ACCERR_MASK)
+#define FTFA_FSTAT_RDCOLERR_MASK                 (0x40u)
+#define FTFA_FSTAT_RDCOLERR_SHIFT                (6u)
+#define FTFA_FSTAT_RDCOLERR_WIDTH                (1u)
+#define FTFA_FSTAT_RDCOLERR(x)                   (((uint32_t)(((uint32_t)(x)) << FTFA_FSTAT_RDCOLERR_SHIFT)) & FTFA_FSTAT_RDCOLERR_MASK)
+#define FTFA_FSTAT_CCIF_MASK                     (0x80u)
+#define FTFA_FSTAT_CCIF_SHIFT                    (7u)
+#define FTFA_FSTAT_CCIF_WIDTH                    (1u)
+#define FTFA_FSTAT_CCIF(x)                       (((uint32_t)(((uint32_t)(x)) << FTFA_FSTAT_CCIF_SHIFT)) & FTFA_FSTAT_CCIF_MASK)
@@ -0,0 +1,149 @@
+/**
+ * fsl_bitaccess.h
+ * Host stand-in for the bit manipulation engine macros of the Kinetis SDK.
+ * 
+ * On target the BME does the read-modify-write in one bus cycle. Here it
+ * is done in place and the models see the result right away, so e.g. a
+ * chip enable pulse made with BME_OR32() on PSOR and PCOR is as long on
+ * the pin as the code between the two writes takes.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* User headers */
+#include "soc.h"
+
+/* Global defines */
+#define BME_AND32(addr, wdata)          BME_vAnd32((volatile uint32_t *)(addr), (uint32_t)(wdata))
+#define BME_OR32(addr, wdata)           BME_vOr32((volatile uint32_t *)(addr), (uint32_t)(wdata))
+#define BME_XOR32(addr, wdata)          BME_vXor32((volatile uint32_t *)(addr), (uint32_t)(wdata))
+#define BME_BFI32(addr, wdata, bit, width) \
+    BME_vBfi32((volatile uint32_t *)(addr), (uint32_t)(wdata), (uint32_t)(bit), (uint32_t)(width))
+#define BME_UBFX32(addr, bit, width)    BME_ulUbfx32((volatile uint32_t *)(addr), (uint32_t)(bit), (uint32_t)(width))
+#define BME_AND8(addr, wdata)           BME_vAnd8((volatile uint8_t *)(addr), (uint8_t)(wdata))
+#define BME_OR8(addr, wdata)            BME_vOr8((volatile uint8_t *)(addr), (uint8_t)(wdata))
+
+
+/* Function descriptions */
+
+/**
+ * @brief   AND register with value.
+ * 
+ * @param   pulAddr     Register.
+ * 
+ * @param   ulData      Value.
+ * 
+ * @return  None
+ */
+static inline void BME_vAnd32(volatile uint32_t *const pulAddr, const uint32_t ulData)
+{
+    *pulAddr &= ulData;
+    SOC_vSync();
+}
+
+
+/**
+ * @brief   OR register with value.
+ * 
+ * @param   pulAddr     Register.
+ * 
+ * @param   ulData      Value.
+ * 
+ * @return  None
+ */
+static inline void BME_vOr32(volatile uint32_t *const pulAddr, const uint32_t ulData)
+{
+    *pulAddr |= ulData;
+    SOC_vSync();
+}
+
+
+/**
+ * @brief   AND byte register with value.
+ * 
+ * @param   pucAddr     Register.
+ * 
+ * @param   ucData      Value.
+ * 
+ * @return  None
+ */
+static inline void BME_vAnd8(volatile uint8_t *const pucAddr, const uint8_t ucData)
+{
+    *pucAddr &= ucData;
+    SOC_vSync();
+}
+
+
+/**
+ * @brief   OR byte register with value.
+ * 
+ * @param   pucAddr     Register.
+ * 
+ * @param   ucData      Value.
+ * 
+ * @return  None
+ */
+static inline void BME_vOr8(volatile uint8_t *const pucAddr, const uint8_t ucData)
+{
+    *pucAddr |= ucData;
+    SOC_vSync();
+}
+
+
+/**
+ * @brief   XOR register with value.
+ * 
+ * @param   pulAddr     Register.
+ * 
+ * @param   ulData      Value.
+ * 
+ * @return  None
+ */
+static inline void BME_vXor32(volatile uint32_t *const pulAddr, const uint32_t ulData)
+{
+    *pulAddr ^= ulData;
+    SOC_vSync();
+}
+
+
+/**
+ * @brief   Insert bit field to register.
+ * 
+ * @param   pulAddr     Register.
+ * 
+ * @param   ulData      Value, already shifted to ulBit.
+ * 
+ * @param   ulBit       Lowest bit of field.
+ * 
+ * @param   ulWidth     Field width.
+ * 
+ * @return  None
+ */
+static inline void BME_vBfi32(volatile uint32_t *const pulAddr, const uint32_t ulData, const uint32_t ulBit,
+                              const uint32_t ulWidth)
+{
+    const uint32_t ulMask = (uint32_t)(((1ULL << ulWidth) - 1) << ulBit);
+    
+    *pulAddr = (*pulAddr & ~ulMask) | (ulData & ulMask);
+    SOC_vSync();
+}
+
+
+/**
+ * @brief   Extract bit field from register.
+ * 
+ * @param   pulAddr     Register.
+ * 
+ * @param   ulBit       Lowest bit of field.
+ * 
+ * @param   ulWidth     Field width.
+ * 
+ * @return  Field value.
+ */
+static inline uint32_t BME_ulUbfx32(volatile uint32_t *const pulAddr, const uint32_t ulBit, const uint32_t ulWidth)
+{
+    return (uint32_t)((*pulAddr >> ulBit) & ((1ULL << ulWidth) - 1));
+}
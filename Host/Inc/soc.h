@@ -0,0 +1,157 @@
+/**
+ * soc.h
+ * This header declares the virtual MKL25Z128 the host build runs on.
+ * 
+ * Time is a count of 24 MHz bus clock cycles. It advances only when
+ * firmware touches a peripheral register, when a model consumes time
+ * for a transfer and when the idle task waits for an interrupt, so code
+ * between register accesses takes no virtual time.
+ * 
+ * Peripheral models keep their state in the register blocks declared
+ * in the host MKL25Z4.h. They see firmware writes in their sync
+ * handler, which runs before every register access, and schedule
+ * events for what happens later, e.g. a timer overflow. Events and
+ * sync handlers only change register blocks and pend interrupts,
+ * handlers run when NVIC rules allow it.
+ * 
+ * Everything runs on one host thread. Interrupt handlers run on the
+ * stack of the task they interrupt, like on target.
+ * 
+ * DMA takes 32-bit addresses from firmware, so host programs are linked
+ * with RAM and register blocks where the DMA of the MKL25Z128 can reach
+ * them, see SOC_SRAM_START and SOC_PERIPHERAL_START:
+ *  -no-pie -Wl,-Tdata=0x1FF00000 -Wl,--section-start=.peripherals=0x40000000
+ * Task stacks are in .bss, the FreeRTOS heap is not, so DMA buffers must
+ * be on a task stack or static like on target.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Global defines */
+#define SOC_BUS_CLOCK_HZ                (24000000ULL)
+#define SOC_CORE_CLOCK_HZ               (48000000UL)
+#define SOC_CYCLES_PER_US               (24ULL)
+#define SOC_US(x)                       ((uint64_t)(x) * SOC_CYCLES_PER_US)
+#define SOC_MS(x)                       (SOC_US(x) * 1000ULL)
+#define SOC_CYCLES_TO_US(x)             ((x) / SOC_CYCLES_PER_US)
+
+#define SOC_ACCESS_CYCLES               (1ULL)      /* Register access over the peripheral bridge */
+#define SOC_EXCEPTION_COUNT             (48UL)      /* 16 system exceptions and 32 interrupts */
+#define SOC_PRIORITY_BITS               (2UL)
+#define SOC_THREAD_PRIORITY             (256L)      /* Below all exceptions */
+
+#define SOC_PORT_COUNT                  (5UL)       /* PORTA...PORTE */
+#define SOC_PORT_A                      (0UL)
+#define SOC_PORT_B                      (1UL)
+#define SOC_PORT_C                      (2UL)
+#define SOC_PORT_D                      (3UL)
+#define SOC_PORT_E                      (4UL)
+#define SOC_PIN_WATCHES                 (2UL)       /* Handlers per pin, e.g. a device and a benchmark */
+
+/* DMA reachable windows, accesses elsewhere are bus errors */
+#define SOC_SRAM_START                  (0x1FF00000UL)  /* .data and .bss */
+#define SOC_SRAM_END                    (0x20100000UL)
+#define SOC_PERIPHERAL_START            (0x40000000UL)  /* Register blocks */
+#define SOC_PERIPHERAL_END              (0x40100000UL)
+#define SOC_PERIPHERAL                  __attribute__((section(".peripherals")))
+
+struct SOC_Event;
+
+/* Called when event time is reached, must not call FreeRTOS */
+typedef void (*SOC_EventHandler)(struct SOC_Event *const pxEvent);
+
+/* Called before each register access to pick up firmware writes */
+typedef void (*SOC_SyncHandler)(void);
+
+/* Called when a pin watched with SOC_vWatchPin() changes level */
+typedef void (*SOC_PinHandler)(const uint32_t ulLevel, void *const pvContext);
+
+/* SPI1 slave, called with each byte when it is clocked out */
+typedef uint8_t (*SOC_SpiDevice)(const uint8_t ucMosi);
+
+/* ADC0 input, called for each averaged sample, returns level in 1/65536 of VREFH */
+typedef uint32_t (*SOC_AnalogInput)(const uint32_t ulChannel);
+
+/* RC node on CMP0 input 5 (PTE29), returns bus clock cycles it floats to fall from dFrom to dTo, fractions of VDD */
+typedef uint64_t (*SOC_RcNode)(const double dFrom, const double dTo);
+
+/* Timed event, owned by the model that schedules it */
+struct SOC_Event
+{
+    uint64_t ullTime;                   /* Bus clock cycle */
+    SOC_EventHandler pxHandler;
+    void *pvContext;                    /* For handler */
+    uint32_t ulQueued;                  /* Set while scheduled */
+    struct SOC_Event *pxNext;
+};
+
+/* Peripheral model registered with SOC_vAddModel() */
+struct SOC_Model
+{
+    const char *pcName;
+    SOC_SyncHandler pxSync;             /* NULL for none */
+    struct SOC_Model *pxNext;
+};
+
+/* SPI1 model counters */
+struct SOC_SpiStats
+{
+    uint32_t ulBytes;
+    uint32_t ulOverruns;                /* Received while SPRF was set, byte lost */
+};
+
+/* ADC0, CMP0 and TPM input capture counters */
+struct SOC_AnalogStats
+{
+    uint32_t ulConversions;             /* Completed, compare passed or not */
+    uint32_t ulCompareMisses;           /* Compare failed, no COCO */
+    uint32_t ulCalibrations;
+    uint32_t ulComparatorEdges;         /* CMP0 output changes */
+    uint32_t ulCaptures;                /* TPM channel input captures */
+};
+
+/* FTFA model counters */
+struct SOC_FlashStats
+{
+    uint32_t ulErases;
+    uint32_t ulPrograms;
+    uint32_t ulErrors;                  /* Commands that ended with ACCERR or MGSTAT0 */
+};
+
+
+/* Global variables */
+extern struct SOC_SpiStats xSocSpiStats;
+extern struct SOC_AnalogStats xSocAnalogStats;
+extern struct SOC_FlashStats xSocFlashStats;
+
+
+/* Global function prototypes */
+uint64_t SOC_ullCycles(void);
+void SOC_vSchedule(struct SOC_Event *const pxEvent, const uint64_t ullDelay);
+void SOC_vCancel(struct SOC_Event *const pxEvent);
+void SOC_vConsume(const uint64_t ullCycles);
+void SOC_vSync(void);
+void SOC_vWaitForInterrupt(void);
+void SOC_vAddModel(struct SOC_Model *const pxModel);
+void *SOC_pvAccess(void *const pvBlock);
+
+void SOC_vSetPending(const int32_t lIRQn);
+uint32_t SOC_ulDisableInterrupts(void);
+void SOC_vRestoreInterrupts(const uint32_t ulMask);
+uint32_t SOC_ulInterruptsMasked(void);
+uint32_t SOC_ulInHandler(void);
+void SOC_vStartDispatch(void);
+void SOC_vStopDispatch(void);
+void SOC_vReturnToThread(void);
+
+void SOC_vPeripheralsInit(void);
+void SOC_vSetPin(const uint32_t ulPort, const uint32_t ulPin, const uint32_t ulLevel);
+uint32_t SOC_ulGetPin(const uint32_t ulPort, const uint32_t ulPin);
+void SOC_vWatchPin(const uint32_t ulPort, const uint32_t ulPin, const SOC_PinHandler pxHandler, void *const pvContext);
+void SOC_vConnectSpi(const SOC_SpiDevice pxDevice);
+uint32_t SOC_ulSpiBusy(void);
+void SOC_vConnectAnalog(const SOC_AnalogInput pxInput);
+void SOC_vConnectRc(const SOC_RcNode pxNode);
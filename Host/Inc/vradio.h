@@ -0,0 +1,89 @@
+/**
+ * vradio.h
+ * This header declares the virtual nRF24L01+ of the host build.
+ * 
+ * The node radio is a PTX on SPI1 with CSN on PTE4, CE on PTA1 and IRQ
+ * on PTA2, as wired on the board. SPI1 model clocks bytes through
+ * VRADIO_ucExchange(), they count while CSN is low. The radio decodes the command
+ * set, keeps the register file and the FIFOs and runs Enhanced
+ * ShockBurst timing on the virtual clock: 130 us TX settling, air time
+ * at the RF_SETUP data rate, ACK turnaround, ARD/ARC auto retransmit and
+ * MAX_RT.
+ * 
+ * The other end of the air is a gateway PRX with six pipes. It drops
+ * duplicates by PID and CRC like the chip, sends the ACK payload loaded
+ * with W_ACK_PAYLOAD for the pipe and hands new payloads to a receiver,
+ * e.g. a gateway process on a UNIX-domain socket, see VRADIO_lConnect().
+ * 
+ * VRADIO_Stats are counted by the model, so they are the ground truth
+ * the driver counters in xRadioStats are checked against.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Global defines */
+#define VRADIO_PIPES                    (6UL)
+#define VRADIO_ADDRESS_LEN              (5UL)
+#define VRADIO_MAX_PAYLOAD              (32UL)
+
+/**
+ * Socket datagrams, one per new payload, answered before the model goes
+ * on, so virtual time stands still while the gateway works:
+ *  node -> gateway     [pipe][payload 1...32]
+ *  gateway -> node     [pipe][ACK payload 0...32] loaded for the next ACK
+ */
+#define VRADIO_DATAGRAM_MAX             (1UL + VRADIO_MAX_PAYLOAD)
+
+/**
+ * Hands a new payload to the gateway. Returns length of the ACK payload
+ * written to pucAck, which goes with the ACK of the next new payload on
+ * the pipe like W_ACK_PAYLOAD, 0 for none.
+ */
+typedef uint32_t (*VRADIO_Receiver)(const uint32_t ulPipe, const uint8_t *const pucPayload, const uint32_t ulLength,
+                                    uint8_t *const pucAck);
+
+/* Gateway end of the air */
+struct VRADIO_Config
+{
+    uint8_t ucChannel;                  /* RF_CH of the gateway */
+    uint8_t ucAddress[VRADIO_PIPES][VRADIO_ADDRESS_LEN];    /* LSB first */
+    uint32_t ulLossPerMille;            /* Each packet and ACK is lost with this chance */
+    uint32_t ulSeed;                    /* Of loss pattern */
+    VRADIO_Receiver pxReceiver;         /* NULL to only count payloads */
+};
+
+/* Ground truth */
+struct VRADIO_Stats
+{
+    uint32_t ulPayloads;                /* New payloads sent, not MAX_RT resends */
+    uint32_t ulAttempts;
+    uint32_t ulRetransmits;
+    uint32_t ulAcked;                   /* TX_DS */
+    uint32_t ulMaxRt;
+    uint32_t ulDelivered;               /* New payloads gateway received */
+    uint32_t ulDeliveredBytes;
+    uint32_t ulDuplicates;
+    uint32_t ulLostPackets;
+    uint32_t ulLostAcks;
+    uint32_t ulRejected;                /* Channel, address or packet format differ from gateway */
+    uint32_t ulAckPayloads;             /* Received with ACKs */
+    uint32_t ulAckPayloadBytes;
+    uint32_t ulShortPulses;             /* CE high less than 10 us */
+    uint32_t ulCommandErrors;           /* Unknown command, FIFO overflow or underflow */
+    uint64_t ullAirCycles;              /* TX packets on air */
+    uint64_t ullTxCycles;               /* Settling and air */
+    uint64_t ullRxCycles;               /* Waiting for ACK */
+};
+
+
+/* Global variables */
+extern struct VRADIO_Stats xVradioStats;
+
+
+/* Global function prototypes */
+void VRADIO_vInit(const struct VRADIO_Config *const pxConfig);
+int32_t VRADIO_lConnect(const char *const pcPath);
+uint8_t VRADIO_ucExchange(const uint8_t ucMosi);
@@ -0,0 +1,65 @@
+/**
+ * vsensors.h
+ * This header declares the virtual sensors and pumps of the host build.
+ * 
+ * Air temperature and humidity follow a sine trace around their means.
+ * The TMP36GT drives its ADC0 channel, the HS1101 is the RC node on
+ * CMP0 input 5 and discharges through its 1 MOhm resistor with the
+ * capacitance of the datasheet response at the traced humidity and
+ * temperature. CMP0_OUT on PTE0 is wired to the TPM1 CH1 capture input
+ * on PTA13 like on the board.
+ * 
+ * Soil of each watering zone dries at a steady rate and is watered while
+ * the PWM of its pump runs, i.e. TPM0 counts and PTDn is muxed to its
+ * channel. Probes read their zone through the SEN0193 response on the
+ * channels board.h lists.
+ * 
+ * VSENSORS_Stats are counted by the model, so they are the ground truth
+ * readings are checked against.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Global defines */
+#define VSENSORS_ZONES                  (5UL)       /* Pumps on PTD0...PTD4 */
+
+/* Sensor environment */
+struct VSENSORS_Config
+{
+    double dTemperature;                /* Mean, Celsius */
+    double dTemperatureSwing;           /* Amplitude, Celsius */
+    double dHumidity;                   /* Mean, %RH */
+    double dHumiditySwing;              /* Amplitude, %RH */
+    double dSwingPeriod;                /* Seconds */
+    double dSoilMoisture;               /* At start, % */
+    double dDryingRate;                 /* % per second while pump is off */
+    double dWateringRate;               /* % per second while pump is on */
+    uint32_t ulNoise;                   /* Peak ADC noise in 1/65536 of VREFH */
+    uint32_t ulSeed;                    /* Of noise */
+};
+
+/* Ground truth */
+struct VSENSORS_Stats
+{
+    uint32_t ulSamples;                 /* ADC samples of sensors */
+    uint32_t ulDischarges;              /* HS1101 discharges */
+    double dMinTemperature;             /* Extremes at samples and discharges */
+    double dMaxTemperature;
+    double dMinHumidity;
+    double dMaxHumidity;
+    double dSoilMoisture[VSENSORS_ZONES];   /* Now, % */
+    double dMinSoilMoisture[VSENSORS_ZONES];
+    uint32_t ulPumpStarts[VSENSORS_ZONES];
+    uint64_t ullPumpCycles[VSENSORS_ZONES]; /* Bus clock cycles pump ran */
+};
+
+
+/* Global variables */
+extern struct VSENSORS_Stats xVsensorsStats;
+
+
+/* Global function prototypes */
+void VSENSORS_vInit(const struct VSENSORS_Config *const pxConfig);
@@ -0,0 +1,313 @@
+/**
+ * port.c
+ * FreeRTOS port of the host build.
+ * 
+ * Each task runs on a ucontext with its own host stack, the FreeRTOS
+ * stack only holds a pointer to it in the top word. Host stacks are in
+ * .bss, where DMA can reach buffers on them, see soc.h. Context switches
+ * happen in PendSV_Handler like on Cortex-M, so a task switched out by
+ * an interrupt resumes inside the handler it was in. SysTick is a timed
+ * event of the virtual SoC.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "MKL25Z4.h"
+
+
+/* Local defines */
+#define HOST_STACK_SIZE                 (64UL * 1024UL)     /* Room for host library calls */
+#define HOST_STACKS                     (16UL)
+#define TICK_CYCLES                     (SOC_BUS_CLOCK_HZ / configTICK_RATE_HZ)
+#define KERNEL_PRIORITY                 (configLIBRARY_LOWEST_INTERRUPT_PRIORITY)
+
+struct Port_Context
+{
+    ucontext_t xContext;
+    TaskFunction_t pxCode;
+    void *pvParameters;
+    uint32_t ulStack;                   /* Index to ucStacks */
+};
+
+
+/* Global variables */
+extern void *volatile pxCurrentTCB;
+
+
+/* Local variables */
+static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;  /* Tasks set it to 0 when they start */
+static ucontext_t xSchedulerContext;                /* Caller of vTaskStartScheduler() */
+static struct SOC_Event xTickEvent;
+static uint8_t ucStacks[HOST_STACKS][HOST_STACK_SIZE] __attribute__((aligned(16)));
+static uint8_t ucStackUsed[HOST_STACKS];
+
+
+/* Local function prototypes */
+static struct Port_Context *pxCurrentContext(void);
+static void vTaskEntry(void);
+static void vTick(struct SOC_Event *const pxEvent);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Create host context for a task.
+ * 
+ * @param   pxTopOfStack    FreeRTOS stack of task.
+ * 
+ * @param   pxCode          Task function.
+ * 
+ * @param   pvParameters    For task function.
+ * 
+ * @return  New top of stack, holds the context.
+ */
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters)
+{
+    struct Port_Context *pxContext = malloc(sizeof(*pxContext));
+    uint32_t ulStack = 0;
+    
+    configASSERT(pxContext != NULL);
+    while ((ulStack < HOST_STACKS) && (ucStackUsed[ulStack] != 0))
+    {
+        ulStack++;
+    }
+    configASSERT(ulStack < HOST_STACKS);
+    ucStackUsed[ulStack] = 1;
+    
+    pxContext->ulStack = ulStack;
+    pxContext->pxCode = pxCode;
+    pxContext->pvParameters = pvParameters;
+    
+    (void)getcontext(&pxContext->xContext);
+    pxContext->xContext.uc_stack.ss_sp = ucStacks[pxContext->ulStack];
+    pxContext->xContext.uc_stack.ss_size = HOST_STACK_SIZE;
+    pxContext->xContext.uc_link = NULL;
+    makecontext(&pxContext->xContext, vTaskEntry, 0);
+    
+    pxTopOfStack--;
+    *pxTopOfStack = (StackType_t)(uintptr_t)pxContext;
+    
+    return pxTopOfStack;
+}
+
+
+/**
+ * @brief   Free host context of a deleted task. The task has been
+ *          switched out, so its stack isn't in use.
+ * 
+ * @param   pvTCB       TCB of task, starts with top of stack.
+ * 
+ * @return  None
+ */
+void vPortCleanUpTCB(void *const pvTCB)
+{
+    struct Port_Context *pxContext = (struct Port_Context *)(uintptr_t)**(StackType_t **)pvTCB;
+    
+    ucStackUsed[pxContext->ulStack] = 0;
+    free(pxContext);
+}
+
+
+/**
+ * @brief   Start SysTick and the first task. Returns when a task calls
+ *          vTaskEndScheduler().
+ * 
+ * @param   None
+ * 
+ * @return  pdFALSE
+ */
+BaseType_t xPortStartScheduler(void)
+{
+    NVIC_SetPriority(PendSV_IRQn, KERNEL_PRIORITY);
+    NVIC_SetPriority(SysTick_IRQn, KERNEL_PRIORITY);
+    
+    xTickEvent.pxHandler = vTick;
+    SOC_vSchedule(&xTickEvent, TICK_CYCLES);
+    
+    uxCriticalNesting = 0;
+    SOC_vStartDispatch();
+    
+    (void)swapcontext(&xSchedulerContext, &pxCurrentContext()->xContext);
+    
+    return pdFALSE;
+}
+
+
+/**
+ * @brief   Stop SysTick and return to caller of vTaskStartScheduler().
+ *          Called from a task with interrupts masked.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void vPortEndScheduler(void)
+{
+    SOC_vStopDispatch();
+    SOC_vCancel(&xTickEvent);
+    
+    (void)swapcontext(&pxCurrentContext()->xContext, &xSchedulerContext);
+}
+
+
+/**
+ * @brief   Enter critical section.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void vPortEnterCritical(void)
+{
+    (void)SOC_ulDisableInterrupts();
+    uxCriticalNesting++;
+}
+
+
+/**
+ * @brief   Exit critical section, interrupts that were pended in it
+ *          are taken when the outermost one ends.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void vPortExitCritical(void)
+{
+    configASSERT(uxCriticalNesting != 0);
+    
+    uxCriticalNesting--;
+    if (uxCriticalNesting == 0)
+    {
+        SOC_vRestoreInterrupts(0);
+    }
+}
+
+
+/**
+ * @brief   Request context switch, taken when PendSV may preempt.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void vPortYieldFromISR(void)
+{
+    NVIC_SetPendingIRQ(PendSV_IRQn);
+}
+
+
+/**
+ * @brief   Switch to the task the scheduler selects.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void PendSV_Handler(void)
+{
+    struct Port_Context *const pxPrevious = pxCurrentContext();
+    struct Port_Context *pxNext;
+    const uint32_t ulMask = SOC_ulDisableInterrupts();
+    
+    vTaskSwitchContext();
+    pxNext = pxCurrentContext();
+    
+    if (pxNext != pxPrevious)
+    {
+        (void)swapcontext(&pxPrevious->xContext, &pxNext->xContext);
+    }
+    
+    SOC_vRestoreInterrupts(ulMask);
+}
+
+
+/**
+ * @brief   Increment tick count and request context switch if a task
+ *          was unblocked.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void SysTick_Handler(void)
+{
+    const uint32_t ulMask = SOC_ulDisableInterrupts();
+    
+    if (xTaskIncrementTick() != pdFALSE)
+    {
+        SOC_vSetPending(PendSV_IRQn);
+    }
+    
+    SOC_vRestoreInterrupts(ulMask);
+}
+
+
+/**
+ * @brief   Print failed assert and stop.
+ * 
+ * @param   ulLine      Line of assert.
+ * 
+ * @param   pcFile      File of assert.
+ * 
+ * @return  None
+ */
+void vPortAssertCalled(const uint32_t ulLine, const char *const pcFile)
+{
+    fprintf(stderr, "assert failed: %s:%lu at cycle %llu\n", pcFile, (unsigned long)ulLine,
+            (unsigned long long)SOC_ullCycles());
+    abort();
+}
+
+
+/**
+ * @brief   Read host context of running task.
+ * 
+ * @param   None
+ * 
+ * @return  Context stored by pxPortInitialiseStack().
+ */
+static struct Port_Context *pxCurrentContext(void)
+{
+    return (struct Port_Context *)(uintptr_t)**(StackType_t *volatile *)pxCurrentTCB;
+}
+
+
+/**
+ * @brief   First code of every task. Task is switched in from PendSV or
+ *          scheduler start, so return to thread mode with interrupts on.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vTaskEntry(void)
+{
+    struct Port_Context *const pxContext = pxCurrentContext();
+    
+    SOC_vReturnToThread();
+    SOC_vRestoreInterrupts(0);
+    
+    pxContext->pxCode(pxContext->pvParameters);
+    
+    /* Tasks must delete themselves instead of returning */
+    configASSERT(0);
+}
+
+
+/**
+ * @brief   SysTick timer event.
+ * 
+ * @param   pxEvent     Tick event.
+ * 
+ * @return  None
+ */
+static void vTick(struct SOC_Event *const pxEvent)
+{
+    SOC_vSetPending(SysTick_IRQn);
+    SOC_vSchedule(pxEvent, TICK_CYCLES);
+}
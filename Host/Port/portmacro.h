@@ -0,0 +1,72 @@
+/**
+ * portmacro.h
+ * FreeRTOS port of the host build. Tasks are ucontext coroutines on one
+ * host thread, interrupt masking and PendSV/SysTick go through the
+ * virtual NVIC in soc.c.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+/* System headers */
+#include <stdint.h>
+
+/* User headers */
+#include "FreeRTOSConfig.h"
+#include "soc.h"
+
+#define portCHAR                        char
+#define portFLOAT                       float
+#define portDOUBLE                      double
+#define portLONG                        long
+#define portSHORT                       short
+#define portSTACK_TYPE                  unsigned long
+#define portBASE_TYPE                   long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+typedef uint16_t TickType_t;
+#define portMAX_DELAY                   (TickType_t)0xffff
+#else
+typedef uint32_t TickType_t;
+#define portMAX_DELAY                   (TickType_t)0xffffffff
+#endif
+
+/* Mask of 8 is unsigned int in portable.h and would clear the upper half of 64-bit pointers */
+#define portBYTE_ALIGNMENT              4
+#define portSTACK_GROWTH                -1
+#define portPOINTER_SIZE_TYPE           uintptr_t
+#define portTICK_PERIOD_MS              ((TickType_t)1000 / configTICK_RATE_HZ)
+
+/* Critical sections */
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+
+#define portCRITICAL_NESTING_IN_TCB     0
+#define portSET_INTERRUPT_MASK_FROM_ISR()       SOC_ulDisableInterrupts()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)    SOC_vRestoreInterrupts(x)
+#define portDISABLE_INTERRUPTS()        ((void)SOC_ulDisableInterrupts())
+#define portENABLE_INTERRUPTS()         SOC_vRestoreInterrupts(0)
+#define portENTER_CRITICAL()            vPortEnterCritical()
+#define portEXIT_CRITICAL()             vPortExitCritical()
+
+/* Scheduler utilities */
+void vPortYieldFromISR(void);
+void vPortCleanUpTCB(void *const pvTCB);
+
+#define portYIELD()                     vPortYieldFromISR()
+#define portEND_SWITCHING_ISR(xSwitchRequired)  if (xSwitchRequired) vPortYieldFromISR()
+#define portCLEAN_UP_TCB(pxTCB)         vPortCleanUpTCB(pxTCB)
+#define portNOP()
+
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters)   void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters)         void vFunction(void *pvParameters)
+
+/* Exception handlers, taken by the virtual NVIC */
+void PendSV_Handler(void);
+void SysTick_Handler(void);
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,516 @@
+/**
+ * appbench.c
+ * This file runs the whole Remote application on the host build and
+ * reports its benchmark points.
+ * 
+ * Remote/Src and its drivers run unmodified on the FreeRTOS host port
+ * over the models of the virtual MKL25Z128: ADC0 scans and compare
+ * monitoring, HS1101 bursts through CMP0, TPM1 and DMA, pump PWM on
+ * TPM0, the nRF24L01 on SPI1 and calibration records in flash. Sensors
+ * and pumps are vsensors.c, the gateway is the Gateway/ decoder behind
+ * vradio.c.
+ * 
+ * A monitor task collects xBenchmarkReport one tick after vBenchmarkTask
+ * publishes it, so system.c is built with vBenchmarkTask renamed to the
+ * wrapper here that starts both. Its idle hook is renamed too, the one
+ * here also sleeps so that virtual time moves on. main.c never returns,
+ * so the monitor prints the report and exits when the run is over.
+ * 
+ * Build from repository root:
+ *  cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-attributes -DRAMFUNC=
+ *     -IHost/Inc -IHost/Port -IRemote/Inc -IRemote/Drivers/Inc -IRemote/FreeRTOS/include -IGateway/Inc
+ *     -DvApplicationIdleHook=vSystemIdleHook -DvBenchmarkTask=vAppbenchBenchmarkTask -c Remote/Src/system.c
+ *  cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-attributes -DRAMFUNC=
+ *     -IHost/Inc -IHost/Port -IRemote/Inc -IRemote/Drivers/Inc -IRemote/FreeRTOS/include -IGateway/Inc
+ *     -Dmain=lRemoteMain -c Remote/Src/main.c
+ *  cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-attributes -DRAMFUNC=
+ *     -IHost/Inc -IHost/Port -IRemote/Inc -IRemote/Drivers/Inc -IRemote/FreeRTOS/include -IGateway/Inc
+ *     -no-pie -Wl,-Tdata=0x1FF00000 -Wl,--section-start=.peripherals=0x40000000
+ *     Host/Src/appbench.c Host/Src/vsensors.c Host/Src/vradio.c Host/Src/soc.c Host/Src/peripherals.c Host/Port/port.c
+ *     system.o main.o Remote/Src/HS1101.c Remote/Src/benchmark.c Remote/Src/comm.c Remote/Src/command.c
+ *     Remote/Src/filter.c Remote/Src/frame.c Remote/Src/motor.c Remote/Src/pool.c Remote/Src/sensors.c
+ *     Remote/Drivers/Src/adc.c Remote/Drivers/Src/dma.c Remote/Drivers/Src/flash.c Remote/Drivers/Src/lptmr.c
+ *     Remote/Drivers/Src/nrf24l01.c Remote/Drivers/Src/pit.c Remote/Drivers/Src/spi.c Remote/Drivers/Src/tpm.c
+ *     Remote/FreeRTOS/src/tasks.c Remote/FreeRTOS/src/queue.c Remote/FreeRTOS/src/list.c Remote/FreeRTOS/src/timers.c
+ *     Remote/FreeRTOS/src/event_groups.c Remote/FreeRTOS/src/heap_3.c Gateway/Src/decoder.c
+ *     -lm -o appbench
+ * printf-stdarg.c is left out, host libc has printf and csnprintf is here.
+ * 
+ * Usage: appbench [-t seconds] [-l loss per mille] [-s seed]
+ * Exit status is the number of failed checks.
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "frame.h"
+#include "decoder.h"
+#include "vradio.h"
+#include "vsensors.h"
+
+
+/* Local defines */
+#define APPBENCH_SECONDS                (60UL)      /* Virtual run time */
+#define APPBENCH_STACK_SIZE             (configMINIMAL_STACK_SIZE * 2)
+#define APPBENCH_SETTLE_SECONDS         (10UL)      /* Sensor filters start from boot readings, checks skip them */
+#define APPBENCH_TEMPERATURE_SLACK      (1L)        /* Celsius, rounding of the TMP36 conversion */
+#define APPBENCH_HUMIDITY_SLACK         (3L)        /* %RH, uncalibrated HS1101 */
+#define APPBENCH_SOIL_SLACK             (2L)        /* %, conversion and the probe reading older than the frame */
+
+/* Benchmark points merged over report periods */
+struct Appbench_Point
+{
+    uint32_t ulCount;
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint64_t ullTotal;                  /* Sum of averages weighted by counts */
+};
+
+/* Decoded readings */
+struct Appbench_Readings
+{
+    uint32_t ulFrames;
+    uint32_t ulSamples;
+    int32_t lMin[FRAME_FIELD_COUNT];
+    int32_t lMax[FRAME_FIELD_COUNT];
+    uint32_t ulCount[FRAME_FIELD_COUNT];
+};
+
+
+/* Global function prototypes */
+int lRemoteMain(void);
+void vSystemIdleHook(void);
+void vAppbenchBenchmarkTask(void *const pvParam);
+
+
+/* Local variables */
+static const char *const pcPointNames[BENCH_POINT_COUNT] =
+{
+    "vSensorTask loop",
+    "vFrameTask loop",
+    "vCommTask loop",
+    "vMotorTask loop",
+    "sensor read to radio",
+    "radio send",
+    "radio delivery",
+    "radio stream",
+    "spi queue",
+    "spi transfer",
+    "adc scan",
+};
+static uint32_t ulSeconds = APPBENCH_SECONDS;
+static uint32_t ulLossPerMille;
+static uint32_t ulPeriods;
+static uint32_t ulIdlePercent;
+static struct Appbench_Point xPoints[BENCH_POINT_COUNT];
+static struct Decoder_Node xDecoder;
+static struct Appbench_Readings xReadings;
+
+
+/* Local function prototypes */
+static void vMonitorTask(void *const pvParam);
+static void vMerge(void);
+static uint32_t ulGatewayReceive(const uint32_t ulPipe, const uint8_t *const pucPayload, const uint32_t ulLength,
+                                 uint8_t *const pucAck);
+static void vGatewayOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext);
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed);
+static uint32_t ulReport(void);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Parse options, set up sensors and radio, then boot the
+ *          application.
+ * 
+ * @param   argc        Argument count.
+ * 
+ * @param   argv        Arguments.
+ * 
+ * @return  1 on bad options, otherwise the monitor exits.
+ */
+int main(int argc, char **argv)
+{
+    struct VRADIO_Config xRadioConfig =
+    {
+        .ucChannel = NRF24L01_RF_CHANNEL,
+        .ulSeed = 1,
+        .pxReceiver = ulGatewayReceive,
+    };
+    struct VSENSORS_Config xSensorConfig =
+    {
+        .dTemperature = 22.0,
+        .dTemperatureSwing = 3.0,
+        .dHumidity = 55.0,
+        .dHumiditySwing = 10.0,
+        .dSwingPeriod = 600.0,
+        .dSoilMoisture = 20.0,              /* Dry, pump starts on first reading */
+        .dDryingRate = 0.05,
+        .dWateringRate = 2.0,
+        .ulNoise = 16,
+        .ulSeed = 1,
+    };
+    int lOption;
+    
+    while ((lOption = getopt(argc, argv, "t:l:s:")) != -1)
+    {
+        switch (lOption)
+        {
+            case 't':
+                ulSeconds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                ulLossPerMille = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                xRadioConfig.ulSeed = (uint32_t)strtoul(optarg, NULL, 0);
+                xSensorConfig.ulSeed = xRadioConfig.ulSeed;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t seconds] [-l loss per mille] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    xRadioConfig.ulLossPerMille = ulLossPerMille;
+    
+    /* Gateway listens on the address of every pipe */
+    for (uint32_t i = 0; i < VRADIO_PIPES; i++)
+    {
+        const uint8_t ucAddress[VRADIO_ADDRESS_LEN] = { COMMAND_ADDRESS_BASE + i, 0x22, 0x33, 0x44, 0x55 };
+        
+        memcpy(xRadioConfig.ucAddress[i], ucAddress, VRADIO_ADDRESS_LEN);
+    }
+    DECODER_vNodeInit(&xDecoder);
+    for (uint32_t i = 0; i < FRAME_FIELD_COUNT; i++)
+    {
+        xReadings.lMin[i] = INT32_MAX;
+        xReadings.lMax[i] = INT32_MIN;
+    }
+    
+    SOC_vPeripheralsInit();
+    VSENSORS_vInit(&xSensorConfig);
+    VRADIO_vInit(&xRadioConfig);
+    
+    return lRemoteMain();
+}
+
+
+/**
+ * @brief   Idle hook, runs the one of system.c and sleeps until the next
+ *          interrupt so that virtual time moves on.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void vApplicationIdleHook(void)
+{
+    vSystemIdleHook();
+    __WFI();
+}
+
+
+/**
+ * @brief   Host libc has no csnprintf, system.c names motor timers with it.
+ * 
+ * @param   pcBuffer    Output.
+ * 
+ * @param   xSize       Room in pcBuffer.
+ * 
+ * @param   pcFormat    printf format.
+ * 
+ * @return  Characters written, like vsnprintf.
+ */
+int csnprintf(char *pcBuffer, size_t xSize, const char *pcFormat, ...)
+{
+    va_list xArgs;
+    int lWritten;
+    
+    va_start(xArgs, pcFormat);
+    lWritten = vsnprintf(pcBuffer, xSize, pcFormat, xArgs);
+    va_end(xArgs);
+    
+    return lWritten;
+}
+
+
+/**
+ * @brief   Created by vCreateTasks() in place of vBenchmarkTask. Starts
+ *          the monitor on the same tick and becomes vBenchmarkTask.
+ * 
+ * @param   pvParam     Passed on.
+ * 
+ * @return  None
+ */
+void vAppbenchBenchmarkTask(void *const pvParam)
+{
+    static TickType_t xStart;
+    BaseType_t xCreated;
+    
+    xStart = xTaskGetTickCount();
+    xCreated = xTaskCreate(vMonitorTask, "Monitor", APPBENCH_STACK_SIZE, &xStart, BENCHMARKTASKPRIORITY, NULL);
+    configASSERT(xCreated == pdPASS);
+    
+    vBenchmarkTask(pvParam);
+}
+
+
+/**
+ * @brief   Monitor task. Merges each report of vBenchmarkTask, which has
+ *          the same priority and wakes a tick earlier, then exits with
+ *          the report after the run.
+ * 
+ * @param   pvParam     Tick vBenchmarkTask started on.
+ * 
+ * @return  None
+ */
+static void vMonitorTask(void *const pvParam)
+{
+    TickType_t xLastWakeTime = *(const TickType_t *)pvParam;
+    const uint32_t ulRunPeriods = (ulSeconds * 1000UL + BENCHMARK_REPORT_PERIOD_MS - 1) / BENCHMARK_REPORT_PERIOD_MS;
+    
+    /* Stay a tick behind vBenchmarkTask */
+    vTaskDelayUntil(&xLastWakeTime, 1);
+    
+    while (ulPeriods < ulRunPeriods)
+    {
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(BENCHMARK_REPORT_PERIOD_MS));
+        vMerge();
+    }
+    
+    exit((int)ulReport());
+}
+
+
+/**
+ * @brief   Merge latest xBenchmarkReport to the run totals.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vMerge(void)
+{
+    for (uint32_t i = 0; i < BENCH_POINT_COUNT; i++)
+    {
+        const struct Benchmark_Stats *const pxReport = &xBenchmarkReport[i];
+        struct Appbench_Point *const pxPoint = &xPoints[i];
+        
+        if (pxReport->ulCount == 0)
+        {
+            continue;
+        }
+        
+        if ((pxPoint->ulCount == 0) || (pxReport->ulMin < pxPoint->ulMin))
+        {
+            pxPoint->ulMin = pxReport->ulMin;
+        }
+        if (pxReport->ulMax > pxPoint->ulMax)
+        {
+            pxPoint->ulMax = pxReport->ulMax;
+        }
+        pxPoint->ulCount += pxReport->ulCount;
+        pxPoint->ullTotal += (uint64_t)pxReport->ulAverage * pxReport->ulCount;
+    }
+    
+    ulIdlePercent = ulBenchmarkIdlePercent;
+    ulPeriods++;
+}
+
+
+/**
+ * @brief   In-process gateway, VRADIO_Receiver. Decodes frames of the
+ *          node, sends no commands.
+ * 
+ * @param   ulPipe      Pipe of the frame.
+ * 
+ * @param   pucPayload  Frame.
+ * 
+ * @param   ulLength    Frame length.
+ * 
+ * @param   pucAck      Unused.
+ * 
+ * @return  0, no ACK payload.
+ */
+static uint32_t ulGatewayReceive(const uint32_t ulPipe, const uint8_t *const pucPayload, const uint32_t ulLength,
+                                 uint8_t *const pucAck)
+{
+    (void)pucAck;
+    
+    if (ulPipe == COMMAND_PIPE(NODE_ID))
+    {
+        (void)DECODER_lPush(&xDecoder, pucPayload, ulLength, vGatewayOutput, NULL);
+    }
+    
+    return 0;
+}
+
+
+/**
+ * @brief   Decoder output of the gateway, tracks range of each field
+ *          once sensors have settled.
+ * 
+ * @param   pxFrame     Decoded frame.
+ * 
+ * @param   pvContext   Unused.
+ * 
+ * @return  None
+ */
+static void vGatewayOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext)
+{
+    (void)pvContext;
+    
+    if (pxFrame->ulType == FRAME_TYPE_SCHEDULE)
+    {
+        return;
+    }
+    
+    xReadings.ulFrames++;
+    for (uint32_t s = 0; s < pxFrame->ulSampleCount; s++)
+    {
+        xReadings.ulSamples++;
+        if (pxFrame->xSamples[s].ulTimestamp < APPBENCH_SETTLE_SECONDS)
+        {
+            continue;
+        }
+        
+        for (uint32_t f = 0; f < pxFrame->ulFieldCount; f++)
+        {
+            const uint32_t ulType = pxFrame->xFields[f].ulType;
+            const int32_t lValue = pxFrame->xSamples[s].lValues[f];
+            
+            if (ulType >= FRAME_FIELD_COUNT)
+            {
+                continue;
+            }
+            
+            xReadings.ulCount[ulType]++;
+            xReadings.lMin[ulType] = (lValue < xReadings.lMin[ulType]) ? lValue : xReadings.lMin[ulType];
+            xReadings.lMax[ulType] = (lValue > xReadings.lMax[ulType]) ? lValue : xReadings.lMax[ulType];
+        }
+    }
+}
+
+
+/**
+ * @brief   Print result of a check.
+ * 
+ * @param   pcName      What was checked.
+ * 
+ * @param   ulPassed    Nonzero if it held.
+ * 
+ * @return  0 if passed, else 1.
+ */
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed)
+{
+    printf("%-44s %s\n", pcName, ulPassed ? "ok" : "FAILED");
+    
+    return ulPassed ? 0 : 1;
+}
+
+
+/**
+ * @brief   Print benchmark points, model counters and readings against
+ *          the ground truth of the models, and check them.
+ * 
+ * @note    Readings are checked against the extremes of the air the
+ *          models were sampled at, widened by the slack of each sensor.
+ * 
+ * @param   None
+ * 
+ * @return  Number of failed checks.
+ */
+static uint32_t ulReport(void)
+{
+    const double dSeconds = (double)SOC_ullCycles() / SOC_BUS_CLOCK_HZ;
+    const int32_t lMinTemperature = (int32_t)floor(xVsensorsStats.dMinTemperature) - APPBENCH_TEMPERATURE_SLACK;
+    const int32_t lMaxTemperature = (int32_t)ceil(xVsensorsStats.dMaxTemperature) + APPBENCH_TEMPERATURE_SLACK;
+    const int32_t lMinHumidity = (int32_t)floor(xVsensorsStats.dMinHumidity) - APPBENCH_HUMIDITY_SLACK;
+    const int32_t lMaxHumidity = (int32_t)ceil(xVsensorsStats.dMaxHumidity) + APPBENCH_HUMIDITY_SLACK;
+    double dMinSoil = 100.0;
+    int32_t lMinSoil;
+    uint32_t ulFailed = 0;
+    
+    for (uint32_t i = 0; i < BOARD_MOTOR_COUNT; i++)
+    {
+        dMinSoil = fmin(dMinSoil, xVsensorsStats.dMinSoilMoisture[i]);
+    }
+    lMinSoil = (int32_t)floor(dMinSoil) - APPBENCH_SOIL_SLACK;
+    
+    printf("appbench: %lu report periods, %.3f s virtual, idle %lu %%\n", (unsigned long)ulPeriods, dSeconds,
+           (unsigned long)ulIdlePercent);
+    printf("%-24s %8s %8s %8s %8s\n", "us", "count", "min", "avg", "max");
+    for (uint32_t i = 0; i < BENCH_POINT_COUNT; i++)
+    {
+        const struct Appbench_Point *const pxPoint = &xPoints[i];
+        
+        printf("%-24s %8lu %8lu %8lu %8lu\n", pcPointNames[i], (unsigned long)pxPoint->ulCount,
+               (unsigned long)pxPoint->ulMin,
+               (unsigned long)((pxPoint->ulCount != 0) ? (pxPoint->ullTotal / pxPoint->ulCount) : 0),
+               (unsigned long)pxPoint->ulMax);
+    }
+    printf("adc: boot %lu us, calibration %lu us%s, conversions %lu, compare misses %lu, scan timeouts %lu\n",
+           (unsigned long)xAdcCalibrationStats.ulBootUs, (unsigned long)xAdcCalibrationStats.ulCalibrationUs,
+           xAdcCalibrationStats.ulCached ? " cached" : "", (unsigned long)xSocAnalogStats.ulConversions,
+           (unsigned long)xSocAnalogStats.ulCompareMisses, (unsigned long)ulScanTimeouts);
+    for (uint32_t i = 0; i < ADC_PROFILE_COUNT; i++)
+    {
+        printf("adc profile %lu: %lu ns, mean %lu, noise %lu\n", (unsigned long)i,
+               (unsigned long)xAdcProfileStats[i].ulConversionNs, (unsigned long)xAdcProfileStats[i].ulMean,
+               (unsigned long)xAdcProfileStats[i].ulNoise);
+    }
+    printf("hs1101: discharges %lu, captures %lu, comparator edges %lu, burst errors %lu\n",
+           (unsigned long)xVsensorsStats.ulDischarges, (unsigned long)xSocAnalogStats.ulCaptures,
+           (unsigned long)xSocAnalogStats.ulComparatorEdges, (unsigned long)ulHumidityBurstErrors);
+    printf("flash: erases %lu, programs %lu, errors %lu\n", (unsigned long)xSocFlashStats.ulErases,
+           (unsigned long)xSocFlashStats.ulPrograms, (unsigned long)xSocFlashStats.ulErrors);
+    for (uint32_t i = 0; i < BOARD_MOTOR_COUNT; i++)
+    {
+        printf("zone %lu: moisture %.1f %% (min %.1f), pump starts %lu, on %.1f s\n", (unsigned long)i,
+               xVsensorsStats.dSoilMoisture[i], xVsensorsStats.dMinSoilMoisture[i],
+               (unsigned long)xVsensorsStats.ulPumpStarts[i],
+               (double)xVsensorsStats.ullPumpCycles[i] / SOC_BUS_CLOCK_HZ);
+    }
+    printf("radio: delivered %lu, lost packets %lu, max rt %lu, radio on %.2f %%\n",
+           (unsigned long)xVradioStats.ulDelivered, (unsigned long)xVradioStats.ulLostPackets,
+           (unsigned long)xVradioStats.ulMaxRt,
+           100.0 * (double)(xVradioStats.ullTxCycles + xVradioStats.ullRxCycles) / (double)SOC_ullCycles());
+    printf("gateway: frames %lu, samples %lu, errors %lu\n", (unsigned long)xReadings.ulFrames,
+           (unsigned long)xReadings.ulSamples, (unsigned long)xDecoder.ulErrors);
+    printf("temperature %ld...%ld C, air %.1f...%.1f C\n", (long)xReadings.lMin[FRAME_FIELD_TEMPERATURE],
+           (long)xReadings.lMax[FRAME_FIELD_TEMPERATURE], xVsensorsStats.dMinTemperature, xVsensorsStats.dMaxTemperature);
+    printf("humidity %ld...%ld %%RH, air %.1f...%.1f %%RH\n", (long)xReadings.lMin[FRAME_FIELD_HUMIDITY],
+           (long)xReadings.lMax[FRAME_FIELD_HUMIDITY], xVsensorsStats.dMinHumidity, xVsensorsStats.dMaxHumidity);
+    printf("soil %ld...%ld %%, zones min %.1f %%\n", (long)xReadings.lMin[FRAME_FIELD_SOIL_MOISTURE],
+           (long)xReadings.lMax[FRAME_FIELD_SOIL_MOISTURE], dMinSoil);
+    
+    ulFailed += ulCheck("every task loop measured", (xPoints[BENCH_SENSOR_LOOP].ulCount != 0)
+                                                    && (xPoints[BENCH_FRAME_LOOP].ulCount != 0)
+                                                    && (xPoints[BENCH_COMM_LOOP].ulCount != 0)
+                                                    && (xPoints[BENCH_MOTOR_LOOP].ulCount != 0));
+    ulFailed += ulCheck("sensor to radio measured", xPoints[BENCH_SENSOR_TO_RADIO].ulCount != 0);
+    ulFailed += ulCheck("adc calibrated", xSocAnalogStats.ulCalibrations != 0);
+    ulFailed += ulCheck("no flash errors", xSocFlashStats.ulErrors == 0);
+    ulFailed += ulCheck("no scan timeouts", ulScanTimeouts == 0);
+    ulFailed += ulCheck("no humidity burst errors", ulHumidityBurstErrors == 0);
+    ulFailed += ulCheck("pump watered zone 0", xVsensorsStats.ulPumpStarts[0] != 0);
+    ulFailed += ulCheck("no radio command errors", (xVradioStats.ulCommandErrors == 0) && (xVradioStats.ulShortPulses == 0)
+                                                   && (xVradioStats.ulRejected == 0));
+    ulFailed += ulCheck("frames decoded", (xReadings.ulFrames != 0) && (xDecoder.ulErrors == 0));
+    ulFailed += ulCheck("temperature matches air", (xReadings.ulCount[FRAME_FIELD_TEMPERATURE] != 0)
+                                                   && (xReadings.lMin[FRAME_FIELD_TEMPERATURE] >= lMinTemperature)
+                                                   && (xReadings.lMax[FRAME_FIELD_TEMPERATURE] <= lMaxTemperature));
+    ulFailed += ulCheck("humidity matches air", (xReadings.ulCount[FRAME_FIELD_HUMIDITY] != 0)
+                                                && (xReadings.lMin[FRAME_FIELD_HUMIDITY] >= lMinHumidity)
+                                                && (xReadings.lMax[FRAME_FIELD_HUMIDITY] <= lMaxHumidity));
+    ulFailed += ulCheck("soil moisture matches zones", (xReadings.ulCount[FRAME_FIELD_SOIL_MOISTURE] != 0)
+                                                       && (xReadings.lMin[FRAME_FIELD_SOIL_MOISTURE] >= lMinSoil)
+                                                       && (xReadings.lMax[FRAME_FIELD_SOIL_MOISTURE] <= 100));
+    
+    return ulFailed;
+}
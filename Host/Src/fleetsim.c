@@ -0,0 +1,1293 @@
+/**
+ * fleetsim.c
+ * This file simulates a fleet of nodes sharing the radio channel of one
+ * gateway and reports how the retransmit settings of nrf24l01.h hold up
+ * as the fleet grows.
+ * 
+ * Every node has its own virtual clock, booted at a random time within
+ * the first batch latency and drifting by up to FLEETSIM_DRIFT_PPM, and its
+ * own sensor trace: air temperature and humidity follow a sine with a
+ * phase of their own, soil dries at a rate of its own and a pump waters
+ * it back up when it gets dry. Readings go through the real
+ * Remote/Src/frame.c encoder with the batching of the frame task in
+ * comm.c: a frame is sent when the next reading doesn't fit, when its
+ * first reading is COMM_BATCH_LATENCY_MS old, or right away when a pump
+ * starts, and the frame after a dropped one is rebuilt as a key frame.
+ * 
+ * Each node has a simulated nRF24L01+ with the Enhanced ShockBurst
+ * timing of vradio.c, and the comm task policy of comm.c on top of it:
+ * retransmit COMM_TX_RETRIES times after MAX_RT, then requeue the frame
+ * after COMM_TX_BACKOFF_MS, and drop it after COMM_TX_REQUEUES. Nodes of
+ * a channel share the air with the gateway ACKs, and any overlap of two
+ * packets loses both, there is no capture effect. The gateway radio of
+ * a channel is half-duplex, it misses packets while it turns around for
+ * an ACK, and filters retransmits of an acked packet by PID and CRC like
+ * Enhanced ShockBurst does. Frames that get through go to a Gateway/
+ * decoder per node, so the delivery ratio counts readings the gateway
+ * could decode, and sensor to gateway latency is from the reading to
+ * its decoding.
+ * 
+ * Readings of -t seconds are counted. Nodes go on sampling for another
+ * batch latency, so the last counted readings are batched like the rest,
+ * and the run ends when every frame is delivered or dropped.
+ * 
+ * Nodes are coupled through the channel at the resolution of a packet,
+ * so one fleet runs as a single discrete-event simulation on one thread.
+ * Fleets of the sweep are independent and run on -j threads that take
+ * the next one as they finish, so the largest fleet sets the wall time.
+ * 
+ * Not modelled: TX FIFO bursts of ulStream() (every frame goes on its
+ * own like in ulTransmit()), ACK payloads, schedule frames, RF range and
+ * noise. Frame node ID is one byte, the gateway keys decoders by node.
+ * 
+ * Build from repository root:
+ *  cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -IHost/Inc -IHost/Port -IRemote/Inc -IRemote/Drivers/Inc
+ *     -IRemote/FreeRTOS/include -IGateway/Inc Host/Src/fleetsim.c Remote/Src/frame.c Gateway/Src/decoder.c
+ *     -lpthread -lm -o fleetsim
+ * 
+ * Usage: fleetsim [-n nodes,...] [-d ARD,...] [-r ARC,...] [-w ARD spread] [-c channels]
+ *                 [-t seconds] [-p sample period seconds] [-s seed] [-j threads]
+ * Exit status is the number of failed checks.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "frame.h"
+#include "decoder.h"
+
+
+/* Local defines */
+#define FLEETSIM_SECONDS                (3600UL)    /* Sampling time of each fleet */
+#define FLEETSIM_PERIOD                 (10UL)      /* Seconds between readings */
+#define FLEETSIM_MAX_RUNS               (64UL)      /* Fleets in a sweep */
+#define FLEETSIM_DRIFT_PPM              (40.0)      /* Crystal tolerance */
+#define FLEETSIM_FIELDS                 (3UL)       /* Temperature, humidity, one soil probe */
+#define FLEETSIM_LOAD_NS                (FLEETSIM_US(100))  /* W_TX_PAYLOAD over SPI1 and CE pulse */
+
+#define FLEETSIM_DRY_LEVEL              (30.0)      /* %, pump starts below */
+#define FLEETSIM_WET_LEVEL              (60.0)      /* %, pump stops above */
+#define FLEETSIM_DRYING_RATE            (0.01)      /* % per second, mean */
+#define FLEETSIM_WATERING_RATE          (0.5)       /* % per second */
+#define FLEETSIM_SWING_PERIOD           (3600.0)    /* Seconds */
+
+/* Enhanced ShockBurst timing of vradio.c at 2 Mbps, 5-byte address, 2-byte CRC */
+#define FLEETSIM_US(x)                  ((uint64_t)(x) * 1000ULL)
+#define FLEETSIM_MS(x)                  (FLEETSIM_US(x) * 1000ULL)
+#define NS_PER_SECOND                   (1000000000ULL)
+#define NS_PER_BIT                      (500ULL)
+#define SETTLE_NS                       (FLEETSIM_US(130))
+#define ARD_NS(ard)                     (FLEETSIM_US(((uint64_t)(ard) + 1) * 250))
+#define PACKET_NS(payload)              ((8ULL + 40ULL + 9ULL + (uint64_t)(payload) * 8ULL + 16ULL) * NS_PER_BIT)
+#define ACK_NS                          (SETTLE_NS + PACKET_NS(0))
+#define ARD_MAX                         (15UL)
+#define ARC_MAX                         (15UL)
+
+/* Node radio and comm task states */
+enum Fleetsim_States
+{
+    FLEETSIM_IDLE,                      /* Comm queue empty */
+    FLEETSIM_LOADING,                   /* Payload going over SPI1 */
+    FLEETSIM_SETTLING,
+    FLEETSIM_ON_AIR,
+    FLEETSIM_WAITING_ACK,
+    FLEETSIM_BACKOFF                    /* Frame requeued */
+};
+
+/* Event kinds */
+enum Fleetsim_Events
+{
+    FLEETSIM_EVENT_SAMPLE,
+    FLEETSIM_EVENT_DEADLINE,            /* Batch latency of a frame, tag is batch */
+    FLEETSIM_EVENT_RADIO,               /* Node state timeout */
+    FLEETSIM_EVENT_ACK_START,           /* Gateway ACK goes on air */
+    FLEETSIM_EVENT_ACK_END
+};
+
+/* Pending event, ordered by time and then by scheduling order */
+struct Fleetsim_Event
+{
+    uint64_t ullTime;                   /* ns */
+    uint64_t ullOrder;
+    uint32_t ulNode;
+    uint32_t ulKind;                    /* enum Fleetsim_Events */
+    uint32_t ulTag;
+};
+
+/* Packet on air, collided if another one was on air at any time of it */
+struct Fleetsim_Air
+{
+    uint32_t ulStarts;                  /* Channel starts after own one */
+    uint32_t ulCollided;
+};
+
+/* Channel of a gateway radio */
+struct Fleetsim_Channel
+{
+    uint32_t ulActive;                  /* Packets on air */
+    uint32_t ulStarts;                  /* Packets started */
+    uint64_t ullDeafUntil;              /* Gateway turning around for an ACK or sending it */
+};
+
+/* Frame in the comm queue of a node */
+struct Fleetsim_Message
+{
+    uint8_t ucFrame[FRAME_MAX_SIZE];
+    uint32_t ulLength;
+    uint32_t ulRequeues;
+    uint64_t ullQueued;                 /* ns */
+};
+
+/* Node and the gateway state kept for it */
+struct Fleetsim_Node
+{
+    /* Clock and sensors */
+    uint64_t ullBoot;                   /* ns */
+    double dRate;                       /* Local seconds per second */
+    uint32_t ulSeconds;                 /* Uptime of next reading */
+    double dPhase;
+    double dSoil;                       /* % */
+    double dDryingRate;
+    uint32_t ulPumping;
+    uint64_t ullSoilUpdated;            /* ns */
+    
+    /* Frame task */
+    struct Frame_Encoder xEncoder;
+    uint32_t ulFrameSeconds[FRAME_MAX_SAMPLES];
+    int32_t lFrameValues[FRAME_MAX_SAMPLES][FLEETSIM_FIELDS];
+    uint32_t ulBatch;                   /* Started batches */
+    uint32_t ulDropped;                 /* COMM_EVENT_FRAME_DROPPED */
+    
+    /* Comm task and nRF24L01+ */
+    struct Fleetsim_Message xQueue[MESSAGE_POOL_BLOCKS];
+    uint32_t ulHead;
+    uint32_t ulCount;
+    uint32_t ulChannel;
+    uint32_t ulArd;
+    uint32_t ulState;                   /* enum Fleetsim_States */
+    uint64_t ullStateStart;
+    uint32_t ulArcCount;                /* OBSERVE_TX ARC_CNT */
+    uint32_t ulRetries;                 /* Of ulTransmit() after MAX_RT */
+    uint32_t ulAckComing;
+    uint8_t ucPid;
+    struct Fleetsim_Air xPacket;
+    struct Fleetsim_Air xAck;
+    uint32_t ulAirDeaf;                 /* Gateway was deaf when packet started */
+    uint64_t ullRadioOn;                /* ns settling, on air and waiting for ACK */
+    
+    /* Gateway */
+    uint8_t ucLastPid;
+    uint16_t usLastCrc;
+    uint32_t ulHeard;                   /* Nonzero when PID and CRC are valid */
+    struct Decoder_Node xDecoder;
+};
+
+/* Fleet of the sweep and its results */
+struct Fleetsim_Run
+{
+    uint32_t ulNodes;
+    uint32_t ulArd;                     /* Of node 0, see nrf24l01.h */
+    uint32_t ulArc;
+    
+    uint32_t ulSamples;                 /* Readings taken */
+    uint32_t ulDecoded;                 /* Readings decoded by gateway */
+    uint32_t ulFrames;                  /* Frames passed to comm queue */
+    uint32_t ulPoolDrops;               /* Frames lost on a full comm queue */
+    uint32_t ulAcked;
+    uint32_t ulTxDrops;                 /* Frames dropped after COMM_TX_REQUEUES */
+    uint32_t ulRequeues;
+    uint32_t ulPackets;
+    uint32_t ulCollided;                /* Packets, ACKs not counted */
+    uint32_t ulDuplicates;              /* Retransmits filtered by gateway */
+    uint32_t ulErrors;                  /* Decoder errors */
+    uint32_t ulSensorP50Ms;
+    uint32_t ulSensorP99Ms;
+    uint32_t ulRadioP50Us;              /* Queued to acked */
+    uint32_t ulRadioP99Us;
+    double dRadioOnMean;                /* ms per hour */
+    double dRadioOnMax;
+};
+
+/* Growable list of latencies */
+struct Fleetsim_Latencies
+{
+    uint32_t *pulValues;
+    uint32_t ulCount;
+    uint32_t ulSlots;
+};
+
+/* State of one fleet simulation */
+struct Fleetsim_Sim
+{
+    struct Fleetsim_Run *pxRun;
+    struct Fleetsim_Node *pxNodes;
+    struct Fleetsim_Channel *pxChannels;
+    struct Fleetsim_Event *pxEvents;    /* Binary heap */
+    uint32_t ulEvents;
+    uint32_t ulEventSlots;
+    uint64_t ullOrder;
+    uint64_t ullNow;                    /* ns */
+    uint64_t ullCountEnd;               /* Readings before are counted */
+    uint64_t ullSampleEnd;
+    uint32_t ulRandom;
+    struct Fleetsim_Latencies xSensor;  /* ms */
+    struct Fleetsim_Latencies xRadio;   /* us */
+};
+
+/* Gateway output context */
+struct Fleetsim_Output
+{
+    struct Fleetsim_Sim *pxSim;
+    struct Fleetsim_Node *pxNode;
+};
+
+
+/* Local variables */
+static const uint8_t ucFrameTags[FLEETSIM_FIELDS] =
+{
+    FRAME_FIELD_TEMPERATURE << 4,
+    FRAME_FIELD_HUMIDITY << 4,
+    FRAME_FIELD_SOIL_MOISTURE << 4
+};
+static uint32_t ulSeconds = FLEETSIM_SECONDS;
+static uint32_t ulPeriod = FLEETSIM_PERIOD;
+static uint32_t ulChannels = 1;
+static uint32_t ulSpread = NRF24L01_RETR_DELAY_SPREAD;
+static uint32_t ulSeed = 1;
+static struct Fleetsim_Run xRuns[FLEETSIM_MAX_RUNS];
+static uint32_t ulRuns;
+static uint32_t ulNextRun;              /* Taken by workers */
+
+
+/* Local function prototypes */
+static uint32_t ulParseList(const char *pcList, uint32_t *const pulValues, const uint32_t ulMax);
+static void *pvWorker(void *pvParam);
+static void vSimulate(struct Fleetsim_Run *const pxRun);
+static void vNodeInit(struct Fleetsim_Sim *const pxSim, const uint32_t ulIndex);
+static void vSchedule(struct Fleetsim_Sim *const pxSim, const uint64_t ullTime, const uint32_t ulNode, const uint32_t ulKind,
+                      const uint32_t ulTag);
+static void vPop(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Event *const pxEvent);
+static void vSample(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode);
+static void vReadSensors(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode, int32_t *const plValues);
+static uint32_t ulFrameAppend(struct Fleetsim_Node *const pxNode, const uint32_t ulSeconds, const int32_t *const plValues);
+static void vFrameFlush(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode);
+static void vFrameSend(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode);
+static void vRadioEvent(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode);
+static void vStartAttempt(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode);
+static void vAttemptOutcome(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode, const uint32_t ulAcked);
+static void vNextMessage(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode);
+static void vAirStart(struct Fleetsim_Channel *const pxChannel, struct Fleetsim_Air *const pxAir);
+static uint32_t ulAirEnd(struct Fleetsim_Channel *const pxChannel, const struct Fleetsim_Air *const pxAir);
+static void vGatewayReceive(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode);
+static void vGatewayOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext);
+static uint64_t ullGlobalTime(const struct Fleetsim_Node *const pxNode, const uint32_t ulLocalSeconds);
+static void vAddLatency(struct Fleetsim_Latencies *const pxList, const uint32_t ulValue);
+static uint32_t ulPercentile(struct Fleetsim_Latencies *const pxList, const uint32_t ulPercent);
+static int lCompare(const void *pvA, const void *pvB);
+static double dRandom(struct Fleetsim_Sim *const pxSim);
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Parse options, run the sweep on worker threads and print it.
+ * 
+ * @param   argc        Argument count.
+ * 
+ * @param   argv        Arguments.
+ * 
+ * @return  Number of failed checks, 1 on bad options.
+ */
+int main(int argc, char **argv)
+{
+    uint32_t ulNodes[FLEETSIM_MAX_RUNS] = { 10, 100, 1000, 10000 };
+    uint32_t ulArds[ARD_MAX + 1] = { NRF24L01_RETR_DELAY };
+    uint32_t ulArcs[ARC_MAX + 1] = { NRF24L01_RETR_COUNT };
+    uint32_t ulNodeCount = 4;
+    uint32_t ulArdCount = 1;
+    uint32_t ulArcCount = 1;
+    uint32_t ulThreads = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t ulSmallest = UINT32_MAX;
+    uint32_t ulFailed = 0;
+    uint32_t ulErrors = 0;
+    uint32_t ulDelivered = 1;
+    uint32_t ulInTime = 1;
+    pthread_t xThreads[FLEETSIM_MAX_RUNS];
+    int lOption;
+    
+    while ((lOption = getopt(argc, argv, "n:d:r:w:c:t:p:s:j:")) != -1)
+    {
+        switch (lOption)
+        {
+            case 'n':
+                ulNodeCount = ulParseList(optarg, ulNodes, FLEETSIM_MAX_RUNS);
+                break;
+            case 'd':
+                ulArdCount = ulParseList(optarg, ulArds, ARD_MAX + 1);
+                break;
+            case 'r':
+                ulArcCount = ulParseList(optarg, ulArcs, ARC_MAX + 1);
+                break;
+            case 'w':
+                ulSpread = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                ulChannels = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                ulSeconds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                ulPeriod = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                ulSeed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'j':
+                ulThreads = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                ulNodeCount = 0;
+                break;
+        }
+    }
+    
+    if ((ulNodeCount == 0) || (ulArdCount == 0) || (ulArcCount == 0) || (ulNodeCount * ulArdCount * ulArcCount > FLEETSIM_MAX_RUNS)
+        || (ulSpread == 0) || (ulChannels == 0) || (ulSeconds == 0) || (ulPeriod == 0))
+    {
+        fprintf(stderr, "usage: %s [-n nodes,...] [-d ARD,...] [-r ARC,...] [-w ARD spread] [-c channels]\n"
+                        "       [-t seconds] [-p sample period seconds] [-s seed] [-j threads]\n"
+                        "at most %lu fleets, ARD and ARC 0...15\n", argv[0], (unsigned long)FLEETSIM_MAX_RUNS);
+        return 1;
+    }
+    
+    for (uint32_t n = 0; n < ulNodeCount; n++)
+    {
+        for (uint32_t d = 0; d < ulArdCount; d++)
+        {
+            for (uint32_t r = 0; r < ulArcCount; r++)
+            {
+                xRuns[ulRuns].ulNodes = (ulNodes[n] != 0) ? ulNodes[n] : 1;
+                xRuns[ulRuns].ulArd = (ulArds[d] <= ARD_MAX) ? ulArds[d] : ARD_MAX;
+                xRuns[ulRuns].ulArc = (ulArcs[r] <= ARC_MAX) ? ulArcs[r] : ARC_MAX;
+                ulRuns++;
+            }
+        }
+    }
+    
+    ulThreads = (ulThreads == 0) ? 1 : ((ulThreads > ulRuns) ? ulRuns : ulThreads);
+    for (uint32_t i = 0; i < ulThreads; i++)
+    {
+        if (pthread_create(&xThreads[i], NULL, pvWorker, NULL) != 0)
+        {
+            fprintf(stderr, "fleetsim: can't start worker\n");
+            return 1;
+        }
+    }
+    for (uint32_t i = 0; i < ulThreads; i++)
+    {
+        (void)pthread_join(xThreads[i], NULL);
+    }
+    
+    printf("fleetsim: %lu s of readings every %lu s, %lu channel(s), ARD spread %lu, %lu thread(s)\n",
+           (unsigned long)ulSeconds, (unsigned long)ulPeriod, (unsigned long)ulChannels, (unsigned long)ulSpread,
+           (unsigned long)ulThreads);
+    printf("%6s %3s %3s %9s %9s %7s %6s %7s %8s %6s %6s %7s %7s %8s %8s\n", "nodes", "ard", "arc", "readings", "delivery",
+           "frames", "lost", "requeue", "collided", "p50 s", "p99 s", "p50 us", "p99 us", "on ms/h", "max ms/h");
+    for (uint32_t i = 0; i < ulRuns; i++)
+    {
+        const struct Fleetsim_Run *const pxRun = &xRuns[i];
+        
+        printf("%6lu %3lu %3lu %9lu %8.3f%% %7lu %6lu %7lu %7.2f%% %6.1f %6.1f %7lu %7lu %8.1f %8.1f\n", (unsigned long)pxRun->ulNodes,
+               (unsigned long)pxRun->ulArd, (unsigned long)pxRun->ulArc, (unsigned long)pxRun->ulSamples,
+               100.0 * pxRun->ulDecoded / (pxRun->ulSamples ? pxRun->ulSamples : 1), (unsigned long)pxRun->ulFrames,
+               (unsigned long)(pxRun->ulPoolDrops + pxRun->ulTxDrops), (unsigned long)pxRun->ulRequeues,
+               100.0 * pxRun->ulCollided / (pxRun->ulPackets ? pxRun->ulPackets : 1), pxRun->ulSensorP50Ms / 1000.0,
+               pxRun->ulSensorP99Ms / 1000.0, (unsigned long)pxRun->ulRadioP50Us, (unsigned long)pxRun->ulRadioP99Us,
+               pxRun->dRadioOnMean, pxRun->dRadioOnMax);
+        
+        ulErrors += pxRun->ulErrors;
+        ulSmallest = (pxRun->ulNodes < ulSmallest) ? pxRun->ulNodes : ulSmallest;
+    }
+    printf("s: reading to gateway decode, us: frame queued to acked, ms/h: radio on per node\n");
+    
+    for (uint32_t i = 0; i < ulRuns; i++)
+    {
+        if (xRuns[i].ulNodes == ulSmallest)
+        {
+            ulDelivered &= ((uint64_t)xRuns[i].ulDecoded * 1000ULL >= (uint64_t)xRuns[i].ulSamples * 999ULL);
+            ulInTime &= (xRuns[i].ulSensorP99Ms <= COMM_BATCH_LATENCY_MS + ulPeriod * 1000UL);
+        }
+    }
+    ulFailed += ulCheck("gateway decoded every frame it got", ulErrors == 0);
+    ulFailed += ulCheck("smallest fleet delivers 99.9 % of readings", ulDelivered);
+    ulFailed += ulCheck("smallest fleet p99 within batch latency", ulInTime);
+    
+    return (int)ulFailed;
+}
+
+
+/**
+ * @brief   Parse comma separated list of numbers.
+ * 
+ * @param   pcList      Option argument.
+ * 
+ * @param   pulValues   Parsed values.
+ * 
+ * @param   ulMax       Size of pulValues.
+ * 
+ * @return  Number of values, 0 if the list is empty or too long.
+ */
+static uint32_t ulParseList(const char *pcList, uint32_t *const pulValues, const uint32_t ulMax)
+{
+    uint32_t ulCount = 0;
+    char *pcEnd;
+    
+    while (*pcList != '\0')
+    {
+        if (ulCount == ulMax)
+        {
+            return 0;
+        }
+        
+        pulValues[ulCount++] = (uint32_t)strtoul(pcList, &pcEnd, 0);
+        if (pcEnd == pcList)
+        {
+            return 0;
+        }
+        pcList = (*pcEnd == ',') ? pcEnd + 1 : pcEnd;
+    }
+    
+    return ulCount;
+}
+
+
+/**
+ * @brief   Simulate fleets of the sweep until none is left.
+ * 
+ * @param   pvParam     Unused.
+ * 
+ * @return  NULL
+ */
+static void *pvWorker(void *pvParam)
+{
+    uint32_t ulRun;
+    
+    (void)pvParam;
+    
+    while ((ulRun = __atomic_fetch_add(&ulNextRun, 1, __ATOMIC_RELAXED)) < ulRuns)
+    {
+        vSimulate(&xRuns[ulRun]);
+    }
+    
+    return NULL;
+}
+
+
+/**
+ * @brief   Simulate one fleet until readings are over and every frame
+ *          is delivered or dropped, then fill in results.
+ * 
+ * @param   pxRun       Fleet.
+ * 
+ * @return  None
+ */
+static void vSimulate(struct Fleetsim_Run *const pxRun)
+{
+    struct Fleetsim_Sim xSim;
+    struct Fleetsim_Event xEvent;
+    struct Fleetsim_Node *pxNode;
+    uint64_t ullRadioOn = 0;
+    uint64_t ullRadioOnMax = 0;
+    
+    memset(&xSim, 0, sizeof(xSim));
+    xSim.pxRun = pxRun;
+    xSim.ulRandom = (ulSeed ^ ((uint32_t)(pxRun - xRuns) * 0x9E3779B9UL)) | 1UL;
+    xSim.ullCountEnd = (uint64_t)ulSeconds * NS_PER_SECOND;
+    xSim.ullSampleEnd = xSim.ullCountEnd + FLEETSIM_MS(COMM_BATCH_LATENCY_MS);
+    xSim.pxNodes = calloc(pxRun->ulNodes, sizeof(struct Fleetsim_Node));
+    xSim.pxChannels = calloc(ulChannels, sizeof(struct Fleetsim_Channel));
+    if ((xSim.pxNodes == NULL) || (xSim.pxChannels == NULL))
+    {
+        fprintf(stderr, "fleetsim: out of memory\n");
+        exit(1);
+    }
+    
+    for (uint32_t i = 0; i < pxRun->ulNodes; i++)
+    {
+        vNodeInit(&xSim, i);
+    }
+    
+    while (xSim.ulEvents > 0)
+    {
+        vPop(&xSim, &xEvent);
+        xSim.ullNow = xEvent.ullTime;
+        pxNode = &xSim.pxNodes[xEvent.ulNode];
+        
+        switch (xEvent.ulKind)
+        {
+            case FLEETSIM_EVENT_SAMPLE:
+                vSample(&xSim, pxNode);
+                break;
+            
+            case FLEETSIM_EVENT_DEADLINE:
+                /* Batch may have gone out full or urgent meanwhile */
+                if ((xEvent.ulTag == pxNode->ulBatch) && (pxNode->xEncoder.ulSamples > 0))
+                {
+                    vFrameFlush(&xSim, pxNode);
+                }
+                break;
+            
+            case FLEETSIM_EVENT_RADIO:
+                vRadioEvent(&xSim, pxNode);
+                break;
+            
+            case FLEETSIM_EVENT_ACK_START:
+                vAirStart(&xSim.pxChannels[pxNode->ulChannel], &pxNode->xAck);
+                vSchedule(&xSim, xSim.ullNow + PACKET_NS(0), xEvent.ulNode, FLEETSIM_EVENT_ACK_END, 0);
+                break;
+            
+            case FLEETSIM_EVENT_ACK_END:
+                pxNode->xAck.ulCollided = ulAirEnd(&xSim.pxChannels[pxNode->ulChannel], &pxNode->xAck);
+                
+                /* Node misses an ACK it didn't wait for, its ARD timeout retransmits */
+                if (pxNode->ulAckComing != 0)
+                {
+                    pxNode->ullRadioOn += xSim.ullNow - pxNode->ullStateStart;
+                    pxNode->ullStateStart = xSim.ullNow;
+                    pxNode->ulAckComing = 0;
+                    vAttemptOutcome(&xSim, pxNode, pxNode->xAck.ulCollided == 0);
+                }
+                break;
+            
+            default:
+                break;
+        }
+    }
+    
+    for (uint32_t i = 0; i < pxRun->ulNodes; i++)
+    {
+        ullRadioOn += xSim.pxNodes[i].ullRadioOn;
+        ullRadioOnMax = (xSim.pxNodes[i].ullRadioOn > ullRadioOnMax) ? xSim.pxNodes[i].ullRadioOn : ullRadioOnMax;
+    }
+    pxRun->dRadioOnMean = (double)ullRadioOn / pxRun->ulNodes / 1e6 * 3600.0 * NS_PER_SECOND / xSim.ullNow;
+    pxRun->dRadioOnMax = (double)ullRadioOnMax / 1e6 * 3600.0 * NS_PER_SECOND / xSim.ullNow;
+    pxRun->ulSensorP50Ms = ulPercentile(&xSim.xSensor, 50);
+    pxRun->ulSensorP99Ms = ulPercentile(&xSim.xSensor, 99);
+    pxRun->ulRadioP50Us = ulPercentile(&xSim.xRadio, 50);
+    pxRun->ulRadioP99Us = ulPercentile(&xSim.xRadio, 99);
+    
+    free(xSim.xSensor.pulValues);
+    free(xSim.xRadio.pulValues);
+    free(xSim.pxEvents);
+    free(xSim.pxChannels);
+    free(xSim.pxNodes);
+}
+
+
+/**
+ * @brief   Boot a node at a random time and schedule its first reading.
+ * 
+ *          Node n has NODE_ID n + 1, its channel and retransmit delay
+ *          follow from it like on target.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   ulIndex     Node.
+ * 
+ * @return  None
+ */
+static void vNodeInit(struct Fleetsim_Sim *const pxSim, const uint32_t ulIndex)
+{
+    struct Fleetsim_Node *const pxNode = &pxSim->pxNodes[ulIndex];
+    const uint32_t ulArd = pxSim->pxRun->ulArd + (ulIndex + 1) % ulSpread;
+    
+    pxNode->ullBoot = (uint64_t)(dRandom(pxSim) * FLEETSIM_MS(COMM_BATCH_LATENCY_MS));
+    pxNode->dRate = 1.0 + (2.0 * dRandom(pxSim) - 1.0) * FLEETSIM_DRIFT_PPM * 1e-6;
+    pxNode->dPhase = 2.0 * M_PI * dRandom(pxSim);
+    pxNode->dSoil = FLEETSIM_DRY_LEVEL + (FLEETSIM_WET_LEVEL - FLEETSIM_DRY_LEVEL) * dRandom(pxSim);
+    pxNode->dDryingRate = FLEETSIM_DRYING_RATE * (0.5 + dRandom(pxSim));
+    pxNode->ullSoilUpdated = pxNode->ullBoot;
+    pxNode->ulChannel = ulIndex % ulChannels;
+    pxNode->ulArd = (ulArd <= ARD_MAX) ? ulArd : ARD_MAX;
+    
+    FRAME_vEncoderInit(&pxNode->xEncoder, (uint8_t)(ulIndex + 1), ucFrameTags, FLEETSIM_FIELDS);
+    DECODER_vNodeInit(&pxNode->xDecoder);
+    
+    vSchedule(pxSim, pxNode->ullBoot, ulIndex, FLEETSIM_EVENT_SAMPLE, 0);
+}
+
+
+/**
+ * @brief   Add event to heap.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   ullTime     When, ns.
+ * 
+ * @param   ulNode      Node it is for.
+ * 
+ * @param   ulKind      enum Fleetsim_Events.
+ * 
+ * @param   ulTag       Kind specific.
+ * 
+ * @return  None
+ */
+static void vSchedule(struct Fleetsim_Sim *const pxSim, const uint64_t ullTime, const uint32_t ulNode, const uint32_t ulKind,
+                      const uint32_t ulTag)
+{
+    struct Fleetsim_Event *const pxEvents = pxSim->pxEvents;
+    const struct Fleetsim_Event xEvent = { ullTime, pxSim->ullOrder++, ulNode, ulKind, ulTag };
+    uint32_t ulChild;
+    uint32_t ulParent;
+    
+    if (pxSim->ulEvents == pxSim->ulEventSlots)
+    {
+        pxSim->ulEventSlots = (pxSim->ulEventSlots != 0) ? pxSim->ulEventSlots * 2 : 1024;
+        pxSim->pxEvents = realloc(pxEvents, pxSim->ulEventSlots * sizeof(struct Fleetsim_Event));
+        if (pxSim->pxEvents == NULL)
+        {
+            fprintf(stderr, "fleetsim: out of memory\n");
+            exit(1);
+        }
+    }
+    
+    /* Sift up */
+    for (ulChild = pxSim->ulEvents++; ulChild > 0; ulChild = ulParent)
+    {
+        ulParent = (ulChild - 1) / 2;
+        if ((pxSim->pxEvents[ulParent].ullTime < ullTime)
+            || ((pxSim->pxEvents[ulParent].ullTime == ullTime) && (pxSim->pxEvents[ulParent].ullOrder < xEvent.ullOrder)))
+        {
+            break;
+        }
+        pxSim->pxEvents[ulChild] = pxSim->pxEvents[ulParent];
+    }
+    pxSim->pxEvents[ulChild] = xEvent;
+}
+
+
+/**
+ * @brief   Take earliest event from heap.
+ * 
+ * @param   pxSim       Simulation with events.
+ * 
+ * @param   pxEvent     Earliest event.
+ * 
+ * @return  None
+ */
+static void vPop(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Event *const pxEvent)
+{
+    struct Fleetsim_Event *const pxEvents = pxSim->pxEvents;
+    const struct Fleetsim_Event xLast = pxEvents[--pxSim->ulEvents];
+    uint32_t ulParent = 0;
+    uint32_t ulChild;
+    
+    *pxEvent = pxEvents[0];
+    
+    /* Sift down */
+    while ((ulChild = 2 * ulParent + 1) < pxSim->ulEvents)
+    {
+        if ((ulChild + 1 < pxSim->ulEvents)
+            && ((pxEvents[ulChild + 1].ullTime < pxEvents[ulChild].ullTime)
+                || ((pxEvents[ulChild + 1].ullTime == pxEvents[ulChild].ullTime) && (pxEvents[ulChild + 1].ullOrder < pxEvents[ulChild].ullOrder))))
+        {
+            ulChild++;
+        }
+        if ((xLast.ullTime < pxEvents[ulChild].ullTime)
+            || ((xLast.ullTime == pxEvents[ulChild].ullTime) && (xLast.ullOrder < pxEvents[ulChild].ullOrder)))
+        {
+            break;
+        }
+        pxEvents[ulParent] = pxEvents[ulChild];
+        ulParent = ulChild;
+    }
+    pxEvents[ulParent] = xLast;
+}
+
+
+/**
+ * @brief   Take a reading and pass it to the frame task, which batches
+ *          it like vFrameTask().
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node due for a reading.
+ * 
+ * @return  None
+ */
+static void vSample(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode)
+{
+    const uint32_t ulIndex = (uint32_t)(pxNode - pxSim->pxNodes);
+    const uint32_t ulPumping = pxNode->ulPumping;
+    int32_t lValues[FLEETSIM_FIELDS];
+    uint64_t ullNext;
+    
+    vReadSensors(pxSim, pxNode, lValues);
+    if (pxSim->ullNow < pxSim->ullCountEnd)
+    {
+        pxSim->pxRun->ulSamples++;
+    }
+    
+    /* Full frame is sent and reading starts the next one */
+    if (ulFrameAppend(pxNode, pxNode->ulSeconds, lValues) == 0)
+    {
+        vFrameFlush(pxSim, pxNode);
+        (void)ulFrameAppend(pxNode, pxNode->ulSeconds, lValues);
+    }
+    
+    if (pxNode->xEncoder.ulSamples == 1)
+    {
+        pxNode->ulBatch++;
+        vSchedule(pxSim, ullGlobalTime(pxNode, pxNode->ulSeconds) + FLEETSIM_MS(COMM_BATCH_LATENCY_MS), ulIndex,
+                  FLEETSIM_EVENT_DEADLINE, pxNode->ulBatch);
+    }
+    
+    /* Pump start is reported right away */
+    if ((ulPumping == 0) && (pxNode->ulPumping != 0))
+    {
+        vFrameFlush(pxSim, pxNode);
+    }
+    
+    pxNode->ulSeconds += ulPeriod;
+    ullNext = ullGlobalTime(pxNode, pxNode->ulSeconds);
+    if (ullNext < pxSim->ullSampleEnd)
+    {
+        vSchedule(pxSim, ullNext, ulIndex, FLEETSIM_EVENT_SAMPLE, 0);
+    }
+}
+
+
+/**
+ * @brief   Read sensor trace of a node now, and start or stop its pump.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node.
+ * 
+ * @param   plValues    Temperature, humidity and soil moisture.
+ * 
+ * @return  None
+ */
+static void vReadSensors(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode, int32_t *const plValues)
+{
+    const double dSeconds = (double)pxSim->ullNow / NS_PER_SECOND;
+    const double dElapsed = (double)(pxSim->ullNow - pxNode->ullSoilUpdated) / NS_PER_SECOND;
+    const double dAngle = 2.0 * M_PI * dSeconds / FLEETSIM_SWING_PERIOD + pxNode->dPhase;
+    
+    pxNode->dSoil += (pxNode->ulPumping != 0) ? FLEETSIM_WATERING_RATE * dElapsed : -pxNode->dDryingRate * dElapsed;
+    pxNode->dSoil = fmin(fmax(pxNode->dSoil, 0.0), 100.0);
+    pxNode->ullSoilUpdated = pxSim->ullNow;
+    
+    if ((pxNode->ulPumping == 0) && (pxNode->dSoil < FLEETSIM_DRY_LEVEL))
+    {
+        pxNode->ulPumping = 1;
+    }
+    else if ((pxNode->ulPumping != 0) && (pxNode->dSoil > FLEETSIM_WET_LEVEL))
+    {
+        pxNode->ulPumping = 0;
+    }
+    
+    plValues[0] = (int32_t)lround(22.0 + 3.0 * sin(dAngle));
+    plValues[1] = (int32_t)lround(55.0 + 10.0 * cos(dAngle));
+    plValues[2] = (int32_t)lround(pxNode->dSoil);
+}
+
+
+/**
+ * @brief   Append reading to frame and keep it for vFrameFlush().
+ * 
+ * @param   pxNode      Node.
+ * 
+ * @param   ulSeconds   Uptime of reading.
+ * 
+ * @param   plValues    Reading.
+ * 
+ * @return  1 if appended, 0 if frame is full.
+ */
+static uint32_t ulFrameAppend(struct Fleetsim_Node *const pxNode, const uint32_t ulSeconds, const int32_t *const plValues)
+{
+    const uint32_t ulIndex = pxNode->xEncoder.ulSamples;
+    
+    if (FRAME_ulEncoderAppend(&pxNode->xEncoder, ulSeconds, plValues) == 0)
+    {
+        return 0;
+    }
+    
+    pxNode->ulFrameSeconds[ulIndex] = ulSeconds;
+    memcpy(pxNode->lFrameValues[ulIndex], plValues, sizeof(pxNode->lFrameValues[ulIndex]));
+    
+    return 1;
+}
+
+
+/**
+ * @brief   Send frame, rebuilding a delta frame as key frame after a
+ *          dropped one like vFrameFlush() of comm.c.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node with started frame.
+ * 
+ * @return  None
+ */
+static void vFrameFlush(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode)
+{
+    const uint32_t ulSamples = pxNode->xEncoder.ulSamples;
+    
+    if ((pxNode->ulDropped != 0) && ((pxNode->xEncoder.ucFrame[0] & 0x0F) == FRAME_TYPE_DELTA))
+    {
+        FRAME_vEncoderDiscard(&pxNode->xEncoder);
+        
+        for (uint32_t i = 0; i < ulSamples; i++)
+        {
+            if (ulFrameAppend(pxNode, pxNode->ulFrameSeconds[i], pxNode->lFrameValues[i]) == 0)
+            {
+                vFrameSend(pxSim, pxNode);
+                (void)ulFrameAppend(pxNode, pxNode->ulFrameSeconds[i], pxNode->lFrameValues[i]);
+            }
+        }
+    }
+    pxNode->ulDropped = 0;
+    
+    vFrameSend(pxSim, pxNode);
+}
+
+
+/**
+ * @brief   Finish frame and queue it for the comm task, or drop it when
+ *          every message block is taken.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node with started frame.
+ * 
+ * @return  None
+ */
+static void vFrameSend(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode)
+{
+    struct Fleetsim_Message *pxMessage;
+    const uint32_t ulLength = FRAME_ulEncoderFinish(&pxNode->xEncoder);
+    
+    if (pxNode->ulCount == MESSAGE_POOL_BLOCKS)
+    {
+        pxSim->pxRun->ulPoolDrops++;
+        FRAME_vEncoderResync(&pxNode->xEncoder);
+        return;
+    }
+    
+    pxMessage = &pxNode->xQueue[(pxNode->ulHead + pxNode->ulCount++) % MESSAGE_POOL_BLOCKS];
+    memcpy(pxMessage->ucFrame, pxNode->xEncoder.ucFrame, ulLength);
+    pxMessage->ulLength = ulLength;
+    pxMessage->ulRequeues = 0;
+    pxMessage->ullQueued = pxSim->ullNow;
+    pxSim->pxRun->ulFrames++;
+    
+    if (pxNode->ulState == FLEETSIM_IDLE)
+    {
+        vNextMessage(pxSim, pxNode);
+    }
+}
+
+
+/**
+ * @brief   Step node nRF24L01+ and comm task, mirrors vRadioEvent() of
+ *          vradio.c.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node whose state timed out.
+ * 
+ * @return  None
+ */
+static void vRadioEvent(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode)
+{
+    const uint32_t ulIndex = (uint32_t)(pxNode - pxSim->pxNodes);
+    struct Fleetsim_Channel *const pxChannel = &pxSim->pxChannels[pxNode->ulChannel];
+    const uint64_t ullElapsed = pxSim->ullNow - pxNode->ullStateStart;
+    const struct Fleetsim_Message *const pxMessage = &pxNode->xQueue[pxNode->ulHead];
+    
+    pxNode->ullStateStart = pxSim->ullNow;
+    
+    switch (pxNode->ulState)
+    {
+        case FLEETSIM_LOADING:
+            /* New payload gets next PID */
+            pxNode->ucPid = (uint8_t)((pxNode->ucPid + 1) & 0x03);
+            pxNode->ulArcCount = 0;
+            pxNode->ulRetries = 0;
+            vStartAttempt(pxSim, pxNode);
+            break;
+        
+        case FLEETSIM_SETTLING:
+            pxNode->ullRadioOn += ullElapsed;
+            pxNode->ulAirDeaf = (pxSim->ullNow < pxChannel->ullDeafUntil) ? 1 : 0;
+            vAirStart(pxChannel, &pxNode->xPacket);
+            pxSim->pxRun->ulPackets++;
+            pxNode->ulState = FLEETSIM_ON_AIR;
+            vSchedule(pxSim, pxSim->ullNow + PACKET_NS(pxMessage->ulLength), ulIndex, FLEETSIM_EVENT_RADIO, 0);
+            break;
+        
+        case FLEETSIM_ON_AIR:
+            pxNode->ullRadioOn += ullElapsed;
+            pxNode->ulState = FLEETSIM_WAITING_ACK;
+            pxNode->ulAckComing = 0;
+            
+            if (ulAirEnd(pxChannel, &pxNode->xPacket) != 0)
+            {
+                pxSim->pxRun->ulCollided++;
+            }
+            else if (pxNode->ulAirDeaf == 0)
+            {
+                vGatewayReceive(pxSim, pxNode);
+                
+                /* Gateway turns around and acks, ACK must be in before ARD or the node misses it */
+                pxChannel->ullDeafUntil = pxSim->ullNow + ACK_NS;
+                pxNode->xAck.ulCollided = 0;
+                vSchedule(pxSim, pxSim->ullNow + SETTLE_NS, ulIndex, FLEETSIM_EVENT_ACK_START, 0);
+                pxNode->ulAckComing = (ACK_NS <= ARD_NS(pxNode->ulArd)) ? 1 : 0;
+            }
+            
+            if (pxNode->ulAckComing == 0)
+            {
+                vSchedule(pxSim, pxSim->ullNow + ARD_NS(pxNode->ulArd), ulIndex, FLEETSIM_EVENT_RADIO, 0);
+            }
+            break;
+        
+        case FLEETSIM_WAITING_ACK:
+            pxNode->ullRadioOn += ullElapsed;
+            vAttemptOutcome(pxSim, pxNode, 0);
+            break;
+        
+        case FLEETSIM_BACKOFF:
+            vNextMessage(pxSim, pxNode);
+            break;
+        
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief   Settle TX PLL for a transmission of the frame at queue head.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node.
+ * 
+ * @return  None
+ */
+static void vStartAttempt(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode)
+{
+    pxNode->ulState = FLEETSIM_SETTLING;
+    pxNode->ullStateStart = pxSim->ullNow;
+    vSchedule(pxSim, pxSim->ullNow + SETTLE_NS, (uint32_t)(pxNode - pxSim->pxNodes), FLEETSIM_EVENT_RADIO, 0);
+}
+
+
+/**
+ * @brief   Retransmit after ARD while ARC allows, then apply the
+ *          ulTransmit() and ulTxOutcome() policy of comm.c.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node waiting for ACK.
+ * 
+ * @param   ulAcked     Nonzero if ACK was received.
+ * 
+ * @return  None
+ */
+static void vAttemptOutcome(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode, const uint32_t ulAcked)
+{
+    struct Fleetsim_Message *const pxMessage = &pxNode->xQueue[pxNode->ulHead];
+    
+    if (ulAcked != 0)
+    {
+        pxSim->pxRun->ulAcked++;
+        vAddLatency(&pxSim->xRadio, (uint32_t)((pxSim->ullNow - pxMessage->ullQueued) / 1000ULL));
+    }
+    else if (pxNode->ulArcCount < pxSim->pxRun->ulArc)
+    {
+        pxNode->ulArcCount++;
+        vStartAttempt(pxSim, pxNode);
+        return;
+    }
+    else if (pxNode->ulRetries < COMM_TX_RETRIES)
+    {
+        /* MAX_RT keeps payload in TX FIFO, comm task pulses CE again */
+        pxNode->ulRetries++;
+        pxNode->ulArcCount = 0;
+        vStartAttempt(pxSim, pxNode);
+        return;
+    }
+    else if (pxMessage->ulRequeues < COMM_TX_REQUEUES)
+    {
+        /* Front of queue keeps frame order */
+        pxMessage->ulRequeues++;
+        pxSim->pxRun->ulRequeues++;
+        pxNode->ulState = FLEETSIM_BACKOFF;
+        vSchedule(pxSim, pxSim->ullNow + FLEETSIM_MS(COMM_TX_BACKOFF_MS), (uint32_t)(pxNode - pxSim->pxNodes),
+                  FLEETSIM_EVENT_RADIO, 0);
+        return;
+    }
+    else
+    {
+        pxSim->pxRun->ulTxDrops++;
+        pxNode->ulDropped = 1;
+    }
+    
+    pxNode->ulHead = (pxNode->ulHead + 1) % MESSAGE_POOL_BLOCKS;
+    pxNode->ulCount--;
+    vNextMessage(pxSim, pxNode);
+}
+
+
+/**
+ * @brief   Comm task takes the frame at queue head, or waits for one.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node.
+ * 
+ * @return  None
+ */
+static void vNextMessage(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode)
+{
+    if (pxNode->ulCount == 0)
+    {
+        pxNode->ulState = FLEETSIM_IDLE;
+        return;
+    }
+    
+    pxNode->ulState = FLEETSIM_LOADING;
+    vSchedule(pxSim, pxSim->ullNow + FLEETSIM_LOAD_NS, (uint32_t)(pxNode - pxSim->pxNodes), FLEETSIM_EVENT_RADIO, 0);
+}
+
+
+/**
+ * @brief   Put packet on air. It collides with packets already on air.
+ * 
+ * @param   pxChannel   Channel.
+ * 
+ * @param   pxAir       Packet.
+ * 
+ * @return  None
+ */
+static void vAirStart(struct Fleetsim_Channel *const pxChannel, struct Fleetsim_Air *const pxAir)
+{
+    pxAir->ulCollided = (pxChannel->ulActive > 0) ? 1 : 0;
+    pxChannel->ulActive++;
+    pxChannel->ulStarts++;
+    pxAir->ulStarts = pxChannel->ulStarts;
+}
+
+
+/**
+ * @brief   Take packet off air. It collided with packets started since.
+ * 
+ * @param   pxChannel   Channel.
+ * 
+ * @param   pxAir       Packet.
+ * 
+ * @return  Nonzero if packet collided.
+ */
+static uint32_t ulAirEnd(struct Fleetsim_Channel *const pxChannel, const struct Fleetsim_Air *const pxAir)
+{
+    pxChannel->ulActive--;
+    
+    return (pxAir->ulCollided != 0) || (pxChannel->ulStarts != pxAir->ulStarts);
+}
+
+
+/**
+ * @brief   Gateway got the frame at queue head of a node. Retransmits
+ *          of the payload it already has are acked but not decoded.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @param   pxNode      Node that sent it.
+ * 
+ * @return  None
+ */
+static void vGatewayReceive(struct Fleetsim_Sim *const pxSim, struct Fleetsim_Node *const pxNode)
+{
+    const struct Fleetsim_Message *const pxMessage = &pxNode->xQueue[pxNode->ulHead];
+    const uint16_t usCrc = (uint16_t)(pxMessage->ucFrame[pxMessage->ulLength - 2] | (pxMessage->ucFrame[pxMessage->ulLength - 1] << 8));
+    struct Fleetsim_Output xOutput = { pxSim, pxNode };
+    int32_t lStatus;
+    
+    if ((pxNode->ulHeard != 0) && (pxNode->ucLastPid == pxNode->ucPid) && (pxNode->usLastCrc == usCrc))
+    {
+        pxSim->pxRun->ulDuplicates++;
+        return;
+    }
+    pxNode->ulHeard = 1;
+    pxNode->ucLastPid = pxNode->ucPid;
+    pxNode->usLastCrc = usCrc;
+    
+    lStatus = DECODER_lPush(&pxNode->xDecoder, pxMessage->ucFrame, pxMessage->ulLength, vGatewayOutput, &xOutput);
+    if ((lStatus < 0) && (lStatus != DECODER_STALE))
+    {
+        pxSim->pxRun->ulErrors++;
+    }
+}
+
+
+/**
+ * @brief   Count decoded readings and their latency.
+ * 
+ * @param   pxFrame     Decoded frame.
+ * 
+ * @param   pvContext   struct Fleetsim_Output.
+ * 
+ * @return  None
+ */
+static void vGatewayOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext)
+{
+    const struct Fleetsim_Output *const pxOutput = pvContext;
+    struct Fleetsim_Sim *const pxSim = pxOutput->pxSim;
+    const struct Fleetsim_Node *const pxNode = pxOutput->pxNode;
+    const uint32_t ulUptime = (uint32_t)((double)(pxSim->ullNow - pxNode->ullBoot) * pxNode->dRate / NS_PER_SECOND);
+    uint32_t ulSeconds;
+    uint64_t ullTaken;
+    
+    if (pxFrame->ulType == FRAME_TYPE_SCHEDULE)
+    {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < pxFrame->ulSampleCount; i++)
+    {
+        /* Timestamp is uptime modulo 65536 */
+        ulSeconds = ulUptime - ((ulUptime - pxFrame->xSamples[i].ulTimestamp) & 0xFFFFUL);
+        ullTaken = ullGlobalTime(pxNode, ulSeconds);
+        if (ullTaken < pxSim->ullCountEnd)
+        {
+            vAddLatency(&pxSim->xSensor, (uint32_t)((pxSim->ullNow - ullTaken) / 1000000ULL));
+            pxSim->pxRun->ulDecoded++;
+        }
+    }
+}
+
+
+/**
+ * @brief   Simulation time of a node uptime.
+ * 
+ * @param   pxNode          Node.
+ * 
+ * @param   ulLocalSeconds  Uptime.
+ * 
+ * @return  ns
+ */
+static uint64_t ullGlobalTime(const struct Fleetsim_Node *const pxNode, const uint32_t ulLocalSeconds)
+{
+    return pxNode->ullBoot + (uint64_t)llround((double)ulLocalSeconds * NS_PER_SECOND / pxNode->dRate);
+}
+
+
+/**
+ * @brief   Add value to latency list.
+ * 
+ * @param   pxList      List.
+ * 
+ * @param   ulValue     Latency.
+ * 
+ * @return  None
+ */
+static void vAddLatency(struct Fleetsim_Latencies *const pxList, const uint32_t ulValue)
+{
+    if (pxList->ulCount == pxList->ulSlots)
+    {
+        pxList->ulSlots = (pxList->ulSlots != 0) ? pxList->ulSlots * 2 : 4096;
+        pxList->pulValues = realloc(pxList->pulValues, pxList->ulSlots * sizeof(uint32_t));
+        if (pxList->pulValues == NULL)
+        {
+            fprintf(stderr, "fleetsim: out of memory\n");
+            exit(1);
+        }
+    }
+    
+    pxList->pulValues[pxList->ulCount++] = ulValue;
+}
+
+
+/**
+ * @brief   Percentile of latency list, sorts it.
+ * 
+ * @param   pxList      List.
+ * 
+ * @param   ulPercent   0...100.
+ * 
+ * @return  Latency, 0 for an empty list.
+ */
+static uint32_t ulPercentile(struct Fleetsim_Latencies *const pxList, const uint32_t ulPercent)
+{
+    if (pxList->ulCount == 0)
+    {
+        return 0;
+    }
+    
+    qsort(pxList->pulValues, pxList->ulCount, sizeof(uint32_t), lCompare);
+    
+    return pxList->pulValues[(uint32_t)(((uint64_t)pxList->ulCount - 1) * ulPercent / 100)];
+}
+
+
+/**
+ * @brief   qsort() order of latencies.
+ * 
+ * @param   pvA         Latency.
+ * 
+ * @param   pvB         Latency.
+ * 
+ * @return  Negative, 0 or positive like strcmp().
+ */
+static int lCompare(const void *pvA, const void *pvB)
+{
+    const uint32_t ulA = *(const uint32_t *)pvA;
+    const uint32_t ulB = *(const uint32_t *)pvB;
+    
+    return (ulA > ulB) - (ulA < ulB);
+}
+
+
+/**
+ * @brief   Draw uniform random number.
+ * 
+ * @param   pxSim       Simulation.
+ * 
+ * @return  0...1, 1 excluded.
+ */
+static double dRandom(struct Fleetsim_Sim *const pxSim)
+{
+    /* xorshift32 */
+    pxSim->ulRandom ^= pxSim->ulRandom << 13;
+    pxSim->ulRandom ^= pxSim->ulRandom >> 17;
+    pxSim->ulRandom ^= pxSim->ulRandom << 5;
+    
+    return (double)(pxSim->ulRandom >> 8) / 16777216.0;
+}
+
+
+/**
+ * @brief   Print result of a check.
+ * 
+ * @param   pcName      What was checked.
+ * 
+ * @param   ulPassed    Nonzero if it held.
+ * 
+ * @return  0 if passed, else 1.
+ */
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed)
+{
+    printf("%-44s %s\n", pcName, ulPassed ? "ok" : "FAILED");
+    
+    return ulPassed ? 0 : 1;
+}
@@ -0,0 +1,2088 @@
+/**
+ * peripherals.c
+ * This file holds the register blocks of the host build and models
+ * GPIO with port interrupts, TPM counters and input capture, PIT
+ * timers, LPTMR0, ADC0, CMP0, SPI1, DMA0 with DMAMUX0 and the FTFA
+ * flash controller.
+ * 
+ * Flag registers cleared by writing ones keep a marker bit set that
+ * software writes clear, so the models can tell a write from their own
+ * value. Counters are written back on every sync, a different value
+ * found there was written by software.
+ * 
+ * SPI1 is a master with one byte TX buffer and a shifter, bytes go back
+ * to back at the BR baud rate and the slave connected with
+ * SOC_vConnectSpi() answers each one when it is clocked out. Only DMA
+ * reads of D clear SPRF, software reads can't be seen. DMA channels move
+ * one item per cycle-steal request a few cycles after it is raised,
+ * with channel linking and D_REQ, but not SMOD/DMOD or differing source
+ * and destination sizes.
+ * 
+ * ADC0 converts the input connected with SOC_vConnectAnalog() in the
+ * conversion time of its configuration, with hardware average, compare
+ * and the PIT and LPTMR0 alternate triggers. It is ideal, PG, MG and OFS
+ * aren't applied and calibration always passes. Like SPI1 D, only DMA
+ * reads of R clear COCO. CMP0 compares the RC node on PTE29 with its
+ * DAC: the node follows the pin at once while it is a GPIO output and
+ * discharges as SOC_vConnectRc() tells while it floats. Hysteresis and
+ * filter aren't modelled. TPM channels capture edges of model driven
+ * pins. FTFA erases and programs the sectors of _shumidity and
+ * _scalibration in typical command times.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MKL25Z4.h"
+
+
+/* Local defines */
+#define PINS                            (32UL)
+#define ISFR_MARKER                     (1ULL << 32)
+#define FLAG_MARKER                     (1UL << 31)     /* TPM STATUS, PIT TFLG, LPTMR0 CSR, ADC0 SC1A */
+
+/* PORT_PCR_IRQC values */
+#define IRQC_LOGIC_ZERO                 (8UL)
+#define IRQC_RISING_EDGE                (9UL)
+#define IRQC_FALLING_EDGE               (10UL)
+#define IRQC_EITHER_EDGE                (11UL)
+#define IRQC_LOGIC_ONE                  (12UL)
+
+#define PCR_MUX(pcr)                    (((pcr) & PORT_PCR_MUX_MASK) >> PORT_PCR_MUX_SHIFT)
+#define MUX_GPIO                        (1UL)
+
+#define TPM_COUNT                       (3UL)
+#define TPM_CHANNELS                    (6UL)
+#define TPM_INPUT_CLOCK_HZ              (48000000ULL)   /* MCGPLLCLK / 2 */
+#define PIT_CHANNELS                    (2UL)
+#define LPTMR_CLOCK_LPO                 (1UL)           /* PSR PCS */
+#define LPTMR_LPO_CYCLES                (SOC_BUS_CLOCK_HZ / 1000ULL)
+
+#define ADC_CH_DISABLED                 (31UL)
+#define ADC_FIRST_ADCK                  (3ULL)          /* Single conversion adder, ADCK and bus cycles */
+#define ADC_FIRST_BUS                   (5ULL)
+#define ADC_HSC_ADCK                    (2UL)
+#define ADC_CALIBRATION_CONVERSIONS     (8ULL)          /* Calibration time in conversions */
+#define ADC_INPUT_MAX                   (0xFFFFUL)
+
+/* SIM_SOPT7_ADC0TRGSEL values */
+#define ADC_TRIGGER_PIT0                (4UL)
+#define ADC_TRIGGER_LPTMR0              (14UL)
+
+#define CMP_PLUS_RC                     (5UL)           /* MUXCR PSEL of PTE29 */
+#define CMP_MINUS_DAC                   (7UL)           /* MUXCR MSEL */
+#define CMP_DAC_STEPS                   (64.0)
+#define CMP_OUT_PIN                     (0UL)           /* PTE0 */
+#define CMP_OUT_MUX                     (5UL)
+#define RC_PIN                          (29UL)          /* PTE29 */
+
+#define FLASH_SECTOR_WORDS              (256UL)         /* 1 KB */
+#define FLASH_ADDRESS_MASK              (0x00FFFFFFUL)  /* FCCOB1...3 */
+#define FLASH_ERASE_CYCLES              (SOC_MS(14))
+#define FLASH_PROGRAM_CYCLES            (SOC_US(65))
+#define FLASH_CMD_PROGRAM_LONGWORD      (0x06UL)
+#define FLASH_CMD_ERASE_SECTOR          (0x09UL)
+#define FSTAT_MARKER                    (0x02UL)        /* Reserved bit */
+#define FSTAT_ERRORS                    (FTFA_FSTAT_RDCOLERR_MASK | FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK)
+
+#define SPI_D_MARKER                    (0x5A00UL)      /* Upper byte, char writes leave 0x00 or 0xFF */
+#define SPI_D_MARKER_MASK               (0xFF00UL)
+#define SPI_BITS                        (8ULL)
+
+#define DMA_CHANNELS                    (4UL)
+#define DMA_TRANSFER_CYCLES             (3ULL)          /* Arbitration, read and write */
+#define DMA_DSR_ERRORS                  (DMA_DSR_BCR_CE_MASK | DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK)
+
+/* DMAMUX0 request sources */
+#define DMAMUX_SOURCE_SPI1_RX           (18UL)
+#define DMAMUX_SOURCE_SPI1_TX           (19UL)
+#define DMAMUX_SOURCE_TPM0_CH0          (24UL)          /* ...29 for CH5 */
+#define DMAMUX_SOURCE_TPM1_CH0          (32UL)          /* 33 for CH1 */
+#define DMAMUX_SOURCE_TPM2_CH0          (34UL)          /* 35 for CH1 */
+#define DMAMUX_SOURCE_ADC0              (40UL)
+
+/* DMA_DCR_LINKCC values */
+#define LINKCC_BOTH                     (1UL)           /* LCH1 after each cycle-steal, LCH2 when BCR is zero */
+#define LINKCC_CYCLE_STEAL              (2UL)           /* LCH1 after each cycle-steal */
+#define LINKCC_BCR_ZERO                 (3UL)           /* LCH1 when BCR is zero */
+
+
+/* Global variables */
+SOC_PERIPHERAL ADC_Type xSocAdc0;
+SOC_PERIPHERAL CMP_Type xSocCmp0;
+SOC_PERIPHERAL DMA_Type xSocDma0;
+SOC_PERIPHERAL DMAMUX_Type xSocDmamux0;
+SOC_PERIPHERAL FGPIO_Type xSocGpio[SOC_PORT_COUNT];
+SOC_PERIPHERAL PORT_Type xSocPort[SOC_PORT_COUNT];
+SOC_PERIPHERAL SIM_Type xSocSim;
+SOC_PERIPHERAL SPI_Type xSocSpi1;
+SOC_PERIPHERAL TPM_Type xSocTpm[TPM_COUNT];
+SOC_PERIPHERAL PIT_Type xSocPit;
+SOC_PERIPHERAL LPTMR_Type xSocLptmr0;
+SOC_PERIPHERAL FTFA_Type xSocFtfa;
+
+struct SOC_SpiStats xSocSpiStats;
+struct SOC_AnalogStats xSocAnalogStats;
+struct SOC_FlashStats xSocFlashStats;
+
+/**
+ * Calibration sectors the linker script reserves on target, erased. DMA
+ * window puts them below 0x20000000, so FCCOB addresses, the low 24 bits
+ * of the firmware's, find them again.
+ */
+uint32_t _shumidity[FLASH_SECTOR_WORDS] __attribute__((aligned(1024))) = { [0 ... FLASH_SECTOR_WORDS - 1] = 0xFFFFFFFFUL };
+uint32_t _scalibration[FLASH_SECTOR_WORDS] __attribute__((aligned(1024))) = { [0 ... FLASH_SECTOR_WORDS - 1] = 0xFFFFFFFFUL };
+
+
+/* Local variables */
+struct Pin_Watch
+{
+    SOC_PinHandler pxHandler;
+    void *pvContext;
+};
+
+struct Tpm_State
+{
+    uint64_t ullStart;                  /* Cycle when counter had ulStartCount */
+    uint32_t ulStartCount;
+    uint32_t ulShownCount;              /* CNT written by model */
+    uint32_t ulShownStatus;
+    uint32_t ulClock;                   /* SC CMOD and PS counter runs with, 0 when stopped */
+    uint32_t ulShownControl[TPM_CHANNELS];  /* CnSC written by model */
+    struct SOC_Event xOverflow;
+};
+
+/* Channel input of a pin */
+struct Tpm_Pin
+{
+    uint8_t ucPort;
+    uint8_t ucPin;
+    uint8_t ucMux;
+    uint8_t ucTpm;
+    uint8_t ucChannel;
+};
+
+struct Pit_Channel
+{
+    uint64_t ullStart;                  /* Cycle of latest load */
+    uint32_t ulLoad;
+    uint32_t ulEnabled;
+    struct SOC_Event xExpiry;
+};
+
+struct Lptmr_State
+{
+    uint32_t ulEnabled;
+    uint32_t ulFlag;                    /* TCF */
+    uint64_t ullStart;                  /* Cycle counter was last reset */
+    uint64_t ullTick;                   /* Bus clock cycles per counter tick */
+    struct SOC_Event xCompare;
+};
+
+struct Adc_State
+{
+    uint32_t ulBusy;                    /* Conversion or calibration running */
+    uint32_t ulCalibrating;
+    uint32_t ulChannel;                 /* Latched at start */
+    uint32_t ulSamples;
+    uint32_t ulMode;                    /* CFG1 MODE */
+    uint32_t ulRequest;                 /* DMA request of latest conversion */
+    SOC_AnalogInput pxInput;
+    struct SOC_Event xDone;
+};
+
+struct Cmp_State
+{
+    uint32_t ulDriven;                  /* Node follows pin */
+    double dStart;                      /* Node level when it started to float, fraction of VDD */
+    uint64_t ullStart;
+    double dThreshold;                  /* Minus input the crossing is for */
+    uint64_t ullCrossing;               /* Cycle floating node falls below dThreshold */
+    uint32_t ulOutput;                  /* COUT */
+    uint32_t ulPin;                     /* Level driven to PTE0 */
+    SOC_RcNode pxNode;
+    struct SOC_Event xCrossing;
+};
+
+struct Flash_State
+{
+    uint32_t ulShownStatus;             /* FSTAT written by model */
+    uint32_t ulCommand;                 /* FCCOB0 of running command */
+    uint32_t *pulWord;                  /* Target of running command */
+    uint32_t ulData;
+    struct SOC_Event xDone;
+};
+
+struct Spi_State
+{
+    uint32_t ulTxFull;                  /* Byte waiting in TX buffer */
+    uint8_t ucTx;
+    uint32_t ulShifting;
+    uint8_t ucShift;
+    uint8_t ucRx;                       /* Shown in D */
+    SOC_SpiDevice pxDevice;
+    struct SOC_Event xShift;
+};
+
+struct Dma_Channel
+{
+    uint32_t ulShownStatus;             /* DSR_BCR written by model */
+    uint32_t ulStart;                   /* START or link pending */
+    struct SOC_Event xTransfer;
+};
+
+static struct Pin_Watch xWatches[SOC_PORT_COUNT][PINS][SOC_PIN_WATCHES];
+static uint32_t ulInputs[SOC_PORT_COUNT];   /* Levels driven by models */
+static uint32_t ulLevels[SOC_PORT_COUNT];   /* Pin levels seen last */
+static uint32_t ulFlags[SOC_PORT_COUNT];    /* ISFR */
+static const int32_t lPortIrqs[SOC_PORT_COUNT] = { PORTA_IRQn, -1, -1, PORTD_IRQn, -1 };
+
+static struct Tpm_State xTpmStates[TPM_COUNT];
+static const int32_t lTpmIrqs[TPM_COUNT] = { TPM0_IRQn, TPM1_IRQn, TPM2_IRQn };
+
+static const struct Tpm_Pin xTpmPins[] =
+{
+    { SOC_PORT_A, 12, 3, 1, 0 },
+    { SOC_PORT_A, 13, 3, 1, 1 },
+    { SOC_PORT_B, 0, 3, 1, 0 },
+    { SOC_PORT_B, 1, 3, 1, 1 },
+    { SOC_PORT_B, 2, 3, 2, 0 },
+    { SOC_PORT_B, 3, 3, 2, 1 },
+    { SOC_PORT_D, 0, 4, 0, 0 },
+    { SOC_PORT_D, 1, 4, 0, 1 },
+    { SOC_PORT_D, 2, 4, 0, 2 },
+    { SOC_PORT_D, 3, 4, 0, 3 },
+    { SOC_PORT_D, 4, 4, 0, 4 },
+    { SOC_PORT_D, 5, 4, 0, 5 },
+};
+
+static struct Pit_Channel xPitChannels[PIT_CHANNELS];
+
+static struct Lptmr_State xLptmrState;
+
+static struct Adc_State xAdcState;
+
+/* Typical results, CLxD, CLxS and CLx4...CLx0 for both sides */
+static const uint32_t ulAdcCalibration[7] = { 0x0A, 0x20, 0x200, 0x100, 0x80, 0x40, 0x20 };
+
+static struct Cmp_State xCmpState;
+
+static struct Flash_State xFlashState;
+static uint32_t *const pulFlashSectors[] = { _shumidity, _scalibration };
+
+static struct Spi_State xSpiState;
+
+static struct Dma_Channel xDmaChannels[DMA_CHANNELS];
+
+static void vGpioSync(void);
+static void vTpmSync(void);
+static void vPitSync(void);
+static void vLptmrSync(void);
+static void vAdcSync(void);
+static void vCmpSync(void);
+static void vSpiSync(void);
+static void vFlashSync(void);
+static void vDmaSync(void);
+
+static struct SOC_Model xGpioModel = { "GPIO", vGpioSync, NULL };
+static struct SOC_Model xTpmModel = { "TPM", vTpmSync, NULL };
+static struct SOC_Model xPitModel = { "PIT", vPitSync, NULL };
+static struct SOC_Model xLptmrModel = { "LPTMR0", vLptmrSync, NULL };
+static struct SOC_Model xAdcModel = { "ADC0", vAdcSync, NULL };
+static struct SOC_Model xCmpModel = { "CMP0", vCmpSync, NULL };
+static struct SOC_Model xSpiModel = { "SPI1", vSpiSync, NULL };
+static struct SOC_Model xFlashModel = { "FTFA", vFlashSync, NULL };
+static struct SOC_Model xDmaModel = { "DMA0", vDmaSync, NULL };
+
+
+/* Local function prototypes */
+static uint32_t ulPinIrqc(const uint32_t ulPort, const uint32_t ulPin);
+static void vLevelFlags(const uint32_t ulPort);
+static void vPinChanged(const uint32_t ulPort, const uint32_t ulPin, const uint32_t ulLevel);
+static uint32_t ulTpmCount(const uint32_t ulTpm);
+static void vTpmOverflow(struct SOC_Event *const pxEvent);
+static void vTpmSchedule(const uint32_t ulTpm);
+static void vTpmCapture(const uint32_t ulTpm, const uint32_t ulChannel, const uint32_t ulLevel);
+static uint32_t ulTpmRequest(const uint32_t ulTpm, const uint32_t ulChannel);
+static void vTpmClearFlag(const uint32_t ulTpm, const uint32_t ulChannel);
+static void vPitExpiry(struct SOC_Event *const pxEvent);
+static void vLptmrSchedule(void);
+static void vLptmrCompare(struct SOC_Event *const pxEvent);
+static void vAdcTrigger(const uint32_t ulSource);
+static void vAdcStart(const uint32_t ulCalibrate);
+static uint64_t ullAdcConversionCycles(void);
+static void vAdcDone(struct SOC_Event *const pxEvent);
+static uint32_t ulAdcResult(void);
+static void vCmpUpdate(void);
+static void vCmpCrossing(struct SOC_Event *const pxEvent);
+static void vFlashLaunch(void);
+static void vFlashDone(struct SOC_Event *const pxEvent);
+static void vSpiWrite(const uint8_t ucData);
+static uint8_t ucSpiRead(void);
+static void vSpiShiftNext(void);
+static void vSpiShiftDone(struct SOC_Event *const pxEvent);
+static void vSpiInterrupt(void);
+static void vDmaUpdate(void);
+static uint32_t ulDmaReady(const uint32_t ulChannel);
+static uint32_t ulDmaRequest(const uint32_t ulChannel);
+static void vDmaTransfer(struct SOC_Event *const pxEvent);
+static uint32_t ulDmaMove(const uint32_t ulChannel);
+static void vDmaLink(const uint32_t ulChannel);
+static uint32_t ulBusValid(const uint32_t ulAddress, const uint32_t ulSize);
+static uint32_t ulBusRead(const uint32_t ulAddress, const uint32_t ulSize, uint32_t *const pulValue);
+static uint32_t ulBusWrite(const uint32_t ulAddress, const uint32_t ulSize, const uint32_t ulValue);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Reset register blocks and register the models of this file.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void SOC_vPeripheralsInit(void)
+{
+    if ((ulBusValid((uint32_t)(uintptr_t)&xSocDma0, sizeof(xSocDma0)) == 0)
+        || (ulBusValid((uint32_t)(uintptr_t)&xSpiState, sizeof(xSpiState)) == 0))
+    {
+        fprintf(stderr, "soc: DMA can't reach RAM and registers, link with -no-pie -Wl,-Tdata=0x%08lX "
+                "-Wl,--section-start=.peripherals=0x%08lX\n", SOC_SRAM_START, SOC_PERIPHERAL_START);
+        abort();
+    }
+    
+    for (uint32_t i = 0; i < SOC_PORT_COUNT; i++)
+    {
+        xSocPort[i].ISFR = ISFR_MARKER;
+    }
+    
+    for (uint32_t i = 0; i < TPM_COUNT; i++)
+    {
+        xTpmStates[i].xOverflow.pxHandler = vTpmOverflow;
+        xTpmStates[i].xOverflow.pvContext = &xTpmStates[i];
+        xTpmStates[i].ulShownStatus = FLAG_MARKER;
+        xSocTpm[i].STATUS = FLAG_MARKER;
+        xSocTpm[i].MOD = TPM_MOD_MOD_MASK;
+    }
+    
+    for (uint32_t i = 0; i < PIT_CHANNELS; i++)
+    {
+        xPitChannels[i].xExpiry.pxHandler = vPitExpiry;
+        xPitChannels[i].xExpiry.pvContext = &xPitChannels[i];
+        xSocPit.CHANNEL[i].TFLG = FLAG_MARKER;
+    }
+    
+    xLptmrState.xCompare.pxHandler = vLptmrCompare;
+    xSocLptmr0.CSR = FLAG_MARKER;
+    
+    xAdcState.xDone.pxHandler = vAdcDone;
+    xSocAdc0.SC1[0] = ADC_SC1_ADCH(ADC_CH_DISABLED) | FLAG_MARKER;
+    xSocAdc0.SC1[1] = ADC_SC1_ADCH(ADC_CH_DISABLED);
+    
+    xCmpState.xCrossing.pxHandler = vCmpCrossing;
+    
+    xFlashState.xDone.pxHandler = vFlashDone;
+    xFlashState.ulShownStatus = FTFA_FSTAT_CCIF_MASK;
+    xSocFtfa.FSTAT = FTFA_FSTAT_CCIF_MASK | FSTAT_MARKER;
+    
+    xSpiState.xShift.pxHandler = vSpiShiftDone;
+    xSocSpi1.S = SPI_S_SPTEF_MASK;
+    xSocSpi1.D = SPI_D_MARKER;
+    
+    for (uint32_t i = 0; i < DMA_CHANNELS; i++)
+    {
+        xDmaChannels[i].xTransfer.pxHandler = vDmaTransfer;
+        xDmaChannels[i].xTransfer.pvContext = &xDmaChannels[i];
+    }
+    
+    /**
+     * Pins are sampled by the other models, so GPIO syncs first. Timers
+     * trigger ADC0 and CMP0 edges are captured by TPM1, so they sync
+     * before them. DMA is last to see requests of the same sync.
+     */
+    SOC_vAddModel(&xGpioModel);
+    SOC_vAddModel(&xTpmModel);
+    SOC_vAddModel(&xPitModel);
+    SOC_vAddModel(&xLptmrModel);
+    SOC_vAddModel(&xAdcModel);
+    SOC_vAddModel(&xCmpModel);
+    SOC_vAddModel(&xSpiModel);
+    SOC_vAddModel(&xFlashModel);
+    SOC_vAddModel(&xDmaModel);
+}
+
+
+/**
+ * @brief   Drive input pin from a model. Edges set the interrupt flag
+ *          the pin is configured for, are captured by a TPM channel
+ *          muxed to the pin and call its watch handlers at once.
+ * 
+ * @param   ulPort      SOC_PORT_A...SOC_PORT_E
+ * 
+ * @param   ulPin       0...31
+ * 
+ * @param   ulLevel     LOW/HIGH
+ * 
+ * @return  None
+ */
+void SOC_vSetPin(const uint32_t ulPort, const uint32_t ulPin, const uint32_t ulLevel)
+{
+    const uint32_t ulMask = 1UL << ulPin;
+    const uint32_t ulPrevious = ulLevels[ulPort] & ulMask;
+    uint32_t ulIrqc;
+    uint32_t ulFlag = 0;
+    
+    ulInputs[ulPort] = (ulLevel != 0) ? (ulInputs[ulPort] | ulMask) : (ulInputs[ulPort] & ~ulMask);
+    
+    /* Output pins keep the level MCU drives */
+    if (xSocGpio[ulPort].PDDR & ulMask)
+    {
+        return;
+    }
+    
+    ulLevels[ulPort] = (ulLevels[ulPort] & ~ulMask) | (ulInputs[ulPort] & ulMask);
+    xSocGpio[ulPort].PDIR = ulLevels[ulPort];
+    
+    ulIrqc = ulPinIrqc(ulPort, ulPin);
+    if ((ulPrevious == 0) && (ulLevel != 0))
+    {
+        ulFlag = (ulIrqc == IRQC_RISING_EDGE) || (ulIrqc == IRQC_EITHER_EDGE) || (ulIrqc == IRQC_LOGIC_ONE);
+    }
+    else if ((ulPrevious != 0) && (ulLevel == 0))
+    {
+        ulFlag = (ulIrqc == IRQC_FALLING_EDGE) || (ulIrqc == IRQC_EITHER_EDGE) || (ulIrqc == IRQC_LOGIC_ZERO);
+    }
+    
+    if (ulFlag && ((ulFlags[ulPort] & ulMask) == 0))
+    {
+        ulFlags[ulPort] |= ulMask;
+        xSocPort[ulPort].ISFR = ulFlags[ulPort] | ISFR_MARKER;
+        if (lPortIrqs[ulPort] >= 0)
+        {
+            SOC_vSetPending(lPortIrqs[ulPort]);
+        }
+    }
+    
+    if ((ulPrevious != 0) != (ulLevel != 0))
+    {
+        vPinChanged(ulPort, ulPin, (ulLevel != 0) ? 1 : 0);
+    }
+}
+
+
+/**
+ * @brief   Read pin level, driven by MCU or a model.
+ * 
+ * @param   ulPort      SOC_PORT_A...SOC_PORT_E
+ * 
+ * @param   ulPin       0...31
+ * 
+ * @return  LOW/HIGH
+ */
+uint32_t SOC_ulGetPin(const uint32_t ulPort, const uint32_t ulPin)
+{
+    return (ulLevels[ulPort] >> ulPin) & 1;
+}
+
+
+/**
+ * @brief   Call handler when level of pin changes, e.g. a chip select
+ *          driven by MCU or a pin driven by another model. Handlers of a
+ *          pin are called in the order they were added.
+ * 
+ * @param   ulPort      SOC_PORT_A...SOC_PORT_E
+ * 
+ * @param   ulPin       0...31
+ * 
+ * @param   pxHandler   Called on sync after the change.
+ * 
+ * @param   pvContext   For handler.
+ * 
+ * @return  None
+ */
+void SOC_vWatchPin(const uint32_t ulPort, const uint32_t ulPin, const SOC_PinHandler pxHandler, void *const pvContext)
+{
+    for (uint32_t i = 0; i < SOC_PIN_WATCHES; i++)
+    {
+        if (xWatches[ulPort][ulPin][i].pxHandler == NULL)
+        {
+            xWatches[ulPort][ulPin][i].pxHandler = pxHandler;
+            xWatches[ulPort][ulPin][i].pvContext = pvContext;
+            return;
+        }
+    }
+    
+    fprintf(stderr, "soc: more than %lu watches on pin %lu of port %lu\n", SOC_PIN_WATCHES, (unsigned long)ulPin,
+            (unsigned long)ulPort);
+    abort();
+}
+
+
+/**
+ * @brief   Connect slave to SPI1. It sees every byte, so it follows its
+ *          own chip select.
+ * 
+ * @param   pxDevice    Slave, NULL to clock 0xFF in.
+ * 
+ * @return  None
+ */
+void SOC_vConnectSpi(const SOC_SpiDevice pxDevice)
+{
+    xSpiState.pxDevice = pxDevice;
+}
+
+
+/**
+ * @brief   Connect analog inputs to ADC0.
+ * 
+ * @param   pxInput     Called with the channel for each sample, NULL
+ *                      to read 0.
+ * 
+ * @return  None
+ */
+void SOC_vConnectAnalog(const SOC_AnalogInput pxInput)
+{
+    xAdcState.pxInput = pxInput;
+}
+
+
+/**
+ * @brief   Connect RC node to CMP0 input 5, e.g. a sensor capacitor
+ *          discharging through a resistor.
+ * 
+ * @param   pxNode      Discharge time of the node, NULL to discharge at
+ *                      once.
+ * 
+ * @return  None
+ */
+void SOC_vConnectRc(const SOC_RcNode pxNode)
+{
+    xCmpState.pxNode = pxNode;
+}
+
+
+/**
+ * @brief   Tell whether SPI1 has a byte to clock, e.g. to check that a
+ *          chip select isn't released in the middle of a transfer.
+ * 
+ * @param   None
+ * 
+ * @return  1 if shifting or TX buffer is full.
+ */
+uint32_t SOC_ulSpiBusy(void)
+{
+    return ((xSpiState.ulShifting != 0) || (xSpiState.ulTxFull != 0)) ? 1 : 0;
+}
+
+
+/**
+ * @brief   Apply set, clear and toggle writes, update pin levels and
+ *          clear interrupt flags software wrote ones to.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vGpioSync(void)
+{
+    FGPIO_Type *pxGpio;
+    PORT_Type *pxPort;
+    uint32_t ulChanged;
+    uint32_t ulLevel;
+    
+    for (uint32_t ulPort = 0; ulPort < SOC_PORT_COUNT; ulPort++)
+    {
+        pxGpio = &xSocGpio[ulPort];
+        pxPort = &xSocPort[ulPort];
+        
+        if ((pxGpio->PSOR | pxGpio->PCOR | pxGpio->PTOR) != 0)
+        {
+            pxGpio->PDOR = ((pxGpio->PDOR | pxGpio->PSOR) & ~pxGpio->PCOR) ^ pxGpio->PTOR;
+            pxGpio->PSOR = 0;
+            pxGpio->PCOR = 0;
+            pxGpio->PTOR = 0;
+        }
+        
+        ulLevel = (pxGpio->PDOR & pxGpio->PDDR) | (ulInputs[ulPort] & ~pxGpio->PDDR);
+        ulChanged = ulLevel ^ ulLevels[ulPort];
+        ulLevels[ulPort] = ulLevel;
+        pxGpio->PDIR = ulLevel;
+        
+        for (uint32_t ulPin = 0; ulChanged != 0; ulPin++, ulChanged >>= 1)
+        {
+            if (ulChanged & 1)
+            {
+                vPinChanged(ulPort, ulPin, (ulLevel >> ulPin) & 1);
+            }
+        }
+        
+        if ((pxPort->ISFR & ISFR_MARKER) == 0)
+        {
+            ulFlags[ulPort] &= ~(uint32_t)pxPort->ISFR;
+            vLevelFlags(ulPort);
+            pxPort->ISFR = ulFlags[ulPort] | ISFR_MARKER;
+        }
+    }
+}
+
+
+/**
+ * @brief   Read interrupt configuration of pin.
+ * 
+ * @param   ulPort      SOC_PORT_A...SOC_PORT_E
+ * 
+ * @param   ulPin       0...31
+ * 
+ * @return  PORT_PCR_IRQC field.
+ */
+static uint32_t ulPinIrqc(const uint32_t ulPort, const uint32_t ulPin)
+{
+    return (xSocPort[ulPort].PCR[ulPin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT;
+}
+
+
+/**
+ * @brief   Set flags of level sensitive pins again after they were
+ *          cleared, request interrupt while any flag is set.
+ * 
+ * @param   ulPort      SOC_PORT_A...SOC_PORT_E
+ * 
+ * @return  None
+ */
+static void vLevelFlags(const uint32_t ulPort)
+{
+    uint32_t ulIrqc;
+    
+    for (uint32_t ulPin = 0; ulPin < PINS; ulPin++)
+    {
+        ulIrqc = ulPinIrqc(ulPort, ulPin);
+        if (((ulIrqc == IRQC_LOGIC_ZERO) && (SOC_ulGetPin(ulPort, ulPin) == 0))
+            || ((ulIrqc == IRQC_LOGIC_ONE) && (SOC_ulGetPin(ulPort, ulPin) != 0)))
+        {
+            ulFlags[ulPort] |= 1UL << ulPin;
+        }
+    }
+    
+    if ((ulFlags[ulPort] != 0) && (lPortIrqs[ulPort] >= 0))
+    {
+        SOC_vSetPending(lPortIrqs[ulPort]);
+    }
+}
+
+
+/**
+ * @brief   Pin changed level, call its watch handlers and capture the
+ *          edge in a TPM channel muxed to it.
+ * 
+ * @param   ulPort      SOC_PORT_A...SOC_PORT_E
+ * 
+ * @param   ulPin       0...31
+ * 
+ * @param   ulLevel     LOW/HIGH
+ * 
+ * @return  None
+ */
+static void vPinChanged(const uint32_t ulPort, const uint32_t ulPin, const uint32_t ulLevel)
+{
+    const struct Pin_Watch *pxWatch;
+    const struct Tpm_Pin *pxTpmPin;
+    
+    for (uint32_t i = 0; i < sizeof(xTpmPins) / sizeof(xTpmPins[0]); i++)
+    {
+        pxTpmPin = &xTpmPins[i];
+        if ((pxTpmPin->ucPort == ulPort) && (pxTpmPin->ucPin == ulPin) && (PCR_MUX(xSocPort[ulPort].PCR[ulPin]) == pxTpmPin->ucMux))
+        {
+            vTpmCapture(pxTpmPin->ucTpm, pxTpmPin->ucChannel, ulLevel);
+        }
+    }
+    
+    for (uint32_t i = 0; i < SOC_PIN_WATCHES; i++)
+    {
+        pxWatch = &xWatches[ulPort][ulPin][i];
+        if (pxWatch->pxHandler != NULL)
+        {
+            pxWatch->pxHandler(ulLevel, pxWatch->pvContext);
+        }
+    }
+}
+
+
+/**
+ * @brief   Follow CNT, SC, STATUS and CnSC writes and update counters.
+ * 
+ * @note    CHF is cleared by writing one, but a CnSC write that leaves
+ *          the register as it was can't be seen, e.g. a BME OR of CHF
+ *          while it is set. Clear it through STATUS then.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vTpmSync(void)
+{
+    TPM_Type *pxTpm;
+    struct Tpm_State *pxState;
+    uint32_t ulClock;
+    uint32_t ulWritten;
+    
+    for (uint32_t i = 0; i < TPM_COUNT; i++)
+    {
+        pxTpm = &xSocTpm[i];
+        pxState = &xTpmStates[i];
+        
+        /* Any write resets counter */
+        if (pxTpm->CNT != pxState->ulShownCount)
+        {
+            pxState->ulStartCount = 0;
+            pxState->ullStart = SOC_ullCycles();
+        }
+        else
+        {
+            pxState->ulStartCount = ulTpmCount(i);
+            pxState->ullStart = SOC_ullCycles();
+        }
+        
+        if (pxTpm->STATUS != pxState->ulShownStatus)
+        {
+            pxState->ulShownStatus = (pxState->ulShownStatus & ~pxTpm->STATUS) | FLAG_MARKER;
+            pxTpm->SC &= ~TPM_SC_TOF_MASK;
+            if ((pxState->ulShownStatus & TPM_STATUS_TOF_MASK) != 0)
+            {
+                pxTpm->SC |= TPM_SC_TOF_MASK;
+            }
+            
+            for (uint32_t c = 0; c < TPM_CHANNELS; c++)
+            {
+                if ((pxState->ulShownStatus & (TPM_STATUS_CH0F_MASK << c)) == 0)
+                {
+                    pxState->ulShownControl[c] &= ~TPM_CnSC_CHF_MASK;
+                    pxTpm->CONTROLS[c].CnSC = pxState->ulShownControl[c];
+                }
+            }
+        }
+        
+        for (uint32_t c = 0; c < TPM_CHANNELS; c++)
+        {
+            ulWritten = pxTpm->CONTROLS[c].CnSC;
+            if (ulWritten != pxState->ulShownControl[c])
+            {
+                pxState->ulShownControl[c] = (ulWritten & ~TPM_CnSC_CHF_MASK)
+                                           | (pxState->ulShownControl[c] & ~ulWritten & TPM_CnSC_CHF_MASK);
+                pxTpm->CONTROLS[c].CnSC = pxState->ulShownControl[c];
+                if ((pxState->ulShownControl[c] & TPM_CnSC_CHF_MASK) == 0)
+                {
+                    pxState->ulShownStatus &= ~(TPM_STATUS_CH0F_MASK << c);
+                }
+            }
+        }
+        
+        ulClock = pxTpm->SC & (TPM_SC_CMOD_MASK | TPM_SC_PS_MASK);
+        if ((ulClock & TPM_SC_CMOD_MASK) == 0)
+        {
+            ulClock = 0;
+        }
+        if (ulClock != pxState->ulClock)
+        {
+            pxState->ulClock = ulClock;
+            vTpmSchedule(i);
+        }
+        
+        pxTpm->CNT = pxState->ulStartCount;
+        pxTpm->STATUS = pxState->ulShownStatus;
+        pxState->ulShownCount = pxState->ulStartCount;
+    }
+}
+
+
+/**
+ * @brief   Read counter value at current time.
+ * 
+ * @param   ulTpm       0...2
+ * 
+ * @return  CNT
+ */
+static uint32_t ulTpmCount(const uint32_t ulTpm)
+{
+    const struct Tpm_State *pxState = &xTpmStates[ulTpm];
+    const uint64_t ullModulo = (uint64_t)(xSocTpm[ulTpm].MOD & TPM_MOD_MOD_MASK) + 1;
+    uint64_t ullTicks;
+    
+    if (pxState->ulClock == 0)
+    {
+        return pxState->ulStartCount;
+    }
+    
+    ullTicks = ((SOC_ullCycles() - pxState->ullStart) * (TPM_INPUT_CLOCK_HZ / SOC_BUS_CLOCK_HZ)) >> (pxState->ulClock & TPM_SC_PS_MASK);
+    
+    return (uint32_t)((pxState->ulStartCount + ullTicks) % ullModulo);
+}
+
+
+/**
+ * @brief   Schedule next overflow of running counter.
+ * 
+ * @param   ulTpm       0...2
+ * 
+ * @return  None
+ */
+static void vTpmSchedule(const uint32_t ulTpm)
+{
+    struct Tpm_State *pxState = &xTpmStates[ulTpm];
+    const uint64_t ullModulo = (uint64_t)(xSocTpm[ulTpm].MOD & TPM_MOD_MOD_MASK) + 1;
+    uint64_t ullTicks;
+    uint64_t ullCycles;
+    
+    if (pxState->ulClock == 0)
+    {
+        SOC_vCancel(&pxState->xOverflow);
+        return;
+    }
+    
+    ullTicks = ullModulo - (ulTpmCount(ulTpm) % ullModulo);
+    ullCycles = ((ullTicks << (pxState->ulClock & TPM_SC_PS_MASK)) + (TPM_INPUT_CLOCK_HZ / SOC_BUS_CLOCK_HZ) - 1)
+                / (TPM_INPUT_CLOCK_HZ / SOC_BUS_CLOCK_HZ);
+    SOC_vSchedule(&pxState->xOverflow, ullCycles);
+}
+
+
+/**
+ * @brief   Counter wrapped from MOD to 0, set TOF.
+ * 
+ * @param   pxEvent     Overflow event of the TPM.
+ * 
+ * @return  None
+ */
+static void vTpmOverflow(struct SOC_Event *const pxEvent)
+{
+    struct Tpm_State *pxState = pxEvent->pvContext;
+    const uint32_t ulTpm = (uint32_t)(pxState - xTpmStates);
+    
+    pxState->ulShownStatus |= TPM_STATUS_TOF_MASK;
+    xSocTpm[ulTpm].STATUS = pxState->ulShownStatus;
+    xSocTpm[ulTpm].SC |= TPM_SC_TOF_MASK;
+    
+    if (xSocTpm[ulTpm].SC & TPM_SC_TOIE_MASK)
+    {
+        SOC_vSetPending(lTpmIrqs[ulTpm]);
+    }
+    
+    vTpmSchedule(ulTpm);
+}
+
+
+/**
+ * @brief   Edge on the pin of a channel. In input capture mode with the
+ *          edge selected and the counter running, CNT is captured to CnV
+ *          and CHF requests DMA or the interrupt.
+ * 
+ * @param   ulTpm       0...2
+ * 
+ * @param   ulChannel   0...5
+ * 
+ * @param   ulLevel     Level after the edge.
+ * 
+ * @return  None
+ */
+static void vTpmCapture(const uint32_t ulTpm, const uint32_t ulChannel, const uint32_t ulLevel)
+{
+    struct Tpm_State *pxState = &xTpmStates[ulTpm];
+    const uint32_t ulControl = pxState->ulShownControl[ulChannel];
+    const uint32_t ulEdge = (ulLevel != 0) ? TPM_CnSC_ELSA_MASK : TPM_CnSC_ELSB_MASK;
+    
+    if ((ulControl & (TPM_CnSC_MSB_MASK | TPM_CnSC_MSA_MASK)) || ((ulControl & ulEdge) == 0) || (pxState->ulClock == 0))
+    {
+        return;
+    }
+    
+    xSocTpm[ulTpm].CONTROLS[ulChannel].CnV = ulTpmCount(ulTpm);
+    pxState->ulShownControl[ulChannel] |= TPM_CnSC_CHF_MASK;
+    pxState->ulShownStatus |= TPM_STATUS_CH0F_MASK << ulChannel;
+    xSocTpm[ulTpm].CONTROLS[ulChannel].CnSC = pxState->ulShownControl[ulChannel];
+    xSocTpm[ulTpm].STATUS = pxState->ulShownStatus;
+    xSocAnalogStats.ulCaptures++;
+    
+    /* DMA request replaces the interrupt */
+    if (ulControl & TPM_CnSC_DMA_MASK)
+    {
+        vDmaUpdate();
+    }
+    else if (ulControl & TPM_CnSC_CHIE_MASK)
+    {
+        SOC_vSetPending(lTpmIrqs[ulTpm]);
+    }
+}
+
+
+/**
+ * @brief   Read DMA request of channel.
+ * 
+ * @param   ulTpm       0...2
+ * 
+ * @param   ulChannel   0...5
+ * 
+ * @return  1 if CHF is set with DMA enabled.
+ */
+static uint32_t ulTpmRequest(const uint32_t ulTpm, const uint32_t ulChannel)
+{
+    const uint32_t ulControl = xTpmStates[ulTpm].ulShownControl[ulChannel];
+    
+    return ((ulControl & TPM_CnSC_DMA_MASK) && (ulControl & TPM_CnSC_CHF_MASK)) ? 1 : 0;
+}
+
+
+/**
+ * @brief   CnV read by DMA, clears CHF.
+ * 
+ * @param   ulTpm       0...2
+ * 
+ * @param   ulChannel   0...5
+ * 
+ * @return  None
+ */
+static void vTpmClearFlag(const uint32_t ulTpm, const uint32_t ulChannel)
+{
+    struct Tpm_State *pxState = &xTpmStates[ulTpm];
+    
+    pxState->ulShownControl[ulChannel] &= ~TPM_CnSC_CHF_MASK;
+    pxState->ulShownStatus &= ~(TPM_STATUS_CH0F_MASK << ulChannel);
+    xSocTpm[ulTpm].CONTROLS[ulChannel].CnSC = pxState->ulShownControl[ulChannel];
+    xSocTpm[ulTpm].STATUS = pxState->ulShownStatus;
+}
+
+
+/**
+ * @brief   Follow TCTRL, TFLG and LDVAL writes and update counters.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vPitSync(void)
+{
+    struct Pit_Channel *pxChannel;
+    uint32_t ulEnabled;
+    uint64_t ullElapsed;
+    
+    for (uint32_t i = 0; i < PIT_CHANNELS; i++)
+    {
+        pxChannel = &xPitChannels[i];
+        
+        if ((xSocPit.CHANNEL[i].TFLG & FLAG_MARKER) == 0)
+        {
+            xSocPit.CHANNEL[i].TFLG = FLAG_MARKER;
+        }
+        
+        ulEnabled = ((xSocPit.MCR & PIT_MCR_MDIS_MASK) == 0) && (xSocPit.CHANNEL[i].TCTRL & PIT_TCTRL_TEN_MASK);
+        if (ulEnabled && (pxChannel->ulEnabled == 0))
+        {
+            pxChannel->ullStart = SOC_ullCycles();
+            pxChannel->ulLoad = xSocPit.CHANNEL[i].LDVAL;
+            SOC_vSchedule(&pxChannel->xExpiry, (uint64_t)pxChannel->ulLoad + 1);
+        }
+        else if ((ulEnabled == 0) && pxChannel->ulEnabled)
+        {
+            SOC_vCancel(&pxChannel->xExpiry);
+        }
+        pxChannel->ulEnabled = ulEnabled;
+        
+        if (ulEnabled)
+        {
+            ullElapsed = SOC_ullCycles() - pxChannel->ullStart;
+            xSocPit.CHANNEL[i].CVAL = pxChannel->ulLoad - (uint32_t)ullElapsed;
+        }
+    }
+}
+
+
+/**
+ * @brief   Channel counted down to zero, set TIF, trigger ADC0 and load
+ *          LDVAL.
+ * 
+ * @param   pxEvent     Expiry event of the channel.
+ * 
+ * @return  None
+ */
+static void vPitExpiry(struct SOC_Event *const pxEvent)
+{
+    struct Pit_Channel *pxChannel = pxEvent->pvContext;
+    const uint32_t ulChannel = (uint32_t)(pxChannel - xPitChannels);
+    
+    xSocPit.CHANNEL[ulChannel].TFLG = PIT_TFLG_TIF_MASK | FLAG_MARKER;
+    if (xSocPit.CHANNEL[ulChannel].TCTRL & PIT_TCTRL_TIE_MASK)
+    {
+        SOC_vSetPending(PIT_IRQn);
+    }
+    vAdcTrigger(ADC_TRIGGER_PIT0 + ulChannel);
+    
+    pxChannel->ullStart = SOC_ullCycles();
+    pxChannel->ulLoad = xSocPit.CHANNEL[ulChannel].LDVAL;
+    SOC_vSchedule(&pxChannel->xExpiry, (uint64_t)pxChannel->ulLoad + 1);
+}
+
+
+
+/**
+ * @brief   Follow CSR writes and update counter. Disabling resets the
+ *          counter and clears TCF.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vLptmrSync(void)
+{
+    struct Lptmr_State *pxState = &xLptmrState;
+    const uint32_t ulControl = xSocLptmr0.CSR;
+    uint32_t ulEnabled;
+    
+    if ((ulControl & FLAG_MARKER) == 0)
+    {
+        if (ulControl & LPTMR_CSR_TCF_MASK)
+        {
+            pxState->ulFlag = 0;
+        }
+        
+        ulEnabled = (ulControl & LPTMR_CSR_TEN_MASK) ? 1 : 0;
+        if (ulEnabled && (pxState->ulEnabled == 0))
+        {
+            pxState->ullStart = SOC_ullCycles();
+            vLptmrSchedule();
+        }
+        else if (ulEnabled == 0)
+        {
+            SOC_vCancel(&pxState->xCompare);
+            pxState->ulFlag = 0;
+        }
+        pxState->ulEnabled = ulEnabled;
+        
+        xSocLptmr0.CSR = (ulControl & ~LPTMR_CSR_TCF_MASK) | pxState->ulFlag | FLAG_MARKER;
+    }
+    
+    xSocLptmr0.CNR = pxState->ulEnabled ? (uint32_t)((SOC_ullCycles() - pxState->ullStart) / pxState->ullTick) : 0;
+}
+
+
+/**
+ * @brief   Schedule next compare of running counter from PSR and CMR.
+ *          Only the LPO clock is modelled.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vLptmrSchedule(void)
+{
+    struct Lptmr_State *pxState = &xLptmrState;
+    const uint32_t ulPrescale = xSocLptmr0.PSR;
+    
+    if (((ulPrescale & LPTMR_PSR_PCS_MASK) >> LPTMR_PSR_PCS_SHIFT) != LPTMR_CLOCK_LPO)
+    {
+        fprintf(stderr, "soc: LPTMR0 clock %lu isn't modelled, use the LPO\n",
+                (unsigned long)((ulPrescale & LPTMR_PSR_PCS_MASK) >> LPTMR_PSR_PCS_SHIFT));
+        abort();
+    }
+    
+    pxState->ullTick = LPTMR_LPO_CYCLES;
+    if ((ulPrescale & LPTMR_PSR_PBYP_MASK) == 0)
+    {
+        pxState->ullTick <<= ((ulPrescale & LPTMR_PSR_PRESCALE_MASK) >> LPTMR_PSR_PRESCALE_SHIFT) + 1;
+    }
+    
+    SOC_vSchedule(&pxState->xCompare, ((uint64_t)(xSocLptmr0.CMR & LPTMR_CMR_COMPARE_MASK) + 1) * pxState->ullTick);
+}
+
+
+/**
+ * @brief   Counter reached CMR, set TCF, trigger ADC0 and restart.
+ * 
+ * @param   pxEvent     Compare event.
+ * 
+ * @return  None
+ */
+static void vLptmrCompare(struct SOC_Event *const pxEvent)
+{
+    struct Lptmr_State *pxState = &xLptmrState;
+    
+    (void)pxEvent;
+    
+    pxState->ulFlag = LPTMR_CSR_TCF_MASK;
+    xSocLptmr0.CSR |= LPTMR_CSR_TCF_MASK;
+    if (xSocLptmr0.CSR & LPTMR_CSR_TIE_MASK)
+    {
+        SOC_vSetPending(LPTimer_IRQn);
+    }
+    vAdcTrigger(ADC_TRIGGER_LPTMR0);
+    
+    pxState->ullStart = SOC_ullCycles();
+    vLptmrSchedule();
+}
+
+
+/**
+ * @brief   Follow SC1A writes and start conversions and calibration.
+ *          Writing SC1A aborts a conversion in progress and clears
+ *          COCO, with software trigger it starts the next one.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vAdcSync(void)
+{
+    struct Adc_State *pxState = &xAdcState;
+    const uint32_t ulControl = xSocAdc0.SC1[0];
+    
+    if ((ulControl & FLAG_MARKER) == 0)
+    {
+        if (pxState->ulBusy)
+        {
+            SOC_vCancel(&pxState->xDone);
+            pxState->ulBusy = 0;
+        }
+        if (pxState->ulCalibrating)
+        {
+            pxState->ulCalibrating = 0;
+            xSocAdc0.SC3 = (xSocAdc0.SC3 & ~ADC_SC3_CAL_MASK) | ADC_SC3_CALF_MASK;
+        }
+        pxState->ulRequest = 0;
+        xSocAdc0.SC1[0] = (ulControl & (ADC_SC1_AIEN_MASK | ADC_SC1_DIFF_MASK | ADC_SC1_ADCH_MASK)) | FLAG_MARKER;
+        
+        if (((xSocAdc0.SC2 & ADC_SC2_ADTRG_MASK) == 0) && (((ulControl & ADC_SC1_ADCH_MASK) >> ADC_SC1_ADCH_SHIFT) != ADC_CH_DISABLED))
+        {
+            vAdcStart(0);
+        }
+    }
+    
+    if ((xSocAdc0.SC3 & ADC_SC3_CAL_MASK) && (pxState->ulCalibrating == 0))
+    {
+        vAdcStart(1);
+    }
+}
+
+
+/**
+ * @brief   Hardware trigger, starts a conversion if it is the selected
+ *          alternate trigger and ADC0 waits for one.
+ * 
+ * @param   ulSource    SOPT7 ADC0TRGSEL of the trigger.
+ * 
+ * @return  None
+ */
+static void vAdcTrigger(const uint32_t ulSource)
+{
+    const uint32_t ulOptions = xSocSim.SOPT7;
+    
+    if (((ulOptions & SIM_SOPT7_ADC0ALTTRGEN_MASK) == 0)
+     || (((ulOptions & SIM_SOPT7_ADC0TRGSEL_MASK) >> SIM_SOPT7_ADC0TRGSEL_SHIFT) != ulSource)
+     || ((xSocAdc0.SC2 & ADC_SC2_ADTRG_MASK) == 0)
+     || xAdcState.ulBusy
+     || (((xSocAdc0.SC1[0] & ADC_SC1_ADCH_MASK) >> ADC_SC1_ADCH_SHIFT) == ADC_CH_DISABLED))
+    {
+        return;
+    }
+    
+    vAdcStart(0);
+}
+
+
+/**
+ * @brief   Start conversion of SC1A channel, or calibration. COCO stays
+ *          set until R is read or SC1A written, calibration clears it.
+ * 
+ * @param   ulCalibrate     1 to calibrate.
+ * 
+ * @return  None
+ */
+static void vAdcStart(const uint32_t ulCalibrate)
+{
+    struct Adc_State *pxState = &xAdcState;
+    const uint32_t ulAverage = xSocAdc0.SC3;
+    uint64_t ullCycles = ullAdcConversionCycles();
+    
+    pxState->ulBusy = 1;
+    pxState->ulCalibrating = ulCalibrate;
+    pxState->ulChannel = (xSocAdc0.SC1[0] & ADC_SC1_ADCH_MASK) >> ADC_SC1_ADCH_SHIFT;
+    pxState->ulMode = (xSocAdc0.CFG1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT;
+    pxState->ulSamples = (ulAverage & ADC_SC3_AVGE_MASK) ? (4UL << ((ulAverage & ADC_SC3_AVGS_MASK) >> ADC_SC3_AVGS_SHIFT)) : 1;
+    
+    if (ulCalibrate)
+    {
+        xSocAdc0.SC1[0] &= ~ADC_SC1_COCO_MASK;
+        pxState->ulRequest = 0;
+        ullCycles *= ADC_CALIBRATION_CONVERSIONS;
+    }
+    
+    SOC_vSchedule(&pxState->xDone, ullCycles);
+}
+
+
+/**
+ * @brief   Conversion time of CFG1, CFG2 and SC3 from the reference
+ *          manual tables, averaged samples included.
+ * 
+ * @param   None
+ * 
+ * @return  Bus clock cycles.
+ */
+static uint64_t ullAdcConversionCycles(void)
+{
+    /* Single-ended base time by MODE and long sample adders by ADLSTS, ADCK cycles */
+    static const uint32_t ulBaseAdck[4] = { 17, 20, 20, 25 };
+    static const uint32_t ulLongAdck[4] = { 20, 12, 6, 2 };
+    const uint32_t ulConfig1 = xSocAdc0.CFG1;
+    const uint32_t ulConfig2 = xSocAdc0.CFG2;
+    const uint32_t ulClock = (ulConfig1 & ADC_CFG1_ADICLK_MASK) >> ADC_CFG1_ADICLK_SHIFT;
+    uint64_t ullAdck;
+    uint64_t ullSample;
+    
+    if (ulClock > 1)
+    {
+        fprintf(stderr, "soc: ADC0 clock %lu isn't modelled, use the bus clock\n", (unsigned long)ulClock);
+        abort();
+    }
+    
+    ullAdck = (uint64_t)(ulClock + 1) << ((ulConfig1 & ADC_CFG1_ADIV_MASK) >> ADC_CFG1_ADIV_SHIFT);
+    ullSample = ulBaseAdck[(ulConfig1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT];
+    if (ulConfig1 & ADC_CFG1_ADLSMP_MASK)
+    {
+        ullSample += ulLongAdck[(ulConfig2 & ADC_CFG2_ADLSTS_MASK) >> ADC_CFG2_ADLSTS_SHIFT];
+    }
+    if (ulConfig2 & ADC_CFG2_ADHSC_MASK)
+    {
+        ullSample += ADC_HSC_ADCK;
+    }
+    if (xSocAdc0.SC3 & ADC_SC3_AVGE_MASK)
+    {
+        ullSample <<= ((xSocAdc0.SC3 & ADC_SC3_AVGS_MASK) >> ADC_SC3_AVGS_SHIFT) + 2;
+    }
+    
+    return (ADC_FIRST_ADCK + ullSample) * ullAdck + ADC_FIRST_BUS;
+}
+
+
+/**
+ * @brief   Conversion or calibration done. A conversion that fails the
+ *          compare function is dropped without setting COCO.
+ * 
+ * @param   pxEvent     Done event.
+ * 
+ * @return  None
+ */
+static void vAdcDone(struct SOC_Event *const pxEvent)
+{
+    struct Adc_State *pxState = &xAdcState;
+    volatile uint32_t *const pulPlus = &xSocAdc0.CLPD;
+    volatile uint32_t *const pulMinus = &xSocAdc0.CLMD;
+    const uint32_t ulCompare = xSocAdc0.SC2;
+    uint32_t ulResult;
+    uint32_t ulPassed;
+    
+    (void)pxEvent;
+    
+    pxState->ulBusy = 0;
+    
+    if (pxState->ulCalibrating)
+    {
+        pxState->ulCalibrating = 0;
+        for (uint32_t i = 0; i < sizeof(ulAdcCalibration) / sizeof(ulAdcCalibration[0]); i++)
+        {
+            pulPlus[i] = ulAdcCalibration[i];
+            pulMinus[i] = ulAdcCalibration[i];
+        }
+        xSocAdc0.OFS = 0;
+        xSocAdc0.SC3 &= ~(ADC_SC3_CAL_MASK | ADC_SC3_CALF_MASK);
+        xSocAdc0.SC1[0] |= ADC_SC1_COCO_MASK;
+        xSocAnalogStats.ulCalibrations++;
+        return;
+    }
+    
+    xSocAnalogStats.ulConversions++;
+    ulResult = ulAdcResult();
+    
+    if (ulCompare & ADC_SC2_ACFE_MASK)
+    {
+        ulPassed = (ulCompare & ADC_SC2_ACFGT_MASK) ? (ulResult >= xSocAdc0.CV1) : (ulResult < xSocAdc0.CV1);
+        if (ulPassed == 0)
+        {
+            xSocAnalogStats.ulCompareMisses++;
+            return;
+        }
+    }
+    
+    xSocAdc0.R[0] = ulResult;
+    xSocAdc0.SC1[0] |= ADC_SC1_COCO_MASK;
+    if (xSocAdc0.SC1[0] & ADC_SC1_AIEN_MASK)
+    {
+        SOC_vSetPending(ADC0_IRQn);
+    }
+    
+    /* Request is raised by COCO setting, stale COCO can't retrigger DMA */
+    pxState->ulRequest = (ulCompare & ADC_SC2_DMAEN_MASK) ? 1 : 0;
+    vDmaUpdate();
+}
+
+
+/**
+ * @brief   Average input samples of latched channel and quantize to
+ *          the latched resolution, right justified.
+ * 
+ * @param   None
+ * 
+ * @return  Result for R.
+ */
+static uint32_t ulAdcResult(void)
+{
+    /* Right shift of 16-bit level by MODE: 8, 12, 10 and 16 bits */
+    static const uint8_t ucShift[4] = { 8, 4, 6, 0 };
+    struct Adc_State *pxState = &xAdcState;
+    uint64_t ullSum = 0;
+    uint32_t ulLevel;
+    
+    for (uint32_t i = 0; (pxState->pxInput != NULL) && (i < pxState->ulSamples); i++)
+    {
+        ulLevel = pxState->pxInput(pxState->ulChannel);
+        ullSum += (ulLevel > ADC_INPUT_MAX) ? ADC_INPUT_MAX : ulLevel;
+    }
+    
+    return (uint32_t)(ullSum / pxState->ulSamples) >> ucShift[pxState->ulMode];
+}
+
+
+/**
+ * @brief   Follow pin, DAC and control writes.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vCmpSync(void)
+{
+    vCmpUpdate();
+}
+
+
+/**
+ * @brief   Update RC node and comparator output. The node follows PTE29
+ *          while it is a GPIO output, when it is released it discharges
+ *          from that level and crosses the DAC threshold at a time the
+ *          connected node tells. COUT drives PTE0 when OPE is set and the
+ *          pin is muxed to CMP0_OUT.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vCmpUpdate(void)
+{
+    struct Cmp_State *pxState = &xCmpState;
+    const uint64_t ullNow = SOC_ullCycles();
+    const uint32_t ulControl = xSocCmp0.CR1;
+    const uint32_t ulMux = xSocCmp0.MUXCR;
+    const uint32_t ulDriven = (PCR_MUX(xSocPort[SOC_PORT_E].PCR[RC_PIN]) == MUX_GPIO) && (xSocGpio[SOC_PORT_E].PDDR & (1UL << RC_PIN));
+    double dThreshold = 0.0;
+    uint32_t ulAbove;
+    uint32_t ulOutput;
+    
+    if ((((ulMux & CMP_MUXCR_MSEL_MASK) >> CMP_MUXCR_MSEL_SHIFT) == CMP_MINUS_DAC) && (xSocCmp0.DACCR & CMP_DACCR_DACEN_MASK))
+    {
+        dThreshold = (((xSocCmp0.DACCR & CMP_DACCR_VOSEL_MASK) >> CMP_DACCR_VOSEL_SHIFT) + 1) / CMP_DAC_STEPS;
+    }
+    
+    if (ulDriven)
+    {
+        pxState->dStart = SOC_ulGetPin(SOC_PORT_E, RC_PIN) ? 1.0 : 0.0;
+    }
+    
+    /* Released, or threshold moved while floating */
+    if ((ulDriven == 0) && (pxState->ulDriven || (dThreshold != pxState->dThreshold)))
+    {
+        if (pxState->ulDriven)
+        {
+            pxState->ullStart = ullNow;
+        }
+        
+        if (dThreshold <= 0.0)
+        {
+            pxState->ullCrossing = UINT64_MAX;
+        }
+        else if ((pxState->dStart > dThreshold) && (pxState->pxNode != NULL))
+        {
+            pxState->ullCrossing = pxState->ullStart + pxState->pxNode(pxState->dStart, dThreshold);
+        }
+        else
+        {
+            pxState->ullCrossing = pxState->ullStart;
+        }
+    }
+    pxState->ulDriven = ulDriven;
+    pxState->dThreshold = dThreshold;
+    
+    if (((ulMux & CMP_MUXCR_PSEL_MASK) >> CMP_MUXCR_PSEL_SHIFT) != CMP_PLUS_RC)
+    {
+        ulAbove = 0;
+    }
+    else if (ulDriven)
+    {
+        ulAbove = (pxState->dStart > dThreshold) ? 1 : 0;
+    }
+    else
+    {
+        ulAbove = (ullNow < pxState->ullCrossing) ? 1 : 0;
+    }
+    
+    ulOutput = (ulControl & CMP_CR1_EN_MASK) ? (ulAbove ^ ((ulControl & CMP_CR1_INV_MASK) ? 1 : 0)) : 0;
+    if (ulOutput != pxState->ulOutput)
+    {
+        pxState->ulOutput = ulOutput;
+        xSocAnalogStats.ulComparatorEdges++;
+    }
+    xSocCmp0.SCR = (xSocCmp0.SCR & ~CMP_SCR_COUT_MASK) | (ulOutput ? CMP_SCR_COUT_MASK : 0);
+    
+    if ((ulControl & CMP_CR1_OPE_MASK) && (PCR_MUX(xSocPort[SOC_PORT_E].PCR[CMP_OUT_PIN]) == CMP_OUT_MUX) && (ulOutput != pxState->ulPin))
+    {
+        pxState->ulPin = ulOutput;
+        SOC_vSetPin(SOC_PORT_E, CMP_OUT_PIN, ulOutput);
+    }
+    
+    if ((ulDriven == 0) && (ullNow < pxState->ullCrossing) && (pxState->ullCrossing != UINT64_MAX))
+    {
+        SOC_vSchedule(&pxState->xCrossing, pxState->ullCrossing - ullNow);
+    }
+    else
+    {
+        SOC_vCancel(&pxState->xCrossing);
+    }
+}
+
+
+/**
+ * @brief   Floating node fell below the DAC threshold.
+ * 
+ * @param   pxEvent     Crossing event.
+ * 
+ * @return  None
+ */
+static void vCmpCrossing(struct SOC_Event *const pxEvent)
+{
+    (void)pxEvent;
+    
+    vCmpUpdate();
+}
+
+
+/**
+ * @brief   Follow C1 and D writes. Disabling SPI1 drops the bytes in
+ *          flight.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vSpiSync(void)
+{
+    if ((xSocSpi1.C1 & SPI_C1_SPE_MASK) == 0)
+    {
+        SOC_vCancel(&xSpiState.xShift);
+        xSpiState.ulShifting = 0;
+        xSpiState.ulTxFull = 0;
+        xSocSpi1.S = SPI_S_SPTEF_MASK;
+        xSocSpi1.D = xSpiState.ucRx | SPI_D_MARKER;
+        return;
+    }
+    
+    if ((xSocSpi1.D & SPI_D_MARKER_MASK) != SPI_D_MARKER)
+    {
+        vSpiWrite((uint8_t)xSocSpi1.D);
+    }
+    
+    vSpiShiftNext();
+    vSpiInterrupt();
+}
+
+
+/**
+ * @brief   Byte written to D by software or DMA. Ignored while TX buffer
+ *          is full, like on target.
+ * 
+ * @param   ucData      Byte to send.
+ * 
+ * @return  None
+ */
+static void vSpiWrite(const uint8_t ucData)
+{
+    xSocSpi1.D = xSpiState.ucRx | SPI_D_MARKER;
+    
+    if ((xSocSpi1.S & SPI_S_SPTEF_MASK) == 0)
+    {
+        return;
+    }
+    
+    xSpiState.ucTx = ucData;
+    xSpiState.ulTxFull = 1;
+    xSocSpi1.S &= ~SPI_S_SPTEF_MASK;
+    
+    vSpiShiftNext();
+}
+
+
+/**
+ * @brief   D read by DMA, clears SPRF.
+ * 
+ * @param   None
+ * 
+ * @return  Received byte.
+ */
+static uint8_t ucSpiRead(void)
+{
+    xSocSpi1.S &= ~SPI_S_SPRF_MASK;
+    
+    return xSpiState.ucRx;
+}
+
+
+/**
+ * @brief   Move TX buffer to shifter if it is idle and start clocking.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vSpiShiftNext(void)
+{
+    const uint32_t ulBr = xSocSpi1.BR;
+    const uint64_t ullBitCycles = (uint64_t)(((ulBr & SPI_BR_SPPR_MASK) >> SPI_BR_SPPR_SHIFT) + 1)
+                                  << (((ulBr & SPI_BR_SPR_MASK) >> SPI_BR_SPR_SHIFT) + 1);
+    
+    if ((xSpiState.ulShifting != 0) || (xSpiState.ulTxFull == 0)
+        || ((xSocSpi1.C1 & (SPI_C1_SPE_MASK | SPI_C1_MSTR_MASK)) != (SPI_C1_SPE_MASK | SPI_C1_MSTR_MASK)))
+    {
+        return;
+    }
+    
+    xSpiState.ucShift = xSpiState.ucTx;
+    xSpiState.ulTxFull = 0;
+    xSpiState.ulShifting = 1;
+    xSocSpi1.S |= SPI_S_SPTEF_MASK;
+    
+    SOC_vSchedule(&xSpiState.xShift, SPI_BITS * ullBitCycles);
+}
+
+
+/**
+ * @brief   Last bit clocked, exchange byte with slave and set SPRF.
+ * 
+ * @param   pxEvent     Shift event of SPI1.
+ * 
+ * @return  None
+ */
+static void vSpiShiftDone(struct SOC_Event *const pxEvent)
+{
+    const uint8_t ucMiso = (xSpiState.pxDevice != NULL) ? xSpiState.pxDevice(xSpiState.ucShift) : 0xFF;
+    
+    (void)pxEvent;
+    
+    xSpiState.ulShifting = 0;
+    xSocSpiStats.ulBytes++;
+    
+    if (xSocSpi1.S & SPI_S_SPRF_MASK)
+    {
+        xSocSpiStats.ulOverruns++;
+    }
+    else
+    {
+        xSpiState.ucRx = ucMiso;
+        xSocSpi1.S |= SPI_S_SPRF_MASK;
+        xSocSpi1.D = ucMiso | SPI_D_MARKER;
+    }
+    
+    vSpiShiftNext();
+    vSpiInterrupt();
+    vDmaUpdate();
+}
+
+
+/**
+ * @brief   Request SPI1 interrupt for flags it is enabled for.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vSpiInterrupt(void)
+{
+    const uint32_t ulC1 = xSocSpi1.C1;
+    const uint32_t ulS = xSocSpi1.S;
+    
+    if (((ulC1 & SPI_C1_SPIE_MASK) && (ulS & SPI_S_SPRF_MASK)) || ((ulC1 & SPI_C1_SPTIE_MASK) && (ulS & SPI_S_SPTEF_MASK)))
+    {
+        SOC_vSetPending(SPI1_IRQn);
+    }
+}
+
+
+
+/**
+ * @brief   Follow FSTAT writes. Errors are cleared by writing ones,
+ *          writing CCIF launches the command in FCCOB.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vFlashSync(void)
+{
+    struct Flash_State *pxState = &xFlashState;
+    const uint32_t ulStatus = xSocFtfa.FSTAT;
+    uint32_t ulLaunch;
+    
+    if (ulStatus & FSTAT_MARKER)
+    {
+        return;
+    }
+    
+    pxState->ulShownStatus &= ~(ulStatus & (FSTAT_ERRORS | FTFA_FSTAT_MGSTAT0_MASK));
+    
+    /* Launch is ignored while a command runs or errors are set */
+    ulLaunch = (ulStatus & FTFA_FSTAT_CCIF_MASK) && (pxState->ulShownStatus & FTFA_FSTAT_CCIF_MASK)
+            && ((pxState->ulShownStatus & FSTAT_ERRORS) == 0);
+    if (ulLaunch)
+    {
+        vFlashLaunch();
+    }
+    
+    xSocFtfa.FSTAT = pxState->ulShownStatus | FSTAT_MARKER;
+}
+
+
+/**
+ * @brief   Check FCCOB command and start it. Only sector erase and
+ *          longword program of the modelled sectors are accepted.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vFlashLaunch(void)
+{
+    struct Flash_State *pxState = &xFlashState;
+    const uint32_t ulAddress = ((uint32_t)xSocFtfa.FCCOB1 << 16) | ((uint32_t)xSocFtfa.FCCOB2 << 8) | xSocFtfa.FCCOB3;
+    uint32_t *pulSector = NULL;
+    uint32_t ulBase = 0;
+    uint64_t ullCycles;
+    
+    for (uint32_t i = 0; i < sizeof(pulFlashSectors) / sizeof(pulFlashSectors[0]); i++)
+    {
+        ulBase = (uint32_t)(uintptr_t)pulFlashSectors[i] & FLASH_ADDRESS_MASK;
+        if ((ulAddress >= ulBase) && (ulAddress < ulBase + FLASH_SECTOR_WORDS * sizeof(uint32_t)))
+        {
+            pulSector = pulFlashSectors[i];
+            break;
+        }
+    }
+    
+    pxState->ulCommand = xSocFtfa.FCCOB0;
+    if ((pulSector == NULL) || (ulAddress % sizeof(uint32_t)))
+    {
+        pxState->ulCommand = 0;
+    }
+    
+    switch (pxState->ulCommand)
+    {
+        case FLASH_CMD_ERASE_SECTOR:
+            pxState->pulWord = pulSector;
+            ullCycles = FLASH_ERASE_CYCLES;
+            break;
+        case FLASH_CMD_PROGRAM_LONGWORD:
+            pxState->pulWord = &pulSector[(ulAddress - ulBase) / sizeof(uint32_t)];
+            pxState->ulData = ((uint32_t)xSocFtfa.FCCOB4 << 24) | ((uint32_t)xSocFtfa.FCCOB5 << 16)
+                            | ((uint32_t)xSocFtfa.FCCOB6 << 8) | xSocFtfa.FCCOB7;
+            ullCycles = FLASH_PROGRAM_CYCLES;
+            break;
+        default:
+            pxState->ulShownStatus |= FTFA_FSTAT_ACCERR_MASK;
+            xSocFlashStats.ulErrors++;
+            return;
+    }
+    
+    pxState->ulShownStatus &= ~(FTFA_FSTAT_CCIF_MASK | FTFA_FSTAT_MGSTAT0_MASK);
+    SOC_vSchedule(&pxState->xDone, ullCycles);
+}
+
+
+/**
+ * @brief   Command done, change flash and set CCIF. Programming can only
+ *          clear bits, MGSTAT0 is set if the longword doesn't read back.
+ * 
+ * @param   pxEvent     Done event.
+ * 
+ * @return  None
+ */
+static void vFlashDone(struct SOC_Event *const pxEvent)
+{
+    struct Flash_State *pxState = &xFlashState;
+    
+    (void)pxEvent;
+    
+    if (pxState->ulCommand == FLASH_CMD_ERASE_SECTOR)
+    {
+        memset(pxState->pulWord, 0xFF, FLASH_SECTOR_WORDS * sizeof(uint32_t));
+        xSocFlashStats.ulErases++;
+    }
+    else
+    {
+        *pxState->pulWord &= pxState->ulData;
+        if (*pxState->pulWord != pxState->ulData)
+        {
+            pxState->ulShownStatus |= FTFA_FSTAT_MGSTAT0_MASK;
+            xSocFlashStats.ulErrors++;
+        }
+        xSocFlashStats.ulPrograms++;
+    }
+    
+    pxState->ulShownStatus |= FTFA_FSTAT_CCIF_MASK;
+    xSocFtfa.FSTAT = pxState->ulShownStatus | FSTAT_MARKER;
+}
+
+
+/**
+ * @brief   Follow DSR_BCR and START writes and serve requests.
+ * 
+ * @note    Driver clears DONE by writing back the value it read, which
+ *          can't be told from the model's own, so any DSR_BCR write that
+ *          is seen clears DONE and errors.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vDmaSync(void)
+{
+    struct Dma_Channel *pxChannel;
+    uint32_t ulWritten;
+    
+    for (uint32_t i = 0; i < DMA_CHANNELS; i++)
+    {
+        pxChannel = &xDmaChannels[i];
+        
+        ulWritten = xSocDma0.DMA[i].DSR_BCR;
+        if (ulWritten != pxChannel->ulShownStatus)
+        {
+            pxChannel->ulShownStatus = ulWritten & DMA_DSR_BCR_BCR_MASK;
+            xSocDma0.DMA[i].DSR_BCR = pxChannel->ulShownStatus;
+        }
+        
+        if (xSocDma0.DMA[i].DCR & DMA_DCR_START_MASK)
+        {
+            xSocDma0.DMA[i].DCR &= ~DMA_DCR_START_MASK;
+            pxChannel->ulStart = 1;
+        }
+    }
+    
+    vDmaUpdate();
+}
+
+
+/**
+ * @brief   Schedule transfer of each channel that is ready for one.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vDmaUpdate(void)
+{
+    for (uint32_t i = 0; i < DMA_CHANNELS; i++)
+    {
+        if ((xDmaChannels[i].xTransfer.ulQueued == 0) && ulDmaReady(i))
+        {
+            SOC_vSchedule(&xDmaChannels[i].xTransfer, DMA_TRANSFER_CYCLES);
+        }
+    }
+}
+
+
+/**
+ * @brief   Tell whether channel has bytes left and a start or an
+ *          enabled request.
+ * 
+ * @param   ulChannel   0...3
+ * 
+ * @return  1 if ready.
+ */
+static uint32_t ulDmaReady(const uint32_t ulChannel)
+{
+    const uint32_t ulStatus = xDmaChannels[ulChannel].ulShownStatus;
+    
+    if (((ulStatus & DMA_DSR_BCR_BCR_MASK) == 0) || (ulStatus & DMA_DSR_ERRORS))
+    {
+        return 0;
+    }
+    
+    return (xDmaChannels[ulChannel].ulStart || ((xSocDma0.DMA[ulChannel].DCR & DMA_DCR_ERQ_MASK) && ulDmaRequest(ulChannel)))
+           ? 1 : 0;
+}
+
+
+/**
+ * @brief   Read request line DMAMUX0 routes to channel.
+ * 
+ * @param   ulChannel   0...3
+ * 
+ * @return  1 if requesting.
+ */
+static uint32_t ulDmaRequest(const uint32_t ulChannel)
+{
+    const uint32_t ulConfig = xSocDmamux0.CHCFG[ulChannel];
+    const uint32_t ulSource = (ulConfig & DMAMUX_CHCFG_SOURCE_MASK) >> DMAMUX_CHCFG_SOURCE_SHIFT;
+    
+    if ((ulConfig & DMAMUX_CHCFG_ENBL_MASK) == 0)
+    {
+        return 0;
+    }
+    
+    if ((ulSource >= DMAMUX_SOURCE_TPM0_CH0) && (ulSource < DMAMUX_SOURCE_TPM0_CH0 + TPM_CHANNELS))
+    {
+        return ulTpmRequest(0, ulSource - DMAMUX_SOURCE_TPM0_CH0);
+    }
+    if ((ulSource >= DMAMUX_SOURCE_TPM1_CH0) && (ulSource < DMAMUX_SOURCE_TPM2_CH0 + 2))
+    {
+        return ulTpmRequest(1 + (ulSource - DMAMUX_SOURCE_TPM1_CH0) / 2, (ulSource - DMAMUX_SOURCE_TPM1_CH0) % 2);
+    }
+    
+    switch (ulSource)
+    {
+        case DMAMUX_SOURCE_SPI1_RX:
+            return (xSocSpi1.C2 & SPI_C2_RXDMAE_MASK) && (xSocSpi1.S & SPI_S_SPRF_MASK);
+        case DMAMUX_SOURCE_SPI1_TX:
+            return (xSocSpi1.C2 & SPI_C2_TXDMAE_MASK) && (xSocSpi1.C1 & SPI_C1_SPE_MASK) && (xSocSpi1.S & SPI_S_SPTEF_MASK);
+        case DMAMUX_SOURCE_ADC0:
+            return (xSocAdc0.SC2 & ADC_SC2_DMAEN_MASK) && xAdcState.ulRequest;
+        default:
+            return 0;
+    }
+}
+
+
+/**
+ * @brief   Serve channel: one item in cycle-steal mode, else until BCR
+ *          is zero. Sets DONE and requests the interrupt at the end.
+ * 
+ * @param   pxEvent     Transfer event of the channel.
+ * 
+ * @return  None
+ */
+static void vDmaTransfer(struct SOC_Event *const pxEvent)
+{
+    struct Dma_Channel *pxChannel = pxEvent->pvContext;
+    const uint32_t ulChannel = (uint32_t)(pxChannel - xDmaChannels);
+    const uint32_t ulControl = xSocDma0.DMA[ulChannel].DCR;
+    const uint32_t ulLinkMode = (ulControl & DMA_DCR_LINKCC_MASK) >> DMA_DCR_LINKCC_SHIFT;
+    uint32_t ulMoved;
+    
+    /* Request may have gone since it was seen */
+    if (ulDmaReady(ulChannel) == 0)
+    {
+        return;
+    }
+    pxChannel->ulStart = 0;
+    
+    do
+    {
+        ulMoved = ulDmaMove(ulChannel);
+    } while (ulMoved && ((ulControl & DMA_DCR_CS_MASK) == 0) && (pxChannel->ulShownStatus & DMA_DSR_BCR_BCR_MASK));
+    
+    if (ulMoved && (ulControl & DMA_DCR_CS_MASK) && ((ulLinkMode == LINKCC_BOTH) || (ulLinkMode == LINKCC_CYCLE_STEAL)))
+    {
+        vDmaLink((ulControl & DMA_DCR_LCH1_MASK) >> DMA_DCR_LCH1_SHIFT);
+    }
+    
+    if ((ulMoved == 0) || ((pxChannel->ulShownStatus & DMA_DSR_BCR_BCR_MASK) == 0))
+    {
+        pxChannel->ulShownStatus |= DMA_DSR_BCR_DONE_MASK;
+        
+        if (ulControl & DMA_DCR_D_REQ_MASK)
+        {
+            xSocDma0.DMA[ulChannel].DCR &= ~DMA_DCR_ERQ_MASK;
+        }
+        if (ulControl & DMA_DCR_EINT_MASK)
+        {
+            SOC_vSetPending(DMA0_IRQn + (int32_t)ulChannel);
+        }
+        
+        if (ulMoved && (ulLinkMode == LINKCC_BOTH))
+        {
+            vDmaLink((ulControl & DMA_DCR_LCH2_MASK) >> DMA_DCR_LCH2_SHIFT);
+        }
+        else if (ulMoved && (ulLinkMode == LINKCC_BCR_ZERO))
+        {
+            vDmaLink((ulControl & DMA_DCR_LCH1_MASK) >> DMA_DCR_LCH1_SHIFT);
+        }
+    }
+    
+    xSocDma0.DMA[ulChannel].DSR_BCR = pxChannel->ulShownStatus;
+    vDmaUpdate();
+}
+
+
+/**
+ * @brief   Move one item from SAR to DAR and advance the addresses.
+ * 
+ * @param   ulChannel   0...3
+ * 
+ * @return  1 if moved, 0 on bus error, error bit is set.
+ */
+static uint32_t ulDmaMove(const uint32_t ulChannel)
+{
+    static const uint32_t ulSizes[4] = { 4, 1, 2, 0 };
+    struct Dma_Channel *pxChannel = &xDmaChannels[ulChannel];
+    const uint32_t ulControl = xSocDma0.DMA[ulChannel].DCR;
+    const uint32_t ulSize = ulSizes[(ulControl & DMA_DCR_SSIZE_MASK) >> DMA_DCR_SSIZE_SHIFT];
+    const uint32_t ulSource = xSocDma0.DMA[ulChannel].SAR;
+    const uint32_t ulDestination = xSocDma0.DMA[ulChannel].DAR;
+    uint32_t ulValue;
+    
+    if ((ulSize == 0) || (ulSize != ulSizes[(ulControl & DMA_DCR_DSIZE_MASK) >> DMA_DCR_DSIZE_SHIFT])
+        || ((pxChannel->ulShownStatus & DMA_DSR_BCR_BCR_MASK) < ulSize))
+    {
+        pxChannel->ulShownStatus |= DMA_DSR_BCR_CE_MASK;
+        return 0;
+    }
+    
+    if (ulBusRead(ulSource, ulSize, &ulValue) == 0)
+    {
+        pxChannel->ulShownStatus |= DMA_DSR_BCR_BES_MASK;
+        return 0;
+    }
+    if (ulBusWrite(ulDestination, ulSize, ulValue) == 0)
+    {
+        pxChannel->ulShownStatus |= DMA_DSR_BCR_BED_MASK;
+        return 0;
+    }
+    
+    if (ulControl & DMA_DCR_SINC_MASK)
+    {
+        xSocDma0.DMA[ulChannel].SAR = ulSource + ulSize;
+    }
+    if (ulControl & DMA_DCR_DINC_MASK)
+    {
+        xSocDma0.DMA[ulChannel].DAR = ulDestination + ulSize;
+    }
+    pxChannel->ulShownStatus -= ulSize;
+    
+    return 1;
+}
+
+
+/**
+ * @brief   Start linked channel, like setting its START bit.
+ * 
+ * @param   ulChannel   0...3
+ * 
+ * @return  None
+ */
+static void vDmaLink(const uint32_t ulChannel)
+{
+    xDmaChannels[ulChannel].ulStart = 1;
+}
+
+
+/**
+ * @brief   Tell whether DMA can reach address range.
+ * 
+ * @param   ulAddress   First byte.
+ * 
+ * @param   ulSize      Bytes.
+ * 
+ * @return  1 if in RAM or peripheral window.
+ */
+static uint32_t ulBusValid(const uint32_t ulAddress, const uint32_t ulSize)
+{
+    const uint64_t ullEnd = (uint64_t)ulAddress + ulSize;
+    
+    return (((ulAddress >= SOC_SRAM_START) && (ullEnd <= SOC_SRAM_END))
+            || ((ulAddress >= SOC_PERIPHERAL_START) && (ullEnd <= SOC_PERIPHERAL_END))) ? 1 : 0;
+}
+
+
+/**
+ * @brief   DMA read. SPI1 D is read through its model, ADC0 R and TPM
+ *          CnV reads clear COCO and CHF.
+ * 
+ * @param   ulAddress   Address from SAR.
+ * 
+ * @param   ulSize      1, 2 or 4 bytes.
+ * 
+ * @param   pulValue    Value read.
+ * 
+ * @return  1, or 0 on bus error.
+ */
+static uint32_t ulBusRead(const uint32_t ulAddress, const uint32_t ulSize, uint32_t *const pulValue)
+{
+    *pulValue = 0;
+    
+    if (ulBusValid(ulAddress, ulSize) == 0)
+    {
+        return 0;
+    }
+    
+    if (ulAddress == (uint32_t)(uintptr_t)&xSocSpi1.D)
+    {
+        *pulValue = ucSpiRead();
+        return 1;
+    }
+    
+    memcpy(pulValue, (const void *)(uintptr_t)ulAddress, ulSize);
+    
+    if (ulAddress == (uint32_t)(uintptr_t)&xSocAdc0.R[0])
+    {
+        xSocAdc0.SC1[0] &= ~ADC_SC1_COCO_MASK;
+        xAdcState.ulRequest = 0;
+    }
+    
+    for (uint32_t i = 0; i < TPM_COUNT; i++)
+    {
+        for (uint32_t c = 0; c < TPM_CHANNELS; c++)
+        {
+            if (ulAddress == (uint32_t)(uintptr_t)&xSocTpm[i].CONTROLS[c].CnV)
+            {
+                vTpmClearFlag(i, c);
+            }
+        }
+    }
+    
+    return 1;
+}
+
+
+/**
+ * @brief   DMA write. SPI1 D is written through its model, other
+ *          registers are seen by their models on the next sync.
+ * 
+ * @param   ulAddress   Address from DAR.
+ * 
+ * @param   ulSize      1, 2 or 4 bytes.
+ * 
+ * @param   ulValue     Value to write.
+ * 
+ * @return  1, or 0 on bus error.
+ */
+static uint32_t ulBusWrite(const uint32_t ulAddress, const uint32_t ulSize, const uint32_t ulValue)
+{
+    if (ulBusValid(ulAddress, ulSize) == 0)
+    {
+        return 0;
+    }
+    
+    if (ulAddress == (uint32_t)(uintptr_t)&xSocSpi1.D)
+    {
+        vSpiWrite((uint8_t)ulValue);
+    }
+    else
+    {
+        memcpy((void *)(uintptr_t)ulAddress, &ulValue, ulSize);
+    }
+    
+    return 1;
+}
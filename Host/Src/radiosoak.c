@@ -0,0 +1,557 @@
+/**
+ * radiosoak.c
+ * This file soak tests the nRF24L01 driver against the virtual
+ * nRF24L01+ of the host build.
+ * 
+ * The real Remote/Drivers/Src/nrf24l01.c runs in a FreeRTOS task on the
+ * host port, over the real SPI1 and DMA drivers on the peripheral
+ * models, and sends encoded frames like the comm task does: send, wait
+ * for IRQ, retransmit after MAX_RT and flush, or with -b in bursts
+ * through the TX FIFO. ACK payloads of the gateway are decoded as
+ * commands. Gateway end uses the Gateway/ decoder and downlink, or a
+ * socketgateway process with -u.
+ * 
+ * Build from repository root:
+ *  cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -IHost/Inc -IHost/Port -IRemote/Inc -IRemote/Drivers/Inc -IRemote/FreeRTOS/include -IGateway/Inc
+ *     -no-pie -Wl,-Tdata=0x1FF00000 -Wl,--section-start=.peripherals=0x40000000
+ *     Host/Src/radiosoak.c Host/Src/vradio.c Host/Src/soc.c Host/Src/peripherals.c Host/Port/port.c
+ *     Remote/FreeRTOS/src/tasks.c Remote/FreeRTOS/src/queue.c Remote/FreeRTOS/src/list.c Remote/FreeRTOS/src/timers.c
+ *     Remote/FreeRTOS/src/event_groups.c Remote/FreeRTOS/src/heap_3.c Remote/Drivers/Src/nrf24l01.c
+ *     Remote/Drivers/Src/spi.c Remote/Drivers/Src/dma.c Remote/Drivers/Src/tpm.c Remote/Drivers/Src/pit.c
+ *     Remote/Src/benchmark.c Remote/Src/frame.c Remote/Src/command.c Gateway/Src/decoder.c Gateway/Src/downlink.c
+ *     -o radiosoak
+ * 
+ * Usage: radiosoak [-n frames] [-l loss per mille] [-s seed] [-b] [-u socket]
+ * Exit status is 1 if driver counters differ from the radio model, the
+ * driver broke the command set or a frame was lost without loss.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "frame.h"
+#include "command.h"
+#include "decoder.h"
+#include "downlink.h"
+#include "vradio.h"
+
+
+/* Local defines */
+#define SOAK_FRAMES                     (1000UL)
+#define SOAK_FIELDS                     (3UL)
+#define SOAK_TX_TIMEOUT_MS              (COMM_TX_TIMEOUT_MS)
+#define SOAK_TX_RETRIES                 (COMM_TX_RETRIES)
+#define SOAK_COMMAND_INTERVAL           (4UL)       /* Uplinks per queued downlink command */
+#define SOAK_STACK_SIZE                 (configMINIMAL_STACK_SIZE * 2)
+
+/* Frame outcomes, as seen by the node */
+struct Soak_Stats
+{
+    uint32_t ulFrames;
+    uint32_t ulFrameBytes;
+    uint32_t ulAcked;
+    uint32_t ulDropped;
+    uint32_t ulWrites;                  /* Payloads written to TX FIFO */
+    uint32_t ulCommandPayloads;
+    uint32_t ulCommands;
+    uint32_t ulCommandErrors;
+    uint32_t ulCommandGaps;             /* Payload sequence numbers skipped */
+    uint64_t ullCycles;                 /* Virtual time of the soak */
+};
+
+/* In-process gateway */
+struct Soak_Gateway
+{
+    struct Decoder_Node xDecoders[VRADIO_PIPES];
+    struct Downlink_Node xDownlinks[VRADIO_PIPES];
+    uint32_t ulUplinks;
+};
+
+
+/* Local variables */
+static const uint8_t ucSoakTags[SOAK_FIELDS] =
+{
+    FRAME_FIELD_TEMPERATURE << 4,
+    FRAME_FIELD_HUMIDITY << 4,
+    FRAME_FIELD_SOIL_MOISTURE << 4
+};
+
+static uint32_t ulSoakFrames = SOAK_FRAMES;
+static uint32_t ulBurst = FALSE;
+static struct Soak_Stats xSoakStats;
+static struct Soak_Gateway xGateway;
+static struct Frame_Encoder xEncoder;
+
+
+/* Local function prototypes */
+static void vSoakTask(void *const pvParam);
+static uint32_t ulNextFrame(uint8_t *const pucFrame);
+static uint32_t ulSendOne(const uint8_t *const pucFrame, const uint32_t ulLength);
+static void vSendBurst(void);
+static void vReadCommands(void);
+static uint32_t ulGatewayReceive(const uint32_t ulPipe, const uint8_t *const pucPayload, const uint32_t ulLength,
+                                 uint8_t *const pucAck);
+static void vGatewayOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext);
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed);
+static uint32_t ulReport(const uint32_t ulLossy);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Parse options, run soak and compare counters.
+ * 
+ * @param   argc        Argument count.
+ * 
+ * @param   argv        Arguments.
+ * 
+ * @return  0 if all checks passed, else 1.
+ */
+int main(int argc, char **argv)
+{
+    struct VRADIO_Config xRadioConfig =
+    {
+        .ucChannel = NRF24L01_RF_CHANNEL,
+        .ulSeed = 1,
+        .pxReceiver = ulGatewayReceive,
+    };
+    const char *pcSocket = NULL;
+    BaseType_t xCreated;
+    int lOption;
+    
+    while ((lOption = getopt(argc, argv, "n:l:s:bu:")) != -1)
+    {
+        switch (lOption)
+        {
+            case 'n':
+                ulSoakFrames = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                xRadioConfig.ulLossPerMille = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                xRadioConfig.ulSeed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                ulBurst = TRUE;
+                break;
+            case 'u':
+                pcSocket = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n frames] [-l loss per mille] [-s seed] [-b] [-u socket]\n", argv[0]);
+                return 1;
+        }
+    }
+    
+    /* Gateway listens on the address of every pipe */
+    for (uint32_t i = 0; i < VRADIO_PIPES; i++)
+    {
+        const uint8_t ucAddress[VRADIO_ADDRESS_LEN] = { COMMAND_ADDRESS_BASE + i, 0x22, 0x33, 0x44, 0x55 };
+        
+        memcpy(xRadioConfig.ucAddress[i], ucAddress, VRADIO_ADDRESS_LEN);
+        DECODER_vNodeInit(&xGateway.xDecoders[i]);
+    }
+    DOWNLINK_vNodeInit(&xGateway.xDownlinks[COMMAND_PIPE(NODE_ID)], NODE_ID);
+    
+    SOC_vPeripheralsInit();
+    VRADIO_vInit(&xRadioConfig);
+    if ((pcSocket != NULL) && (VRADIO_lConnect(pcSocket) != 0))
+    {
+        return 1;
+    }
+    
+    PIT_vInit();
+    TPM2_vInit();
+    SPI1_vInit();
+    FRAME_vEncoderInit(&xEncoder, (uint8_t)NODE_ID, ucSoakTags, SOAK_FIELDS);
+    
+    xCreated = xTaskCreate(vSoakTask, "Soak", SOAK_STACK_SIZE, NULL, COMMTASKPRIORITY, NULL);
+    configASSERT(xCreated == pdPASS);
+    
+    vTaskStartScheduler();
+    
+    return (int)ulReport((xRadioConfig.ulLossPerMille != 0) || (pcSocket != NULL));
+}
+
+
+/**
+ * @brief   Idle hook, sleeps until the next interrupt so that virtual
+ *          time moves on.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void vApplicationIdleHook(void)
+{
+    BENCH_vIdleHook();
+    __WFI();
+}
+
+
+/**
+ * @brief   Soak task. Sends the frames and ends the scheduler.
+ * 
+ * @param   pvParam     Unused.
+ * 
+ * @return  None
+ */
+static void vSoakTask(void *const pvParam)
+{
+    (void)pvParam;
+    uint8_t ucFrame[FRAME_MAX_SIZE];
+    const uint64_t ullStart = SOC_ullCycles();
+    
+    nRF24L01_vInit();
+    
+    while (xSoakStats.ulFrames < ulSoakFrames)
+    {
+        if (ulBurst == TRUE)
+        {
+            vSendBurst();
+        }
+        else
+        {
+            const uint32_t ulLength = ulNextFrame(ucFrame);
+            
+            if (ulSendOne(ucFrame, ulLength) == TRUE)
+            {
+                xSoakStats.ulAcked++;
+            }
+            else
+            {
+                xSoakStats.ulDropped++;
+                FRAME_vEncoderResync(&xEncoder);
+            }
+        }
+    }
+    
+    xSoakStats.ullCycles = SOC_ullCycles() - ullStart;
+    vTaskEndScheduler();
+}
+
+
+/**
+ * @brief   Encode frame of one sample, values wander like readings.
+ * 
+ * @param   pucFrame    Room for FRAME_MAX_SIZE bytes.
+ * 
+ * @return  Frame length.
+ */
+static uint32_t ulNextFrame(uint8_t *const pucFrame)
+{
+    const uint32_t ulIndex = xSoakStats.ulFrames;
+    const int32_t lValues[SOAK_FIELDS] =
+    {
+        20 + (int32_t)(ulIndex / 16) % 10,
+        40 + (int32_t)(ulIndex * 7) % 30,
+        (int32_t)(ulIndex * 13) % 101
+    };
+    uint32_t ulLength;
+    
+    (void)FRAME_ulEncoderAppend(&xEncoder, ulIndex, lValues);
+    ulLength = FRAME_ulEncoderFinish(&xEncoder);
+    memcpy(pucFrame, xEncoder.ucFrame, ulLength);
+    
+    xSoakStats.ulFrames++;
+    xSoakStats.ulFrameBytes += ulLength;
+    
+    return ulLength;
+}
+
+
+/**
+ * @brief   Send frame with the retry policy of the comm task.
+ * 
+ * @param   pucFrame    Frame.
+ * 
+ * @param   ulLength    Frame length.
+ * 
+ * @return  TRUE if frame was acked, else FALSE and TX FIFO is flushed.
+ */
+static uint32_t ulSendOne(const uint8_t *const pucFrame, const uint32_t ulLength)
+{
+    const TickType_t xTimeout = pdMS_TO_TICKS(SOAK_TX_TIMEOUT_MS);
+    uint32_t ulResult;
+    
+    xSoakStats.ulWrites++;
+    nRF24L01_vSendPayload((const char *)pucFrame, ulLength);
+    ulResult = nRF24L01_ulWaitForTransmit(xTimeout);
+    
+    for (uint32_t i = 0; (i < SOAK_TX_RETRIES) && (ulResult == NRF24L01_TX_MAX_RT); i++)
+    {
+        nRF24L01_vRetransmit();
+        ulResult = nRF24L01_ulWaitForTransmit(xTimeout);
+    }
+    
+    if (ulResult == NRF24L01_TX_ACKED)
+    {
+        vReadCommands();
+        return TRUE;
+    }
+    
+    nRF24L01_vFlushTx();
+    
+    return FALSE;
+}
+
+
+/**
+ * @brief   Stream up to NRF24L01_TX_FIFO_SIZE frames through TX FIFO,
+ *          refilling it on every ACK. Frames left after retries are
+ *          dropped.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vSendBurst(void)
+{
+    const TickType_t xTimeout = pdMS_TO_TICKS(SOAK_TX_TIMEOUT_MS);
+    uint8_t ucFrame[FRAME_MAX_SIZE];
+    uint32_t ulCount = 0;
+    uint32_t ulRetries = 0;
+    uint32_t ulAcked;
+    uint32_t ulResult;
+    
+    nRF24L01_vStreamStart();
+    
+    for (;;)
+    {
+        while ((ulCount < NRF24L01_TX_FIFO_SIZE) && (xSoakStats.ulFrames < ulSoakFrames))
+        {
+            const uint32_t ulLength = ulNextFrame(ucFrame);
+            
+            xSoakStats.ulWrites++;
+            nRF24L01_vLoadPayload((const char *)ucFrame, ulLength);
+            ulCount++;
+        }
+        
+        if (ulCount == 0)
+        {
+            break;
+        }
+        
+        ulResult = nRF24L01_ulStreamWait(xTimeout, &ulAcked);
+        vReadCommands();
+        
+        xSoakStats.ulAcked += ulAcked;
+        ulCount -= ulAcked;
+        if (ulAcked > 0)
+        {
+            ulRetries = 0;
+        }
+        
+        if (ulResult == NRF24L01_TX_MAX_RT)
+        {
+            if (ulRetries == SOAK_TX_RETRIES)
+            {
+                break;
+            }
+            
+            ulRetries++;
+            nRF24L01_vStreamResume();
+        }
+        else if (ulResult == NRF24L01_TX_TIMEOUT)
+        {
+            break;
+        }
+    }
+    
+    nRF24L01_vStreamStop();
+    
+    if (ulCount > 0)
+    {
+        xSoakStats.ulDropped += ulCount;
+        FRAME_vEncoderResync(&xEncoder);
+    }
+}
+
+
+/**
+ * @brief   Decode ACK payloads waiting in RX FIFO as commands.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vReadCommands(void)
+{
+    static uint32_t ulPrevSequence;
+    static uint32_t ulSequenceValid = FALSE;
+    uint8_t ucPayload[COMMAND_PAYLOAD_MAX_SIZE];
+    struct Command xCommands[COMMAND_MAX_COUNT];
+    uint32_t ulSequence;
+    uint32_t ulLength;
+    int32_t lCount;
+    
+    while ((ulLength = nRF24L01_ulReadAckPayload(ucPayload)) > 0)
+    {
+        xSoakStats.ulCommandPayloads++;
+        
+        lCount = COMMAND_lDecode(ucPayload, ulLength, NODE_ID, &ulSequence, xCommands);
+        if (lCount < 0)
+        {
+            xSoakStats.ulCommandErrors++;
+            continue;
+        }
+        
+        if ((ulSequenceValid == TRUE) && (ulSequence != ((ulPrevSequence + 1) & 0xFFUL)))
+        {
+            xSoakStats.ulCommandGaps++;
+        }
+        ulPrevSequence = ulSequence;
+        ulSequenceValid = TRUE;
+        xSoakStats.ulCommands += (uint32_t)lCount;
+    }
+}
+
+
+/**
+ * @brief   In-process gateway, VRADIO_Receiver. Decodes the frame and
+ *          queues a command every SOAK_COMMAND_INTERVAL:th uplink.
+ * 
+ * @param   ulPipe      Pipe of the frame.
+ * 
+ * @param   pucPayload  Frame.
+ * 
+ * @param   ulLength    Frame length.
+ * 
+ * @param   pucAck      Room for the next ACK payload of the pipe.
+ * 
+ * @return  ACK payload length.
+ */
+static uint32_t ulGatewayReceive(const uint32_t ulPipe, const uint8_t *const pucPayload, const uint32_t ulLength,
+                                 uint8_t *const pucAck)
+{
+    struct Downlink_Node *const pxDownlink = &xGateway.xDownlinks[ulPipe];
+    const struct Command xCommand =
+    {
+        .ucType = COMMAND_THRESHOLD,
+        .ucTarget = 0,
+        .usValue = (uint16_t)(xGateway.ulUplinks % 100),
+    };
+    
+    xGateway.ulUplinks++;
+    
+    /* Decoder counts frames and errors */
+    (void)DECODER_lPush(&xGateway.xDecoders[ulPipe], pucPayload, ulLength, vGatewayOutput, NULL);
+    
+    if (pxDownlink->ulNode == 0)
+    {
+        return 0; /* No node of the soak on this pipe */
+    }
+    
+    DOWNLINK_vUplink(pxDownlink);
+    if ((xGateway.ulUplinks % SOAK_COMMAND_INTERVAL) == 0)
+    {
+        (void)DOWNLINK_lQueue(pxDownlink, &xCommand);
+    }
+    
+    return DOWNLINK_ulLoad(pxDownlink, pucAck);
+}
+
+
+/**
+ * @brief   Decoder output of the in-process gateway, frames are only
+ *          counted by the decoder.
+ * 
+ * @param   pxFrame     Decoded frame.
+ * 
+ * @param   pvContext   Unused.
+ * 
+ * @return  None
+ */
+static void vGatewayOutput(const struct Decoder_Frame *const pxFrame, void *const pvContext)
+{
+    (void)pxFrame;
+    (void)pvContext;
+}
+
+
+/**
+ * @brief   Print result of a check.
+ * 
+ * @param   pcName      What was checked.
+ * 
+ * @param   ulPassed    Nonzero if it held.
+ * 
+ * @return  0 if passed, else 1.
+ */
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed)
+{
+    printf("%-44s %s\n", pcName, ulPassed ? "ok" : "FAILED");
+    
+    return ulPassed ? 0 : 1;
+}
+
+
+/**
+ * @brief   Print driver and model counters side by side and check them.
+ * 
+ * @note    In bursts one TX_DS may stand for several ACKs and the
+ *          driver counts ARC_CNT of the latest payload only, so its
+ *          retransmits are a lower bound there.
+ * 
+ * @param   ulLossy     Nonzero if packets may be lost, or the gateway is
+ *                      outside, so frames may be dropped.
+ * 
+ * @return  Number of failed checks, 0 or 1 for exit status.
+ */
+static uint32_t ulReport(const uint32_t ulLossy)
+{
+    const struct Decoder_Node *const pxDecoder = &xGateway.xDecoders[COMMAND_PIPE(NODE_ID)];
+    const double dSeconds = (double)xSoakStats.ullCycles / SOC_BUS_CLOCK_HZ;
+    uint32_t ulFailed = 0;
+    
+    printf("soak: %lu frames in %.3f s virtual, %s\n", (unsigned long)xSoakStats.ulFrames, dSeconds,
+           (ulBurst == TRUE) ? "bursts" : "single");
+    printf("%-24s %10s %10s\n", "", "driver", "radio");
+    printf("%-24s %10lu %10lu\n", "payloads", (unsigned long)xRadioStats.ulPayloads,
+           (unsigned long)(xVradioStats.ulAcked + xVradioStats.ulMaxRt));
+    printf("%-24s %10lu %10lu\n", "retransmits", (unsigned long)xRadioStats.ulRetransmits,
+           (unsigned long)xVradioStats.ulRetransmits);
+    printf("%-24s %10lu %10lu\n", "max rt", (unsigned long)xRadioStats.ulLostPayloads, (unsigned long)xVradioStats.ulMaxRt);
+    printf("%-24s %10lu %10lu\n", "ack payloads", (unsigned long)xRadioStats.ulAckPayloads,
+           (unsigned long)xVradioStats.ulAckPayloads);
+    printf("%-24s %10lu %10lu\n", "airtime us", (unsigned long)xRadioStats.ulAirtimeUs,
+           (unsigned long)(xVradioStats.ullTxCycles / (SOC_BUS_CLOCK_HZ / 1000000)));
+    printf("%-24s %10lu\n", "timeouts", (unsigned long)xRadioStats.ulTimeouts);
+    printf("%-24s %10lu\n", "spi transactions", (unsigned long)xSpiStats.ulTransactions);
+    printf("frames: acked %lu, dropped %lu, delivered %lu, duplicates %lu, lost packets %lu, lost acks %lu\n",
+           (unsigned long)xSoakStats.ulAcked, (unsigned long)xSoakStats.ulDropped, (unsigned long)xVradioStats.ulDelivered,
+           (unsigned long)xVradioStats.ulDuplicates, (unsigned long)xVradioStats.ulLostPackets,
+           (unsigned long)xVradioStats.ulLostAcks);
+    printf("throughput %.0f B/s, radio on %.1f %%, air %.1f %%\n",
+           (double)xVradioStats.ulDeliveredBytes / dSeconds,
+           100.0 * (double)(xVradioStats.ullTxCycles + xVradioStats.ullRxCycles) / (double)xSoakStats.ullCycles,
+           100.0 * (double)xVradioStats.ullAirCycles / (double)xSoakStats.ullCycles);
+    printf("commands: payloads %lu, commands %lu, errors %lu, gaps %lu\n", (unsigned long)xSoakStats.ulCommandPayloads,
+           (unsigned long)xSoakStats.ulCommands, (unsigned long)xSoakStats.ulCommandErrors,
+           (unsigned long)xSoakStats.ulCommandGaps);
+    
+    ulFailed += ulCheck("no command errors", xVradioStats.ulCommandErrors == 0);
+    ulFailed += ulCheck("no short CE pulses", xVradioStats.ulShortPulses == 0);
+    ulFailed += ulCheck("no rejected packets", xVradioStats.ulRejected == 0);
+    ulFailed += ulCheck("no timeouts", xRadioStats.ulTimeouts == 0);
+    ulFailed += ulCheck("payload outcomes match", xRadioStats.ulPayloads == xVradioStats.ulAcked + xVradioStats.ulMaxRt);
+    ulFailed += ulCheck("max rt matches", xRadioStats.ulLostPayloads == xVradioStats.ulMaxRt);
+    ulFailed += ulCheck("retransmits match", (ulBurst == TRUE) ? (xRadioStats.ulRetransmits <= xVradioStats.ulRetransmits)
+                                                                : (xRadioStats.ulRetransmits == xVradioStats.ulRetransmits));
+    ulFailed += ulCheck("ack payloads match", xRadioStats.ulAckPayloads == xVradioStats.ulAckPayloads);
+    ulFailed += ulCheck("commands decode", xSoakStats.ulCommandErrors == 0);
+    ulFailed += ulCheck("acked frames delivered", (xSoakStats.ulAcked <= xVradioStats.ulDelivered)
+                                                  && (xVradioStats.ulDelivered <= xSoakStats.ulWrites));
+    
+    if (ulLossy == FALSE)
+    {
+        ulFailed += ulCheck("all frames acked", xSoakStats.ulAcked == xSoakStats.ulFrames);
+        ulFailed += ulCheck("all frames decoded", (pxDecoder->ulFrames == xSoakStats.ulFrames) && (pxDecoder->ulErrors == 0));
+        ulFailed += ulCheck("no command gaps", xSoakStats.ulCommandGaps == 0);
+    }
+    
+    return (ulFailed == 0) ? 0 : 1;
+}
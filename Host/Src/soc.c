@@ -0,0 +1,598 @@
+/**
+ * soc.c
+ * This file runs the virtual bus clock, timed events and the NVIC of
+ * the host build.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MKL25Z4.h"
+
+
+/* Local defines */
+#define EXCEPTION(irqn)                 ((uint32_t)((int32_t)(irqn) + 16))
+#define FIRST_INTERRUPT                 (16UL)
+#define PRIORITY_SHIFT                  (8UL - SOC_PRIORITY_BITS)
+
+typedef void (*SOC_Handler)(void);
+
+
+/* Handlers the firmware may define, NULL when it doesn't */
+extern void HardFault_Handler(void) __attribute__((weak));
+extern void PendSV_Handler(void) __attribute__((weak));
+extern void SysTick_Handler(void) __attribute__((weak));
+extern void DMA0_IRQHandler(void) __attribute__((weak));
+extern void DMA1_IRQHandler(void) __attribute__((weak));
+extern void DMA2_IRQHandler(void) __attribute__((weak));
+extern void DMA3_IRQHandler(void) __attribute__((weak));
+extern void FTFA_IRQHandler(void) __attribute__((weak));
+extern void SPI1_IRQHandler(void) __attribute__((weak));
+extern void ADC0_IRQHandler(void) __attribute__((weak));
+extern void CMP0_IRQHandler(void) __attribute__((weak));
+extern void TPM0_IRQHandler(void) __attribute__((weak));
+extern void TPM1_IRQHandler(void) __attribute__((weak));
+extern void TPM2_IRQHandler(void) __attribute__((weak));
+extern void PIT_IRQHandler(void) __attribute__((weak));
+extern void LPTimer_IRQHandler(void) __attribute__((weak));
+extern void PORTA_IRQHandler(void) __attribute__((weak));
+extern void PORTD_IRQHandler(void) __attribute__((weak));
+
+
+/* Global variables */
+uint32_t SystemCoreClock = SOC_CORE_CLOCK_HZ;
+
+
+/* Local variables */
+static SOC_Handler const pxVectors[SOC_EXCEPTION_COUNT] =
+{
+    [EXCEPTION(HardFault_IRQn)]     = HardFault_Handler,
+    [EXCEPTION(PendSV_IRQn)]        = PendSV_Handler,
+    [EXCEPTION(SysTick_IRQn)]       = SysTick_Handler,
+    [EXCEPTION(DMA0_IRQn)]          = DMA0_IRQHandler,
+    [EXCEPTION(DMA1_IRQn)]          = DMA1_IRQHandler,
+    [EXCEPTION(DMA2_IRQn)]          = DMA2_IRQHandler,
+    [EXCEPTION(DMA3_IRQn)]          = DMA3_IRQHandler,
+    [EXCEPTION(FTFA_IRQn)]          = FTFA_IRQHandler,
+    [EXCEPTION(SPI1_IRQn)]          = SPI1_IRQHandler,
+    [EXCEPTION(ADC0_IRQn)]          = ADC0_IRQHandler,
+    [EXCEPTION(CMP0_IRQn)]          = CMP0_IRQHandler,
+    [EXCEPTION(TPM0_IRQn)]          = TPM0_IRQHandler,
+    [EXCEPTION(TPM1_IRQn)]          = TPM1_IRQHandler,
+    [EXCEPTION(TPM2_IRQn)]          = TPM2_IRQHandler,
+    [EXCEPTION(PIT_IRQn)]           = PIT_IRQHandler,
+    [EXCEPTION(LPTimer_IRQn)]       = LPTimer_IRQHandler,
+    [EXCEPTION(PORTA_IRQn)]         = PORTA_IRQHandler,
+    [EXCEPTION(PORTD_IRQn)]         = PORTD_IRQHandler,
+};
+
+static uint64_t ullNow = 0;                 /* Bus clock cycles */
+static struct SOC_Event *pxEvents = NULL;   /* Sorted by time */
+static struct SOC_Model *pxModels = NULL;
+static struct SOC_Model *pxLastModel = NULL;
+
+static uint8_t ucPriorities[SOC_EXCEPTION_COUNT];
+static uint64_t ullPending = 0;             /* Bit per exception number */
+static uint64_t ullEnabled = (1ULL << FIRST_INTERRUPT) - 1;    /* System exceptions can't be disabled */
+static uint32_t ulPrimask = 1;              /* Interrupts masked until scheduler starts */
+static uint32_t ulDispatching = 0;          /* Set by scheduler start */
+static int32_t lActivePriority = SOC_THREAD_PRIORITY;
+
+
+/* Local function prototypes */
+static void vRunEvents(const uint64_t ullUntil);
+static void vSyncModels(void);
+static uint32_t ulDispatch(void);
+static int32_t lHighestPending(void);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Read virtual time.
+ * 
+ * @param   None
+ * 
+ * @return  Bus clock cycles since start.
+ */
+uint64_t SOC_ullCycles(void)
+{
+    return ullNow;
+}
+
+
+/**
+ * @brief   Schedule event, or move it if it is already scheduled.
+ * 
+ * @param   pxEvent     Event with handler set.
+ * 
+ * @param   ullDelay    Bus clock cycles from now.
+ * 
+ * @return  None
+ */
+void SOC_vSchedule(struct SOC_Event *const pxEvent, const uint64_t ullDelay)
+{
+    struct SOC_Event **ppxLink = &pxEvents;
+    
+    SOC_vCancel(pxEvent);
+    
+    pxEvent->ullTime = ullNow + ullDelay;
+    pxEvent->ulQueued = 1;
+    
+    /* Events at the same time run in scheduling order */
+    while ((*ppxLink != NULL) && ((*ppxLink)->ullTime <= pxEvent->ullTime))
+    {
+        ppxLink = &(*ppxLink)->pxNext;
+    }
+    pxEvent->pxNext = *ppxLink;
+    *ppxLink = pxEvent;
+}
+
+
+/**
+ * @brief   Remove event from schedule, nothing happens if it isn't there.
+ * 
+ * @param   pxEvent     Event.
+ * 
+ * @return  None
+ */
+void SOC_vCancel(struct SOC_Event *const pxEvent)
+{
+    struct SOC_Event **ppxLink = &pxEvents;
+    
+    if (pxEvent->ulQueued == 0)
+    {
+        return;
+    }
+    
+    while (*ppxLink != pxEvent)
+    {
+        ppxLink = &(*ppxLink)->pxNext;
+    }
+    *ppxLink = pxEvent->pxNext;
+    pxEvent->ulQueued = 0;
+}
+
+
+/**
+ * @brief   Let time pass, e.g. for a bus access or a busy wait. Events
+ *          that fall due run and interrupts they raise are taken.
+ * 
+ * @param   ullCycles   Bus clock cycles.
+ * 
+ * @return  None
+ */
+void SOC_vConsume(const uint64_t ullCycles)
+{
+    const uint64_t ullUntil = ullNow + ullCycles;
+    
+    vSyncModels();
+    vRunEvents(ullUntil);
+    
+    /* Taken interrupts may have switched tasks and let more time pass */
+    if (ullNow < ullUntil)
+    {
+        ullNow = ullUntil;
+    }
+    
+    SOC_vSync();
+}
+
+
+/**
+ * @brief   Let models pick up register writes and take interrupts that
+ *          are due.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void SOC_vSync(void)
+{
+    vSyncModels();
+    (void)ulDispatch();
+}
+
+
+/**
+ * @brief   Sleep until an interrupt is taken, like WFI with PRIMASK
+ *          clear. Returns without an interrupt if one is pending but
+ *          masked, like WFI does.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void SOC_vWaitForInterrupt(void)
+{
+    vSyncModels();
+    
+    for (;;)
+    {
+        if (ulDispatch() != 0)
+        {
+            return;
+        }
+        
+        if ((ullPending & ullEnabled) != 0)
+        {
+            return;
+        }
+        
+        if (pxEvents == NULL)
+        {
+            fprintf(stderr, "soc: waiting for interrupt with nothing scheduled at cycle %llu\n", (unsigned long long)ullNow);
+            abort();
+        }
+        
+        vRunEvents(pxEvents->ullTime);
+        vSyncModels();
+    }
+}
+
+
+/**
+ * @brief   Register model. Sync handlers run in registration order, so
+ *          register GPIO before peripherals that sample pins.
+ * 
+ * @param   pxModel     Model, must stay valid.
+ * 
+ * @return  None
+ */
+void SOC_vAddModel(struct SOC_Model *const pxModel)
+{
+    pxModel->pxNext = NULL;
+    
+    if (pxLastModel == NULL)
+    {
+        pxModels = pxModel;
+    }
+    else
+    {
+        pxLastModel->pxNext = pxModel;
+    }
+    pxLastModel = pxModel;
+}
+
+
+/**
+ * @brief   Bus access of a register block, see MKL25Z4.h.
+ * 
+ * @param   pvBlock     Register block memory.
+ * 
+ * @return  pvBlock
+ */
+void *SOC_pvAccess(void *const pvBlock)
+{
+    SOC_vConsume(SOC_ACCESS_CYCLES);
+    
+    return pvBlock;
+}
+
+
+/**
+ * @brief   Pend exception from a model. Taken on next sync.
+ * 
+ * @param   lIRQn       IRQn_Type
+ * 
+ * @return  None
+ */
+void SOC_vSetPending(const int32_t lIRQn)
+{
+    ullPending |= 1ULL << EXCEPTION(lIRQn);
+}
+
+
+/**
+ * @brief   Set PRIMASK.
+ * 
+ * @param   None
+ * 
+ * @return  Previous PRIMASK.
+ */
+uint32_t SOC_ulDisableInterrupts(void)
+{
+    const uint32_t ulPrevious = ulPrimask;
+    
+    ulPrimask = 1;
+    
+    return ulPrevious;
+}
+
+
+/**
+ * @brief   Restore PRIMASK, pending interrupts are taken when it clears.
+ * 
+ * @param   ulMask      PRIMASK from SOC_ulDisableInterrupts().
+ * 
+ * @return  None
+ */
+void SOC_vRestoreInterrupts(const uint32_t ulMask)
+{
+    ulPrimask = ulMask;
+    
+    if (ulMask == 0)
+    {
+        (void)ulDispatch();
+    }
+}
+
+
+/**
+ * @brief   Read PRIMASK.
+ * 
+ * @param   None
+ * 
+ * @return  1 if interrupts are masked.
+ */
+uint32_t SOC_ulInterruptsMasked(void)
+{
+    return ulPrimask;
+}
+
+
+/**
+ * @brief   Tell whether an exception handler is running.
+ * 
+ * @param   None
+ * 
+ * @return  1 in handler mode, 0 in thread mode.
+ */
+uint32_t SOC_ulInHandler(void)
+{
+    return (lActivePriority != SOC_THREAD_PRIORITY) ? 1 : 0;
+}
+
+
+/**
+ * @brief   Start taking interrupts. Called when the scheduler starts,
+ *          until then they stay pending.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void SOC_vStartDispatch(void)
+{
+    ulDispatching = 1;
+}
+
+
+/**
+ * @brief   Stop taking interrupts, e.g. when the scheduler ends.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void SOC_vStopDispatch(void)
+{
+    ulDispatching = 0;
+}
+
+
+/**
+ * @brief   Return from exception to a task that starts running, its
+ *          stack has no handler frames to unwind.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void SOC_vReturnToThread(void)
+{
+    lActivePriority = SOC_THREAD_PRIORITY;
+}
+
+
+/**
+ * @brief   Set exception priority, like CMSIS only the upper bits are kept.
+ * 
+ * @param   xIRQn       Exception.
+ * 
+ * @param   ulPriority  0...3, 0 is the highest.
+ * 
+ * @return  None
+ */
+void NVIC_SetPriority(const IRQn_Type xIRQn, const uint32_t ulPriority)
+{
+    ucPriorities[EXCEPTION(xIRQn)] = (uint8_t)(ulPriority << PRIORITY_SHIFT);
+}
+
+
+/**
+ * @brief   Read exception priority.
+ * 
+ * @param   xIRQn       Exception.
+ * 
+ * @return  0...3
+ */
+uint32_t NVIC_GetPriority(const IRQn_Type xIRQn)
+{
+    return (uint32_t)ucPriorities[EXCEPTION(xIRQn)] >> PRIORITY_SHIFT;
+}
+
+
+/**
+ * @brief   Enable interrupt, it is taken right away if pending.
+ * 
+ * @param   xIRQn       Interrupt.
+ * 
+ * @return  None
+ */
+void NVIC_EnableIRQ(const IRQn_Type xIRQn)
+{
+    ullEnabled |= 1ULL << EXCEPTION(xIRQn);
+    (void)ulDispatch();
+}
+
+
+/**
+ * @brief   Disable interrupt, pending state is kept.
+ * 
+ * @param   xIRQn       Interrupt.
+ * 
+ * @return  None
+ */
+void NVIC_DisableIRQ(const IRQn_Type xIRQn)
+{
+    if (EXCEPTION(xIRQn) >= FIRST_INTERRUPT)
+    {
+        ullEnabled &= ~(1ULL << EXCEPTION(xIRQn));
+    }
+}
+
+
+/**
+ * @brief   Pend interrupt from software.
+ * 
+ * @param   xIRQn       Interrupt.
+ * 
+ * @return  None
+ */
+void NVIC_SetPendingIRQ(const IRQn_Type xIRQn)
+{
+    SOC_vSetPending(xIRQn);
+    (void)ulDispatch();
+}
+
+
+/**
+ * @brief   Clear pending interrupt.
+ * 
+ * @param   xIRQn       Interrupt.
+ * 
+ * @return  None
+ */
+void NVIC_ClearPendingIRQ(const IRQn_Type xIRQn)
+{
+    ullPending &= ~(1ULL << EXCEPTION(xIRQn));
+}
+
+
+/**
+ * @brief   Read pending state of interrupt.
+ * 
+ * @param   xIRQn       Interrupt.
+ * 
+ * @return  1 if pending.
+ */
+uint32_t NVIC_GetPendingIRQ(const IRQn_Type xIRQn)
+{
+    return (uint32_t)((ullPending >> EXCEPTION(xIRQn)) & 1);
+}
+
+
+/**
+ * @brief   Run events due until given time, time follows each event.
+ * 
+ * @param   ullUntil    Bus clock cycle.
+ * 
+ * @return  None
+ */
+static void vRunEvents(const uint64_t ullUntil)
+{
+    struct SOC_Event *pxEvent;
+    
+    while ((pxEvents != NULL) && (pxEvents->ullTime <= ullUntil))
+    {
+        pxEvent = pxEvents;
+        pxEvents = pxEvent->pxNext;
+        pxEvent->ulQueued = 0;
+        
+        if (pxEvent->ullTime > ullNow)
+        {
+            ullNow = pxEvent->ullTime;
+        }
+        
+        /* Handler may schedule it again */
+        pxEvent->pxHandler(pxEvent);
+    }
+}
+
+
+/**
+ * @brief   Run sync handlers of all models.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vSyncModels(void)
+{
+    for (struct SOC_Model *pxModel = pxModels; pxModel != NULL; pxModel = pxModel->pxNext)
+    {
+        if (pxModel->pxSync != NULL)
+        {
+            pxModel->pxSync();
+        }
+    }
+}
+
+
+/**
+ * @brief   Take pending exceptions that preempt the running code, highest
+ *          priority first. A handler may switch tasks, then this returns
+ *          when the interrupted task runs again.
+ * 
+ * @param   None
+ * 
+ * @return  Number of exceptions taken.
+ */
+static uint32_t ulDispatch(void)
+{
+    uint32_t ulTaken = 0;
+    int32_t lException;
+    int32_t lPrevious;
+    
+    while ((ulDispatching != 0) && (ulPrimask == 0))
+    {
+        lException = lHighestPending();
+        if ((lException < 0) || (ucPriorities[lException] >= lActivePriority))
+        {
+            break;
+        }
+        
+        if (pxVectors[lException] == NULL)
+        {
+            fprintf(stderr, "soc: no handler for exception %ld\n", (long)lException);
+            abort();
+        }
+        
+        ullPending &= ~(1ULL << lException);
+        lPrevious = lActivePriority;
+        lActivePriority = ucPriorities[lException];
+        
+        pxVectors[lException]();
+        
+        lActivePriority = lPrevious;
+        ulTaken++;
+    }
+    
+    return ulTaken;
+}
+
+
+/**
+ * @brief   Find enabled pending exception of highest priority, lowest
+ *          exception number wins a tie.
+ * 
+ * @param   None
+ * 
+ * @return  Exception number, -1 if none.
+ */
+static int32_t lHighestPending(void)
+{
+    uint64_t ullReady = ullPending & ullEnabled;
+    int32_t lHighest = -1;
+    
+    for (int32_t i = 0; ullReady != 0; i++, ullReady >>= 1)
+    {
+        if ((ullReady & 1) && ((lHighest < 0) || (ucPriorities[i] < ucPriorities[lHighest])))
+        {
+            lHighest = i;
+        }
+    }
+    
+    return lHighest;
+}
@@ -0,0 +1,373 @@
+/**
+ * spibench.c
+ * This file benchmarks nRF24L01_vSendPayload() over the real SPI1 and
+ * DMA drivers on the SPI1 and DMA0 models of the host build.
+ * 
+ * For each SPI1 baud rate of the sweep a payload is sent -n times and
+ * acked by the virtual nRF24L01+. Chip select PTE4 is watched to time
+ * how long each call holds the bus. Releasing it while SPI1 still has a
+ * byte to clock, or while the RX channel has bytes left, is counted as
+ * a cut transfer: the transaction was ended before DMA finished.
+ * 
+ * Build from repository root:
+ *  cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -IHost/Inc -IHost/Port -IRemote/Inc -IRemote/Drivers/Inc
+ *     -IRemote/FreeRTOS/include -no-pie -Wl,-Tdata=0x1FF00000 -Wl,--section-start=.peripherals=0x40000000
+ *     Host/Src/spibench.c Host/Src/vradio.c Host/Src/soc.c Host/Src/peripherals.c Host/Port/port.c
+ *     Remote/FreeRTOS/src/tasks.c Remote/FreeRTOS/src/queue.c Remote/FreeRTOS/src/list.c Remote/FreeRTOS/src/timers.c
+ *     Remote/FreeRTOS/src/event_groups.c Remote/FreeRTOS/src/heap_3.c Remote/Drivers/Src/nrf24l01.c
+ *     Remote/Drivers/Src/spi.c Remote/Drivers/Src/dma.c Remote/Drivers/Src/tpm.c Remote/Drivers/Src/pit.c
+ *     Remote/Src/benchmark.c -o spibench
+ * 
+ * Usage: spibench [-n sends per rate] [-l payload length]
+ * Exit status is 1 if a transfer was cut, a received byte was lost, the
+ * radio saw a bad command or a payload wasn't acked.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "command.h"
+#include "vradio.h"
+
+
+/* Local defines */
+#define SPIBENCH_SENDS                  (200UL)
+#define SPIBENCH_PAYLOAD_LEN            (NRF24L01_MAX_TX_PAYLOAD)
+#define SPIBENCH_TX_TIMEOUT_MS          (COMM_TX_TIMEOUT_MS)
+#define SPIBENCH_STACK_SIZE             (configMINIMAL_STACK_SIZE * 2)
+#define SPIBENCH_NRF24L01_MAX_HZ        (10000000UL)            /* SCK limit of the radio */
+#define SPIBENCH_CS_PIN                 (4UL)                   /* PTE4 */
+
+#define SPIBENCH_BR(sppr, spr)          (SPI_BR_SPPR(sppr) | SPI_BR_SPR(spr))
+#define SPIBENCH_BAUDRATE(br)           (BUS_CLOCK_HZ / ((((br) >> SPI_BR_SPPR_SHIFT) + 1UL) \
+                                         * (2UL << ((br) & SPI_BR_SPR_MASK))))
+
+/* Results of one baud rate */
+struct Spibench_Result
+{
+    uint32_t ulBr;                      /* SPI1 BR */
+    uint32_t ulCalls;
+    uint32_t ulBytes;                   /* Clocked during the calls */
+    uint32_t ulSelects;
+    uint32_t ulCuts;
+    uint32_t ulOverruns;
+    uint32_t ulNotAcked;
+    uint64_t ullCallCycles;
+    uint64_t ullMaxCallCycles;
+    uint64_t ullSelectCycles;           /* Chip select low during the calls */
+};
+
+
+/* Local variables */
+static const uint32_t ulRates[] =
+{
+    SPIBENCH_BR(0, 0),                  /* 12 MHz */
+    SPIBENCH_BR(0, 1),                  /* 6 MHz */
+    SPIBENCH_BR(2, 0),                  /* 4 MHz */
+    SPIBENCH_BR(3, 0),                  /* 3 MHz */
+    SPIBENCH_BR(SPI1_BR_SPPR, SPI1_BR_SPR), /* 2 MHz, driver default */
+    SPIBENCH_BR(7, 0),                  /* 1.5 MHz */
+    SPIBENCH_BR(2, 2),                  /* 1 MHz */
+    SPIBENCH_BR(2, 3),                  /* 500 kHz */
+};
+
+#define SPIBENCH_RATES                  (sizeof(ulRates) / sizeof(ulRates[0]))
+
+static struct Spibench_Result xResults[SPIBENCH_RATES];
+static struct Spibench_Result *pxCurrent = NULL;   /* Rate being measured */
+static uint32_t ulSends = SPIBENCH_SENDS;
+static uint32_t ulPayloadLength = SPIBENCH_PAYLOAD_LEN;
+static uint32_t ulInCall = FALSE;
+static uint64_t ullSelectStart;
+static uint32_t ulCutsOutside = 0;
+
+
+/* Local function prototypes */
+static void vBenchTask(void *const pvParam);
+static void vRunRate(struct Spibench_Result *const pxResult, const char *const pcPayload);
+static void vChipSelect(const uint32_t ulLevel, void *const pvContext);
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed);
+static uint32_t ulReport(void);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Parse options, run the sweep and print results.
+ * 
+ * @param   argc        Argument count.
+ * 
+ * @param   argv        Arguments.
+ * 
+ * @return  0 if all checks passed, else 1.
+ */
+int main(int argc, char **argv)
+{
+    struct VRADIO_Config xRadioConfig =
+    {
+        .ucChannel = NRF24L01_RF_CHANNEL,
+        .ulSeed = 1,
+    };
+    BaseType_t xCreated;
+    int lOption;
+    
+    while ((lOption = getopt(argc, argv, "n:l:")) != -1)
+    {
+        switch (lOption)
+        {
+            case 'n':
+                ulSends = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                ulPayloadLength = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n sends per rate] [-l payload length]\n", argv[0]);
+                return 1;
+        }
+    }
+    
+    if ((ulPayloadLength == 0) || (ulPayloadLength > SPIBENCH_PAYLOAD_LEN))
+    {
+        fprintf(stderr, "payload length must be 1...%lu\n", (unsigned long)SPIBENCH_PAYLOAD_LEN);
+        return 1;
+    }
+    
+    /* Gateway listens on the address of every pipe */
+    for (uint32_t i = 0; i < VRADIO_PIPES; i++)
+    {
+        const uint8_t ucAddress[VRADIO_ADDRESS_LEN] = { COMMAND_ADDRESS_BASE + i, 0x22, 0x33, 0x44, 0x55 };
+        
+        memcpy(xRadioConfig.ucAddress[i], ucAddress, VRADIO_ADDRESS_LEN);
+    }
+    
+    SOC_vPeripheralsInit();
+    VRADIO_vInit(&xRadioConfig);
+    SOC_vWatchPin(SOC_PORT_E, SPIBENCH_CS_PIN, vChipSelect, NULL);
+    
+    PIT_vInit();
+    TPM2_vInit();
+    SPI1_vInit();
+    
+    xCreated = xTaskCreate(vBenchTask, "Bench", SPIBENCH_STACK_SIZE, NULL, COMMTASKPRIORITY, NULL);
+    configASSERT(xCreated == pdPASS);
+    
+    vTaskStartScheduler();
+    
+    return (int)ulReport();
+}
+
+
+/**
+ * @brief   Idle hook, sleeps until the next interrupt so that virtual
+ *          time moves on.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void vApplicationIdleHook(void)
+{
+    BENCH_vIdleHook();
+    __WFI();
+}
+
+
+/**
+ * @brief   Benchmark task. Runs the sweep and ends the scheduler.
+ * 
+ * @param   pvParam     Unused.
+ * 
+ * @return  None
+ */
+static void vBenchTask(void *const pvParam)
+{
+    char cPayload[SPIBENCH_PAYLOAD_LEN];
+    
+    (void)pvParam;
+    
+    for (uint32_t i = 0; i < ulPayloadLength; i++)
+    {
+        cPayload[i] = (char)(i * 37 + 11);
+    }
+    
+    nRF24L01_vInit();
+    
+    for (uint32_t i = 0; i < SPIBENCH_RATES; i++)
+    {
+        xResults[i].ulBr = ulRates[i];
+        
+        /* Bus is idle between calls, change rate with SPI1 disabled */
+        SPI1->C1 &= ~SPI_C1_SPE_MASK;
+        SPI1->BR = (uint8_t)ulRates[i];
+        SPI1->C1 |= SPI_C1_SPE_MASK;
+        
+        vRunRate(&xResults[i], cPayload);
+    }
+    
+    vTaskEndScheduler();
+}
+
+
+/**
+ * @brief   Send payloads at the current rate and wait for their ACKs.
+ *          Only the vSendPayload() calls are timed.
+ * 
+ * @param   pxResult    Results of the rate.
+ * 
+ * @param   pcPayload   Payload.
+ * 
+ * @return  None
+ */
+static void vRunRate(struct Spibench_Result *const pxResult, const char *const pcPayload)
+{
+    const TickType_t xTimeout = pdMS_TO_TICKS(SPIBENCH_TX_TIMEOUT_MS);
+    uint64_t ullStart;
+    uint64_t ullCycles;
+    uint32_t ulBytes;
+    uint32_t ulOverruns;
+    
+    pxCurrent = pxResult;
+    
+    for (uint32_t i = 0; i < ulSends; i++)
+    {
+        ulBytes = xSocSpiStats.ulBytes;
+        ulOverruns = xSocSpiStats.ulOverruns;
+        ulInCall = TRUE;
+        ullStart = SOC_ullCycles();
+        
+        nRF24L01_vSendPayload(pcPayload, ulPayloadLength);
+        
+        ullCycles = SOC_ullCycles() - ullStart;
+        ulInCall = FALSE;
+        
+        pxResult->ulCalls++;
+        pxResult->ulBytes += xSocSpiStats.ulBytes - ulBytes;
+        pxResult->ulOverruns += xSocSpiStats.ulOverruns - ulOverruns;
+        pxResult->ullCallCycles += ullCycles;
+        if (ullCycles > pxResult->ullMaxCallCycles)
+        {
+            pxResult->ullMaxCallCycles = ullCycles;
+        }
+        
+        if (nRF24L01_ulWaitForTransmit(xTimeout) != NRF24L01_TX_ACKED)
+        {
+            pxResult->ulNotAcked++;
+            nRF24L01_vFlushTx();
+        }
+    }
+    
+    pxCurrent = NULL;
+}
+
+
+/**
+ * @brief   Chip select watcher. Times the calls and counts releases
+ *          before the transfer was clocked and moved.
+ * 
+ * @param   ulLevel     Level of PTE4, LOW selects.
+ * 
+ * @param   pvContext   Unused.
+ * 
+ * @return  None
+ */
+static void vChipSelect(const uint32_t ulLevel, void *const pvContext)
+{
+    const uint32_t ulRxLeft = xSocDma0.DMA[SPI1_RX_DMA_CHANNEL].DSR_BCR & DMA_DSR_BCR_BCR_MASK;
+    uint32_t ulCut;
+    
+    (void)pvContext;
+    
+    if (ulLevel == LOW)
+    {
+        ullSelectStart = SOC_ullCycles();
+        return;
+    }
+    
+    ulCut = (SOC_ulSpiBusy() != 0) || (ulRxLeft != 0);
+    
+    if (pxCurrent == NULL)
+    {
+        ulCutsOutside += ulCut;
+        return;
+    }
+    
+    pxCurrent->ulCuts += ulCut;
+    if (ulInCall == TRUE)
+    {
+        pxCurrent->ulSelects++;
+        pxCurrent->ullSelectCycles += SOC_ullCycles() - ullSelectStart;
+    }
+}
+
+
+/**
+ * @brief   Print result of a check.
+ * 
+ * @param   pcName      What was checked.
+ * 
+ * @param   ulPassed    Nonzero if it held.
+ * 
+ * @return  0 if passed, else 1.
+ */
+static uint32_t ulCheck(const char *const pcName, const uint32_t ulPassed)
+{
+    printf("%-44s %s\n", pcName, ulPassed ? "ok" : "FAILED");
+    
+    return ulPassed ? 0 : 1;
+}
+
+
+/**
+ * @brief   Print table of the sweep and check it.
+ * 
+ * @param   None
+ * 
+ * @return  Number of failed checks, 0 or 1 for exit status.
+ */
+static uint32_t ulReport(void)
+{
+    uint32_t ulCuts = ulCutsOutside;
+    uint32_t ulOverruns = 0;
+    uint32_t ulNotAcked = 0;
+    uint32_t ulFailed = 0;
+    
+    printf("spibench: %lu sends of %lu bytes per rate\n", (unsigned long)ulSends, (unsigned long)ulPayloadLength);
+    printf("%-10s %6s %8s %8s %8s %9s %9s %5s %8s\n", "sck", "bytes", "call us", "max us", "cs us", "bus B/s",
+           "call B/s", "cuts", "overruns");
+    
+    for (uint32_t i = 0; i < SPIBENCH_RATES; i++)
+    {
+        const struct Spibench_Result *const pxResult = &xResults[i];
+        const uint32_t ulBaudrate = SPIBENCH_BAUDRATE(pxResult->ulBr);
+        const double dCallSeconds = (double)pxResult->ullCallCycles / SOC_BUS_CLOCK_HZ;
+        const double dSelectSeconds = (double)pxResult->ullSelectCycles / SOC_BUS_CLOCK_HZ;
+        
+        if (pxResult->ulCalls == 0)
+        {
+            continue;
+        }
+        
+        printf("%7.3f%-3s %6lu %8.1f %8.1f %8.1f %9.0f %9.0f %5lu %8lu\n", ulBaudrate / 1e6,
+               (ulBaudrate > SPIBENCH_NRF24L01_MAX_HZ) ? "M*" : "M",
+               (unsigned long)(pxResult->ulBytes / pxResult->ulCalls),
+               1e6 * dCallSeconds / pxResult->ulCalls, (double)SOC_CYCLES_TO_US(pxResult->ullMaxCallCycles),
+               1e6 * dSelectSeconds / pxResult->ulCalls, (double)pxResult->ulBytes / dSelectSeconds,
+               (double)(ulPayloadLength * pxResult->ulCalls) / dCallSeconds, (unsigned long)pxResult->ulCuts,
+               (unsigned long)pxResult->ulOverruns);
+        
+        ulCuts += pxResult->ulCuts;
+        ulOverruns += pxResult->ulOverruns;
+        ulNotAcked += pxResult->ulNotAcked;
+    }
+    printf("* above the %lu MHz SCK limit of nRF24L01+\n", (unsigned long)(SPIBENCH_NRF24L01_MAX_HZ / 1000000UL));
+    
+    ulFailed += ulCheck("no transfers cut before DMA finished", ulCuts == 0);
+    ulFailed += ulCheck("no received bytes lost", ulOverruns == 0);
+    ulFailed += ulCheck("no command errors", xVradioStats.ulCommandErrors == 0);
+    ulFailed += ulCheck("all payloads acked", (ulNotAcked == 0) && (xVradioStats.ulAcked == ulSends * SPIBENCH_RATES));
+    
+    return (ulFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,1074 @@
+/**
+ * vradio.c
+ * This file models the nRF24L01+ of the node and the gateway it talks
+ * to, see vradio.h.
+ * 
+ * Not modelled: PRX mode of the node radio, power up delay, RPD and
+ * continuous wave. Commands the node can't use in PTX mode, like
+ * W_ACK_PAYLOAD, count as command errors. Gateway loads ACK payloads
+ * through its receiver instead of SPI.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "soc.h"
+#include "vradio.h"
+
+
+/* Local defines */
+#define CE_PIN                          (1UL)       /* PTA1 */
+#define IRQ_PIN                         (2UL)       /* PTA2 */
+#define CSN_PIN                         (4UL)       /* PTE4 */
+
+#define SETTLE_CYCLES                   (SOC_US(130))   /* TX and RX PLL settling */
+#define MIN_CE_PULSE_CYCLES             (SOC_US(10))
+#define ARD_CYCLES(ard)                 (SOC_US(((uint64_t)(ard) + 1) * 250))
+#define PREAMBLE_BITS                   (8UL)
+#define PCF_BITS                        (9UL)       /* Length 6, PID 2, NO_ACK 1 */
+#define FIFO_SIZE                       (3UL)
+
+/* Commands */
+#define R_REGISTER                      (0x00U)
+#define W_REGISTER                      (0x20U)
+#define REGISTER_MASK                   (0x1FU)
+#define R_RX_PAYLOAD                    (0x61U)
+#define W_TX_PAYLOAD                    (0xA0U)
+#define FLUSH_TX                        (0xE1U)
+#define FLUSH_RX                        (0xE2U)
+#define REUSE_TX_PL                     (0xE3U)
+#define R_RX_PL_WID                     (0x60U)
+#define W_ACK_PAYLOAD                   (0xA8U)     /* Low 3 bits are pipe */
+#define W_TX_PAYLOAD_NOACK              (0xB0U)
+#define NOP                             (0xFFU)
+
+/* Registers */
+#define CONFIG                          (0x00U)
+#define EN_AA                           (0x01U)
+#define EN_RXADDR                       (0x02U)
+#define SETUP_AW                        (0x03U)
+#define SETUP_RETR                      (0x04U)
+#define RF_CH                           (0x05U)
+#define RF_SETUP                        (0x06U)
+#define STATUS                          (0x07U)
+#define OBSERVE_TX                      (0x08U)
+#define RPD                             (0x09U)
+#define RX_ADDR_P0                      (0x0AU)
+#define RX_ADDR_P1                      (0x0BU)
+#define TX_ADDR                         (0x10U)
+#define FIFO_STATUS                     (0x17U)
+#define DYNPD                           (0x1CU)
+#define FEATURE                         (0x1DU)
+#define REGISTER_COUNT                  (0x1EU)
+
+/* Register bits */
+#define CONFIG_EN_CRC                   (0x08U)
+#define CONFIG_CRCO                     (0x04U)
+#define CONFIG_PWR_UP                   (0x02U)
+#define CONFIG_PRIM_RX                  (0x01U)
+#define STATUS_RX_DR                    (0x40U)
+#define STATUS_TX_DS                    (0x20U)
+#define STATUS_MAX_RT                   (0x10U)
+#define STATUS_FLAGS                    (STATUS_RX_DR | STATUS_TX_DS | STATUS_MAX_RT)   /* Same bits mask them in CONFIG */
+#define STATUS_RX_P_NO_EMPTY            (0x0EU)
+#define STATUS_TX_FULL                  (0x01U)
+#define RF_SETUP_RF_DR_LOW              (0x20U)
+#define RF_SETUP_RF_DR_HIGH             (0x08U)
+#define FIFO_STATUS_TX_REUSE            (0x40U)
+#define FIFO_STATUS_TX_FULL             (0x20U)
+#define FIFO_STATUS_TX_EMPTY            (0x10U)
+#define FIFO_STATUS_RX_FULL             (0x02U)
+#define FIFO_STATUS_RX_EMPTY            (0x01U)
+#define FEATURE_EN_DPL                  (0x04U)
+#define FEATURE_EN_ACK_PAY              (0x02U)
+#define FEATURE_EN_DYN_ACK              (0x01U)
+#define PIPE0                           (0x01U)     /* EN_AA, EN_RXADDR and DYNPD bit */
+
+#define SETUP_RETR_ARD(x)               (((x) >> 4) & 0x0FU)
+#define SETUP_RETR_ARC(x)               ((x) & 0x0FU)
+#define OBSERVE_TX_PLOS_MAX             (0xF0U)
+#define OBSERVE_TX_ARC_CNT              (0x0FU)
+
+/* Gateway radio, same packet format as the node is configured for by nrf24l01.c */
+#define GATEWAY_RF_SETUP_RATE           (RF_SETUP_RF_DR_HIGH)   /* 2 Mbps */
+#define GATEWAY_CRC                     (CONFIG_EN_CRC | CONFIG_CRCO)
+#define GATEWAY_SETUP_AW                (0x03U)     /* 5 bytes */
+
+enum Radio_States
+{
+    RADIO_STANDBY,                      /* Standby-I or -II, as CE tells */
+    RADIO_SETTLING,
+    RADIO_ON_AIR,
+    RADIO_WAITING_ACK                   /* Until ACK or ARD */
+};
+
+struct Radio_Payload
+{
+    uint8_t ucData[VRADIO_MAX_PAYLOAD];
+    uint8_t ucLength;
+    uint8_t ucNoAck;
+    uint8_t ucSent;                     /* Attempted, keeps its PID after MAX_RT */
+};
+
+struct Radio_Fifo
+{
+    struct Radio_Payload xSlots[FIFO_SIZE];
+    uint32_t ulHead;
+    uint32_t ulCount;
+};
+
+/* Gateway state of a pipe */
+struct Gateway_Pipe
+{
+    uint32_t ulSeen;                    /* Set after first packet */
+    uint8_t ucPid;                      /* Of latest packet */
+    uint16_t usCrc;
+    struct Radio_Payload xLoaded;       /* W_ACK_PAYLOAD for the next new packet */
+    struct Radio_Payload xSent;         /* Sent with latest ACK, sent again to a retransmit */
+};
+
+
+/* Global variables */
+struct VRADIO_Stats xVradioStats;
+
+
+/* Local variables */
+static struct VRADIO_Config xConfig;
+static int lSocket = -1;
+
+/* Node radio */
+static uint8_t ucRegisters[REGISTER_COUNT];
+static uint8_t ucRxAddressP0[VRADIO_ADDRESS_LEN];
+static uint8_t ucRxAddressP1[VRADIO_ADDRESS_LEN];
+static uint8_t ucTxAddress[VRADIO_ADDRESS_LEN];
+static uint8_t ucFlags;                 /* STATUS RX_DR, TX_DS and MAX_RT */
+static uint8_t ucObserve;               /* OBSERVE_TX */
+static uint8_t ucPid;
+static uint32_t ulReuse;                /* REUSE_TX_PL active */
+static struct Radio_Fifo xTxFifo;
+static struct Radio_Fifo xRxFifo;
+
+static uint32_t ulState = RADIO_STANDBY;
+static uint64_t ullStateStart;
+static struct SOC_Event xRadioEvent;
+static uint32_t ulChipEnable;
+static uint64_t ullChipEnableRise;
+static uint32_t ulPulseStarted;         /* Packet started by latest CE rising edge */
+static uint32_t ulFlushedOnAir;         /* TX FIFO flushed during a packet */
+static struct Radio_Payload xOnAir;     /* Copy of packet sent */
+static uint32_t ulAckComing;            /* ACK of the packet on air will be received */
+static struct Radio_Payload xAck;       /* Its payload */
+static uint32_t ulIrqLevel = 1;
+
+/* SPI frame */
+static uint32_t ulSelected;
+static uint32_t ulIndex;                /* Bytes clocked in this frame */
+static uint8_t ucCommand;
+static uint8_t ucFrameIn[VRADIO_MAX_PAYLOAD];
+static uint8_t ucFrameOut[VRADIO_MAX_PAYLOAD];
+
+/* Gateway */
+static struct Gateway_Pipe xPipes[VRADIO_PIPES];
+static uint32_t ulRandom;
+
+
+/* Local function prototypes */
+static void vReset(void);
+static uint8_t ucStatus(void);
+static uint32_t ulReadRegister(const uint8_t ucRegister, uint8_t *const pucValue);
+static void vWriteRegister(const uint8_t ucRegister, const uint8_t *const pucValue, const uint32_t ulLength);
+static void vPrepare(void);
+static void vExecute(void);
+static void vUpdateIrq(void);
+static void vChipSelect(const uint32_t ulLevel, void *const pvContext);
+static void vChipEnable(const uint32_t ulLevel, void *const pvContext);
+static void vNextPacket(void);
+static void vStartAttempt(void);
+static void vRadioEvent(struct SOC_Event *const pxEvent);
+static void vAckReceived(void);
+static uint64_t ullPacketCycles(const uint32_t ulPayload);
+static uint32_t ulGatewayReceive(const struct Radio_Payload *const pxPacket);
+static uint32_t ulSocketReceiver(const uint32_t ulPipe, const uint8_t *const pucPayload, const uint32_t ulLength,
+                                 uint8_t *const pucAck);
+static uint32_t ulLost(void);
+static uint16_t usCrc16(const uint8_t *const pucData, const uint32_t ulLength);
+static struct Radio_Payload *pxFifoHead(struct Radio_Fifo *const pxFifo);
+static struct Radio_Payload *pxFifoPush(struct Radio_Fifo *const pxFifo);
+static void vFifoPop(struct Radio_Fifo *const pxFifo);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Reset radio and gateway, connect SPI1, CSN, CE and IRQ pins.
+ * 
+ * @param   pxConfig    Gateway end of the air.
+ * 
+ * @return  None
+ */
+void VRADIO_vInit(const struct VRADIO_Config *const pxConfig)
+{
+    xConfig = *pxConfig;
+    ulRandom = (xConfig.ulSeed != 0) ? xConfig.ulSeed : 1;
+    
+    memset(&xVradioStats, 0, sizeof(xVradioStats));
+    memset(xPipes, 0, sizeof(xPipes));
+    vReset();
+    
+    xRadioEvent.pxHandler = vRadioEvent;
+    SOC_vWatchPin(SOC_PORT_E, CSN_PIN, vChipSelect, NULL);
+    SOC_vWatchPin(SOC_PORT_A, CE_PIN, vChipEnable, NULL);
+    SOC_vConnectSpi(VRADIO_ucExchange);
+    SOC_vSetPin(SOC_PORT_A, IRQ_PIN, ulIrqLevel);
+}
+
+
+/**
+ * @brief   Connect gateway to a socket, payloads go there instead of
+ *          xConfig.pxReceiver.
+ * 
+ * @param   pcPath      UNIX-domain SOCK_SEQPACKET socket.
+ * 
+ * @return  0, or -1 if connecting failed.
+ */
+int32_t VRADIO_lConnect(const char *const pcPath)
+{
+    struct sockaddr_un xAddress = { .sun_family = AF_UNIX };
+    
+    if (strlen(pcPath) >= sizeof(xAddress.sun_path))
+    {
+        return -1;
+    }
+    strcpy(xAddress.sun_path, pcPath);
+    
+    lSocket = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if ((lSocket < 0) || (connect(lSocket, (struct sockaddr *)&xAddress, sizeof(xAddress)) != 0))
+    {
+        perror("vradio: connect");
+        return -1;
+    }
+    
+    xConfig.pxReceiver = ulSocketReceiver;
+    
+    return 0;
+}
+
+
+/**
+ * @brief   Clock one byte while CSN is low. First byte of a frame is the
+ *          command, STATUS is shifted out with it.
+ * 
+ * @param   ucMosi      Byte from MCU.
+ * 
+ * @return  Byte to MCU.
+ */
+uint8_t VRADIO_ucExchange(const uint8_t ucMosi)
+{
+    uint8_t ucMiso = NOP;
+    
+    if (ulSelected == 0)
+    {
+        return ucMiso;
+    }
+    
+    if (ulIndex == 0)
+    {
+        ucCommand = ucMosi;
+        ucMiso = ucStatus();
+        vPrepare();
+    }
+    else if (ulIndex <= VRADIO_MAX_PAYLOAD)
+    {
+        ucFrameIn[ulIndex - 1] = ucMosi;
+        ucMiso = ucFrameOut[ulIndex - 1];
+    }
+    
+    ulIndex++;
+    
+    return ucMiso;
+}
+
+
+/**
+ * @brief   Power on reset values.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vReset(void)
+{
+    memset(ucRegisters, 0, sizeof(ucRegisters));
+    ucRegisters[CONFIG] = CONFIG_EN_CRC;
+    ucRegisters[EN_AA] = 0x3F;
+    ucRegisters[EN_RXADDR] = 0x03;
+    ucRegisters[SETUP_AW] = 0x03;
+    ucRegisters[SETUP_RETR] = 0x03;
+    ucRegisters[RF_CH] = 0x02;
+    ucRegisters[RF_SETUP] = 0x0E;
+    ucRegisters[RX_ADDR_P1 + 1] = 0xC3;
+    ucRegisters[RX_ADDR_P1 + 2] = 0xC4;
+    ucRegisters[RX_ADDR_P1 + 3] = 0xC5;
+    ucRegisters[RX_ADDR_P1 + 4] = 0xC6;
+    memset(ucRxAddressP0, 0xE7, VRADIO_ADDRESS_LEN);
+    memset(ucRxAddressP1, 0xC2, VRADIO_ADDRESS_LEN);
+    memset(ucTxAddress, 0xE7, VRADIO_ADDRESS_LEN);
+    
+    ucFlags = 0;
+    ucObserve = 0;
+    ulReuse = 0;
+    memset(&xTxFifo, 0, sizeof(xTxFifo));
+    memset(&xRxFifo, 0, sizeof(xRxFifo));
+}
+
+
+/**
+ * @brief   Compose STATUS.
+ * 
+ * @param   None
+ * 
+ * @return  STATUS
+ */
+static uint8_t ucStatus(void)
+{
+    uint8_t ucValue = ucFlags;
+    
+    /* ACK payloads arrive on pipe 0 */
+    ucValue |= (xRxFifo.ulCount == 0) ? STATUS_RX_P_NO_EMPTY : 0;
+    ucValue |= (xTxFifo.ulCount == FIFO_SIZE) ? STATUS_TX_FULL : 0;
+    
+    return ucValue;
+}
+
+
+/**
+ * @brief   Read register.
+ * 
+ * @param   ucRegister  Register.
+ * 
+ * @param   pucValue    Room for 5 bytes.
+ * 
+ * @return  Bytes in register.
+ */
+static uint32_t ulReadRegister(const uint8_t ucRegister, uint8_t *const pucValue)
+{
+    switch (ucRegister)
+    {
+        case STATUS:
+            pucValue[0] = ucStatus();
+            break;
+        case OBSERVE_TX:
+            pucValue[0] = ucObserve;
+            break;
+        case RX_ADDR_P0:
+            memcpy(pucValue, ucRxAddressP0, VRADIO_ADDRESS_LEN);
+            return VRADIO_ADDRESS_LEN;
+        case RX_ADDR_P1:
+            memcpy(pucValue, ucRxAddressP1, VRADIO_ADDRESS_LEN);
+            return VRADIO_ADDRESS_LEN;
+        case TX_ADDR:
+            memcpy(pucValue, ucTxAddress, VRADIO_ADDRESS_LEN);
+            return VRADIO_ADDRESS_LEN;
+        case FIFO_STATUS:
+            pucValue[0] = (ulReuse ? FIFO_STATUS_TX_REUSE : 0)
+                          | ((xTxFifo.ulCount == FIFO_SIZE) ? FIFO_STATUS_TX_FULL : 0)
+                          | ((xTxFifo.ulCount == 0) ? FIFO_STATUS_TX_EMPTY : 0)
+                          | ((xRxFifo.ulCount == FIFO_SIZE) ? FIFO_STATUS_RX_FULL : 0)
+                          | ((xRxFifo.ulCount == 0) ? FIFO_STATUS_RX_EMPTY : 0);
+            break;
+        default:
+            pucValue[0] = (ucRegister < REGISTER_COUNT) ? ucRegisters[ucRegister] : 0;
+            break;
+    }
+    
+    return 1;
+}
+
+
+/**
+ * @brief   Write register.
+ * 
+ * @param   ucRegister  Register.
+ * 
+ * @param   pucValue    Bytes clocked in after command.
+ * 
+ * @param   ulLength    1...5
+ * 
+ * @return  None
+ */
+static void vWriteRegister(const uint8_t ucRegister, const uint8_t *const pucValue, const uint32_t ulLength)
+{
+    const uint32_t ulAddressLength = (ulLength < VRADIO_ADDRESS_LEN) ? ulLength : VRADIO_ADDRESS_LEN;
+    
+    switch (ucRegister)
+    {
+        case STATUS:
+            ucFlags &= (uint8_t)~(pucValue[0] & STATUS_FLAGS);
+            break;
+        case OBSERVE_TX:
+        case RPD:
+        case FIFO_STATUS:
+            break;
+        case RX_ADDR_P0:
+            memcpy(ucRxAddressP0, pucValue, ulAddressLength);
+            break;
+        case RX_ADDR_P1:
+            memcpy(ucRxAddressP1, pucValue, ulAddressLength);
+            break;
+        case TX_ADDR:
+            memcpy(ucTxAddress, pucValue, ulAddressLength);
+            break;
+        case RF_CH:
+            /* Writing RF_CH resets lost packet count */
+            ucRegisters[RF_CH] = pucValue[0] & 0x7FU;
+            ucObserve &= OBSERVE_TX_ARC_CNT;
+            break;
+        default:
+            if (ucRegister < REGISTER_COUNT)
+            {
+                ucRegisters[ucRegister] = pucValue[0];
+            }
+            else
+            {
+                xVradioStats.ulCommandErrors++;
+            }
+            break;
+    }
+    
+    vUpdateIrq();
+}
+
+
+/**
+ * @brief   Fill MISO bytes of a read command.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vPrepare(void)
+{
+    const struct Radio_Payload *const pxPayload = pxFifoHead(&xRxFifo);
+    
+    memset(ucFrameOut, 0, sizeof(ucFrameOut));
+    
+    if ((ucCommand & ~REGISTER_MASK) == R_REGISTER)
+    {
+        (void)ulReadRegister(ucCommand & REGISTER_MASK, ucFrameOut);
+    }
+    else if ((ucCommand == R_RX_PAYLOAD) && (pxPayload != NULL))
+    {
+        memcpy(ucFrameOut, pxPayload->ucData, pxPayload->ucLength);
+    }
+    else if ((ucCommand == R_RX_PL_WID) && (pxPayload != NULL))
+    {
+        ucFrameOut[0] = pxPayload->ucLength;
+    }
+}
+
+
+/**
+ * @brief   Run command when frame ends.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vExecute(void)
+{
+    const uint32_t ulLength = ulIndex - 1;
+    struct Radio_Payload *pxPayload;
+    
+    if ((ucCommand & ~REGISTER_MASK) == R_REGISTER)
+    {
+        return;
+    }
+    
+    if ((ucCommand & ~REGISTER_MASK) == W_REGISTER)
+    {
+        if (ulLength != 0)
+        {
+            vWriteRegister(ucCommand & REGISTER_MASK, ucFrameIn, ulLength);
+        }
+        return;
+    }
+    
+    switch (ucCommand)
+    {
+        case R_RX_PAYLOAD:
+            if ((ulLength == 0) || (xRxFifo.ulCount == 0))
+            {
+                xVradioStats.ulCommandErrors++;
+                break;
+            }
+            vFifoPop(&xRxFifo);
+            break;
+        
+        case W_TX_PAYLOAD:
+        case W_TX_PAYLOAD_NOACK:
+            if ((ulLength == 0) || (ulLength > VRADIO_MAX_PAYLOAD)
+                || ((ucCommand == W_TX_PAYLOAD_NOACK) && ((ucRegisters[FEATURE] & FEATURE_EN_DYN_ACK) == 0)))
+            {
+                xVradioStats.ulCommandErrors++;
+                break;
+            }
+            pxPayload = pxFifoPush(&xTxFifo);
+            if (pxPayload == NULL)
+            {
+                xVradioStats.ulCommandErrors++;
+                break;
+            }
+            memcpy(pxPayload->ucData, ucFrameIn, ulLength);
+            pxPayload->ucLength = (uint8_t)ulLength;
+            pxPayload->ucNoAck = (ucCommand == W_TX_PAYLOAD_NOACK);
+            pxPayload->ucSent = 0;
+            ulReuse = 0;
+            
+            /* Standby-II sends it right away */
+            if ((ulState == RADIO_STANDBY) && ulChipEnable)
+            {
+                vNextPacket();
+            }
+            break;
+        
+        case FLUSH_TX:
+            xTxFifo.ulCount = 0;
+            ulReuse = 0;
+            ulFlushedOnAir = (ulState != RADIO_STANDBY);
+            break;
+        
+        case FLUSH_RX:
+            xRxFifo.ulCount = 0;
+            break;
+        
+        case REUSE_TX_PL:
+            ulReuse = 1;
+            break;
+        
+        case R_RX_PL_WID:
+        case NOP:
+            break;
+        
+        default:
+            /* W_ACK_PAYLOAD is for PRX mode, node radio is PTX */
+            xVradioStats.ulCommandErrors++;
+            break;
+    }
+    
+    vUpdateIrq();
+}
+
+
+/**
+ * @brief   Drive IRQ low while an unmasked flag is set.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vUpdateIrq(void)
+{
+    const uint32_t ulLevel = ((ucFlags & ~ucRegisters[CONFIG] & STATUS_FLAGS) == 0) ? 1 : 0;
+    
+    if (ulLevel != ulIrqLevel)
+    {
+        ulIrqLevel = ulLevel;
+        SOC_vSetPin(SOC_PORT_A, IRQ_PIN, ulLevel);
+    }
+}
+
+
+/**
+ * @brief   CSN pin watcher. Command of a frame takes effect when CSN
+ *          goes high.
+ * 
+ * @param   ulLevel     Pin level, LOW selects.
+ * 
+ * @param   pvContext   Unused.
+ * 
+ * @return  None
+ */
+static void vChipSelect(const uint32_t ulLevel, void *const pvContext)
+{
+    (void)pvContext;
+    
+    if ((ulLevel == 0) && (ulSelected == 0))
+    {
+        ulSelected = 1;
+        ulIndex = 0;
+    }
+    else if ((ulLevel != 0) && (ulSelected != 0))
+    {
+        ulSelected = 0;
+        if (ulIndex != 0)
+        {
+            vExecute();
+        }
+    }
+}
+
+
+/**
+ * @brief   CE pin handler. Rising edge starts a packet, falling edge
+ *          checks the pulse was long enough for it.
+ * 
+ * @param   ulLevel     Level of CE.
+ * 
+ * @param   pvContext   Unused.
+ * 
+ * @return  None
+ */
+static void vChipEnable(const uint32_t ulLevel, void *const pvContext)
+{
+    (void)pvContext;
+    
+    ulChipEnable = ulLevel;
+    
+    if (ulLevel)
+    {
+        ullChipEnableRise = SOC_ullCycles();
+        ulPulseStarted = 0;
+        if (ulState == RADIO_STANDBY)
+        {
+            vNextPacket();
+            ulPulseStarted = (ulState != RADIO_STANDBY);
+        }
+    }
+    else if (ulPulseStarted && ((SOC_ullCycles() - ullChipEnableRise) < MIN_CE_PULSE_CYCLES))
+    {
+        xVradioStats.ulShortPulses++;
+    }
+}
+
+
+/**
+ * @brief   Start packet at head of TX FIFO if radio may transmit.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vNextPacket(void)
+{
+    if ((xTxFifo.ulCount == 0) || (ulChipEnable == 0) || (ucFlags & STATUS_MAX_RT)
+        || ((ucRegisters[CONFIG] & (CONFIG_PWR_UP | CONFIG_PRIM_RX)) != CONFIG_PWR_UP))
+    {
+        ulState = RADIO_STANDBY;
+        return;
+    }
+    
+    /**
+     * PID only changes for a new payload. One sent again after MAX_RT or
+     * reused keeps it, so gateway drops it as a duplicate.
+     */
+    if ((ulReuse == 0) && (pxFifoHead(&xTxFifo)->ucSent == 0))
+    {
+        ucPid = (ucPid + 1) & 0x03U;
+        pxFifoHead(&xTxFifo)->ucSent = 1;
+        xVradioStats.ulPayloads++;
+    }
+    ucObserve &= (uint8_t)~OBSERVE_TX_ARC_CNT;
+    ulFlushedOnAir = 0;
+    
+    vStartAttempt();
+}
+
+
+/**
+ * @brief   Start settling for one attempt of packet at head of TX FIFO.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vStartAttempt(void)
+{
+    xOnAir = *pxFifoHead(&xTxFifo);
+    ulState = RADIO_SETTLING;
+    ullStateStart = SOC_ullCycles();
+    xVradioStats.ulAttempts++;
+    
+    SOC_vSchedule(&xRadioEvent, SETTLE_CYCLES);
+}
+
+
+/**
+ * @brief   Step Enhanced ShockBurst state machine.
+ * 
+ * @param   pxEvent     Radio event.
+ * 
+ * @return  None
+ */
+static void vRadioEvent(struct SOC_Event *const pxEvent)
+{
+    const uint64_t ullElapsed = SOC_ullCycles() - ullStateStart;
+    uint64_t ullAckCycles;
+    uint64_t ullArdCycles;
+    
+    ullStateStart = SOC_ullCycles();
+    
+    switch (ulState)
+    {
+        case RADIO_SETTLING:
+            xVradioStats.ullTxCycles += ullElapsed;
+            ulState = RADIO_ON_AIR;
+            SOC_vSchedule(pxEvent, ullPacketCycles(xOnAir.ucLength));
+            break;
+        
+        case RADIO_ON_AIR:
+            xVradioStats.ullTxCycles += ullElapsed;
+            xVradioStats.ullAirCycles += ullElapsed;
+            
+            /* Packet went out even if TX FIFO was flushed meanwhile */
+            ulAckComing = ulGatewayReceive(&xOnAir);
+            
+            if (xOnAir.ucNoAck || ((ucRegisters[EN_AA] & PIPE0) == 0))
+            {
+                ulAckComing = 0;
+                vAckReceived();
+                break;
+            }
+            
+            /* ACK must be in before ARD, or the radio misses it */
+            ullAckCycles = SETTLE_CYCLES + ullPacketCycles(xAck.ucLength);
+            ullArdCycles = ARD_CYCLES(SETUP_RETR_ARD(ucRegisters[SETUP_RETR]));
+            if (ulAckComing && (ullAckCycles > ullArdCycles))
+            {
+                ulAckComing = 0;
+            }
+            
+            ulState = RADIO_WAITING_ACK;
+            SOC_vSchedule(pxEvent, ulAckComing ? ullAckCycles : ullArdCycles);
+            break;
+        
+        case RADIO_WAITING_ACK:
+            xVradioStats.ullRxCycles += ullElapsed;
+            if (ulAckComing)
+            {
+                vAckReceived();
+            }
+            else if ((ucObserve & OBSERVE_TX_ARC_CNT) < SETUP_RETR_ARC(ucRegisters[SETUP_RETR]))
+            {
+                ucObserve++;
+                xVradioStats.ulRetransmits++;
+                vStartAttempt();
+            }
+            else
+            {
+                if ((ucObserve & OBSERVE_TX_PLOS_MAX) != OBSERVE_TX_PLOS_MAX)
+                {
+                    ucObserve += 0x10U;
+                }
+                ucFlags |= STATUS_MAX_RT;
+                xVradioStats.ulMaxRt++;
+                ulState = RADIO_STANDBY;
+                vUpdateIrq();
+            }
+            break;
+        
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief   Packet was acked, or needed no ACK. Remove it from TX FIFO,
+ *          store ACK payload and go on with the next one.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vAckReceived(void)
+{
+    struct Radio_Payload *pxPayload;
+    
+    xVradioStats.ulAcked++;
+    
+    if ((ulReuse == 0) && (ulFlushedOnAir == 0))
+    {
+        vFifoPop(&xTxFifo);
+    }
+    
+    if (ulAckComing && (xAck.ucLength != 0))
+    {
+        pxPayload = pxFifoPush(&xRxFifo);
+        if (pxPayload == NULL)
+        {
+            xVradioStats.ulCommandErrors++;
+        }
+        else
+        {
+            *pxPayload = xAck;
+            ucFlags |= STATUS_RX_DR;
+            xVradioStats.ulAckPayloads++;
+            xVradioStats.ulAckPayloadBytes += xAck.ucLength;
+        }
+    }
+    
+    ucFlags |= STATUS_TX_DS;
+    vUpdateIrq();
+    
+    vNextPacket();
+}
+
+
+/**
+ * @brief   Time on air of a packet with current configuration.
+ * 
+ * @param   ulPayload   Payload bytes.
+ * 
+ * @return  Bus clock cycles.
+ */
+static uint64_t ullPacketCycles(const uint32_t ulPayload)
+{
+    const uint8_t ucSetup = ucRegisters[RF_SETUP];
+    const uint32_t ulAddressBits = (ucRegisters[SETUP_AW] + 2UL) * 8UL;
+    const uint32_t ulCrcBits = (ucRegisters[CONFIG] & CONFIG_EN_CRC) ? ((ucRegisters[CONFIG] & CONFIG_CRCO) ? 16 : 8) : 0;
+    const uint64_t ullBits = PREAMBLE_BITS + ulAddressBits + PCF_BITS + ulPayload * 8UL + ulCrcBits;
+    uint64_t ullCyclesPerBit;
+    
+    if (ucSetup & RF_SETUP_RF_DR_LOW)
+    {
+        ullCyclesPerBit = SOC_BUS_CLOCK_HZ / 250000ULL;
+    }
+    else if (ucSetup & RF_SETUP_RF_DR_HIGH)
+    {
+        ullCyclesPerBit = SOC_BUS_CLOCK_HZ / 2000000ULL;
+    }
+    else
+    {
+        ullCyclesPerBit = SOC_BUS_CLOCK_HZ / 1000000ULL;
+    }
+    
+    return ullBits * ullCyclesPerBit;
+}
+
+
+/**
+ * @brief   Gateway receives packet on air. Sets xAck to the ACK payload
+ *          that goes back.
+ * 
+ * @param   pxPacket    Packet.
+ * 
+ * @return  1 if the node gets an ACK.
+ */
+static uint32_t ulGatewayReceive(const struct Radio_Payload *const pxPacket)
+{
+    const uint8_t ucFormat = (uint8_t)(((ucRegisters[CONFIG] & GATEWAY_CRC) != GATEWAY_CRC)
+                                       || ((ucRegisters[RF_SETUP] & (RF_SETUP_RF_DR_LOW | RF_SETUP_RF_DR_HIGH)) != GATEWAY_RF_SETUP_RATE)
+                                       || (ucRegisters[SETUP_AW] != GATEWAY_SETUP_AW)
+                                       || ((ucRegisters[FEATURE] & FEATURE_EN_DPL) == 0)
+                                       || ((ucRegisters[DYNPD] & PIPE0) == 0));
+    const uint16_t usCrc = usCrc16(pxPacket->ucData, pxPacket->ucLength);
+    struct Gateway_Pipe *pxPipe = NULL;
+    uint32_t ulPipe;
+    
+    memset(&xAck, 0, sizeof(xAck));
+    
+    for (ulPipe = 0; ulPipe < VRADIO_PIPES; ulPipe++)
+    {
+        if (memcmp(ucTxAddress, xConfig.ucAddress[ulPipe], VRADIO_ADDRESS_LEN) == 0)
+        {
+            pxPipe = &xPipes[ulPipe];
+            break;
+        }
+    }
+    
+    if ((pxPipe == NULL) || ucFormat || (ucRegisters[RF_CH] != xConfig.ucChannel))
+    {
+        xVradioStats.ulRejected++;
+        return 0;
+    }
+    
+    if (ulLost())
+    {
+        xVradioStats.ulLostPackets++;
+        return 0;
+    }
+    
+    if (pxPipe->ulSeen && (pxPipe->ucPid == ucPid) && (pxPipe->usCrc == usCrc))
+    {
+        /* Retransmit after a lost ACK gets the same ACK payload */
+        xVradioStats.ulDuplicates++;
+    }
+    else
+    {
+        pxPipe->ulSeen = 1;
+        pxPipe->ucPid = ucPid;
+        pxPipe->usCrc = usCrc;
+        pxPipe->xSent = pxPipe->xLoaded;
+        memset(&pxPipe->xLoaded, 0, sizeof(pxPipe->xLoaded));
+        
+        xVradioStats.ulDelivered++;
+        xVradioStats.ulDeliveredBytes += pxPacket->ucLength;
+        
+        if (xConfig.pxReceiver != NULL)
+        {
+            pxPipe->xLoaded.ucLength = (uint8_t)xConfig.pxReceiver(ulPipe, pxPacket->ucData, pxPacket->ucLength,
+                                                                   pxPipe->xLoaded.ucData);
+        }
+    }
+    xAck = pxPipe->xSent;
+    
+    if (pxPacket->ucNoAck)
+    {
+        return 0;
+    }
+    
+    if (ulLost())
+    {
+        xVradioStats.ulLostAcks++;
+        return 0;
+    }
+    
+    /* Node listens for the ACK on pipe 0 with the TX address */
+    if (((ucRegisters[EN_RXADDR] & PIPE0) == 0) || (memcmp(ucRxAddressP0, ucTxAddress, VRADIO_ADDRESS_LEN) != 0)
+        || ((xAck.ucLength != 0) && ((ucRegisters[FEATURE] & FEATURE_EN_ACK_PAY) == 0)))
+    {
+        xVradioStats.ulRejected++;
+        return 0;
+    }
+    
+    return 1;
+}
+
+
+/**
+ * @brief   Receiver that passes payloads to a gateway process.
+ * 
+ * @param   ulPipe      Gateway pipe.
+ * 
+ * @param   pucPayload  Payload.
+ * 
+ * @param   ulLength    Payload length.
+ * 
+ * @param   pucAck      Room for ACK payload.
+ * 
+ * @return  ACK payload length.
+ */
+static uint32_t ulSocketReceiver(const uint32_t ulPipe, const uint8_t *const pucPayload, const uint32_t ulLength,
+                                 uint8_t *const pucAck)
+{
+    uint8_t ucDatagram[VRADIO_DATAGRAM_MAX];
+    ssize_t lReceived;
+    
+    ucDatagram[0] = (uint8_t)ulPipe;
+    memcpy(&ucDatagram[1], pucPayload, ulLength);
+    
+    if (send(lSocket, ucDatagram, ulLength + 1, 0) != (ssize_t)(ulLength + 1))
+    {
+        perror("vradio: send");
+        exit(EXIT_FAILURE);
+    }
+    
+    lReceived = recv(lSocket, ucDatagram, sizeof(ucDatagram), 0);
+    if ((lReceived < 1) || (ucDatagram[0] != ulPipe))
+    {
+        fprintf(stderr, "vradio: gateway did not answer pipe %lu\n", (unsigned long)ulPipe);
+        exit(EXIT_FAILURE);
+    }
+    
+    memcpy(pucAck, &ucDatagram[1], (size_t)(lReceived - 1));
+    
+    return (uint32_t)(lReceived - 1);
+}
+
+
+/**
+ * @brief   Draw packet loss.
+ * 
+ * @param   None
+ * 
+ * @return  1 if lost.
+ */
+static uint32_t ulLost(void)
+{
+    /* xorshift32 */
+    ulRandom ^= ulRandom << 13;
+    ulRandom ^= ulRandom >> 17;
+    ulRandom ^= ulRandom << 5;
+    
+    return ((ulRandom % 1000UL) < xConfig.ulLossPerMille) ? 1 : 0;
+}
+
+
+/**
+ * @brief   CRC-16/CCITT of payload, stands in for packet CRC.
+ * 
+ * @param   pucData     Payload.
+ * 
+ * @param   ulLength    Payload length.
+ * 
+ * @return  CRC
+ */
+static uint16_t usCrc16(const uint8_t *const pucData, const uint32_t ulLength)
+{
+    uint16_t usCrc = 0xFFFF;
+    
+    for (uint32_t i = 0; i < ulLength; i++)
+    {
+        usCrc ^= (uint16_t)(pucData[i] << 8);
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            usCrc = (usCrc & 0x8000) ? (uint16_t)((usCrc << 1) ^ 0x1021) : (uint16_t)(usCrc << 1);
+        }
+    }
+    
+    return usCrc;
+}
+
+
+/**
+ * @brief   Read oldest payload of FIFO.
+ * 
+ * @param   pxFifo      FIFO.
+ * 
+ * @return  Payload, NULL if empty.
+ */
+static struct Radio_Payload *pxFifoHead(struct Radio_Fifo *const pxFifo)
+{
+    return (pxFifo->ulCount == 0) ? NULL : &pxFifo->xSlots[pxFifo->ulHead];
+}
+
+
+/**
+ * @brief   Add payload to FIFO.
+ * 
+ * @param   pxFifo      FIFO.
+ * 
+ * @return  Slot to fill, NULL if full.
+ */
+static struct Radio_Payload *pxFifoPush(struct Radio_Fifo *const pxFifo)
+{
+    struct Radio_Payload *pxPayload;
+    
+    if (pxFifo->ulCount == FIFO_SIZE)
+    {
+        return NULL;
+    }
+    
+    pxPayload = &pxFifo->xSlots[(pxFifo->ulHead + pxFifo->ulCount) % FIFO_SIZE];
+    pxFifo->ulCount++;
+    
+    return pxPayload;
+}
+
+
+/**
+ * @brief   Remove oldest payload of FIFO.
+ * 
+ * @param   pxFifo      FIFO, not empty.
+ * 
+ * @return  None
+ */
+static void vFifoPop(struct Radio_Fifo *const pxFifo)
+{
+    pxFifo->ulHead = (pxFifo->ulHead + 1) % FIFO_SIZE;
+    pxFifo->ulCount--;
+}
@@ -0,0 +1,293 @@
+/**
+ * vsensors.c
+ * This file models the sensors, the HS1101 RC node and the pumps of the
+ * board, see vsensors.h.
+ * 
+ * Not modelled: TMP36GT self-heating, HS1101 hysteresis and stray
+ * capacitance, potentiometer movement (it stays centered) and soil
+ * drying differently in each zone.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "soc.h"
+#include "MKL25Z4.h"
+#include "adc.h"
+#include "board.h"
+#include "vsensors.h"
+
+
+/* Local defines */
+#define CMP_OUT_PIN                     (0UL)       /* PTE0, CMP0_OUT */
+#define CAPTURE_PIN                     (13UL)      /* PTA13, TPM1_CH1 */
+#define PWM_MUX                         (4UL)       /* PTDn ALT4, TPM0_CHn */
+
+#define HS1101_RESISTOR_OHM             (1e6)
+#define HS1101_NOMINAL_PF               (180.0)     /* At 55 %RH, 25 C */
+#define HS1101_DRIFT_PF                 (0.04)      /* Per C */
+#define DRIFT_REFERENCE_TEMPERATURE     (25.0)
+
+#define FULL_SCALE                      (65535.0)
+#define VREF_MV                         (3300.0)
+#define TMP36_OFFSET_MV                 (500.0)
+#define TMP36_MV_PER_DEGREE             (10.0)
+#define POTENTIOMETER_LEVEL             (32768UL)
+
+/* Expands probe table into a zone per ADC channel */
+#define VSENSORS_PROBE_ZONE(probe, channel, profile, convert, zone) [channel] = (zone) + 1,
+
+
+/* Global variables */
+struct VSENSORS_Stats xVsensorsStats;
+
+
+/* Local variables */
+static struct VSENSORS_Config xConfig;
+static uint32_t ulRandom;
+static uint64_t ullUpdated;                 /* Soil integrated up to this cycle */
+static uint32_t ulPumping;                  /* Bit per zone */
+static const uint8_t ucProbeZones[ADC_CH_DISABLED + 1] = { BOARD_SOIL_PROBES(VSENSORS_PROBE_ZONE) };    /* Zone + 1, 0 for none */
+
+static void vSoilSync(void);
+static struct SOC_Model xSoilModel = { "SOIL", vSoilSync, NULL };
+
+
+/* Local function prototypes */
+static uint32_t ulAnalogInput(const uint32_t ulChannel);
+static uint64_t ullRcDischarge(const double dFrom, const double dTo);
+static void vComparatorOut(const uint32_t ulLevel, void *const pvContext);
+static double dSwing(const double dMean, const double dAmplitude);
+static void vRecordAir(const double dTemperature, const double dHumidity);
+static int32_t lNoise(void);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Reset environment, connect ADC0 inputs, the RC node and the
+ *          CMP0_OUT to TPM1_CH1 wire.
+ * 
+ * @param   pxConfig    Environment.
+ * 
+ * @return  None
+ */
+void VSENSORS_vInit(const struct VSENSORS_Config *const pxConfig)
+{
+    uint32_t ulZone;
+    
+    xConfig = *pxConfig;
+    ulRandom = (xConfig.ulSeed != 0) ? xConfig.ulSeed : 1;
+    ullUpdated = SOC_ullCycles();
+    ulPumping = 0;
+    
+    memset(&xVsensorsStats, 0, sizeof(xVsensorsStats));
+    xVsensorsStats.dMinTemperature = INFINITY;
+    xVsensorsStats.dMaxTemperature = -INFINITY;
+    xVsensorsStats.dMinHumidity = INFINITY;
+    xVsensorsStats.dMaxHumidity = -INFINITY;
+    for (ulZone = 0; ulZone < VSENSORS_ZONES; ulZone++)
+    {
+        xVsensorsStats.dSoilMoisture[ulZone] = xConfig.dSoilMoisture;
+        xVsensorsStats.dMinSoilMoisture[ulZone] = xConfig.dSoilMoisture;
+    }
+    
+    SOC_vAddModel(&xSoilModel);
+    SOC_vConnectAnalog(ulAnalogInput);
+    SOC_vConnectRc(ullRcDischarge);
+    SOC_vWatchPin(SOC_PORT_E, CMP_OUT_PIN, vComparatorOut, NULL);
+}
+
+
+/**
+ * @brief   Integrate soil moisture of each zone up to now, then pick up
+ *          pumps started or stopped by firmware.
+ * 
+ *          Pump state only changes with register writes, so it held since
+ *          the previous sync.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void vSoilSync(void)
+{
+    const uint64_t ullNow = SOC_ullCycles();
+    const double dSeconds = (double)(ullNow - ullUpdated) / (double)SOC_BUS_CLOCK_HZ;
+    const uint32_t ulCounting = ((xSocTpm[0].SC & TPM_SC_CMOD_MASK) != 0) ? 1 : 0;
+    uint32_t ulZone;
+    uint32_t ulPump;
+    double dMoisture;
+    
+    for (ulZone = 0; ulZone < VSENSORS_ZONES; ulZone++)
+    {
+        dMoisture = xVsensorsStats.dSoilMoisture[ulZone];
+        if (ulPumping & MASK(ulZone))
+        {
+            dMoisture += xConfig.dWateringRate * dSeconds;
+            xVsensorsStats.ullPumpCycles[ulZone] += ullNow - ullUpdated;
+        }
+        else
+        {
+            dMoisture -= xConfig.dDryingRate * dSeconds;
+        }
+        dMoisture = fmin(fmax(dMoisture, 0.0), 100.0);
+        xVsensorsStats.dSoilMoisture[ulZone] = dMoisture;
+        xVsensorsStats.dMinSoilMoisture[ulZone] = fmin(xVsensorsStats.dMinSoilMoisture[ulZone], dMoisture);
+        
+        ulPump = (ulCounting && (((xSocPort[SOC_PORT_D].PCR[ulZone] & PORT_PCR_MUX_MASK) >> PORT_PCR_MUX_SHIFT) == PWM_MUX)) ? 1 : 0;
+        if (ulPump && !(ulPumping & MASK(ulZone)))
+        {
+            xVsensorsStats.ulPumpStarts[ulZone]++;
+        }
+        ulPumping = (ulPumping & ~MASK(ulZone)) | (ulPump << ulZone);
+    }
+    ullUpdated = ullNow;
+}
+
+
+/**
+ * @brief   Sample analog input of an ADC0 channel.
+ * 
+ * @param   ulChannel   SC1 ADCH.
+ * 
+ * @return  Level in 1/65536 of VREFH, noise added.
+ */
+static uint32_t ulAnalogInput(const uint32_t ulChannel)
+{
+    double dLevel;
+    int32_t lLevel;
+    uint32_t ulZone;
+    
+    vSoilSync();
+    xVsensorsStats.ulSamples++;
+    
+    if (ulChannel == BOARD_TEMPERATURE_CHANNEL)
+    {
+        const double dTemperature = dSwing(xConfig.dTemperature, xConfig.dTemperatureSwing);
+        
+        vRecordAir(dTemperature, dSwing(xConfig.dHumidity, xConfig.dHumiditySwing));
+        dLevel = (TMP36_OFFSET_MV + TMP36_MV_PER_DEGREE * dTemperature) * FULL_SCALE / VREF_MV;
+    }
+    else if ((ulChannel <= ADC_CH_DISABLED) && (ucProbeZones[ulChannel] != 0))
+    {
+        ulZone = ucProbeZones[ulChannel] - 1UL;
+        dLevel = SOIL_MOISTURE_ADC_WET
+               + (100.0 - xVsensorsStats.dSoilMoisture[ulZone]) * (SOIL_MOISTURE_ADC_DRY - SOIL_MOISTURE_ADC_WET) / 100.0;
+    }
+    else if (ulChannel == BOARD_POTENTIOMETER_CHANNEL)
+    {
+        dLevel = POTENTIOMETER_LEVEL;
+    }
+    else
+    {
+        dLevel = 0.0;
+    }
+    
+    lLevel = (int32_t)lround(dLevel) + lNoise();
+    if (lLevel < 0)
+    {
+        lLevel = 0;
+    }
+    
+    return (uint32_t)lLevel;
+}
+
+
+/**
+ * @brief   Time the HS1101 takes to discharge through its resistor.
+ * 
+ *          C = 180 pF * (1.25e-7 RH^3 - 1.36e-5 RH^2 + 2.19e-3 RH + 0.9)
+ *              + 0.04 pF/C * (T - 25 C)
+ *          t = R * C * ln(from / to)
+ * 
+ * @param   dFrom       Node voltage when released, fraction of VDD.
+ * @param   dTo         Comparator threshold, fraction of VDD.
+ * 
+ * @return  Bus clock cycles.
+ */
+static uint64_t ullRcDischarge(const double dFrom, const double dTo)
+{
+    const double dTemperature = dSwing(xConfig.dTemperature, xConfig.dTemperatureSwing);
+    const double dHumidity = dSwing(xConfig.dHumidity, xConfig.dHumiditySwing);
+    const double dPicofarads = HS1101_NOMINAL_PF * (((1.25e-7 * dHumidity - 1.36e-5) * dHumidity + 2.19e-3) * dHumidity + 0.9)
+                             + HS1101_DRIFT_PF * (dTemperature - DRIFT_REFERENCE_TEMPERATURE);
+    const double dSeconds = HS1101_RESISTOR_OHM * dPicofarads * 1e-12 * log(dFrom / dTo);
+    
+    xVsensorsStats.ulDischarges++;
+    vRecordAir(dTemperature, dHumidity);
+    
+    return (uint64_t)llround(dSeconds * (double)SOC_BUS_CLOCK_HZ);
+}
+
+
+/**
+ * @brief   Board wire from CMP0_OUT on PTE0 to TPM1_CH1 on PTA13.
+ * 
+ * @param   ulLevel     PTE0 level.
+ * @param   pvContext   Unused.
+ * 
+ * @return  None
+ */
+static void vComparatorOut(const uint32_t ulLevel, void *const pvContext)
+{
+    (void)pvContext;
+    
+    SOC_vSetPin(SOC_PORT_A, CAPTURE_PIN, ulLevel);
+}
+
+
+/**
+ * @brief   Sine trace of an air value at current virtual time.
+ * 
+ * @param   dMean       Mean.
+ * @param   dAmplitude  Amplitude.
+ * 
+ * @return  Value now.
+ */
+static double dSwing(const double dMean, const double dAmplitude)
+{
+    const double dSeconds = (double)SOC_ullCycles() / (double)SOC_BUS_CLOCK_HZ;
+    
+    return dMean + dAmplitude * sin(2.0 * M_PI * dSeconds / xConfig.dSwingPeriod);
+}
+
+
+/**
+ * @brief   Track extremes of the air firmware sampled.
+ * 
+ * @param   dTemperature    Celsius.
+ * @param   dHumidity       %RH.
+ * 
+ * @return  None
+ */
+static void vRecordAir(const double dTemperature, const double dHumidity)
+{
+    xVsensorsStats.dMinTemperature = fmin(xVsensorsStats.dMinTemperature, dTemperature);
+    xVsensorsStats.dMaxTemperature = fmax(xVsensorsStats.dMaxTemperature, dTemperature);
+    xVsensorsStats.dMinHumidity = fmin(xVsensorsStats.dMinHumidity, dHumidity);
+    xVsensorsStats.dMaxHumidity = fmax(xVsensorsStats.dMaxHumidity, dHumidity);
+}
+
+
+/**
+ * @brief   Draw ADC noise.
+ * 
+ * @param   None
+ * 
+ * @return  -ulNoise...ulNoise
+ */
+static int32_t lNoise(void)
+{
+    if (xConfig.ulNoise == 0)
+    {
+        return 0;
+    }
+    
+    /* xorshift32 */
+    ulRandom ^= ulRandom << 13;
+    ulRandom ^= ulRandom >> 17;
+    ulRandom ^= ulRandom << 5;
+    
+    return (int32_t)(ulRandom % (2UL * xConfig.ulNoise + 1UL)) - (int32_t)xConfig.ulNoise;
+}
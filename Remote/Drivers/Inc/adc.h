@@ -6,12 +6,22 @@
 #pragma once
 
 /* System headers */
+#include <stdint.h>
+#include <stddef.h>
 
 /* Device vendor headers */
 #include "MKL25Z4.h"
+#include "fsl_bitaccess.h"
+#include "FreeRTOS.h"
+#include "task.h"
 
 /* User headers */
 #include "defines.h"
+#include "dma.h"
+#include "pit.h"
+#include "lptmr.h"
+#include "flash.h"
+#include "benchmark.h"
 
 /* Global defines */
 /* ADC0 trigger sources */
@@ -32,6 +42,63 @@
 #define ADC_SC3_AVGS_16SAMPLES                  (0x02)          /* 16 samples averaged */
 #define ADC_SC3_AVGS_32SAMPLES                  (0x03)          /* 32 samples averaged */
 
+/* ADC resolution select, single-ended */
+#define ADC_CFG1_MODE_8BIT                      (0x00)          /* 8-bit conversion */
+#define ADC_CFG1_MODE_12BIT                     (0x01)          /* 12-bit conversion */
+#define ADC_CFG1_MODE_10BIT                     (0x02)          /* 10-bit conversion */
+#define ADC_CFG1_MODE_16BIT                     (0x03)          /* 16-bit conversion */
+
+/* ADC long sample time select */
+#define ADC_CFG2_ADLSTS_20CYCLES                (0x00)          /* 20 extra ADCK cycles */
+#define ADC_CFG2_ADLSTS_12CYCLES                (0x01)          /* 12 extra ADCK cycles */
+#define ADC_CFG2_ADLSTS_6CYCLES                 (0x02)          /* 6 extra ADCK cycles */
+#define ADC_CFG2_ADLSTS_2CYCLES                 (0x03)          /* 2 extra ADCK cycles */
+
+/* Profile characterization */
+#define ADC_PROFILE_MEASURE_SAMPLES             (16UL)
+
+/* Scan engine */
+#define ADC_SCAN_MAX_CHANNELS                   (8UL)
+#define ADC_SCAN_DMA_CHANNEL                    (DMA_CHANNEL2)  /* Moves results, shared with HS1101 */
+#define ADC_SCAN_LINK_DMA_CHANNEL               (DMA_CHANNEL3)  /* Selects next channel, shared with HS1101 */
+
+/* Hardware compare */
+#define ADC_COMPARE_TRIGGER_PERIOD_MS           (1000UL)        /* LPTMR trigger period */
+
+/* Calibration record */
+#define ADC_CALIBRATION_MAGIC                   (0x41444331UL)  /* "ADC1" */
+#define ADC_CALIBRATION_ADDRESS                 ((uint32_t)&_scalibration)
+
+/* Acquisition profiles, from cheapest to most accurate */
+enum ADC_Profiles
+{
+    ADC_PROFILE_FAST,           /* 12-bit, no averaging, high speed */
+    ADC_PROFILE_BALANCED,       /* 16-bit, 8 samples averaged */
+    ADC_PROFILE_LOW_POWER,      /* 16-bit, 32 samples averaged, long sample, low power */
+    ADC_PROFILE_COUNT
+};
+
+/* Measured cost and noise of one profile */
+struct ADC_Profile_Stats
+{
+    uint32_t ulConversionNs;    /* Average conversion time */
+    uint32_t ulMean;            /* Average result, scaled to 16 bits */
+    uint32_t ulNoise;           /* Peak-to-peak, scaled to 16 bits */
+};
+
+/* Boot time cost of calibration */
+struct ADC_Calibration_Stats
+{
+    uint32_t ulBootUs;          /* Spent in ADC0_vInit() on this boot */
+    uint32_t ulCalibrationUs;   /* Spent calibrating and storing the record */
+    uint32_t ulCached;          /* TRUE if record was restored from flash */
+};
+
+/* Global variables */
+extern struct ADC_Profile_Stats xAdcProfileStats[ADC_PROFILE_COUNT];
+extern struct ADC_Calibration_Stats xAdcCalibrationStats;
+extern uint32_t ulScanTimeouts;     /* Scan segments DMA didn't finish, read with debugger */
+
 enum ADC_Channels
 {
     ADC_CH_DADP0,
@@ -71,4 +138,8 @@ enum ADC_Channels
 /* Global function prototypes */
 void ADC0_vInit(void);
 uint16_t ADC0_usReadPolling(const uint8_t ucChannel);
+void ADC0_vInitScan(const uint32_t ulTriggerSource);
+BaseType_t ADC0_xScan(const uint8_t *const pucChannels, const uint8_t *const pucProfiles, uint16_t *const pusResults, const uint32_t ulCount);
+void ADC0_vMeasureProfiles(const uint8_t ucChannel);
+BaseType_t ADC0_xWaitForCompare(const uint8_t ucChannel, const uint16_t usThreshold, const TickType_t xTimeout);
 void CMP0_vInit(void);
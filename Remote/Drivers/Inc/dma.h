@@ -15,6 +15,7 @@
 /* User headers */
 #include "defines.h"
 #include "spi.h"
+#include "FreeRTOS.h"
 
 
 /* Global defines */
@@ -57,10 +58,26 @@
 #define DMA_CHANNEL2                        2
 #define DMA_CHANNEL3                        3
 
+/* DCR transfer sizes */
+#define DMA_DCR_SIZE_32BIT                  0
+#define DMA_DCR_SIZE_8BIT                   1
+#define DMA_DCR_SIZE_16BIT                  2
+
+/* DCR channel-to-channel linking */
+#define DMA_DCR_LINKCC_NONE                 0
+#define DMA_DCR_LINKCC_CYCLE_STEAL          2   /* Link to LCH1 after each cycle-steal transfer */
+#define DMA_DCR_LINKCC_BCR_ZERO             3   /* Link to LCH1 after BCR reaches zero */
+
+/**
+ * Called from DMA ISR when a channel has finished.
+ * ulStatus holds DSR_BCR before DONE was cleared.
+ */
+typedef void (*DMA_Callback)(const uint32_t ulStatus, BaseType_t *const pxHigherPriorityTaskWoken);
+
 /* Global function prototypes */
 void DMAMUX0_vInit(uint32_t const ulChannel, uint32_t const ulSource);
-void DMA0_vLinkChannel(uint32_t const ulSrcCh, uint32_t const ulDstCh);
-void DMA0_vInit(void);
 void DMA0_vInitTransaction(const uint32_t ulChannel, uint32_t *const pulSrcAddr, uint32_t *const pulDstAddr, const uint32_t ulLength);
 void DMA0_vStart(const uint32_t ulChannel);
 void DMA0_vStop(const uint32_t ulChannel);
+void DMA0_vConfigureChannel(const uint32_t ulChannel, const uint32_t ulControl);
+void DMA0_vSetCallback(const uint32_t ulChannel, const DMA_Callback pxCallback);
@@ -0,0 +1,33 @@
+/**
+ * flash.h
+ * Driver module for MKL25 FTFA flash controller.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Device vendor headers */
+#include "MKL25Z4.h"
+#include "FreeRTOS.h"
+
+/* User headers */
+#include "defines.h"
+#include "system.h"
+
+/* Global defines */
+#define FTFA_SECTOR_SIZE                    (1024UL)
+
+/* Flash commands */
+#define FTFA_CMD_PROGRAM_LONGWORD           (0x06)
+#define FTFA_CMD_ERASE_SECTOR               (0x09)
+
+/* Sectors reserved in linker script */
+extern uint32_t _scalibration;              /* ADC calibration record */
+extern uint32_t _shumidity;                 /* HS1101 calibration record */
+
+/* Global function prototypes */
+BaseType_t FTFA_xEraseSector(const uint32_t ulAddress);
+BaseType_t FTFA_xProgram(const uint32_t ulAddress, const uint32_t *const pulData, const uint32_t ulCount);
+uint32_t FTFA_ulChecksum(const uint32_t *const pulData, const uint32_t ulCount);
@@ -0,0 +1,23 @@
+/**
+ * lptmr.h
+ * Driver module for MKL25 LPTMR peripheral.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Device vendor headers */
+#include "MKL25Z4.h"
+
+/* User headers */
+#include "defines.h"
+#include "system.h"
+
+/* Global defines */
+#define LPTMR_MAX_PERIOD_MS                 (0xFFFFUL)
+
+/* Global function prototypes */
+void LPTMR0_vStartTrigger(const uint32_t ulPeriodMs);
+void LPTMR0_vStopTrigger(void);
@@ -17,16 +17,67 @@
 #include "system.h"
 #include "spi.h"
 #include "tpm.h"
+#include "command.h"
 
 /* Global defines */
 
+/**
+ * Radio link tuning, shared by all nodes of one gateway.
+ * Nodes on the same channel get different retransmit delays so that
+ * colliding nodes do not retry in lockstep:
+ * ARD = NRF24L01_RETR_DELAY + NODE_ID % NRF24L01_RETR_DELAY_SPREAD
+ */
+#define NRF24L01_RF_CHANNEL             (50UL)      /* 2400 MHz + n MHz */
+#define NRF24L01_RETR_DELAY             (1UL)       /* (n + 1) * 250 s */
+#define NRF24L01_RETR_DELAY_SPREAD      (4UL)       /* Number of different delays */
+#define NRF24L01_RETR_COUNT             (3UL)       /* 0...15 retransmits */
+
+/* Outcomes of nRF24L01_ulWaitForTransmit() */
+#define NRF24L01_TX_ACKED               (0UL)       /* TX_DS, payload left TX FIFO */
+#define NRF24L01_TX_MAX_RT              (1UL)       /* No ACK after retransmits, payload kept in TX FIFO */
+#define NRF24L01_TX_TIMEOUT             (2UL)       /* No IRQ, state of TX FIFO unknown */
+
+#define NRF24L01_TX_FIFO_SIZE           (3UL)       /* Payloads */
+#define NRF24L01_MAX_TX_PAYLOAD         (31UL)      /* Bytes per nRF24L01_vSendPayload() or nRF24L01_vLoadPayload() */
+
+/* Radio counters, read with debugger */
+struct nRF24L01_Stats
+{
+    uint32_t ulPayloads;        /* Transmissions whose outcome is known */
+    uint32_t ulPayloadBytes;
+    uint32_t ulRetransmits;     /* Sum of ARC_CNT */
+    uint32_t ulLostPayloads;    /* Transmissions ended with MAX_RT */
+    uint32_t ulTimeouts;        /* Transmissions without IRQ */
+    uint32_t ulAirtimeUs;       /* Estimated TX time on air including retransmits */
+    uint32_t ulAckPayloads;     /* Downlink payloads received with ACKs */
+    uint32_t ulAckPayloadBytes;
+    uint32_t ulAckAirtimeUs;    /* RX time ACK payloads added */
+    uint32_t ulSpiTransactions; /* SS frames */
+    uint32_t ulSpiBytes;
+    uint32_t ulSkippedWrites;   /* Register writes the shadow made unnecessary */
+    uint32_t ulShadowChecks;
+    uint32_t ulShadowRestores;  /* Registers lost, e.g. radio power cycled */
+};
+
 /* Global variables */
+extern struct nRF24L01_Stats xRadioStats;
 
 
 /* Function prototypes */
 void nRF24L01_vInit(void);
 void nRF24L01_vResetStatusFlags(void);
 void nRF24L01_vWriteRegister(const uint8_t ucRegister, const uint8_t ucValue);
+uint8_t nRF24L01_ucReadRegister(const uint8_t ucRegister);
 void nRF24L01_vSendCommand(const uint8_t ucCommand);
 void nRF24L01_vWriteAddressRegister(const uint8_t ucRegister, const uint8_t *pucValue, uint32_t ulLength);
 void nRF24L01_vSendPayload(const char *pucPayload, uint32_t ulLength);
+void nRF24L01_vRetransmit(void);
+void nRF24L01_vFlushTx(void);
+uint32_t nRF24L01_ulWaitForTransmit(const TickType_t xTicksToWait);
+void nRF24L01_vStreamStart(void);
+void nRF24L01_vLoadPayload(const char *pucPayload, uint32_t ulLength);
+uint32_t nRF24L01_ulStreamWait(const TickType_t xTicksToWait, uint32_t *const pulAcked);
+void nRF24L01_vStreamResume(void);
+void nRF24L01_vStreamStop(void);
+uint32_t nRF24L01_ulReadAckPayload(uint8_t *const pucPayload);
+uint32_t nRF24L01_ulShadowVerify(void);
@@ -0,0 +1,31 @@
+/**
+ * pit.h
+ * Driver module for MKL25 PIT peripheral.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Device vendor headers */
+#include "MKL25Z4.h"
+
+/* User headers */
+#include "defines.h"
+#include "system.h"
+
+/* Global defines */
+#define PIT_CHANNEL0                        (0UL)
+#define PIT_CHANNEL1                        (1UL)
+
+/* Timestamps are counted with the 24 MHz bus clock */
+#define PIT_TICKS_PER_MICROSECOND           (24UL)
+#define PIT_TICKS_PER_SECOND                (PIT_TICKS_PER_MICROSECOND * 1000000UL)
+#define PIT_TICKS_TO_US(x)                  ((x) / PIT_TICKS_PER_MICROSECOND)
+
+/* Global function prototypes */
+void PIT_vInit(void);
+uint32_t PIT_ulReadTimestamp(void);
+void PIT_vStartTrigger(const uint32_t ulPeriodUs);
+void PIT_vStopTrigger(void);
@@ -6,7 +6,11 @@
  *  PTE1 - MISO
  *  PTE2 - SCK
  *  PTE3 - MOSI
- *  PTE4 - CS
+ *  PTE4 - CS, nRF24L01
+ * 
+ * Transactions are queued and run back to back by DMA0. RX channel
+ * interrupt tells when the last byte is clocked in, then chip select
+ * is released and the next transaction started from the ISR.
  */
 
 #pragma once
@@ -22,13 +26,57 @@
 #include "system.h"
 #include "dma.h"
 #include "tpm.h"
+#include "benchmark.h"
 
 /* Global defines */
+#define SPI1_TX_DMA_CHANNEL             (DMA_CHANNEL0)
+#define SPI1_RX_DMA_CHANNEL             (DMA_CHANNEL1)  /* Interrupt ends transaction */
+
+/* Devices on SPI1, each has its own chip select */
+enum SPI1_Devices
+{
+    SPI1_DEVICE_RADIO,                  /* nRF24L01 */
+    SPI1_DEVICE_COUNT
+};
+
+struct SPI1_Transaction;
+
+/**
+ * Called from DMA ISR when transaction is done. Next queued transaction
+ * is already running.
+ */
+typedef void (*SPI1_Callback)(struct SPI1_Transaction *const pxTransaction, BaseType_t *const pxHigherPriorityTaskWoken);
+
+/* Transaction descriptor, must stay valid until ulDone is set */
+struct SPI1_Transaction
+{
+    uint32_t ulDevice;                  /* enum SPI1_Devices */
+    const char *pucTxData;
+    char *pucRxData;
+    uint32_t ulLength;
+    SPI1_Callback pxCallback;           /* NULL for none */
+    void *pvContext;                    /* For callback */
+    volatile uint32_t ulDone;           /* Set before callback */
+    uint32_t ulStart;                   /* CS low timestamp */
+    uint32_t ulEnd;                     /* CS high timestamp */
+    struct SPI1_Transaction *pxNext;    /* Queue link, set by SPI1_vSubmit() */
+};
+
+/* Engine statistics, read with debugger */
+struct SPI1_Stats
+{
+    uint32_t ulTransactions;
+    uint32_t ulBytes;
+    uint32_t ulQueued;                  /* Submitted while bus was busy */
+    uint32_t ulReturnedNotifications;   /* Taken by a waiting task and given back */
+};
+
+/* Global variables */
+extern struct SPI1_Stats xSpiStats;
 
 /* Global function prototypes */
 void SPI1_vInit(void);
-uint8_t SPI1_ucReadPolling(void);
-void SPI1_vTransmitByte(const char ucByte);
-void SPI1_vTransmitPolling(char *const pucData, char *const pucRxData, const uint32_t ulLength);
-void SPI1_vTransmitDMA(char const *pucTxData, char *const pucRxData, const uint32_t ulLength);
-void SPI1_vSetSlave(const uint32_t ulState);
+void SPI1_vSubmit(struct SPI1_Transaction *const pxTransactions, const uint32_t ulCount);
+void SPI1_vTransmit(const uint32_t ulDevice, const char *const pucTxData, char *const pucRxData, const uint32_t ulLength);
+void SPI1_vTransmitChain(struct SPI1_Transaction *const pxTransactions, const uint32_t ulCount);
+uint32_t SPI1_ulTakeBusyTicks(void);
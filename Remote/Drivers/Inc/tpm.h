@@ -14,16 +14,24 @@
 /* User headers */
 #include "defines.h"
 
+/* Clock sources */
+#define BUS_CLOCK_HZ                        (24000000UL)                                /* Core clock / 2 */
+#define TPM2_CLOCK_HZ                       (24000000UL)                                /* MCGPLLCLK / 2 / prescaler 2 */
+#define TPM_CLOCK_HZ                        (48000000UL)                                /* MCGPLLCLK / 2 */
+#define TPM1_PRESCALER                      (7UL)                                       /* Divide by 128 */
+
+/* SPI1 baud rate = Bus clock / ((SPPR + 1) * 2^(SPR + 1)) */
+#define SPI1_BR_SPPR                        (2UL)
+#define SPI1_BR_SPR                         (1UL)
+#define SPI1_BAUDRATE                       (BUS_CLOCK_HZ / ((SPI1_BR_SPPR + 1) * (2UL << SPI1_BR_SPR)))
+
 /* Timings calculated from 24 MHz clock speed */
 #define MICROSECOND                         (24UL)                                      /* 1.0 s */
 #define TEN_MICROSECONDS                    (MICROSECOND * 10)                          /* 10.0 s */
-#define TIME_BETWEEN_BYTES                  (6UL)                                       /* 0.25 s */
-#define TIME_PER_BYTE                       (MICROSECOND * 2 + TIME_BETWEEN_BYTES)      /* 2.25 s */
 
 /* Global function prototypes */
 void TPM0_vInit(void);
 void TPM1_vInit(void);
 void TPM2_vInit(void);
-void TPM2_vLoadCounter(uint32_t ulBytes);
 void TPM2_vStart(void);
 void TPM2_vStop(void);
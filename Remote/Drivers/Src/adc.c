@@ -8,8 +8,101 @@
 
 /* Local defines */
 #define CMP0_OUT_PIN        (0UL)
+#define SCAN_TIMEOUT_MS     (100UL)
+#define DEFAULT_PROFILE     (ADC_PROFILE_LOW_POWER)
+#define CAL_REGISTER_COUNT  (7UL)               /* CLxD, CLxS, CLx4..CLx0 */
+
+/* Register values of one acquisition profile */
+struct ADC_Profile
+{
+    uint32_t ulCfg1;
+    uint32_t ulCfg2;
+    uint32_t ulSc3;
+    uint32_t ulTriggerPeriodUs;     /* Scan trigger period, must exceed conversion time */
+    uint8_t ucResultShift;          /* Scales result to 16 bits */
+};
+
+/* Calibration results, stored in reserved flash sector */
+struct ADC_Calibration
+{
+    uint32_t ulMagic;
+    uint32_t ulOfs;
+    uint32_t ulPg;
+    uint32_t ulMg;
+    uint32_t ulClp[CAL_REGISTER_COUNT];
+    uint32_t ulClm[CAL_REGISTER_COUNT];
+    uint32_t ulCalibrationUs;
+    uint32_t ulCrc;                     /* CRC-32 of preceding fields */
+};
 
 /* Global variables */
+struct ADC_Profile_Stats xAdcProfileStats[ADC_PROFILE_COUNT];
+struct ADC_Calibration_Stats xAdcCalibrationStats;
+uint32_t ulScanTimeouts = 0;
+
+/* Local variables */
+static TaskHandle_t xScanTask = NULL;
+static uint32_t ulScanTrigger;
+static uint32_t ulScanSequence[ADC_SCAN_MAX_CHANNELS];
+static TaskHandle_t xCompareTask = NULL;
+
+/**
+ * ADCK = bus clock / 2 = 12 MHz, maximum for 16-bit mode.
+ * Conversion takes roughly samples * (base + long sample) ADCK cycles.
+ */
+static const struct ADC_Profile xProfiles[ADC_PROFILE_COUNT] =
+{
+    /**
+     * Fast:
+     * 12 bit, short sample time, high speed
+     * No hardware average
+     */
+    [ADC_PROFILE_FAST] =
+    {
+        .ulCfg1             = ADC_CFG1_ADIV(1) | ADC_CFG1_MODE(ADC_CFG1_MODE_12BIT),
+        .ulCfg2             = ADC_CFG2_ADHSC(1),
+        .ulSc3              = 0,
+        .ulTriggerPeriodUs  = 10,
+        .ucResultShift      = 4
+    },
+    
+    /**
+     * Balanced:
+     * 16 bit, short sample time, normal power
+     * 8 samples averaged
+     */
+    [ADC_PROFILE_BALANCED] =
+    {
+        .ulCfg1             = ADC_CFG1_ADIV(1) | ADC_CFG1_MODE(ADC_CFG1_MODE_16BIT),
+        .ulCfg2             = 0,
+        .ulSc3              = ADC_SC3_AVGE(1) | ADC_SC3_AVGS(ADC_SC3_AVGS_8SAMPLES),
+        .ulTriggerPeriodUs  = 50,
+        .ucResultShift      = 0
+    },
+    
+    /**
+     * Low power:
+     * 16 bit, long sample time - 24 ADCK cycles total, low power
+     * 32 samples averaged
+     */
+    [ADC_PROFILE_LOW_POWER] =
+    {
+        .ulCfg1             = ADC_CFG1_ADLPC(1) | ADC_CFG1_ADIV(1) | ADC_CFG1_ADLSMP(1) | ADC_CFG1_MODE(ADC_CFG1_MODE_16BIT),
+        .ulCfg2             = ADC_CFG2_ADLSTS(ADC_CFG2_ADLSTS_20CYCLES),
+        .ulSc3              = ADC_SC3_AVGE(1) | ADC_SC3_AVGS(ADC_SC3_AVGS_32SAMPLES),
+        .ulTriggerPeriodUs  = 250,
+        .ucResultShift      = 0
+    }
+};
+
+/* Local function prototypes */
+static void ADC0_vScanDone(const uint32_t ulStatus, BaseType_t *const pxHigherPriorityTaskWoken);
+static void ADC0_vSelectTrigger(const uint32_t ulTriggerSource);
+static void ADC0_vApplyProfile(const uint8_t ucProfile);
+static void ADC0_vInitCalibration(void);
+static BaseType_t ADC0_xCalibrate(struct ADC_Calibration *const pxCalibration);
+static void ADC0_vRestoreCalibration(const struct ADC_Calibration *const pxCalibration);
+static BaseType_t ADC0_xScanSegment(const uint8_t *const pucChannels, uint16_t *const pusResults, const uint32_t ulCount, const uint8_t ucProfile);
 
 /* Function descriptions */
 
@@ -27,14 +120,6 @@ void ADC0_vInit(void)
     PORTB->PCR[MOIST_SENSOR_PIN] |= PORT_PCR_MUX(ALT0);
     PORTE->PCR[HUMID_SENSOR_PIN] |= PORT_PCR_MUX(ALT0);
     
-    /**
-     * Low power configuration
-     * Long sample time - 24 ADCK cycles total
-     * 16 bit single-ended conversion
-     * Bus clock input
-     */
-    ADC0->CFG1 = ADC_CFG1_ADLPC(1) | ADC_CFG1_ADLSMP(1) | ADC_CFG1_MODE(3);
-    
     /**
     * Software trigger
     * Compare function disabled
@@ -42,11 +127,211 @@ void ADC0_vInit(void)
     */
     ADC0->SC2 = ADC_SC2_REFSEL(0);
     
+    ADC0_vInitCalibration();
+    
+    /* Polling and compare use default profile */
+    ADC0_vApplyProfile(DEFAULT_PROFILE);
+}
+
+
+/**
+ * @brief   Restore calibration from flash. Calibrates and stores a new
+ *          record if the stored one is missing or corrupt.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void ADC0_vInitCalibration(void)
+{
+    const struct ADC_Calibration *const pxStored = (const struct ADC_Calibration *)ADC_CALIBRATION_ADDRESS;
+    const uint32_t ulCrcLength = offsetof(struct ADC_Calibration, ulCrc) / sizeof(uint32_t);
+    struct ADC_Calibration xCalibration;
+    BaseType_t xAssert;
+    const uint32_t ulStart = PIT_ulReadTimestamp();
+    
+    if ((pxStored->ulMagic == ADC_CALIBRATION_MAGIC) && (pxStored->ulCrc == FTFA_ulChecksum((const uint32_t *)pxStored, ulCrcLength)))
+    {
+        ADC0_vRestoreCalibration(pxStored);
+        xAdcCalibrationStats.ulCalibrationUs = pxStored->ulCalibrationUs;
+        xAdcCalibrationStats.ulCached = TRUE;
+    }
+    else if (ADC0_xCalibrate(&xCalibration) == pdPASS)
+    {
+        xCalibration.ulMagic = ADC_CALIBRATION_MAGIC;
+        xCalibration.ulCalibrationUs = PIT_TICKS_TO_US(PIT_ulReadTimestamp() - ulStart);
+        xCalibration.ulCrc = FTFA_ulChecksum((const uint32_t *)&xCalibration, ulCrcLength);
+        
+        xAssert = FTFA_xEraseSector(ADC_CALIBRATION_ADDRESS);
+        configASSERT(xAssert == pdPASS);
+        xAssert = FTFA_xProgram(ADC_CALIBRATION_ADDRESS, (const uint32_t *)&xCalibration, sizeof(xCalibration) / sizeof(uint32_t));
+        configASSERT(xAssert == pdPASS);
+        
+        xAdcCalibrationStats.ulCalibrationUs = PIT_TICKS_TO_US(PIT_ulReadTimestamp() - ulStart);
+        xAdcCalibrationStats.ulCached = FALSE;
+    }
+    else
+    {
+        /* Calibration failed, run uncalibrated and retry on next boot */
+        xAdcCalibrationStats.ulCalibrationUs = 0;
+        xAdcCalibrationStats.ulCached = FALSE;
+    }
+    
+    xAdcCalibrationStats.ulBootUs = PIT_TICKS_TO_US(PIT_ulReadTimestamp() - ulStart);
+}
+
+
+/**
+ * @brief   Run ADC0 self-calibration.
+ * 
+ * @param   pxCalibration   Results are stored here.
+ * 
+ * @return  pdPASS on success, pdFAIL if calibration failed.
+ */
+static BaseType_t ADC0_xCalibrate(struct ADC_Calibration *const pxCalibration)
+{
+    const volatile uint32_t *const pulClp = &ADC0->CLPD;
+    const volatile uint32_t *const pulClm = &ADC0->CLMD;
+    uint32_t ulPlusSum = 0;
+    uint32_t ulMinusSum = 0;
+    
     /**
-     * Enable hardware average
+     * Recommended calibration configuration:
+     * ADCK = bus clock / 8 = 3 MHz
+     * Long sample time
+     * 16 bit conversion
      * 32 samples averaged
      */
+    ADC0->CFG1 = ADC_CFG1_ADIV(3) | ADC_CFG1_ADLSMP(1) | ADC_CFG1_MODE(ADC_CFG1_MODE_16BIT);
+    ADC0->CFG2 = 0;
     ADC0->SC3 = ADC_SC3_AVGE(1) | ADC_SC3_AVGS(ADC_SC3_AVGS_32SAMPLES);
+    
+    /* Start calibration, completion sets COCO */
+    BME_OR32(&ADC0->SC3, ADC_SC3_CAL(1));
+    while (!(ADC0->SC1[0] & ADC_SC1_COCO(1)))
+    {
+        ; /* Wait until calibration is finished */
+    }
+    
+    if (ADC0->SC3 & ADC_SC3_CALF(1))
+    {
+        return pdFAIL;
+    }
+    
+    for (uint32_t i = 0; i < CAL_REGISTER_COUNT; i++)
+    {
+        pxCalibration->ulClp[i] = pulClp[i];
+        pxCalibration->ulClm[i] = pulClm[i];
+        
+        /* Gains are calculated from CLxS and CLx4..CLx0 */
+        if (i > 0)
+        {
+            ulPlusSum += pulClp[i];
+            ulMinusSum += pulClm[i];
+        }
+    }
+    
+    /* Gain = sum / 2 with MSB set */
+    pxCalibration->ulPg = (ulPlusSum >> 1) | 0x8000;
+    pxCalibration->ulMg = (ulMinusSum >> 1) | 0x8000;
+    pxCalibration->ulOfs = ADC0->OFS;
+    
+    ADC0->PG = pxCalibration->ulPg;
+    ADC0->MG = pxCalibration->ulMg;
+    
+    return pdPASS;
+}
+
+
+/**
+ * @brief   Write stored calibration to ADC0.
+ * 
+ * @param   pxCalibration   Calibration record.
+ * 
+ * @return  None
+ */
+static void ADC0_vRestoreCalibration(const struct ADC_Calibration *const pxCalibration)
+{
+    volatile uint32_t *const pulClp = &ADC0->CLPD;
+    volatile uint32_t *const pulClm = &ADC0->CLMD;
+    
+    for (uint32_t i = 0; i < CAL_REGISTER_COUNT; i++)
+    {
+        pulClp[i] = pxCalibration->ulClp[i];
+        pulClm[i] = pxCalibration->ulClm[i];
+    }
+    
+    ADC0->OFS = pxCalibration->ulOfs;
+    ADC0->PG = pxCalibration->ulPg;
+    ADC0->MG = pxCalibration->ulMg;
+}
+
+
+/**
+ * @brief   Write acquisition profile to ADC0. ADC must be idle.
+ * 
+ * @param   ucProfile   Profile from enum ADC_Profiles.
+ * 
+ * @return  None
+ */
+static void ADC0_vApplyProfile(const uint8_t ucProfile)
+{
+    configASSERT(ucProfile < ADC_PROFILE_COUNT);
+    
+    ADC0->CFG1 = xProfiles[ucProfile].ulCfg1;
+    ADC0->CFG2 = xProfiles[ucProfile].ulCfg2;
+    ADC0->SC3 = xProfiles[ucProfile].ulSc3;
+}
+
+
+/**
+ * @brief   Measure conversion time and noise of every profile on one
+ *          channel. Results are stored in xAdcProfileStats.
+ * 
+ * @note    Polls the ADC, call before scan and compare users start.
+ * 
+ * @param   ucChannel   Channel with a steady input.
+ * 
+ * @return  None
+ */
+void ADC0_vMeasureProfiles(const uint8_t ucChannel)
+{
+    uint32_t ulStart;
+    uint32_t ulTicks;
+    uint32_t ulResult;
+    uint32_t ulSum;
+    uint32_t ulMin;
+    uint32_t ulMax;
+    
+    for (uint8_t ucProfile = 0; ucProfile < ADC_PROFILE_COUNT; ucProfile++)
+    {
+        ADC0_vApplyProfile(ucProfile);
+        
+        ulTicks = 0;
+        ulSum = 0;
+        ulMin = UINT16_MAX;
+        ulMax = 0;
+        
+        for (uint32_t i = 0; i < ADC_PROFILE_MEASURE_SAMPLES; i++)
+        {
+            ulStart = PIT_ulReadTimestamp();
+            ulResult = (uint32_t)ADC0_usReadPolling(ucChannel) << xProfiles[ucProfile].ucResultShift;
+            ulTicks += PIT_ulReadTimestamp() - ulStart;
+            
+            ulSum += ulResult;
+            ulMin = (ulResult < ulMin) ? ulResult : ulMin;
+            ulMax = (ulResult > ulMax) ? ulResult : ulMax;
+        }
+        
+        xAdcProfileStats[ucProfile].ulConversionNs = (ulTicks * 1000) / (ADC_PROFILE_MEASURE_SAMPLES * PIT_TICKS_PER_MICROSECOND);
+        xAdcProfileStats[ucProfile].ulMean = ulSum / ADC_PROFILE_MEASURE_SAMPLES;
+        xAdcProfileStats[ucProfile].ulNoise = ulMax - ulMin;
+        
+        /* Scan trigger would interrupt conversions in progress */
+        configASSERT(xAdcProfileStats[ucProfile].ulConversionNs < (xProfiles[ucProfile].ulTriggerPeriodUs * 1000));
+    }
+    
+    ADC0_vApplyProfile(DEFAULT_PROFILE);
 }
 
         
@@ -72,6 +357,318 @@ uint16_t ADC0_usReadPolling(const uint8_t ucChannel)
 }
 
 
+/**
+ * @brief   Select hardware trigger for DMA driven channel scan.
+ * 
+ * @details Every trigger converts one channel. DMA channel 2 moves the
+ *          result to memory and links to DMA channel 3, which writes the
+ *          next channel to SC1A. The CPU only wakes up once per scan.
+ * 
+ * @param   ulTriggerSource     SIM_SOPT7_ADC0TRGSEL_* trigger. PIT trigger 0
+ *                              is driven by the scan engine, other sources
+ *                              must be started by the caller.
+ * 
+ * @return  None
+ */
+void ADC0_vInitScan(const uint32_t ulTriggerSource)
+{
+    ulScanTrigger = ulTriggerSource;
+    ADC0_vSelectTrigger(ulScanTrigger);
+}
+
+
+/**
+ * @brief   Select ADC0 hardware trigger.
+ * 
+ * @param   ulTriggerSource     SIM_SOPT7_ADC0TRGSEL_* trigger.
+ * 
+ * @return  None
+ */
+static void ADC0_vSelectTrigger(const uint32_t ulTriggerSource)
+{
+    configASSERT(ulTriggerSource <= SIM_SOPT7_ADC0TRGSEL_LPTMR0_TRIG);
+    
+    /* Alternative trigger to ADC0 SC1A */
+    SIM->SOPT7 = (SIM->SOPT7 & ~(SIM_SOPT7_ADC0TRGSEL_MASK | SIM_SOPT7_ADC0PRETRGSEL_MASK)) 
+               | SIM_SOPT7_ADC0ALTTRGEN(1) | SIM_SOPT7_ADC0TRGSEL(ulTriggerSource);
+}
+
+
+/**
+ * @brief   Convert list of channels with DMA. Blocks calling task until done.
+ *          Consecutive channels with the same profile are converted in one
+ *          DMA segment, profile is switched between segments.
+ * 
+ * @note    ADC0_vInitScan() must be called first.
+ * 
+ * @param   pucChannels     Channels to convert.
+ * 
+ * @param   pucProfiles     Acquisition profile of each channel.
+ * 
+ * @param   pusResults      Buffer for results scaled to 16 bits, same order as channels.
+ * 
+ * @param   ulCount         Number of channels.
+ * 
+ * @return  pdPASS, or pdFAIL if a segment timed out and results are not valid.
+ */
+BaseType_t ADC0_xScan(const uint8_t *const pucChannels, const uint8_t *const pucProfiles, uint16_t *const pusResults, const uint32_t ulCount)
+{
+    uint32_t ulSegment = 0;
+    uint32_t ulLength;
+    BaseType_t xResult = pdPASS;
+    const uint32_t ulStart = BENCH_ulTimestamp();
+    
+    configASSERT(ulCount > 0 && (ulCount <= ADC_SCAN_MAX_CHANNELS));
+    
+    while ((ulSegment < ulCount) && (xResult == pdPASS))
+    {
+        ulLength = 1;
+        while ((ulSegment + ulLength < ulCount) && (pucProfiles[ulSegment + ulLength] == pucProfiles[ulSegment]))
+        {
+            ulLength++;
+        }
+        
+        xResult = ADC0_xScanSegment(&pucChannels[ulSegment], &pusResults[ulSegment], ulLength, pucProfiles[ulSegment]);
+        ulSegment += ulLength;
+    }
+    
+    /* Back to default for ADC0_usReadPolling() */
+    ADC0_vApplyProfile(DEFAULT_PROFILE);
+    
+    BENCH_vRecord(BENCH_ADC_SCAN, ulStart);
+    
+    return xResult;
+}
+
+
+/**
+ * @brief   Convert channels with a single profile. Blocks calling task until done.
+ * 
+ * @param   pucChannels     Channels to convert.
+ * 
+ * @param   pusResults      Buffer for results, same order as channels.
+ * 
+ * @param   ulCount         Number of channels.
+ * 
+ * @param   ucProfile       Acquisition profile.
+ * 
+ * @return  pdPASS, or pdFAIL if DMA didn't finish within SCAN_TIMEOUT_MS.
+ */
+static BaseType_t ADC0_xScanSegment(const uint8_t *const pucChannels, uint16_t *const pusResults, const uint32_t ulCount, const uint8_t ucProfile)
+{
+    uint32_t ulDone;
+    
+    /* No scan should be in progress */
+    configASSERT(xScanTask == NULL);
+    xScanTask = xTaskGetCurrentTaskHandle();
+    
+    ADC0_vApplyProfile(ucProfile);
+    
+    /* DMA channels are shared with HS1101 burst, claim them for this segment */
+    DMAMUX0_vInit(ADC_SCAN_DMA_CHANNEL, DMAMUX_CHCFG_SOURCE_ADC0);
+    DMA0_vSetCallback(ADC_SCAN_DMA_CHANNEL, ADC0_vScanDone);
+    
+    /* Channels after the first one, ADC is disabled after last conversion */
+    for (uint32_t i = 1; i < ulCount; i++)
+    {
+        ulScanSequence[i - 1] = ADC_SC1_ADCH(pucChannels[i]);
+    }
+    ulScanSequence[ulCount - 1] = ADC_SC1_ADCH(ADC_CH_DISABLED);
+    
+    /**
+     * Configure result channel:
+     * Interrupt when done
+     * Peripheral request, disabled after last result
+     * 16-bit transfers to incrementing address
+     * Link to sequence channel after every result
+     */
+    DMA0_vConfigureChannel(ADC_SCAN_DMA_CHANNEL, DMA_DCR_EINT(1) | DMA_DCR_ERQ(1) | DMA_DCR_D_REQ(1) | DMA_DCR_CS(1)
+                                               | DMA_DCR_SSIZE(DMA_DCR_SIZE_16BIT) | DMA_DCR_DSIZE(DMA_DCR_SIZE_16BIT) | DMA_DCR_DINC(1)
+                                               | DMA_DCR_LINKCC(DMA_DCR_LINKCC_CYCLE_STEAL) | DMA_DCR_LCH1(ADC_SCAN_LINK_DMA_CHANNEL));
+    DMA0_vInitTransaction(ADC_SCAN_DMA_CHANNEL, (uint32_t *)&ADC0->R[0], (uint32_t *)pusResults, ulCount * sizeof(uint16_t));
+    
+    /**
+     * Configure sequence channel:
+     * Started by link only
+     * 32-bit transfers from incrementing address
+     */
+    DMA0_vConfigureChannel(ADC_SCAN_LINK_DMA_CHANNEL, DMA_DCR_CS(1) | DMA_DCR_SSIZE(DMA_DCR_SIZE_32BIT) | DMA_DCR_DSIZE(DMA_DCR_SIZE_32BIT) | DMA_DCR_SINC(1));
+    DMA0_vInitTransaction(ADC_SCAN_LINK_DMA_CHANNEL, ulScanSequence, (uint32_t *)&ADC0->SC1[0], ulCount * sizeof(uint32_t));
+    
+    DMA0_vStart(ADC_SCAN_DMA_CHANNEL);
+    
+    /**
+     * Hardware trigger
+     * DMA request on conversion complete
+     */
+    BME_OR32(&ADC0->SC2, ADC_SC2_ADTRG(1) | ADC_SC2_DMAEN(1));
+    
+    /* First channel waits for trigger */
+    ADC0->SC1[0] = ADC_SC1_ADCH(pucChannels[0]);
+    
+    if (ulScanTrigger == SIM_SOPT7_ADC0TRGSEL_PIT_TRIG0)
+    {
+        PIT_vStartTrigger(xProfiles[ucProfile].ulTriggerPeriodUs);
+    }
+    
+    /* Sleep until all channels are converted */
+    ulDone = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SCAN_TIMEOUT_MS));
+    
+    if (ulScanTrigger == SIM_SOPT7_ADC0TRGSEL_PIT_TRIG0)
+    {
+        PIT_vStopTrigger();
+    }
+    
+    /* Back to software trigger for ADC0_usReadPolling() */
+    DMA0_vStop(ADC_SCAN_DMA_CHANNEL);
+    BME_AND32(&ADC0->SC2, ~(ADC_SC2_ADTRG(1) | ADC_SC2_DMAEN(1)));
+    ADC0->SC1[0] = ADC_SC1_ADCH(ADC_CH_DISABLED);
+    
+    /**
+     * Timed out, e.g. a lost trigger. Stop the callback from notifying
+     * and take a notification it already gave, so that it can't end the
+     * next wait early. A scan that finished just late is still valid.
+     */
+    if (ulDone == 0)
+    {
+        taskENTER_CRITICAL();
+        xScanTask = NULL;
+        taskEXIT_CRITICAL();
+        ulDone = ulTaskNotifyTake(pdTRUE, 0);
+    }
+    
+    if (ulDone == 0)
+    {
+        ulScanTimeouts++;
+        return pdFAIL;
+    }
+    
+    /* Lower resolutions are right justified */
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        pusResults[i] <<= xProfiles[ucProfile].ucResultShift;
+    }
+    
+    return pdPASS;
+}
+
+
+/**
+ * @brief   DMA callback for completed scan. Notifies scanning task.
+ * 
+ * @param   ulStatus                    DMA channel status.
+ * 
+ * @param   pxHigherPriorityTaskWoken   Set to pdTRUE if context switch is needed.
+ * 
+ * @return  None
+ */
+static void ADC0_vScanDone(const uint32_t ulStatus, BaseType_t *const pxHigherPriorityTaskWoken)
+{
+    /* Bus and configuration errors should not happen */
+    configASSERT((ulStatus & (DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK | DMA_DSR_BCR_CE_MASK)) == 0);
+    
+    /* Task may have given up on a timed out scan */
+    if (xScanTask != NULL)
+    {
+        vTaskNotifyGiveFromISR(xScanTask, pxHigherPriorityTaskWoken);
+    }
+    
+    /* No scan in progress */
+    xScanTask = NULL;
+}
+
+
+/**
+ * @brief   Sleep until channel reads at least usThreshold. LPTMR triggers a
+ *          conversion every ADC_COMPARE_TRIGGER_PERIOD_MS and the compare
+ *          function only completes conversions that pass, so the CPU is
+ *          not woken up by the ones that don't.
+ * 
+ * @param   ucChannel       Channel to monitor.
+ * 
+ * @param   usThreshold     Raw ADC value.
+ * 
+ * @param   xTimeout        Maximum time to wait.
+ * 
+ * @return  pdTRUE if threshold was crossed, pdFALSE on timeout.
+ */
+BaseType_t ADC0_xWaitForCompare(const uint8_t ucChannel, const uint16_t usThreshold, const TickType_t xTimeout)
+{
+    uint32_t ulCrossed;
+    
+    /* Scan and compare share the converter */
+    configASSERT(xScanTask == NULL);
+    configASSERT(xCompareTask == NULL);
+    xCompareTask = xTaskGetCurrentTaskHandle();
+    
+    /**
+     * Compare function enabled
+     * Greater than or equal to CV1
+     * Hardware trigger
+     */
+    ADC0->CV1 = ADC_CV1_CV(usThreshold);
+    BME_OR32(&ADC0->SC2, ADC_SC2_ACFE(1) | ADC_SC2_ACFGT(1) | ADC_SC2_ADTRG(1));
+    ADC0_vSelectTrigger(SIM_SOPT7_ADC0TRGSEL_LPTMR0_TRIG);
+    
+    NVIC_SetPriority(ADC0_IRQn, 3);
+    NVIC_ClearPendingIRQ(ADC0_IRQn);
+    NVIC_EnableIRQ(ADC0_IRQn);
+    
+    /* Interrupt when a conversion passes compare */
+    ADC0->SC1[0] = ADC_SC1_AIEN(1) | ADC_SC1_ADCH(ucChannel);
+    LPTMR0_vStartTrigger(ADC_COMPARE_TRIGGER_PERIOD_MS);
+    
+    ulCrossed = ulTaskNotifyTake(pdTRUE, xTimeout);
+    
+    LPTMR0_vStopTrigger();
+    NVIC_DisableIRQ(ADC0_IRQn);
+    
+    /**
+     * Compare may pass just after the timeout. Stop ISR from notifying
+     * and take a notification it already gave, so that it can't end
+     * the next scan wait early. Late crossing still counts.
+     */
+    taskENTER_CRITICAL();
+    xCompareTask = NULL;
+    taskEXIT_CRITICAL();
+    ulCrossed += ulTaskNotifyTake(pdTRUE, 0);
+    
+    /* Disable converter before handing it back to scan and polling */
+    ADC0->SC1[0] = ADC_SC1_ADCH(ADC_CH_DISABLED);
+    BME_AND32(&ADC0->SC2, ~(ADC_SC2_ACFE(1) | ADC_SC2_ACFGT(1) | ADC_SC2_ADTRG(1)));
+    ADC0_vSelectTrigger(ulScanTrigger);
+    
+    return (ulCrossed != 0) ? pdTRUE : pdFALSE;
+}
+
+
+/**
+ * @brief   ADC0 IRQ handler. Triggered when a compare conversion passes.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void ADC0_IRQHandler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    
+    /* Reading result clears COCO */
+    (void)ADC0->R[0];
+    
+    /* Stop conversions, task restores ADC */
+    ADC0->SC1[0] = ADC_SC1_ADCH(ADC_CH_DISABLED);
+    
+    if (xCompareTask != NULL)
+    {
+        vTaskNotifyGiveFromISR(xCompareTask, &xHigherPriorityTaskWoken);
+    }
+    
+    /* Force context switch if xHigherPriorityTaskWoken is set to pdTRUE */
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+
 /**
  * @brief   Initialize CMP0 peripheral.
  * 
@@ -110,6 +707,7 @@ void CMP0_vInit(void)
     /**
      * Enable 6-bit DAC
      * Set reference voltage at 0.3V => 64 * 0.3V / 3.3V = 6
+     * HS1101 auto-ranging changes it per measurement
      */
     CMP0->DACCR = CMP_DACCR_DACEN(1) | CMP_DACCR_VOSEL(6);
 }
@@ -15,13 +15,20 @@
                                     (((x) >= 0x40000000) && ((x) < 0x40100000)))    
 
 
+/* Local variables */
+static DMA_Callback pxCallbacks[DMAMUX_CHCFG_COUNT];
+
+/* Local function prototypes */
+static void DMA0_vHandleInterrupt(const uint32_t ulChannel);
+
+
 /* Function descriptions */
 
 /**
  * @brief   Initialize DMAMUX0.
  * 
  * @param   ulChannel       DMA channel.
- *
+ * 
  * @param   ucSource        DMA0 trigger source.
  * 
  * @return  None
@@ -30,7 +37,7 @@ void DMAMUX0_vInit(uint32_t const ulChannel, uint32_t const ulSource)
 {
     configASSERT(ulChannel < DMAMUX_CHCFG_COUNT);
     configASSERT(ulSource <= DMAMUX0_CHCFG_SOURCE_TSI);
-
+    
     /* Disable DMA channels to configure it */
     DMAMUX0->CHCFG[ulChannel] = 0;
     
@@ -40,112 +47,160 @@ void DMAMUX0_vInit(uint32_t const ulChannel, uint32_t const ulSource)
 
 
 /**
- * @brief   Link DMA0 channels.
+ * @brief   Initialize DMA addresses and transfer size.
  * 
- * @param   ucSrcCh     Source channel
- *
- * @param   ucDstCh     Destination channel
+ * @param   ulChannel       DMA channel.
+ * 
+ * @param   pulSrcAddr      Source address
+ * 
+ * @param   pulDstAddr      Destination address
+ * 
+ * @param   ulLength        Transaction length
  * 
  * @return  None
  */
-void DMA0_vLinkChannel(const uint32_t ulSrcCh, const uint32_t ulDstCh)
+void DMA0_vInitTransaction(const uint32_t ulChannel, uint32_t *const pulSrcAddr, uint32_t *const pulDstAddr, const uint32_t ulLength)
 {
-    configASSERT(ulSrcCh < DMAMUX_CHCFG_COUNT);
-    configASSERT(ulDstCh < DMAMUX_CHCFG_COUNT);
-
-    /* Perform a link to channel LCH1 after each cycle-steal transfer */
-    DMA0->DMA[ulSrcCh].DCR |= DMA_DCR_LINKCC(2) | DMA_DCR_LCH1(ulDstCh);
+    configASSERT(ulChannel < DMAMUX_CHCFG_COUNT);
+    configASSERT(VALIDATE_ADDR_REG((uint32_t)pulSrcAddr));
+    configASSERT(VALIDATE_ADDR_REG((uint32_t)pulDstAddr));
+    configASSERT(ulLength < BCR_MAX_LEN);
+    
+    /* Initialize source & destination pointers */
+    DMA0->DMA[ulChannel].SAR = DMA_SAR_SAR((uint32_t)pulSrcAddr);
+    DMA0->DMA[ulChannel].DAR = DMA_DAR_DAR((uint32_t)pulDstAddr);
+    
+    /* Number of bytes to transmit, writing zero to DONE has no effect */
+    DMA0->DMA[ulChannel].DSR_BCR = DMA_DSR_BCR_BCR(ulLength);
 }
 
 
 /**
- * @brief   Initialize DMA for byte transfers on peripheral request.
+ * @brief   Enable DMA0 on specified channel.
  * 
- * @param   None
+ * @param   ulChannel       DMA channel.
  * 
  * @return  None
  */
-void DMA0_vInit(void)
+void DMA0_vStart(const uint32_t ulChannel)
 {
-    /**
-     * Configure channel 0:
-     * Increment source address
-     * Transfer bytes
-     * Enable peripheral request
-     * Cycle stealing mode
-     */
-    DMA0->DMA[DMA_CHANNEL0].DCR |= DMA_DCR_ERQ(1) | DMA_DCR_CS(1) | DMA_DCR_SSIZE(1) | DMA_DCR_DSIZE(1) | DMA_DCR_SINC(1);
-
-    /**
-     * Configure channel 1:
-     * Increment destination address
-     * Transfer bytes
-     * Enable peripheral request
-     * Cycle stealing mode
-     */
-    DMA0->DMA[DMA_CHANNEL1].DCR |= DMA_DCR_ERQ(1) | DMA_DCR_CS(1) | DMA_DCR_SSIZE(1) | DMA_DCR_DSIZE(1) | DMA_DCR_DINC(1);
+    configASSERT(ulChannel < DMAMUX_CHCFG_COUNT);
     
-    /* Clear done flags */
-    DMA0->DMA[DMA_CHANNEL0].DSR_BCR &= ~DMA_DSR_BCR_DONE(1);
-    DMA0->DMA[DMA_CHANNEL1].DSR_BCR &= ~DMA_DSR_BCR_DONE(1);
+    /* Set enable flag, CHCFG is a byte register, so byte access */
+    BME_OR8(&DMAMUX0->CHCFG[ulChannel], (uint8_t)DMAMUX_CHCFG_ENBL(1));
 }
 
 
 /**
- * @brief   Initialize DMA addresses and transfer size.
+ * @brief   Disable DMA0.
  * 
  * @param   ulChannel       DMA channel.
  * 
- * @param   pulSrcAddr      Source address
+ * @return  None
+ */
+void DMA0_vStop(const uint32_t ulChannel)
+{
+    configASSERT(ulChannel < DMAMUX_CHCFG_COUNT);
+    
+    BME_AND8(&DMAMUX0->CHCFG[ulChannel], (uint8_t)~DMAMUX_CHCFG_ENBL(1));
+}
+
+
+/**
+ * @brief   Clear channel status and write its control register.
  * 
- * @param   pulDstAddr      Destination address
+ * @param   ulChannel       DMA channel.
  * 
- * @param   ulLength        Transaction length
+ * @param   ulControl       DCR value.
  * 
  * @return  None
  */
-void DMA0_vInitTransaction(const uint32_t ulChannel, uint32_t *const pulSrcAddr, uint32_t *const pulDstAddr, const uint32_t ulLength)
+void DMA0_vConfigureChannel(const uint32_t ulChannel, const uint32_t ulControl)
 {
     configASSERT(ulChannel < DMAMUX_CHCFG_COUNT);
-    configASSERT(VALIDATE_ADDR_REG((uint32_t)pulSrcAddr));
-    configASSERT(VALIDATE_ADDR_REG((uint32_t)pulDstAddr));
-    configASSERT(ulLength < BCR_MAX_LEN);
     
-    /* Initialize source & destination pointers */
-    DMA0->DMA[ulChannel].SAR = DMA_SAR_SAR((uint32_t)pulSrcAddr);
-    DMA0->DMA[ulChannel].DAR = DMA_DAR_DAR((uint32_t)pulDstAddr);
+    /* Clear DONE & error bits */
+    DMA0->DMA[ulChannel].DSR_BCR = DMA_DSR_BCR_DONE(1);
     
-    /* Number of bytes to transmit */
-    DMA0->DMA[ulChannel].DSR_BCR |= DMA_DSR_BCR_BCR(ulLength);
+    DMA0->DMA[ulChannel].DCR = ulControl;
 }
 
 
 /**
- * @brief   Enable DMA0 on specified channel.
+ * @brief   Set function to be called from ISR when channel is done. Enables
+ *          the channel interrupt in NVIC, set DMA_DCR_EINT to generate it.
  * 
  * @param   ulChannel       DMA channel.
  * 
+ * @param   pxCallback      Function to call, NULL to disable.
+ * 
  * @return  None
  */
-void DMA0_vStart(const uint32_t ulChannel)
+void DMA0_vSetCallback(const uint32_t ulChannel, const DMA_Callback pxCallback)
 {
+    const IRQn_Type xIrq = (IRQn_Type)(DMA0_IRQn + ulChannel);
+    
     configASSERT(ulChannel < DMAMUX_CHCFG_COUNT);
     
-    /* Set enable flag */
-    BME_OR32(&DMAMUX0->CHCFG[ulChannel], DMAMUX_CHCFG_ENBL(1));
+    NVIC_DisableIRQ(xIrq);
+    pxCallbacks[ulChannel] = pxCallback;
+    
+    if (pxCallback != NULL)
+    {
+        NVIC_SetPriority(xIrq, 3);
+        NVIC_ClearPendingIRQ(xIrq);
+        NVIC_EnableIRQ(xIrq);
+    }
 }
 
 
 /**
- * @brief   Disable DMA0.
+ * @brief   Common DMA ISR. Clears channel status and calls the registered callback.
  * 
  * @param   ulChannel       DMA channel.
  * 
  * @return  None
  */
-void DMA0_vStop(const uint32_t ulChannel)
+static void DMA0_vHandleInterrupt(const uint32_t ulChannel)
 {
-    configASSERT(ulChannel < DMAMUX_CHCFG_COUNT);
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    const uint32_t ulStatus = DMA0->DMA[ulChannel].DSR_BCR;
+    
+    /* Clear DONE & error bits */
+    BME_OR32(&DMA0->DMA[ulChannel].DSR_BCR, DMA_DSR_BCR_DONE(1));
+    
+    /* Interrupt should not be enabled without callback */
+    configASSERT(pxCallbacks[ulChannel] != NULL);
+    
+    pxCallbacks[ulChannel](ulStatus, &xHigherPriorityTaskWoken);
+    
+    /* Force context switch if xHigherPriorityTaskWoken is set to pdTRUE */
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+
+/**
+ * DMA channel IRQ handlers.
+ */
+void DMA0_IRQHandler(void)
+{
+    DMA0_vHandleInterrupt(DMA_CHANNEL0);
+}
 
-    BME_AND32(&DMAMUX0->CHCFG[ulChannel], ~DMAMUX_CHCFG_ENBL(1));
+
+void DMA1_IRQHandler(void)
+{
+    DMA0_vHandleInterrupt(DMA_CHANNEL1);
+}
+
+
+void DMA2_IRQHandler(void)
+{
+    DMA0_vHandleInterrupt(DMA_CHANNEL2);
+}
+
+
+void DMA3_IRQHandler(void)
+{
+    DMA0_vHandleInterrupt(DMA_CHANNEL3);
 }
@@ -0,0 +1,171 @@
+/**
+ * flash.c
+ * Driver module for MKL25 FTFA flash controller.
+ */
+
+#include "flash.h"
+
+
+/* Local defines */
+#define CRC32_POLYNOMIAL        (0xEDB88320UL)      /* Reversed IEEE 802.3 */
+#define FTFA_FSTAT_ERRORS       (FTFA_FSTAT_RDCOLERR_MASK | FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK)
+
+/* Place function in .data, startup code copies it to RAM, host build defines it empty */
+#ifndef RAMFUNC
+#define RAMFUNC                 __attribute__((section(".data.ramfunc"), noinline, long_call))
+#endif
+
+
+/* Local function prototypes */
+static BaseType_t FTFA_xExecuteCommand(void);
+static RAMFUNC void FTFA_vLaunchCommand(void);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Launch command and wait until it completes.
+ * 
+ * @note    Flash can't be read while a command is in progress, so this
+ *          must run from RAM.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static RAMFUNC void FTFA_vLaunchCommand(void)
+{
+    /* Writing 1 to CCIF launches the command */
+    FTFA->FSTAT = FTFA_FSTAT_CCIF_MASK;
+    
+    while (!(FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK))
+    {
+        ; /* Wait until command is completed */
+    }
+}
+
+
+/**
+ * @brief   Execute command loaded to FCCOB registers.
+ * 
+ * @param   None
+ * 
+ * @return  pdPASS on success, pdFAIL on access error, protection violation
+ *          or failed verify.
+ */
+static BaseType_t FTFA_xExecuteCommand(void)
+{
+    const uint32_t ulPrimask = __get_PRIMASK();
+    
+    /* Interrupt vectors and handlers are in flash */
+    __disable_irq();
+    FTFA_vLaunchCommand();
+    if (ulPrimask == 0)
+    {
+        __enable_irq();
+    }
+    
+    return ((FTFA->FSTAT & (FTFA_FSTAT_ERRORS | FTFA_FSTAT_MGSTAT0_MASK)) == 0) ? pdPASS : pdFAIL;
+}
+
+
+/**
+ * @brief   Erase one flash sector.
+ * 
+ * @param   ulAddress   Sector aligned address.
+ * 
+ * @return  pdPASS on success, else pdFAIL.
+ */
+BaseType_t FTFA_xEraseSector(const uint32_t ulAddress)
+{
+    configASSERT((ulAddress % FTFA_SECTOR_SIZE) == 0);
+    
+    /* Previous command must be done */
+    while (!(FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK))
+    {
+        ;
+    }
+    
+    /* Clear old errors */
+    FTFA->FSTAT = FTFA_FSTAT_ERRORS;
+    
+    FTFA->FCCOB0 = FTFA_CMD_ERASE_SECTOR;
+    FTFA->FCCOB1 = (uint8_t)(ulAddress >> 16);
+    FTFA->FCCOB2 = (uint8_t)(ulAddress >> 8);
+    FTFA->FCCOB3 = (uint8_t)ulAddress;
+    
+    return FTFA_xExecuteCommand();
+}
+
+
+/**
+ * @brief   Program longwords to erased flash.
+ * 
+ * @param   ulAddress   Longword aligned address.
+ * 
+ * @param   pulData     Data to program.
+ * 
+ * @param   ulCount     Number of longwords.
+ * 
+ * @return  pdPASS on success, else pdFAIL.
+ */
+BaseType_t FTFA_xProgram(const uint32_t ulAddress, const uint32_t *const pulData, const uint32_t ulCount)
+{
+    uint32_t ulTarget;
+    
+    configASSERT((ulAddress % sizeof(uint32_t)) == 0);
+    
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        ulTarget = ulAddress + i * sizeof(uint32_t);
+        
+        while (!(FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK))
+        {
+            ;
+        }
+        FTFA->FSTAT = FTFA_FSTAT_ERRORS;
+        
+        /* Address and data, most significant byte first */
+        FTFA->FCCOB0 = FTFA_CMD_PROGRAM_LONGWORD;
+        FTFA->FCCOB1 = (uint8_t)(ulTarget >> 16);
+        FTFA->FCCOB2 = (uint8_t)(ulTarget >> 8);
+        FTFA->FCCOB3 = (uint8_t)ulTarget;
+        FTFA->FCCOB4 = (uint8_t)(pulData[i] >> 24);
+        FTFA->FCCOB5 = (uint8_t)(pulData[i] >> 16);
+        FTFA->FCCOB6 = (uint8_t)(pulData[i] >> 8);
+        FTFA->FCCOB7 = (uint8_t)pulData[i];
+        
+        if (FTFA_xExecuteCommand() != pdPASS)
+        {
+            return pdFAIL;
+        }
+    }
+    
+    return pdPASS;
+}
+
+
+/**
+ * @brief   Calculate CRC-32 of a record stored in flash.
+ * 
+ * @param   pulData     Data to check.
+ * 
+ * @param   ulCount     Number of longwords.
+ * 
+ * @return  CRC-32
+ */
+uint32_t FTFA_ulChecksum(const uint32_t *const pulData, const uint32_t ulCount)
+{
+    uint32_t ulCrc = 0xFFFFFFFF;
+    
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        ulCrc ^= pulData[i];
+        for (uint32_t ulBit = 0; ulBit < 32; ulBit++)
+        {
+            ulCrc = (ulCrc & 1) ? ((ulCrc >> 1) ^ CRC32_POLYNOMIAL) : (ulCrc >> 1);
+        }
+    }
+    
+    return ~ulCrc;
+}
@@ -0,0 +1,53 @@
+/**
+ * lptmr.c
+ * Driver module for MKL25 LPTMR peripheral.
+ */
+
+#include "lptmr.h"
+
+
+/* Local defines */
+#define LPTMR_CLOCK_LPO         (1UL)   /* 1 kHz low power oscillator */
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Start periodic hardware trigger, e.g. for ADC0. LPTMR keeps
+ *          running in low power modes.
+ * 
+ * @param   ulPeriodMs      Trigger period in milliseconds.
+ * 
+ * @return  None
+ */
+void LPTMR0_vStartTrigger(const uint32_t ulPeriodMs)
+{
+    configASSERT(ulPeriodMs > 0 && (ulPeriodMs <= LPTMR_MAX_PERIOD_MS));
+    
+    /* Disabling resets the counter */
+    LPTMR0->CSR = 0;
+    
+    /* 1 kHz LPO clock without prescaler */
+    LPTMR0->PSR = LPTMR_PSR_PCS(LPTMR_CLOCK_LPO) | LPTMR_PSR_PBYP(1);
+    LPTMR0->CMR = LPTMR_CMR_COMPARE(ulPeriodMs - 1);
+    
+    /**
+     * Time counter mode
+     * Clear flag to restart period
+     * Enable timer
+     */
+    LPTMR0->CSR = LPTMR_CSR_TCF(1) | LPTMR_CSR_TEN(1);
+}
+
+
+/**
+ * @brief   Stop hardware trigger.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void LPTMR0_vStopTrigger(void)
+{
+    LPTMR0->CSR = LPTMR_CSR_TCF(1);
+}
@@ -14,6 +14,19 @@
 #define MAX_PAYLOAD_LEN             (32UL)
 #define ADDR_40BIT_LEN              (6UL)
 
+#if NRF24L01_MAX_TX_PAYLOAD >= MAX_PAYLOAD_LEN
+#error "W_TX_PAYLOAD transaction must fit the payload and command byte"
+#endif
+
+#if (NRF24L01_RETR_DELAY + NRF24L01_RETR_DELAY_SPREAD - 1) > 15 || (NRF24L01_RETR_COUNT > 15)
+#error "SETUP_RETR fields are 4 bits wide"
+#endif
+
+/* ARD of 500 s fits an ACK with any payload length at 2 Mbps */
+#if NRF24L01_RETR_DELAY < 1
+#error "ACK payloads need NRF24L01_RETR_DELAY of 1 or more"
+#endif
+
 /* Commands */
 #define R_REGISTER                  (0x00UL)    /* Read command and status registers */
 #define W_REGISTER                  (0x20UL)    /* Write command and status registers - power down/standby modes only */
@@ -22,7 +35,7 @@
 #define FLUSH_TX                    (0xE1UL)    /* Flush TX FIFO */
 #define FLUSH_RX                    (0xE2UL)    /* Flush RX FIFO */
 #define REUSE_TX_PL                 (0xE3UL)    /* Reuse last transmitted payload */
-#define R_RX_PL_WID                 (0x63UL)    /* Read RX payload width */
+#define R_RX_PL_WID                 (0x60UL)    /* Read RX payload width */
 #define W_ACK_PAYLOAD               (0xA8UL)    /* Write Payload to be transmitted together ACK packet */
 #define W_ACK_PAYLOAD_NOACK         (0xB0UL)    /* Disable AUTOACK in specific packet */
 #define NOP                         (0xFFUL)    /* No Operation to read STATUS register */
@@ -31,10 +44,12 @@
 #define CONFIG                      (0x00UL)    /* Configuration Register */
 #define EN_AA                       (0x01UL)    /* Enable Auto Acknowledgement */
 #define EN_RXADDR                   (0x02UL)    /* Enabled RX Addresses */
+#define SETUP_AW                    (0x03UL)    /* Setup of Address Widths */
 #define SETUP_RETR                  (0x04UL)    /* Setup of Automatic Retransmission */
 #define RF_CH                       (0x05UL)    /* RF Channel */
 #define RF_SETUP                    (0x06UL)    /* RF Setup Register */
 #define STATUS                      (0x07UL)    /* Status Register */
+#define OBSERVE_TX                  (0x08UL)    /* Transmit observe register */
 #define RX_ADDR_P0                  (0x0AUL)    /* Receive address data pipe 0 */
 #define RX_ADDR_P1                  (0x0BUL)    /* Receive address data pipe 1 */
 #define RX_ADDR_P2                  (0x0CUL)    /* Receive address data pipe 2 */
@@ -48,6 +63,9 @@
 #define RX_PW_P3                    (0x14UL)    /* RX Payload Width Pipe 3 */
 #define RX_PW_P4                    (0x15UL)    /* RX Payload Width Pipe 4 */
 #define RX_PW_P5                    (0x16UL)    /* RX Payload Width Pipe 5 */
+#define FIFO_STATUS                 (0x17UL)    /* FIFO Status Register */
+#define DYNPD                       (0x1CUL)    /* Enable dynamic payload length */
+#define FEATURE                     (0x1DUL)    /* Feature Register */
 
 /* Register bits */
 #define CONFIG_MASK_RX_DR(x)        (((uint8_t)(((uint8_t)(x)) << 6)) & 0x40UL)
@@ -79,6 +97,7 @@
 #define STATUS_TX_DS(x)             (((uint8_t)(((uint8_t)(x)) << 5)) & 0x20UL)
 #define STATUS_MAX_RT(x)            (((uint8_t)(((uint8_t)(x)) << 4)) & 0x10UL)
 #define STATUS_RX_P_NO(x)           (((uint8_t)(((uint8_t)(x)) << 1)) & 0x0EUL)
+#define STATUS_RX_P_NO_EMPTY        (7UL)       /* RX FIFO empty */
 #define STATUS_TX_FULL(x)           (((uint8_t)(((uint8_t)(x)) << 0)) & 0x01UL)
 
 #define RF_CH_MHZ(x)                (((uint8_t)(((uint8_t)(x)) << 0)) & 0x7FUL)
@@ -89,14 +108,75 @@
 #define RF_SETUP_RF_DR_HIGH(x)      (((uint8_t)(((uint8_t)(x)) << 3)) & 0x08UL)
 #define RF_SETUP_RF_PWR(x)          (((uint8_t)(((uint8_t)(x)) << 1)) & 0x06UL)
 
+#define FIFO_STATUS_TX_FULL(x)      (((uint8_t)(((uint8_t)(x)) << 5)) & 0x20UL)
+#define FIFO_STATUS_TX_EMPTY(x)     (((uint8_t)(((uint8_t)(x)) << 4)) & 0x10UL)
+#define FIFO_STATUS_RX_EMPTY(x)     (((uint8_t)(((uint8_t)(x)) << 0)) & 0x01UL)
+
+#define DYNPD_DPL_P0(x)             (((uint8_t)(((uint8_t)(x)) << 0)) & 0x01UL)
+
+#define FEATURE_EN_DPL(x)           (((uint8_t)(((uint8_t)(x)) << 2)) & 0x04UL)
+#define FEATURE_EN_ACK_PAY(x)       (((uint8_t)(((uint8_t)(x)) << 1)) & 0x02UL)
+#define FEATURE_EN_DYN_ACK(x)       (((uint8_t)(((uint8_t)(x)) << 0)) & 0x01UL)
+
 #define RX_PW_PX(x)                 (((uint8_t)(((uint8_t)(x)) << 0)) & 0x3FUL)
 
+#define OBSERVE_TX_PLOS_CNT(x)      (((uint8_t)(x) & 0xF0UL) >> 4)
+#define OBSERVE_TX_ARC_CNT(x)       (((uint8_t)(x) & 0x0FUL) >> 0)
+
+/**
+ * Enhanced ShockBurst packet at 2 Mbps:
+ * preamble 1 byte + address 5 bytes + packet control 9 bits + payload + CRC 2 bytes
+ * Each attempt also pays 130 s TX settling.
+ */
+#define AIR_BITS_PER_US             (2UL)
+#define AIR_TX_SETTLING_US          (130UL)
+#define AIR_OVERHEAD_BITS           ((1UL + RXTX_ADDR_LEN + 2UL) * 8UL + 9UL)
+#define AIR_TIME_US(payload)        (AIR_TX_SETTLING_US + (AIR_OVERHEAD_BITS + (payload) * 8UL) / AIR_BITS_PER_US)
+#define AIR_ACK_PAYLOAD_US(payload) (((payload) * 8UL) / AIR_BITS_PER_US)  /* RX time added to ACK */
+
+/**
+ * Register shadow. Configuration registers are only written by the MCU,
+ * so their values are kept here and only changed ones are written.
+ * STATUS, OBSERVE_TX, RPD and FIFO_STATUS change on their own and
+ * addresses are multibyte, so they are not shadowed.
+ */
+#define SHADOW_REGISTERS            (FEATURE + 1)
+#define SHADOW_CACHED               (MASK(CONFIG) | MASK(EN_AA) | MASK(EN_RXADDR) | MASK(SETUP_AW) | MASK(SETUP_RETR) \
+                                     | MASK(RF_CH) | MASK(RF_SETUP) | MASK(RX_PW_P0) | MASK(RX_PW_P1) | MASK(RX_PW_P2) \
+                                     | MASK(RX_PW_P3) | MASK(RX_PW_P4) | MASK(RX_PW_P5) | MASK(DYNPD) | MASK(FEATURE))
+#define SHADOW_MAX_COUNT            (15UL)      /* Registers in SHADOW_CACHED */
+#define REGISTER_ACCESS_LEN         (2UL)       /* Command and one byte */
+
+
+/* Global variables */
+struct nRF24L01_Stats xRadioStats;
+
+
+/* Local variables */
+static uint8_t ucTxFifoLength[NRF24L01_TX_FIFO_SIZE];  /* Payload lengths, oldest at head */
+static uint32_t ulTxFifoHead = 0;
+static uint32_t ulTxFifoCount = 0;          /* Payloads in TX FIFO not known to be acked */
+static TaskHandle_t xTxTask = NULL;         /* Task waiting for TX_DS or MAX_RT */
+static uint8_t ucShadow[SHADOW_REGISTERS];  /* Values of SHADOW_CACHED registers */
+static uint32_t ulShadowValid = 0;          /* Registers known to match nRF24L01 */
+static uint32_t ulShadowDirty = 0;          /* Registers staged but not written */
+static uint8_t ucAddress[RXTX_ADDR_LEN];    /* TX_ADDR and RX_ADDR_P0 */
+static uint8_t ucLastStatus = 0;            /* STATUS clocked out by latest SPI transaction */
+
 
 /* Local function prototypes */
 __STATIC_INLINE void nRF24L01_vConfigureIRQ(void);
 __STATIC_INLINE void nRF24L01_vConfigureChipEnable(void);
 __STATIC_INLINE void nRF24L01_vSetChipEnable(const uint32_t ulState);
 __STATIC_INLINE void nRF24L01_vStartTransmission(void);
+static void nRF24L01_vWritePayload(const char *pucPayload, uint32_t ulLength);
+static void nRF24L01_vCompletePayloads(const uint32_t ulAcked, const uint8_t ucStatus);
+static void nRF24L01_vTransfer(const char *const pucTxData, char *const pucRxData, const uint32_t ulLength);
+static uint8_t nRF24L01_ucClearStatus(const uint8_t ucFlags);
+static void nRF24L01_vStageRegister(const uint8_t ucRegister, const uint8_t ucValue);
+static void nRF24L01_vCommitRegisters(void);
+static void nRF24L01_vShadowLoad(void);
+__STATIC_INLINE void nRF24L01_vSetFrame(struct SPI1_Transaction *const pxFrame, const char *const pucTxData, char *const pucRxData);
 
 /* Function descriptions */
 
@@ -112,34 +192,56 @@ void nRF24L01_vInit(void)
     nRF24L01_vConfigureIRQ();
     nRF24L01_vConfigureChipEnable();
     nRF24L01_vSetChipEnable(LOW);
-
-    /* RF Channel 2450 MHz */
-    nRF24L01_vWriteRegister(RF_CH, RF_CH_MHZ(50));
-
-    /* Set RX & TX address matching */
-    const uint8_t ucTxAddr[ADDR_40BIT_LEN] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x00 }; /* LSB written first, null-terminator at end */
+    
+    /* nRF24L01 keeps its registers over an MCU reset, only differing ones are written */
+    nRF24L01_vShadowLoad();
+    
+    /* RF Channel */
+    nRF24L01_vStageRegister(RF_CH, RF_CH_MHZ(NRF24L01_RF_CHANNEL));
+    
+    /* Set RX & TX address matching, own gateway pipe so ACK payloads reach this node only */
+    const uint8_t ucTxAddr[ADDR_40BIT_LEN] = { COMMAND_ADDRESS_BASE + COMMAND_PIPE(NODE_ID), 0x22, 0x33, 0x44, 0x55, 0x00 }; /* LSB written first, null-terminator at end */
     nRF24L01_vWriteAddressRegister(RX_ADDR_P0, ucTxAddr, ADDR_40BIT_LEN);
     nRF24L01_vWriteAddressRegister(TX_ADDR, ucTxAddr, ADDR_40BIT_LEN);
+    memcpy(ucAddress, ucTxAddr, RXTX_ADDR_LEN);
     
     /* Enable data pipe 0 */
-    nRF24L01_vWriteRegister(EN_RXADDR, EN_RXADDR_ERX_P0(1));
-
+    nRF24L01_vStageRegister(EN_RXADDR, EN_RXADDR_ERX_P0(1));
+    
     /* Auto ACK data pipe 0 */
-    nRF24L01_vWriteRegister(EN_AA, EN_AA_ENAA_P0(1));
-
+    nRF24L01_vStageRegister(EN_AA, EN_AA_ENAA_P0(1));
+    
     /**
-     * 500 s delay between retries
-     * 10 retries
+     * Dynamic payload length
+     * Payload with ACK, gateway downlink
      */
-    nRF24L01_vWriteRegister(SETUP_RETR, SETUP_RETR_ARD(1) | SETUP_RETR_ARC(3));
-
+    nRF24L01_vStageRegister(FEATURE, FEATURE_EN_DPL(1) | FEATURE_EN_ACK_PAY(1));
+    
+    /* Pipe 0 receives ACKs of dynamic length */
+    nRF24L01_vStageRegister(DYNPD, DYNPD_DPL_P0(1));
+    
+    /**
+     * Node specific delay between retries
+     * Retry count
+     */
+    nRF24L01_vStageRegister(SETUP_RETR, SETUP_RETR_ARD(NRF24L01_RETR_DELAY + NODE_ID % NRF24L01_RETR_DELAY_SPREAD) | SETUP_RETR_ARC(NRF24L01_RETR_COUNT));
+    
     /**
+     * ACK payload comes with TX_DS, keep RX_DR off IRQ line
      * Enable CRC
      * 2 byte CRC
      * Power Up
      * TX mode
      */
-    nRF24L01_vWriteRegister(CONFIG, CONFIG_EN_CRC(1) | CONFIG_CRCO(1) | CONFIG_PWR_UP(1));
+    nRF24L01_vStageRegister(CONFIG, CONFIG_MASK_RX_DR(1) | CONFIG_EN_CRC(1) | CONFIG_CRCO(1) | CONFIG_PWR_UP(1));
+    
+    /* All staged registers in one burst */
+    nRF24L01_vCommitRegisters();
+    
+    /* Start with empty FIFOs and IRQ line released, each transmission leaves TX side so */
+    nRF24L01_vSendCommand(FLUSH_TX);
+    nRF24L01_vSendCommand(FLUSH_RX);
+    nRF24L01_vResetStatusFlags();
 }
 
 
@@ -205,15 +307,17 @@ __STATIC_INLINE void nRF24L01_vSetChipEnable(const uint32_t ulState)
 /**
  * @brief   Pulse CE line low for 10 s to start transmission.
  * 
+ * @note    IRQ notifies the calling task when transmission ends.
+ * 
  * @param   None
  * 
  * @return  None
  */
 __STATIC_INLINE void nRF24L01_vStartTransmission(void)
 {
-    /* Disable TPM2 interrupts just to be sure */
-    BME_AND8(&TPM2->SC, ~(uint8_t)TPM_SC_TOIE(1));
-
+    /* Set before CE pulse, IRQ comes 130 s after it at the earliest */
+    xTxTask = xTaskGetCurrentTaskHandle();
+    
     /* Send minimum 10 s pulse */
     TPM2->CNT = 0;
     nRF24L01_vSetChipEnable(HIGH);
@@ -224,10 +328,7 @@ __STATIC_INLINE void nRF24L01_vStartTransmission(void)
     }
     TPM2_vStop();
     nRF24L01_vSetChipEnable(LOW);
-
-    /* Turn TPM2 interrupts on again */
-    BME_OR8(&TPM2->SC, TPM_SC_TOIE(1));
-
+    
     /* Reset TPM2 counter */
     TPM2->CNT = 0;
 }
@@ -247,52 +348,446 @@ void nRF24L01_vResetStatusFlags(void)
      * Reset transmission succeeded flag
      * Reset transmission failed flag
      */
-    nRF24L01_vWriteRegister(STATUS, STATUS_RX_DR(1) | STATUS_TX_DS(1) | STATUS_MAX_RT(1));
+    (void)nRF24L01_ucClearStatus(STATUS_RX_DR(1) | STATUS_TX_DS(1) | STATUS_MAX_RT(1));
 }
 
 
 /**
- * @brief   Transmit payload.
+ * @brief   Transmit payload. Wait for the outcome with
+ *          nRF24L01_ulWaitForTransmit() before sending the next one.
  * 
- * @note    Message max length 32 bytes.
+ * @note    TX FIFO must be empty.
  * 
  * @param   pucPayload      Payload to send.
- *
- * @param   ulLength        Transaction length
- *             
+ * 
+ * @param   ulLength        Payload length, max 31 bytes.
+ * 
  * @return  None
  */
 void nRF24L01_vSendPayload(const char *pucPayload, uint32_t ulLength)
 {
-    ulLength++; /* Allocate byte for W_TX_PAYLOD */
+    const uint32_t ulStart = BENCH_ulTimestamp();
     
-    configASSERT((ulLength) < MAX_PAYLOAD_LEN);
-    char ucRxData[ulLength];
-    char ucTxData[ulLength];
+    configASSERT(ulTxFifoCount == 0);
+    
+    nRF24L01_vWritePayload(pucPayload, ulLength);
+    
+    nRF24L01_vStartTransmission();
+    
+    BENCH_vRecordSpan(BENCH_RADIO_SEND, ulStart, BENCH_ulTimestamp(), ulLength + 1);
+}
+
+
+/**
+ * @brief   Send payload left in TX FIFO by MAX_RT again.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void nRF24L01_vRetransmit(void)
+{
+    configASSERT(ulTxFifoCount != 0);
+    
+    nRF24L01_vStartTransmission();
+}
 
-    /* Transfer 1...32 bytes */
-    nRF24L01_vWriteRegister(RX_PW_P0, RX_PW_PX(ulLength));
 
+/**
+ * @brief   Discard payloads left in TX FIFO by MAX_RT or timeout.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void nRF24L01_vFlushTx(void)
+{
     nRF24L01_vSendCommand(FLUSH_TX);
+    ulTxFifoCount = 0;
+}
+
+
+/**
+ * @brief   Block until IRQ tells that transmission ended, then clear
+ *          interrupt flags.
+ * 
+ * @note    Payload stays in TX FIFO unless it was acked, retransmit or
+ *          flush it before sending the next one.
+ * 
+ * @param   xTicksToWait    Max time to wait for IRQ.
+ * 
+ * @return  NRF24L01_TX_ACKED, NRF24L01_TX_MAX_RT or NRF24L01_TX_TIMEOUT.
+ */
+uint32_t nRF24L01_ulWaitForTransmit(const TickType_t xTicksToWait)
+{
+    uint8_t ucStatus;
+    uint32_t ulResult;
+    
+    configASSERT(ulTxFifoCount == 1);
+    
+    (void)ulTaskNotifyTake(pdTRUE, xTicksToWait);
+    
+    /**
+     * IRQ may come after the timeout. Stop it from notifying and take
+     * a notification it already gave, so that it can't end the next
+     * wait early.
+     */
+    taskENTER_CRITICAL();
+    xTxTask = NULL;
+    taskEXIT_CRITICAL();
+    (void)ulTaskNotifyTake(pdTRUE, 0);
+    
+    /**
+     * Flags tell the outcome even if IRQ was late. Clearing them also
+     * reads them and releases IRQ line for next falling edge.
+     */
+    ucStatus = nRF24L01_ucClearStatus(STATUS_RX_DR(1) | STATUS_TX_DS(1) | STATUS_MAX_RT(1));
+    if (ucStatus & STATUS_TX_DS(1))
+    {
+        ulResult = NRF24L01_TX_ACKED;
+        nRF24L01_vCompletePayloads(1, ucStatus);
+    }
+    else if (ucStatus & STATUS_MAX_RT(1))
+    {
+        ulResult = NRF24L01_TX_MAX_RT;
+        nRF24L01_vCompletePayloads(0, ucStatus);
+    }
+    else
+    {
+        ulResult = NRF24L01_TX_TIMEOUT;
+        xRadioStats.ulTimeouts++;
+    }
+    
+    return ulResult;
+}
+
+
+/**
+ * @brief   Start streaming mode. CE is held high, so the nRF24L01 sends
+ *          payloads loaded with nRF24L01_vLoadPayload() back to back.
+ * 
+ * @note    TX FIFO must be empty or loaded with nRF24L01_vLoadPayload().
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void nRF24L01_vStreamStart(void)
+{
+    /* Notify on every TX_DS until nRF24L01_vStreamStop() */
+    xTxTask = xTaskGetCurrentTaskHandle();
+    
+    nRF24L01_vSetChipEnable(HIGH);
+}
+
+
+/**
+ * @brief   Add payload to TX FIFO, sent right away in streaming mode.
+ * 
+ * @note    Max NRF24L01_TX_FIFO_SIZE payloads without an ACK.
+ * 
+ * @param   pucPayload      Payload to send.
+ * 
+ * @param   ulLength        Payload length, max 31 bytes.
+ * 
+ * @return  None
+ */
+void nRF24L01_vLoadPayload(const char *pucPayload, uint32_t ulLength)
+{
+    const uint32_t ulStart = BENCH_ulTimestamp();
+    
+    nRF24L01_vWritePayload(pucPayload, ulLength);
+    
+    BENCH_vRecordSpan(BENCH_RADIO_SEND, ulStart, BENCH_ulTimestamp(), ulLength + 1);
+}
+
+
+/**
+ * @brief   Block in streaming mode until payloads are acked or the
+ *          oldest one reaches MAX_RT.
+ * 
+ * @note    One TX_DS may stand for several ACKs. FIFO_STATUS only tells
+ *          empty and full apart, so a missed ACK is found when FIFO
+ *          empties or fills. Until then pulAcked lags behind.
+ * 
+ * @param   xTicksToWait    Max time to wait for IRQ.
+ * 
+ * @param   pulAcked        Payloads acked since the last call, oldest first.
+ * 
+ * @return  NRF24L01_TX_ACKED, or NRF24L01_TX_MAX_RT when the oldest
+ *          payload stays in TX FIFO until nRF24L01_vStreamResume() or
+ *          nRF24L01_vStreamStop(), or NRF24L01_TX_TIMEOUT.
+ */
+uint32_t nRF24L01_ulStreamWait(const TickType_t xTicksToWait, uint32_t *const pulAcked)
+{
+    uint8_t ucStatus;
+    uint8_t ucFifo;
+    uint32_t ulNotified;
+    uint32_t ulRemaining;
+    
+    configASSERT(ulTxFifoCount != 0);
+    
+    ulNotified = ulTaskNotifyTake(pdTRUE, xTicksToWait);
+    
+    /* Clear only the TX_DS seen, IRQ notifies again of a later one */
+    ucStatus = nRF24L01_ucClearStatus(STATUS_TX_DS(1));
+    
+    ucFifo = nRF24L01_ucReadRegister(FIFO_STATUS);
+    if (ucFifo & FIFO_STATUS_TX_EMPTY(1))
+    {
+        ulRemaining = 0;
+    }
+    else if (ucFifo & FIFO_STATUS_TX_FULL(1))
+    {
+        ulRemaining = NRF24L01_TX_FIFO_SIZE;
+    }
+    else
+    {
+        /* 1...2 payloads left, count one ACK per TX_DS */
+        ulRemaining = ulTxFifoCount - ((ucStatus & STATUS_TX_DS(1)) ? 1 : 0);
+        ulRemaining = (ulRemaining == 0) ? 1 : ulRemaining;
+        ulRemaining = (ulRemaining == NRF24L01_TX_FIFO_SIZE) ? NRF24L01_TX_FIFO_SIZE - 1 : ulRemaining;
+    }
+    
+    configASSERT(ulRemaining <= ulTxFifoCount);
+    *pulAcked = ulTxFifoCount - ulRemaining;
+    
+    nRF24L01_vCompletePayloads(*pulAcked, ucStatus);
+    
+    if (ucStatus & STATUS_MAX_RT(1))
+    {
+        return NRF24L01_TX_MAX_RT;
+    }
+    
+    if ((ulNotified == 0) && (*pulAcked == 0))
+    {
+        xRadioStats.ulTimeouts++;
+        return NRF24L01_TX_TIMEOUT;
+    }
+    
+    return NRF24L01_TX_ACKED;
+}
+
+
+/**
+ * @brief   Clear MAX_RT in streaming mode to send the oldest payload again.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void nRF24L01_vStreamResume(void)
+{
+    configASSERT(ulTxFifoCount != 0);
     
+    /* New CE edge restarts transmission */
+    nRF24L01_vSetChipEnable(LOW);
+    (void)nRF24L01_ucClearStatus(STATUS_MAX_RT(1));
+    nRF24L01_vSetChipEnable(HIGH);
+}
+
+
+/**
+ * @brief   End streaming mode. Payloads not acked are discarded.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void nRF24L01_vStreamStop(void)
+{
+    nRF24L01_vSetChipEnable(LOW);
+    
+    /* Same as in nRF24L01_ulWaitForTransmit() */
+    taskENTER_CRITICAL();
+    xTxTask = NULL;
+    taskEXIT_CRITICAL();
+    (void)ulTaskNotifyTake(pdTRUE, 0);
+    
+    if (ulTxFifoCount != 0)
+    {
+        nRF24L01_vFlushTx();
+    }
+    
+    /* Release IRQ line for next falling edge */
     nRF24L01_vResetStatusFlags();
+}
+
+
+/**
+ * @brief   Read payload the gateway sent with an ACK.
+ * 
+ * @note    Call after each acked payload, RX FIFO holds three. STATUS
+ *          of the latest transaction tells whether there is one, so an
+ *          empty RX FIFO costs no SPI transaction.
+ * 
+ * @param   pucPayload      Room for 32 bytes.
+ * 
+ * @return  Payload length, 0 if there was none.
+ */
+uint32_t nRF24L01_ulReadAckPayload(uint8_t *const pucPayload)
+{
+    char ucTxData[MAX_PAYLOAD_LEN + 1] = { (char)R_RX_PL_WID, (char)NOP };
+    char ucRxData[MAX_PAYLOAD_LEN + 1];
+    uint32_t ulLength;
+    
+    if ((ucLastStatus & STATUS_RX_P_NO(STATUS_RX_P_NO_EMPTY)) == STATUS_RX_P_NO(STATUS_RX_P_NO_EMPTY))
+    {
+        return 0;
+    }
+    
+    nRF24L01_vTransfer(ucTxData, ucRxData, 2);
+    ulLength = (uint8_t)ucRxData[1];
+    
+    /* Width over 32 bytes means a corrupted payload, which must be flushed */
+    if ((ulLength == 0) || (ulLength > MAX_PAYLOAD_LEN))
+    {
+        nRF24L01_vSendCommand(FLUSH_RX);
+        ulLength = 0;
+    }
+    else
+    {
+        ucTxData[0] = (char)R_RX_PAYLOAD;
+        for (uint32_t i = 1; i <= ulLength; i++)
+        {
+            ucTxData[i] = (char)NOP;
+        }
+        nRF24L01_vTransfer(ucTxData, ucRxData, ulLength + 1);
+        
+        for (uint32_t i = 0; i < ulLength; i++)
+        {
+            pucPayload[i] = (uint8_t)ucRxData[i + 1];
+        }
+        
+        xRadioStats.ulAckPayloads++;
+        xRadioStats.ulAckPayloadBytes += ulLength;
+        xRadioStats.ulAckAirtimeUs += AIR_ACK_PAYLOAD_US(ulLength);
+    }
+    
+    /**
+     * NOP refreshes STATUS for the next call. RX_DR is masked from IRQ
+     * line, it is cleared with the other flags.
+     */
+    ucTxData[0] = (char)NOP;
+    nRF24L01_vTransfer(ucTxData, ucRxData, 1);
+    
+    return ulLength;
+}
+
 
+/**
+ * @brief   Write payload to TX FIFO.
+ * 
+ * @param   pucPayload      Payload to send.
+ * 
+ * @param   ulLength        Payload length, max 31 bytes.
+ * 
+ * @return  None
+ */
+static void nRF24L01_vWritePayload(const char *pucPayload, uint32_t ulLength)
+{
+    ulLength++; /* Allocate byte for W_TX_PAYLOD */
+    
+    configASSERT(ulLength <= MAX_PAYLOAD_LEN);
+    configASSERT(ulTxFifoCount < NRF24L01_TX_FIFO_SIZE);
+    char ucRxData[ulLength];
+    char ucTxData[ulLength];
+    
     /* Build message */
     ucTxData[0] = W_TX_PAYLOAD;
     for (uint32_t i = 0; i < ulLength - 1; i++)
     {
         ucTxData[i + 1] = pucPayload[i];
     }
-
+    
     /* Transfer bytes to nRF24L01 */
-    SPI1_vTransmitDMA(ucTxData, ucRxData, ulLength);
+    nRF24L01_vTransfer(ucTxData, ucRxData, ulLength);
     
-    nRF24L01_vStartTransmission();
+    ucTxFifoLength[(ulTxFifoHead + ulTxFifoCount) % NRF24L01_TX_FIFO_SIZE] = (uint8_t)(ulLength - 1);
+    ulTxFifoCount++;
+}
+
+
+/**
+ * @brief   Remove acked payloads from TX FIFO bookkeeping and update
+ *          xRadioStats with their transmissions.
+ * 
+ * @note    ARC_CNT is of the latest transmission and is reset when the
+ *          next one starts. Earlier payloads acked at once are counted
+ *          as sent without retransmits.
+ * 
+ * @param   ulAcked     Payloads acked, oldest first.
+ * 
+ * @param   ucStatus    STATUS register after them.
+ * 
+ * @return  None
+ */
+static void nRF24L01_vCompletePayloads(const uint32_t ulAcked, const uint8_t ucStatus)
+{
+    uint8_t ucObserve;
+    uint32_t ulAttempts;
+    uint32_t ulLength;
+    
+    if ((ulAcked == 0) && ((ucStatus & STATUS_MAX_RT(1)) == 0))
+    {
+        return;
+    }
+    
+    ucObserve = nRF24L01_ucReadRegister(OBSERVE_TX);
+    
+    for (uint32_t i = 0; i < ulAcked; i++)
+    {
+        const uint32_t ulLatest = (i == ulAcked - 1) && ((ucStatus & STATUS_MAX_RT(1)) == 0);
+        
+        ulLength = ucTxFifoLength[ulTxFifoHead];
+        ulAttempts = ulLatest ? OBSERVE_TX_ARC_CNT(ucObserve) + 1 : 1;
+        
+        xRadioStats.ulPayloads++;
+        xRadioStats.ulPayloadBytes += ulLength;
+        xRadioStats.ulRetransmits += ulAttempts - 1;
+        xRadioStats.ulAirtimeUs += ulAttempts * AIR_TIME_US(ulLength);
+        
+        ulTxFifoHead = (ulTxFifoHead + 1) % NRF24L01_TX_FIFO_SIZE;
+        ulTxFifoCount--;
+    }
+    
+    /* Oldest payload left was sent without ACK */
+    if (ucStatus & STATUS_MAX_RT(1))
+    {
+        ulLength = ucTxFifoLength[ulTxFifoHead];
+        ulAttempts = OBSERVE_TX_ARC_CNT(ucObserve) + 1;
+        
+        xRadioStats.ulPayloads++;
+        xRadioStats.ulPayloadBytes += ulLength;
+        xRadioStats.ulRetransmits += ulAttempts - 1;
+        xRadioStats.ulAirtimeUs += ulAttempts * AIR_TIME_US(ulLength);
+        xRadioStats.ulLostPayloads++;
+    }
+}
+
+
+/**
+ * @brief   Read nRF24L01 register.
+ * 
+ * @param   ucRegister      Register to read.
+ * 
+ * @return  Register value.
+ */
+uint8_t nRF24L01_ucReadRegister(const uint8_t ucRegister)
+{
+    char ucRxData[2] = { '\0' };
+    char ucTxData[] = { (char)(R_REGISTER | ucRegister), (char)NOP };
+    
+    /* First byte returns STATUS, second one the register */
+    nRF24L01_vTransfer(ucTxData, ucRxData, 2);
+    
+    return ((uint8_t)ucRxData[1]);
 }
 
 
 /**
- * @brief   Write nRF24L01 register.
+ * @brief   Write nRF24L01 register. Shadowed register is written only
+ *          if its value changes.
  * 
  * @param   ucRegister      Register to write.
  * 
@@ -302,12 +797,77 @@ void nRF24L01_vSendPayload(const char *pucPayload, uint32_t ulLength)
  */
 void nRF24L01_vWriteRegister(const uint8_t ucRegister, const uint8_t ucValue)
 {
-    char ucBuffer[MAX_PAYLOAD_LEN] = { '\0' };
-
+    char ucBuffer[REGISTER_ACCESS_LEN] = { '\0' };
+    
     char ucData[] = { W_REGISTER | ucRegister, ucValue};
-
+    
+    if ((ucRegister < SHADOW_REGISTERS) && (SHADOW_CACHED & MASK(ucRegister)))
+    {
+        nRF24L01_vStageRegister(ucRegister, ucValue);
+        nRF24L01_vCommitRegisters();
+        return;
+    }
+    
     /* First transfer register, then value */
-    SPI1_vTransmitPolling(ucData, ucBuffer, 2);
+    nRF24L01_vTransfer(ucData, ucBuffer, REGISTER_ACCESS_LEN);
+}
+
+
+/**
+ * @brief   Compare shadow with nRF24L01 registers. Registers that
+ *          differ, as after a power cycle of the radio, are written
+ *          again together with the addresses.
+ * 
+ * @note    CE must be low.
+ * 
+ * @param   None
+ * 
+ * @return  Number of registers that differed.
+ */
+uint32_t nRF24L01_ulShadowVerify(void)
+{
+    const uint32_t ulValid = ulShadowValid;
+    uint8_t ucExpected[SHADOW_REGISTERS];
+    uint8_t ucConfig;
+    uint32_t ulMismatches = 0;
+    
+    configASSERT(ulShadowDirty == 0);
+    
+    memcpy(ucExpected, ucShadow, SHADOW_REGISTERS);
+    xRadioStats.ulShadowChecks++;
+    
+    nRF24L01_vShadowLoad();
+    ucConfig = ucShadow[CONFIG];
+    
+    for (uint32_t i = 0; i < SHADOW_REGISTERS; i++)
+    {
+        if ((ulValid & MASK(i)) && (ucShadow[i] != ucExpected[i]))
+        {
+            ucShadow[i] = ucExpected[i];
+            ulShadowDirty |= MASK(i);
+            ulMismatches++;
+        }
+    }
+    
+    if (ulMismatches == 0)
+    {
+        return 0;
+    }
+    
+    xRadioStats.ulShadowRestores += ulMismatches;
+    
+    /* Registers were lost, so were the addresses */
+    nRF24L01_vWriteAddressRegister(RX_ADDR_P0, ucAddress, RXTX_ADDR_LEN);
+    nRF24L01_vWriteAddressRegister(TX_ADDR, ucAddress, RXTX_ADDR_LEN);
+    nRF24L01_vCommitRegisters();
+    
+    /* Two ticks give at least one full tick, over the 1.5 ms power up */
+    if ((ucExpected[CONFIG] & CONFIG_PWR_UP(1)) && ((ucConfig & CONFIG_PWR_UP(1)) == 0))
+    {
+        vTaskDelay((TickType_t)2);
+    }
+    
+    return ulMismatches;
 }
 
 
@@ -320,7 +880,10 @@ void nRF24L01_vWriteRegister(const uint8_t ucRegister, const uint8_t ucValue)
  */
 void nRF24L01_vSendCommand(const uint8_t ucCommand)
 {
-    SPI1_vTransmitByte(ucCommand);
+    char ucRxData[1];
+    const char ucTxData[] = { (char)ucCommand };
+    
+    nRF24L01_vTransfer(ucTxData, ucRxData, 1);
 }
 
 
@@ -351,14 +914,198 @@ void nRF24L01_vWriteAddressRegister(const uint8_t ucRegister, const uint8_t *puc
     {
         ucTxData[i + 1] = pucValue[i];
     }
-
+    
     /* Transfer bytes to nRF24L01 */
-    SPI1_vTransmitDMA(ucTxData, ucRxData, ulLength);
+    nRF24L01_vTransfer(ucTxData, ucRxData, ulLength);
+}
+
+
+/**
+ * @brief   Transfer bytes to nRF24L01 and keep the STATUS it clocks out
+ *          first.
+ * 
+ * @param   pucTxData       Command and data.
+ * 
+ * @param   pucRxData       STATUS and data.
+ * 
+ * @param   ulLength        Transaction length.
+ * 
+ * @return  None
+ */
+static void nRF24L01_vTransfer(const char *const pucTxData, char *const pucRxData, const uint32_t ulLength)
+{
+    SPI1_vTransmit(SPI1_DEVICE_RADIO, pucTxData, pucRxData, ulLength);
+    
+    ucLastStatus = (uint8_t)pucRxData[0];
+    xRadioStats.ulSpiTransactions++;
+    xRadioStats.ulSpiBytes += ulLength;
+}
+
+
+/**
+ * @brief   Clear STATUS flags. Writing a flag that is not set has no
+ *          effect, so no read is needed first.
+ * 
+ * @param   ucFlags         STATUS_RX_DR, STATUS_TX_DS and STATUS_MAX_RT
+ *                          bits to clear.
+ * 
+ * @return  STATUS before clearing.
+ */
+static uint8_t nRF24L01_ucClearStatus(const uint8_t ucFlags)
+{
+    char ucRxData[REGISTER_ACCESS_LEN];
+    char ucTxData[] = { (char)(W_REGISTER | STATUS), (char)ucFlags };
+    
+    nRF24L01_vTransfer(ucTxData, ucRxData, REGISTER_ACCESS_LEN);
+    
+    return (uint8_t)ucRxData[0];
+}
+
+
+/**
+ * @brief   Set shadowed register. Written by nRF24L01_vCommitRegisters()
+ *          if the value differs from nRF24L01.
+ * 
+ * @param   ucRegister      Register in SHADOW_CACHED.
+ * 
+ * @param   ucValue         Value to write.
+ * 
+ * @return  None
+ */
+static void nRF24L01_vStageRegister(const uint8_t ucRegister, const uint8_t ucValue)
+{
+    configASSERT((ucRegister < SHADOW_REGISTERS) && (SHADOW_CACHED & MASK(ucRegister)));
+    
+    if ((ulShadowValid & MASK(ucRegister)) && (ucShadow[ucRegister] == ucValue) && ((ulShadowDirty & MASK(ucRegister)) == 0))
+    {
+        xRadioStats.ulSkippedWrites++;
+        return;
+    }
+    
+    ucShadow[ucRegister] = ucValue;
+    ulShadowDirty |= MASK(ucRegister);
+}
+
+
+/**
+ * @brief   Write staged registers back to back in one SPI burst.
+ * 
+ * @note    W_REGISTER writes one register per SS frame, so the burst
+ *          is a chain of transactions with one task wake-up.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void nRF24L01_vCommitRegisters(void)
+{
+    struct SPI1_Transaction xFrames[SHADOW_MAX_COUNT];
+    char ucTxData[SHADOW_MAX_COUNT * REGISTER_ACCESS_LEN];
+    char ucRxData[SHADOW_MAX_COUNT * REGISTER_ACCESS_LEN];
+    uint32_t ulFrames = 0;
+    uint32_t ulRegister;
+    
+    if (ulShadowDirty == 0)
+    {
+        return;
+    }
+    
+    /* CONFIG last, so radio powers up configured */
+    for (uint32_t i = 1; i <= SHADOW_REGISTERS; i++)
+    {
+        ulRegister = i % SHADOW_REGISTERS;
+        if (ulShadowDirty & MASK(ulRegister))
+        {
+            ucTxData[ulFrames * REGISTER_ACCESS_LEN] = (char)(W_REGISTER | ulRegister);
+            ucTxData[ulFrames * REGISTER_ACCESS_LEN + 1] = (char)ucShadow[ulRegister];
+            nRF24L01_vSetFrame(&xFrames[ulFrames], &ucTxData[ulFrames * REGISTER_ACCESS_LEN], &ucRxData[ulFrames * REGISTER_ACCESS_LEN]);
+            ulFrames++;
+        }
+    }
+    
+    SPI1_vTransmitChain(xFrames, ulFrames);
+    
+    ucLastStatus = (uint8_t)ucRxData[(ulFrames - 1) * REGISTER_ACCESS_LEN];
+    xRadioStats.ulSpiTransactions += ulFrames;
+    xRadioStats.ulSpiBytes += ulFrames * REGISTER_ACCESS_LEN;
+    
+    ulShadowValid |= ulShadowDirty;
+    ulShadowDirty = 0;
 }
 
 
 /**
- * @brief   PORTA IRQ handler. Triggered when nRF24L01 transmits payload.
+ * @brief   Read shadowed registers from nRF24L01 in one SPI burst.
+ *          Staged registers are dropped.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+static void nRF24L01_vShadowLoad(void)
+{
+    struct SPI1_Transaction xFrames[SHADOW_MAX_COUNT];
+    char ucTxData[SHADOW_MAX_COUNT * REGISTER_ACCESS_LEN];
+    char ucRxData[SHADOW_MAX_COUNT * REGISTER_ACCESS_LEN];
+    uint32_t ulFrames = 0;
+    
+    for (uint32_t i = 0; i < SHADOW_REGISTERS; i++)
+    {
+        if (SHADOW_CACHED & MASK(i))
+        {
+            ucTxData[ulFrames * REGISTER_ACCESS_LEN] = (char)(R_REGISTER | i);
+            ucTxData[ulFrames * REGISTER_ACCESS_LEN + 1] = (char)NOP;
+            nRF24L01_vSetFrame(&xFrames[ulFrames], &ucTxData[ulFrames * REGISTER_ACCESS_LEN], &ucRxData[ulFrames * REGISTER_ACCESS_LEN]);
+            ulFrames++;
+        }
+    }
+    configASSERT(ulFrames == SHADOW_MAX_COUNT);
+    
+    SPI1_vTransmitChain(xFrames, ulFrames);
+    
+    ulFrames = 0;
+    for (uint32_t i = 0; i < SHADOW_REGISTERS; i++)
+    {
+        if (SHADOW_CACHED & MASK(i))
+        {
+            ucShadow[i] = (uint8_t)ucRxData[ulFrames * REGISTER_ACCESS_LEN + 1];
+            ulFrames++;
+        }
+    }
+    
+    ucLastStatus = (uint8_t)ucRxData[(ulFrames - 1) * REGISTER_ACCESS_LEN];
+    xRadioStats.ulSpiTransactions += ulFrames;
+    xRadioStats.ulSpiBytes += ulFrames * REGISTER_ACCESS_LEN;
+    
+    ulShadowValid = SHADOW_CACHED;
+    ulShadowDirty = 0;
+}
+
+
+/**
+ * @brief   Set register access frame of a burst.
+ * 
+ * @param   pxFrame         Transaction to set.
+ * 
+ * @param   pucTxData       Command and data.
+ * 
+ * @param   pucRxData       STATUS and data.
+ * 
+ * @return  None
+ */
+__STATIC_INLINE void nRF24L01_vSetFrame(struct SPI1_Transaction *const pxFrame, const char *const pucTxData, char *const pucRxData)
+{
+    pxFrame->ulDevice = SPI1_DEVICE_RADIO;
+    pxFrame->pucTxData = pucTxData;
+    pxFrame->pucRxData = pucRxData;
+    pxFrame->ulLength = REGISTER_ACCESS_LEN;
+}
+
+
+/**
+ * @brief   PORTA IRQ handler. Triggered when nRF24L01 raises TX_DS or
+ *          MAX_RT, wakes the task waiting in nRF24L01_ulWaitForTransmit()
+ *          or nRF24L01_ulStreamWait().
  * 
  * @param   None
  * 
@@ -366,9 +1113,20 @@ void nRF24L01_vWriteAddressRegister(const uint8_t ucRegister, const uint8_t *puc
  */
 void PORTA_IRQHandler(void)
 {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    
     if (PORTA_ISFR & MASK(IRQ))
     {
         /* Clear status flag */
         PORTA->ISFR = MASK(IRQ);
+        
+        /* Waiting task sets it NULL when it stops waiting */
+        if (xTxTask != NULL)
+        {
+            vTaskNotifyGiveFromISR(xTxTask, &xHigherPriorityTaskWoken);
+        }
     }
+    
+    /* Force context switch if xHigherPriorityTaskWoken is set pdTRUE */
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 }
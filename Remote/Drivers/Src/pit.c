@@ -0,0 +1,87 @@
+/**
+ * pit.c
+ * Driver module for MKL25 PIT peripheral.
+ */
+
+#include "pit.h"
+
+
+/* Local defines */
+#define TIMESTAMP_CHANNEL       (PIT_CHANNEL1)
+#define TIMESTAMP_RELOAD        (0xFFFFFFFFUL)
+#define TRIGGER_CHANNEL         (PIT_CHANNEL0)
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Initialize PIT. Channel 1 is left free-running as a timestamp counter.
+ * 
+ * @details Counter wraps every 2^32 / 24 MHz = 178 s. Differences of two
+ *          timestamps are valid as long as they are computed with unsigned
+ *          arithmetic and the measured interval is shorter than that.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void PIT_vInit(void)
+{
+    /**
+     * Enable PIT module clock
+     * Freeze timers in debug mode
+     */
+    PIT->MCR = PIT_MCR_FRZ(1);
+    
+    /* Free-running down counter, no interrupts */
+    PIT->CHANNEL[TIMESTAMP_CHANNEL].TCTRL = 0;
+    PIT->CHANNEL[TIMESTAMP_CHANNEL].LDVAL = TIMESTAMP_RELOAD;
+    PIT->CHANNEL[TIMESTAMP_CHANNEL].TCTRL = PIT_TCTRL_TEN(1);
+}
+
+
+/**
+ * @brief   Read bus clock timestamp.
+ * 
+ * @param   None
+ * 
+ * @return  Elapsed bus clock ticks since PIT_vInit(), modulo 2^32.
+ */
+uint32_t PIT_ulReadTimestamp(void)
+{
+    /* PIT counts down, invert to get an up-counting value */
+    return (TIMESTAMP_RELOAD - PIT->CHANNEL[TIMESTAMP_CHANNEL].CVAL);
+}
+
+
+/**
+ * @brief   Start periodic hardware trigger on channel 0, e.g. for ADC0.
+ * 
+ * @param   ulPeriodUs      Trigger period in microseconds.
+ * 
+ * @return  None
+ */
+void PIT_vStartTrigger(const uint32_t ulPeriodUs)
+{
+    configASSERT(ulPeriodUs > 0);
+    
+    PIT->CHANNEL[TRIGGER_CHANNEL].TCTRL = 0;
+    PIT->CHANNEL[TRIGGER_CHANNEL].LDVAL = ulPeriodUs * PIT_TICKS_PER_MICROSECOND - 1;
+    
+    /* Clear stale flag and start, trigger does not need interrupts */
+    PIT->CHANNEL[TRIGGER_CHANNEL].TFLG = PIT_TFLG_TIF(1);
+    PIT->CHANNEL[TRIGGER_CHANNEL].TCTRL = PIT_TCTRL_TEN(1);
+}
+
+
+/**
+ * @brief   Stop hardware trigger on channel 0.
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void PIT_vStopTrigger(void)
+{
+    PIT->CHANNEL[TRIGGER_CHANNEL].TCTRL = 0;
+}
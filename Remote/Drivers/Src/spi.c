@@ -13,16 +13,48 @@
 #define MOSI                    (3UL)
 #define SS                      (4UL)
 
-#define COMM_TASK_NOTIFICATION  (1UL)
+#define TRANSFER_TIMEOUT_MS     (200UL)
 #define BYTE_OFFSET             (0x01UL)
+#define DMA_DSR_BCR_ERRORS      (DMA_DSR_BCR_CE_MASK | DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK)
+
+
+/* Local variables */
+struct SPI1_ChipSelect
+{
+    FGPIO_Type *pxGpio;
+    PORT_Type *pxPort;
+    uint32_t ulPin;
+};
+
+/* Second device needs an entry here and in enum SPI1_Devices */
+static const struct SPI1_ChipSelect xChipSelects[SPI1_DEVICE_COUNT] =
+{
+    [SPI1_DEVICE_RADIO] = { FGPIOE, PORTE, SS },
+};
+
+static struct SPI1_Transaction *volatile pxActive = NULL;  /* Head of queue, on the bus */
+static struct SPI1_Transaction *pxTail = NULL;
+static volatile uint32_t ulBusyTicks;
+
+
+/* Global variables */
+struct SPI1_Stats xSpiStats;
+
+
+/* Local function prototypes */
+static void SPI1_vStart(struct SPI1_Transaction *const pxTransaction);
+static void SPI1_vTransactionDone(const uint32_t ulStatus, BaseType_t *const pxHigherPriorityTaskWoken);
+static void SPI1_vNotifyTask(struct SPI1_Transaction *const pxTransaction, BaseType_t *const pxHigherPriorityTaskWoken);
+__STATIC_INLINE void SPI1_vSetChipSelect(const uint32_t ulDevice, const uint32_t ulState);
 
 
 /* Function descriptions */
 
 /**
- * @brief   Initialize SPI1 peripheral. Manual SS used for full-duplex mode.
+ * @brief   Initialize SPI1 peripheral and its DMA channels. Manual SS
+ *          used for full-duplex mode.
  * 
- * @details Baud rate = 48 MHz/(3*2) = 4 MHz = 250 ns/bit
+ * @details Baud rate = 24 MHz/(3*2) = 2 MHz = 500 ns/bit, see SPI1_BAUDRATE
  * 
  * @param   None
  * 
@@ -45,10 +77,13 @@ void SPI1_vInit(void)
     PORTE->PCR[MISO] &= ~PORT_PCR_MUX_MASK;
     PORTE->PCR[MISO] |= PORT_PCR_MUX(ALT5);
     
-    /* Set PTE4 as manual SS */
-    PORTE->PCR[SS] = PORT_PCR_MUX(ALT1);
-    FGPIOE->PDDR |= MASK(SS);
-    FGPIOE->PDOR |= MASK(SS);
+    /* Set manual chip selects, released */
+    for (uint32_t i = 0; i < SPI1_DEVICE_COUNT; i++)
+    {
+        xChipSelects[i].pxPort->PCR[xChipSelects[i].ulPin] = PORT_PCR_MUX(ALT1);
+        xChipSelects[i].pxGpio->PDDR |= MASK(xChipSelects[i].ulPin);
+        xChipSelects[i].pxGpio->PSOR = MASK(xChipSelects[i].ulPin);
+    }
     
     /* Select master mode */
     SPI1->C1 = SPI_C1_MSTR_MASK;
@@ -60,7 +95,19 @@ void SPI1_vInit(void)
     SPI1->C1 &= ~(SPI_C1_CPHA_MASK & SPI_C1_CPOL_MASK);
     
     /* Baudrate = Bus clock / ((SPPR + 1) * 2^^(SPR+1)) */
-    SPI1->BR = SPI_BR_SPPR(2) | SPI_BR_SPR(1);
+    SPI1->BR = SPI_BR_SPPR(SPI1_BR_SPPR) | SPI_BR_SPR(SPI1_BR_SPR);
+    
+    /* Channels stay idle until a transaction enables their requests */
+    DMA0_vConfigureChannel(SPI1_TX_DMA_CHANNEL, 0);
+    DMA0_vConfigureChannel(SPI1_RX_DMA_CHANNEL, 0);
+    DMAMUX0_vInit(SPI1_TX_DMA_CHANNEL, DMAMUX_CHCFG_SOURCE_SPI1_TX);
+    DMAMUX0_vInit(SPI1_RX_DMA_CHANNEL, DMAMUX_CHCFG_SOURCE_SPI1_RX);
+    DMA0_vStart(SPI1_TX_DMA_CHANNEL);
+    DMA0_vStart(SPI1_RX_DMA_CHANNEL);
+    DMA0_vSetCallback(SPI1_RX_DMA_CHANNEL, SPI1_vTransactionDone);
+    
+    /* Enable DMA TX & RX */
+    SPI1->C2 |= SPI_C2_TXDMAE_MASK | SPI_C2_RXDMAE_MASK;
     
     /* Enable SPI1 */
     SPI1->C1 |= SPI_C1_SPE_MASK;
@@ -68,174 +115,292 @@ void SPI1_vInit(void)
 
 
 /**
- * @brief   Read byte from SPI1 receive buffer.
+ * @brief   Queue transactions. They run back to back after the ones
+ *          already queued, callbacks are called from DMA ISR.
  * 
- * @param   None
+ * @note    Not callable from ISR.
+ * 
+ * @param   pxTransactions  Descriptors with device, data, length and
+ *                          callback set. Linked in array order.
  * 
- * @return  SPI1->D     Received byte
+ * @param   ulCount         Number of descriptors.
+ * 
+ * @return  None
  */
-uint8_t SPI1_ucReadPolling(void)
+void SPI1_vSubmit(struct SPI1_Transaction *const pxTransactions, const uint32_t ulCount)
 {
-    while (!BME_UBFX8(&SPI1->S, SPI_S_SPRF_SHIFT, SPI_S_SPRF_WIDTH))
+    uint32_t ulBytes = 0;
+    
+    configASSERT(ulCount > 0);
+    
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        configASSERT(pxTransactions[i].ulDevice < SPI1_DEVICE_COUNT);
+        configASSERT(pxTransactions[i].ulLength > 0);
+        
+        pxTransactions[i].ulDone = FALSE;
+        pxTransactions[i].pxNext = (i < ulCount - 1) ? &pxTransactions[i + 1] : NULL;
+        ulBytes += pxTransactions[i].ulLength;
+    }
+    
+    /* DMA ISR pops the queue */
+    taskENTER_CRITICAL();
+    
+    xSpiStats.ulTransactions += ulCount;
+    xSpiStats.ulBytes += ulBytes;
+    
+    if (pxActive == NULL)
+    {
+        pxActive = pxTransactions;
+        SPI1_vStart(pxTransactions);
+    }
+    else
     {
-        ; /* Wait until buffer full */
+        pxTail->pxNext = pxTransactions;
+        xSpiStats.ulQueued += ulCount;
     }
+    pxTail = &pxTransactions[ulCount - 1];
     
-    return SPI1->D;
+    taskEXIT_CRITICAL();
 }
 
 
 /**
- * @brief   Transmit character over SPI by polling.
+ * @brief   Transfer bytes to device. Blocks calling task until done.
+ * 
+ * @param   ulDevice    enum SPI1_Devices
  * 
- * @param   ucByte      Byte to send.
+ * @param   pucTxData   Data to send.
+ * 
+ * @param   pucRxData   Data to receive.
+ * 
+ * @param   ulLength    Transaction length
  * 
  * @return  None
  */
-void SPI1_vTransmitByte(const char ucByte)
+void SPI1_vTransmit(const uint32_t ulDevice, const char *const pucTxData, char *const pucRxData, const uint32_t ulLength)
 {
-    while (!BME_UBFX8(&SPI1->S, SPI_S_SPTEF_SHIFT, SPI_S_SPTEF_WIDTH))
+    struct SPI1_Transaction xTransaction =
     {
-        ; /* Wait until buffer empty */
-    }
-    
-    /* Transfer byte */
-    SPI1_vSetSlave(LOW);
+        .ulDevice = ulDevice,
+        .pucTxData = pucTxData,
+        .pucRxData = pucRxData,
+        .ulLength = ulLength,
+    };
     
-    SPI1->D = ucByte;
-    (void)SPI1_ucReadPolling();
-    
-    SPI1_vSetSlave(HIGH);
+    SPI1_vTransmitChain(&xTransaction, 1);
 }
 
 
 /**
- * @brief   Transmit message over SPI by polling.
+ * @brief   Run transactions back to back, chip select is released
+ *          between them. Blocks calling task until the last is done.
  * 
- * @param   pucTxData   Pointer to data to send.
+ * @note    Callbacks are replaced, the last one notifies calling task.
+ *          Other notifications taken while waiting, such as nRF24L01
+ *          IRQ, are given back.
  * 
- * @param   pucRxData   Pointer to data to receive.
+ * @param   pxTransactions  Descriptors with device, data and length set.
  * 
- * @param   ulLength    Data length
+ * @param   ulCount         Number of descriptors.
  * 
  * @return  None
  */
-void SPI1_vTransmitPolling(char *const pucData, char *const pucRxData, const uint32_t ulLength)
+void SPI1_vTransmitChain(struct SPI1_Transaction *const pxTransactions, const uint32_t ulCount)
 {
-    /* Disable TPM2 interrupts just to be sure */
-    BME_AND8(&TPM2->SC, ~(uint8_t)TPM_SC_TOIE(1));
-
-    TPM2->CNT = 0;
-    TPM2_vStart();
+    struct SPI1_Transaction *const pxLast = &pxTransactions[ulCount - 1];
+    const TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+    const uint32_t ulSubmitTime = BENCH_ulTimestamp();
+    uint32_t ulNotified;
+    uint32_t ulTaken = 0;
     
-    /* Transfer byte */
-    SPI1_vSetSlave(LOW);
-
-    for (uint32_t i = 0; i < ulLength; i++)
+    configASSERT(ulCount > 0);
+    
+    for (uint32_t i = 0; i < ulCount; i++)
     {
-        while (!BME_UBFX8(&SPI1->S, SPI_S_SPTEF_SHIFT, SPI_S_SPTEF_WIDTH))
+        pxTransactions[i].pxCallback = NULL;
+    }
+    pxLast->pxCallback = SPI1_vNotifyTask;
+    pxLast->pvContext = xTask;
+    
+    SPI1_vSubmit(pxTransactions, ulCount);
+    
+    /**
+     * Take one notification at a time until done. The transaction gave
+     * exactly one, so the rest taken belong to someone else. At least
+     * one is taken, done may be set just after a timeout.
+     */
+    do
+    {
+        ulNotified = ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(TRANSFER_TIMEOUT_MS));
+        configASSERT(ulNotified != 0);
+        
+        /* Timeout took nothing, don't give it back */
+        if (ulNotified != 0)
         {
-            ; /* Wait until TX buffer empty */
+            ulTaken++;
         }
-        
-        SPI1->D = pucData[i];
-        pucRxData[i] = SPI1_ucReadPolling();
+    } while ((pxLast->ulDone == FALSE) || (ulTaken == 0));
+    
+    for (; ulTaken > 1; ulTaken--)
+    {
+        xSpiStats.ulReturnedNotifications++;
+        (void)xTaskNotifyGive(xTask);
     }
-
-    while (TPM2->CNT < (TIME_PER_BYTE * ulLength))
+    
+    BENCH_vRecordSpan(BENCH_SPI_QUEUE, ulSubmitTime, pxTransactions[0].ulStart, 0);
+    for (uint32_t i = 0; i < ulCount; i++)
     {
-        ; /* Wait until transaction done */
+        BENCH_vRecordSpan(BENCH_SPI_TRANSFER, pxTransactions[i].ulStart, pxTransactions[i].ulEnd, pxTransactions[i].ulLength);
     }
+}
 
-    /* Stop TPM2 first to give small overhead for SS */
-    TPM2_vStop();
-    
-    SPI1_vSetSlave(HIGH);
 
-    /* Turn TPM2 interrupts on again */
-    BME_OR8(&TPM2->SC, TPM_SC_TOIE(1));
+/**
+ * @brief   Read and reset time chip selects were held low.
+ * 
+ * @param   None
+ * 
+ * @return  Bus busy time in BENCH_ulTimestamp() ticks.
+ */
+uint32_t SPI1_ulTakeBusyTicks(void)
+{
+    uint32_t ulTicks;
+    
+    taskENTER_CRITICAL();
+    ulTicks = ulBusyTicks;
+    ulBusyTicks = 0;
+    taskEXIT_CRITICAL();
+    
+    return ulTicks;
 }
 
 
 /**
- * @brief   Transmit string over SPI by DMA.
+ * @brief   Start transaction on the bus.
  * 
- * @param   pcTxData    String to send
+ * @note    Called with interrupts disabled or from DMA ISR.
+ * 
+ * @param   pxTransaction   Transaction at head of queue.
  * 
- * @param   pcRxData    String to receive
- *
- * @param   ulLength    Transaction length
- *             
  * @return  None
  */
-void SPI1_vTransmitDMA(char const *pucTxData, char *const pucRxData, const uint32_t ulLength)
+static void SPI1_vStart(struct SPI1_Transaction *const pxTransaction)
 {
-    uint32_t ulTxDone;
-    const TickType_t xMaxBlockTime = pdMS_TO_TICKS(200);
-
-    /* Should be NULL as no transmission is in progress */
-    configASSERT(xCommTask == NULL);
-
-    /* Store the handle of the calling task */
-    xCommTask = xTaskGetCurrentTaskHandle();
-
-    /* Set transfer duration */
-    TPM2_vLoadCounter(ulLength);
-
-    /* Set source and destination addresses */
-    DMA0_vInitTransaction(DMA_CHANNEL0, (uint32_t *)(pucTxData + BYTE_OFFSET), (uint32_t *)&(SPI1->D), ulLength - BYTE_OFFSET);
-    DMA0_vInitTransaction(DMA_CHANNEL1, (uint32_t *)&(SPI1->D), (uint32_t *)(pucRxData), ulLength);
+    const uint32_t ulLength = pxTransaction->ulLength;
     
-    /* Begin transfer */
-    SPI1_vSetSlave(LOW);
-
-    /* Reset counter and start timer */
-    TPM2->CNT = 0;
-    TPM2_vStart();
+    /**
+     * Configure RX channel:
+     * Interrupt when done, last byte is clocked out by then
+     * Peripheral request, disabled after last byte
+     * Bytes to incrementing address
+     */
+    DMA0_vConfigureChannel(SPI1_RX_DMA_CHANNEL, DMA_DCR_EINT(1) | DMA_DCR_ERQ(1) | DMA_DCR_D_REQ(1) | DMA_DCR_CS(1)
+                                              | DMA_DCR_SSIZE(DMA_DCR_SIZE_8BIT) | DMA_DCR_DSIZE(DMA_DCR_SIZE_8BIT) | DMA_DCR_DINC(1));
+    DMA0_vInitTransaction(SPI1_RX_DMA_CHANNEL, (uint32_t *)&SPI1->D, (uint32_t *)pxTransaction->pucRxData, ulLength);
+    
+    SPI1_vSetChipSelect(pxTransaction->ulDevice, LOW);
+    pxTransaction->ulStart = BENCH_ulTimestamp();
     
     /**
      * Datasheet recommends starting transfer by reading status register
      * and sending first byte by placing value to register
      */
     (void)SPI1->S;
-    SPI1->D = pucTxData[0];
-
-    /* Enable DMA TX & RX */ 
-    BME_OR8(&SPI1->C2, SPI_C2_TXDMAE(1));
-    BME_OR8(&SPI1->C2, SPI_C2_RXDMAE(1));
-
-    /* Send rest of the bytes */
-    DMA0_vStart(DMA_CHANNEL0);
+    SPI1->D = pxTransaction->pucTxData[0];
+    
+    if (ulLength > BYTE_OFFSET)
+    {
+        /**
+         * Configure TX channel:
+         * Peripheral request, disabled after last byte
+         * Bytes from incrementing address
+         * 
+         * First byte leaves TX buffer right away, so enable request
+         * after byte count is set.
+         */
+        DMA0_vConfigureChannel(SPI1_TX_DMA_CHANNEL, DMA_DCR_D_REQ(1) | DMA_DCR_CS(1)
+                                                  | DMA_DCR_SSIZE(DMA_DCR_SIZE_8BIT) | DMA_DCR_DSIZE(DMA_DCR_SIZE_8BIT) | DMA_DCR_SINC(1));
+        DMA0_vInitTransaction(SPI1_TX_DMA_CHANNEL, (uint32_t *)(pxTransaction->pucTxData + BYTE_OFFSET), (uint32_t *)&SPI1->D, ulLength - BYTE_OFFSET);
+        BME_OR32(&DMA0->DMA[SPI1_TX_DMA_CHANNEL].DCR, DMA_DCR_ERQ(1));
+    }
+}
 
-    ulTxDone = ulTaskNotifyTake(COMM_TASK_NOTIFICATION, xMaxBlockTime);
-    configASSERT(ulTxDone == COMM_TASK_NOTIFICATION);
 
-    /* Disable DMA TX & RX */
-    BME_AND8(&SPI1->C2, ~(uint8_t)SPI_C2_TXDMAE(1));
-    BME_AND8(&SPI1->C2, ~(uint8_t)SPI_C2_RXDMAE(1));
+/**
+ * @brief   DMA callback for received last byte. Releases chip select,
+ *          starts next queued transaction and calls the callback.
+ * 
+ * @param   ulStatus                    RX channel status.
+ * 
+ * @param   pxHigherPriorityTaskWoken   Set to pdTRUE if context switch is needed.
+ * 
+ * @return  None
+ */
+static void SPI1_vTransactionDone(const uint32_t ulStatus, BaseType_t *const pxHigherPriorityTaskWoken)
+{
+    struct SPI1_Transaction *const pxDone = pxActive;
+    
+    configASSERT(pxDone != NULL);
+    configASSERT((ulStatus & DMA_DSR_BCR_ERRORS) == 0);
+    
+    SPI1_vSetChipSelect(pxDone->ulDevice, HIGH);
+    pxDone->ulEnd = BENCH_ulTimestamp();
+    ulBusyTicks += pxDone->ulEnd - pxDone->ulStart;
+    
+    /* Keep bus busy while callback runs */
+    pxActive = pxDone->pxNext;
+    if (pxActive != NULL)
+    {
+        SPI1_vStart(pxActive);
+    }
+    else
+    {
+        pxTail = NULL;
+    }
+    
+    pxDone->ulDone = TRUE;
+    if (pxDone->pxCallback != NULL)
+    {
+        pxDone->pxCallback(pxDone, pxHigherPriorityTaskWoken);
+    }
+}
 
-    DMA0_vStop(DMA_CHANNEL0);
 
-    /* Clear DONE & error bits */
-    BME_OR32(&DMA0->DMA[DMA_CHANNEL0].DSR_BCR, DMA_DSR_BCR_DONE(1));
-    BME_OR32(&DMA0->DMA[DMA_CHANNEL1].DSR_BCR, DMA_DSR_BCR_DONE(1));
+/**
+ * @brief   Transaction callback of SPI1_vTransmitChain().
+ * 
+ * @param   pxTransaction               Done transaction, task in pvContext.
+ * 
+ * @param   pxHigherPriorityTaskWoken   Set to pdTRUE if context switch is needed.
+ * 
+ * @return  None
+ */
+static void SPI1_vNotifyTask(struct SPI1_Transaction *const pxTransaction, BaseType_t *const pxHigherPriorityTaskWoken)
+{
+    vTaskNotifyGiveFromISR((TaskHandle_t)pxTransaction->pvContext, pxHigherPriorityTaskWoken);
 }
 
 
 /**
- * @brief   Set SS line high/low.
+ * @brief   Set chip select line high/low.
+ * 
+ * @param   ulDevice    enum SPI1_Devices
  * 
  * @param   ulState     HIGH/LOW
  *             
  * @return  None
  */
-void SPI1_vSetSlave(const uint32_t ulState)
+__STATIC_INLINE void SPI1_vSetChipSelect(const uint32_t ulDevice, const uint32_t ulState)
 {
-    configASSERT(ulState == LOW || (ulState == HIGH));
-    
-    /* Figure out whether to set or clear bit */
-    const uint32_t *pulReg = (uint32_t *)&FGPIOE->PCOR - ulState; /* Subtract 0 - 1 words from PCOR address => pulReg = FGPIOE->PSOR/PCOR */
+    const struct SPI1_ChipSelect *const pxChipSelect = &xChipSelects[ulDevice];
     
-    /* Perform bitwise operation */
-    BME_OR32(&(*pulReg), MASK(SS));
+    if (ulState == LOW)
+    {
+        pxChipSelect->pxGpio->PCOR = MASK(pxChipSelect->ulPin);
+    }
+    else
+    {
+        pxChipSelect->pxGpio->PSOR = MASK(pxChipSelect->ulPin);
+    }
 }
@@ -74,27 +74,22 @@ void TPM1_vInit(void)
     TPM1->MOD = 0xFFFF;
 
     /**
-     * Input capture (Channel 1) with interrupt
-     * Rising edge trigger
+     * Input capture (Channel 1) with DMA request
+     * Both edges trigger
      */
     TPM1->CONTROLS[0].CnSC = TPM_CnSC_ELSB(1);
-    TPM1->CONTROLS[1].CnSC = TPM_CnSC_ELSA(1) | TPM_CnSC_CHIE(1);
+    TPM1->CONTROLS[1].CnSC = TPM_CnSC_ELSA(1) | TPM_CnSC_ELSB(1) | TPM_CnSC_CHIE(1) | TPM_CnSC_DMA(1);
 
     /**
-     * Enable timer overflow interrupts
+     * Free-running counter, durations are calculated as modular differences
      * Divide by 128 prescaler
      */
-    TPM1->SC = TPM_SC_PS(7) | TPM_SC_TOIE(1);
-    
-    /* Set NVIC for TPM1 ISR */
-    NVIC_SetPriority(TPM1_IRQn, 3);
-    NVIC_ClearPendingIRQ(TPM1_IRQn);
-    NVIC_EnableIRQ(TPM1_IRQn);
+    TPM1->SC = TPM_SC_PS(TPM1_PRESCALER);
 }
 
 
 /**
- * @brief   Initialize TPM2.
+ * @brief   Initialize TPM2. Free running, polled for short delays.
  * 
  * @param   None
  * 
@@ -104,47 +99,16 @@ void TPM2_vInit(void)
 {
     /* Set clock source for TPM2 */
     SIM->SOPT2 |= SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK;
-
-    /**
-     * Enable timer overflow interrupts
-     * Divide by 2 prescaler => 24 MHz clock speed
-     */
-    TPM2->SC = TPM_SC_PS(1) | TPM_SC_TOIE(1);
-
+    
+    /* Divide by 2 prescaler => 24 MHz clock speed */
+    TPM2->SC = TPM_SC_PS(1);
+    TPM2->MOD = TPM_MOD_MOD_MASK;
+    
     /* Clear Timer Overflow Flag */
     TPM2->STATUS |= 0xFFFFFFFF;
     
     /* Reset counters */
     TPM2->CNT = 0;
-
-    /* Set NVIC for TPM2 ISR */
-    NVIC_SetPriority(TPM2_IRQn, 3);
-    NVIC_ClearPendingIRQ(TPM2_IRQn);
-    NVIC_EnableIRQ(TPM2_IRQn);
-}
-
-
-/**
- * @brief   Wrapper function for loading TPM2 counter.
- * 
- * @detail  TPM2 is configured to 48 MHz/2 prescaler = 24 MHz clock speed.
- * 
- * @note    timePerBit = 250 ns
- *          => timePerByte = 2 s
- *          timeBetweenBytes = 0.25 s
- *          => timePerByte = 2.25 s
- *          
- *          deliveryTime = timePerByte * numberOfBytes - timeBetweenBytes
- * 
- *          Note: 2 s overhead at beginning
- * 
- * @param   ulBytes     Number of bytes to send.
- * 
- * @return  None
- */
-void TPM2_vLoadCounter(uint32_t ulBytes)
-{
-    TPM2->MOD = TIME_PER_BYTE * ulBytes - TIME_BETWEEN_BYTES; /* Last delay between bytes not needed */
 }
 
 
@@ -219,6 +219,12 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define configASSERT(x)
 #endif
 
+/* Idle time measurement, see benchmark.c */
+void BENCH_vTaskSwitchedIn(void *const pvTask);
+void BENCH_vTaskSwitchedOut(void *const pvTask);
+#define traceTASK_SWITCHED_IN()                   BENCH_vTaskSwitchedIn(pxCurrentTCB)
+#define traceTASK_SWITCHED_OUT()                  BENCH_vTaskSwitchedOut(pxCurrentTCB)
+
 
 #define portINLINE __inline
 
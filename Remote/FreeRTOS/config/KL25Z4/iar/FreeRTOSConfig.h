@@ -214,5 +214,13 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 /* Normal assert() semantics without relying on the provision of an assert.h header file. */
 #define configASSERT(x) if((x)==0) { taskDISABLE_INTERRUPTS(); for( ;; ); }
 
+/* Idle time measurement, see benchmark.c. portasm.s includes this file, so the prototypes are C only */
+#ifdef __ICCARM__
+void BENCH_vTaskSwitchedIn(void *const pvTask);
+void BENCH_vTaskSwitchedOut(void *const pvTask);
+#endif
+#define traceTASK_SWITCHED_IN()                   BENCH_vTaskSwitchedIn(pxCurrentTCB)
+#define traceTASK_SWITCHED_OUT()                  BENCH_vTaskSwitchedOut(pxCurrentTCB)
+
 #endif /* FREERTOS_CONFIG_H */
 
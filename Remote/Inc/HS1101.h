@@ -6,6 +6,7 @@
 
 /* System headers */
 #include <stdint.h>
+#include <stddef.h>
 
 /* Device vendor headers */
 #include "MKL25Z4.h"
@@ -16,12 +17,71 @@
 /* User headers */
 #include "defines.h"
 #include "system.h"
+#include "flash.h"
+#include "convert.h"
+#include "dma.h"
+#include "pit.h"
+#include "tpm.h"
 
 /* Global defines */
 
+/**
+ * Two-point calibration, once per board:
+ * 1. Place the board in a reference humidity, e.g. over saturated LiCl (11 %RH)
+ * 2. Call HS1101_xCalibratePoint(HS1101_CAL_POINT_LOW, 11, temperature)
+ * 3. Repeat with a higher reference, e.g. over saturated NaCl (75 %RH)
+ *    and HS1101_CAL_POINT_HIGH
+ * Capacitance gain and offset are then stored in flash and restored on boot.
+ */
+#define HS1101_CAL_POINT_LOW            (0UL)
+#define HS1101_CAL_POINT_HIGH           (1UL)
+#define HS1101_CAL_MAGIC                (0x48533133UL)  /* "HS13" */
+#define HS1101_CAL_ADDRESS              ((uint32_t)&_shumidity)
+
+/**
+ * Burst measurement. TPM1 captures both edges of CMP0 output and DMA
+ * recharges the sensor after every discharge, so the CPU only wakes up
+ * once per burst. Cycle count must be a power of two.
+ */
+#define HS1101_BURST_CYCLES             (16UL)
+#define HS1101_CAPTURE_FRACTION_BITS    (4UL)           /* Burst average is Q4 counts */
+#define HS1101_DMA_CHANNEL              (DMA_CHANNEL2)  /* Moves captures, shared with ADC scan */
+#define HS1101_LINK_DMA_CHANNEL         (DMA_CHANNEL3)  /* Toggles pin, shared with ADC scan */
+
+/**
+ * Auto-ranging. Counts are normalized to Q4 TPM1 counts at prescaler 1
+ * (48 MHz) and the reference DAC threshold, so calibration holds in every
+ * range. Ranges are chosen to keep counts between the limits.
+ */
+#define HS1101_THRESHOLD_COUNT          (3UL)
+#define HS1101_REFERENCE_THRESHOLD      (2UL)           /* VOSEL 6, 0.36 V */
+#define HS1101_RANGE_MIN_COUNTS         (8192UL)        /* Resolution needed before slowing down */
+#define HS1101_RANGE_MAX_COUNTS         (49152UL)       /* Headroom for humidity changes */
+#define HS1101_RANGE_RETRIES            (3UL)
+
+/* Range reported with each sample */
+#define HS1101_RANGE(prescaler, threshold)  (((prescaler) << 4) | (threshold))
+#define HS1101_RANGE_PRESCALER(range)       ((range) >> 4)
+#define HS1101_RANGE_THRESHOLD(range)       ((range) & 0x0F)
+
+/**
+ * Uncalibrated capacitance per normalized count, in Q8 pF scaled by 2^16.
+ * count = t * 48 MHz
+ * C = t / (R * ln(Vdd / Vth)), R = 1 MOhm, Vth = 7/64 * Vdd
+ * => 1.205 pF / 128 per count
+ */
+#define HS1101_DEFAULT_GAIN             (9871UL)
+#define HS1101_DEFAULT_OFFSET           (0L)
+
+/* Capacitance drift, 0.04 pF/C in Q8 pF */
+#define HS1101_TEMP_COEFF               (10L)
+#define HS1101_REFERENCE_TEMPERATURE    (25L)
+
 /* Global variables */
-extern TaskHandle_t xAnalogNotification;
+extern uint32_t ulHumidityBurstErrors;
 
 
+/* Global function prototypes */
 void HS1101_vInit(void);
-uint32_t HS1101_ulReadHumidity(void);
+BaseType_t HS1101_xReadHumidity(const int32_t lTemperature, uint32_t *const pulHumidity, uint32_t *const pulRange);
+BaseType_t HS1101_xCalibratePoint(const uint32_t ulPoint, const uint32_t ulReferenceHumidity, const int32_t lTemperature);
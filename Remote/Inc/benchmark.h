@@ -0,0 +1,62 @@
+/**
+ * benchmark.h
+ * This header declares on-target latency measurements.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Device vendor headers */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* User headers */
+#include "defines.h"
+#include "system.h"
+#include "pit.h"
+#include "spi.h"
+
+/* Global defines */
+#define BENCHMARK_REPORT_PERIOD_MS      (10000UL)
+
+/* Measurement points */
+enum Benchmark_Points
+{
+    BENCH_SENSOR_LOOP,          /* vSensorTask loop body */
+    BENCH_FRAME_LOOP,           /* vFrameTask loop body */
+    BENCH_COMM_LOOP,            /* vCommTask loop body */
+    BENCH_MOTOR_LOOP,           /* vMotorTask loop body */
+    BENCH_SENSOR_TO_RADIO,      /* Sensor read to nRF24L01 handoff */
+    BENCH_RADIO_SEND,           /* nRF24L01_vSendPayload() */
+    BENCH_RADIO_DELIVERY,       /* First transmission of a frame to its ACK */
+    BENCH_RADIO_STREAM,         /* Backlog burst, ulBytesPerSecond is frames per second */
+    BENCH_SPI_QUEUE,            /* SPI1 transaction submit to CS low */
+    BENCH_SPI_TRANSFER,         /* CS low time of one SPI1 transaction */
+    BENCH_ADC_SCAN,             /* ADC0_xScan() */
+    BENCH_POINT_COUNT
+};
+
+/* Statistics of one measurement point, reported in microseconds */
+struct Benchmark_Stats
+{
+    uint32_t ulCount;
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint32_t ulAverage;
+    uint32_t ulBytesPerSecond;  /* Only for points recorded with byte counts */
+};
+
+/* Global variables */
+extern struct Benchmark_Stats xBenchmarkReport[BENCH_POINT_COUNT];
+extern uint32_t ulBenchmarkIdlePercent;
+extern uint32_t ulBenchmarkSpiPercent;
+
+
+/* Global function prototypes */
+uint32_t BENCH_ulTimestamp(void);
+void BENCH_vRecord(const uint32_t ulPoint, const uint32_t ulStart);
+void BENCH_vRecordSpan(const uint32_t ulPoint, const uint32_t ulStart, const uint32_t ulEnd, const uint32_t ulBytes);
+void BENCH_vIdleHook(void);
+void vBenchmarkTask(void *const pvParam);
@@ -0,0 +1,59 @@
+/**
+ * board.h
+ * This header describes sensor and pump topology of each board variant.
+ * 
+ * Tables are X-macros, so counts, sensor layout, probe tables and frame
+ * format are expanded at compile time for the selected board. Select
+ * variant with preprocessor define BOARD.
+ */
+
+#pragma once
+
+
+/* Board variants */
+#define BOARD_DEVKIT                    (1)     /* Freedom board, probes simulated on one channel */
+#define BOARD_TWO_ZONE                  (2)     /* Two probes, two pumps */
+
+#ifndef BOARD
+#define BOARD                           BOARD_DEVKIT
+#endif
+
+
+/**
+ * Soil moisture probes:
+ * X(probe, ADC channel, ADC profile, conversion, watering zone)
+ * 
+ * Probes are numbered 0...n-1. Conversion takes 16-bit ADC result and
+ * returns percent, see convert.h. Hardware compare threshold assumes
+ * CONVERT_ulSoilMoisture. Zone n is watered by motor n, TPM0 CHn on PTDn.
+ */
+#if BOARD == BOARD_DEVKIT
+
+#define BOARD_TEMPERATURE_CHANNEL       (ADC_CH_AD8)    /* TMP36GT, PTB0 */
+#define BOARD_POTENTIOMETER_CHANNEL     (ADC_CH_AD12)   /* PTB2 */
+#define BOARD_MOTOR_COUNT               (1UL)
+
+/* Same soil moisture channel to simulate multiple sensors */
+#define BOARD_SOIL_PROBES(X)                                                \
+    X(0, ADC_CH_AD9,  ADC_PROFILE_LOW_POWER, CONVERT_ulSoilMoisture, 0)     \
+    X(1, ADC_CH_AD9,  ADC_PROFILE_LOW_POWER, CONVERT_ulSoilMoisture, 0)
+
+#elif BOARD == BOARD_TWO_ZONE
+
+#define BOARD_TEMPERATURE_CHANNEL       (ADC_CH_AD8)    /* TMP36GT, PTB0 */
+#define BOARD_POTENTIOMETER_CHANNEL     (ADC_CH_AD12)   /* PTB2 */
+#define BOARD_MOTOR_COUNT               (2UL)
+
+#define BOARD_SOIL_PROBES(X)                                                \
+    X(0, ADC_CH_AD9,  ADC_PROFILE_LOW_POWER, CONVERT_ulSoilMoisture, 0)     \
+    X(1, ADC_CH_AD13, ADC_PROFILE_LOW_POWER, CONVERT_ulSoilMoisture, 1)
+
+#else
+#error "Unknown BOARD"
+#endif
+
+
+/* IC counts */
+#define BOARD_COUNT_PROBE(probe, channel, profile, convert, zone)   + 1UL
+#define SOIL_MOISTURE_SENSOR_COUNT      (0UL BOARD_SOIL_PROBES(BOARD_COUNT_PROBE))
+#define MOTOR_COUNT                     (BOARD_MOTOR_COUNT)     /* Max 5 */
@@ -16,18 +16,109 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "event_groups.h"
 
 /* User headers */
 #include "defines.h"
 #include "sensors.h"
 #include "tpm.h"
+#include "benchmark.h"
 #include "printf-stdarg.h"
+#include "frame.h"
+#include "command.h"
 
 /* Global defines */
-#define MAX_FRAME_SIZE          (64UL)
+
+/**
+ * Samples are batched to full radio payloads. A batch is sent when the
+ * next sample doesn't fit, when its first sample is this old, or right
+ * away when a pump starts. Max 327 s due to 16-bit ticks.
+ */
+#define COMM_BATCH_LATENCY_MS   (300000UL)
+
+/**
+ * Transmit policy. After MAX_RT a frame is retransmitted right away
+ * COMM_TX_RETRIES times, then put back to the front of xCommQueue to be
+ * tried again after COMM_TX_BACKOFF_MS. A frame requeued
+ * COMM_TX_REQUEUES times is dropped. Worst case transmission with 4
+ * attempts of 1.25 ms delay is under 7 ms, so the IRQ timeout only
+ * catches a missed IRQ.
+ */
+#define COMM_TX_RETRIES         (2UL)
+#define COMM_TX_REQUEUES        (2UL)
+#define COMM_TX_BACKOFF_MS      (50UL)
+#define COMM_TX_TIMEOUT_MS      (20UL)
+#define COMM_TX_LOG_SIZE        (16UL)
+
+/* Bits of xCommEventGroup */
+#define COMM_EVENT_FRAME_DROPPED (1UL << 0)    /* Comm task gave up on a frame, consumed by frame task */
+
+/* Outcomes of struct Comm_Tx_Record */
+#define COMM_TX_DELIVERED       (0UL)
+#define COMM_TX_DROPPED         (1UL)
+
+/* Batching counters, read with debugger */
+struct Comm_Batch_Stats
+{
+    uint32_t ulFrames;
+    uint32_t ulKeyFrames;
+    uint32_t ulSamples;         /* Samples in sent frames */
+    uint32_t ulBytes;           /* Frame bytes, CRC included */
+    uint32_t ulSizeFlushes;     /* Next sample didn't fit */
+    uint32_t ulDeadlineFlushes; /* COMM_BATCH_LATENCY_MS elapsed */
+    uint32_t ulUrgentFlushes;   /* Pump started */
+    uint32_t ulDroppedFrames;   /* xMessagePool was empty */
+    uint32_t ulRekeyedFrames;   /* Delta frames rebuilt as key frames after a drop */
+    uint32_t ulScheduleFrames;  /* Sample periods reported */
+};
+
+/* Delivery counters, read with debugger */
+struct Comm_Tx_Stats
+{
+    uint32_t ulDelivered;       /* Frames acked */
+    uint32_t ulDropped;         /* Frames given up on */
+    uint32_t ulRetransmits;     /* MAX_RT followed by immediate retry */
+    uint32_t ulRequeues;        /* Frames put back to xCommQueue */
+    uint32_t ulBursts;          /* Backlogs streamed through TX FIFO */
+};
+
+/* Downlink counters, read with debugger */
+struct Comm_Command_Stats
+{
+    uint32_t ulPayloads;        /* ACK payloads accepted */
+    uint32_t ulDuplicates;      /* Same sequence number as previous */
+    uint32_t ulErrors;          /* Failed COMMAND_lDecode() */
+    uint32_t ulCommands;        /* Passed to sensor task */
+    uint32_t ulDropped;         /* xCommandQueue was full */
+};
+
+/* Outcome of one frame, read with debugger */
+struct Comm_Tx_Record
+{
+    uint8_t ucSequence;         /* Frame sequence number */
+    uint8_t ucOutcome;          /* COMM_TX_DELIVERED or COMM_TX_DROPPED */
+    uint8_t ucTransmissions;    /* nRF24L01 transmissions, each up to NRF24L01_RETR_COUNT + 1 attempts */
+    uint32_t ulLatencyUs;       /* First transmission to outcome */
+};
+
+/* Frame passed from frame task to comm task, block of xMessagePool */
+struct AMessage
+{
+    uint8_t ucFrame[FRAME_MAX_SIZE];
+    uint32_t ulLength;
+    uint32_t ulTimestamp;       /* Sensor reading timestamp */
+    uint32_t ulSendTimestamp;   /* First transmission, valid when ulTransmissions > 0 */
+    uint32_t ulTransmissions;
+    uint32_t ulRequeues;
+};
 
 /* Global variables */
-extern TaskHandle_t xCommTask;
+extern EventGroupHandle_t xCommEventGroup;
+extern struct Comm_Batch_Stats xBatchStats;
+extern struct Comm_Tx_Stats xTxStats;
+extern struct Comm_Command_Stats xCommandStats;
+extern struct Comm_Tx_Record xTxLog[COMM_TX_LOG_SIZE];
+extern uint32_t ulTxLogIndex;
 
 
 /* Global function prototypes */
@@ -0,0 +1,84 @@
+/**
+ * command.h
+ * This header declares the downlink command format. Gateway sends
+ * commands in nRF24L01 ACK payloads, so a node picks them up with its
+ * normal uplink and never listens in RX mode.
+ * 
+ * Shared with the gateway, so only standard C headers are used.
+ * 
+ * Payload layout, multibyte values little endian:
+ *  [0]         Version << 4 | command count
+ *  [1]         Node ID
+ *  [2]         Payload sequence number, wraps at 256
+ *  [3...]      Commands: type, target, value
+ *  [n-2...n-1] CRC-16/CCITT of bytes 0...n-3, see FRAME_usChecksum()
+ * 
+ * Node applies commands in order and ignores a payload with the same
+ * sequence number as the previous one, in case the gateway sends it
+ * twice.
+ * 
+ * Gateway receives node n on pipe (n - 1) % COMMAND_PIPES with address
+ * byte 0 COMMAND_ADDRESS_BASE + pipe, so each node gets its own ACK
+ * payloads. Node 1 stays on pipe 0 and the original address 0x11.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* User headers */
+#include "frame.h"
+
+/* Global defines */
+#define COMMAND_VERSION                 (1UL)
+#define COMMAND_HEADER_SIZE             (3UL)
+#define COMMAND_RECORD_SIZE             (4UL)
+#define COMMAND_CRC_SIZE                (2UL)
+#define COMMAND_PAYLOAD_MAX_SIZE        (32UL)  /* nRF24L01 ACK payload */
+#define COMMAND_MAX_COUNT               ((COMMAND_PAYLOAD_MAX_SIZE - COMMAND_HEADER_SIZE - COMMAND_CRC_SIZE) / COMMAND_RECORD_SIZE)
+#define COMMAND_SIZE(count)             (COMMAND_HEADER_SIZE + (count) * COMMAND_RECORD_SIZE + COMMAND_CRC_SIZE)
+
+#define COMMAND_OK                      (0L)
+#define COMMAND_TOO_SHORT               (-1L)
+#define COMMAND_BAD_CRC                 (-2L)
+#define COMMAND_BAD_VERSION             (-3L)
+#define COMMAND_OTHER_NODE              (-4L)
+
+#define COMMAND_PIPES                   (6UL)
+#define COMMAND_ADDRESS_BASE            (0x11U)
+#define COMMAND_PIPE(node)              (((node) + COMMAND_PIPES - 1) % COMMAND_PIPES)
+
+#define COMMAND_TARGET_ALL              (0xFFUL)
+#define COMMAND_PERIOD_UNIT_MS          (FRAME_PERIOD_UNIT_MS)
+
+/* Command types */
+enum Command_Types
+{
+    COMMAND_THRESHOLD = 1,              /* Target probe, value dry below % */
+    COMMAND_PERIOD,                     /* Target frame field tag or all, value max sample period in COMMAND_PERIOD_UNIT_MS */
+    COMMAND_WATER,                      /* Target zone or all, value enum Command_Water */
+    COMMAND_TYPE_COUNT
+};
+
+/* Watering overrides */
+enum Command_Water
+{
+    COMMAND_WATER_AUTO,                 /* Follow soil moisture */
+    COMMAND_WATER_ON,                   /* Water once on next reading, then auto */
+    COMMAND_WATER_OFF,                  /* Don't water until auto */
+    COMMAND_WATER_COUNT
+};
+
+/* Decoded command */
+struct Command
+{
+    uint8_t ucType;                     /* enum Command_Types */
+    uint8_t ucTarget;
+    uint16_t usValue;
+};
+
+
+/* Global function prototypes */
+int32_t COMMAND_lDecode(const uint8_t *const pucPayload, const uint32_t ulLength, const uint32_t ulNode,
+                        uint32_t *const pulSequence, struct Command *const pxCommands);
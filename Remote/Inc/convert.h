@@ -0,0 +1,129 @@
+/**
+ * convert.h
+ * This header declares sensor conversion kernels.
+ * 
+ * Cortex-M0+ has no hardware divider, so divisions by calibration constants
+ * are replaced with multiplication by a reciprocal calculated at compile
+ * time. Results are identical to the integer division formulas for every
+ * 16-bit ADC code, Gateway/Src/convertbench.c checks them on the host.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* User headers */
+#include "defines.h"
+
+/* Global defines */
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE                 static inline
+#endif
+
+
+/**
+ * ceil(2^32 * numerator / denominator), numerator < denominator.
+ * Only use with constants so the 64-bit division is done by the compiler.
+ */
+#define CONVERT_RECIPROCAL(num, den)    ((uint32_t)((((uint64_t)(num) << 32) + (den) - 1) / (den)))
+
+/**
+ * floor(x * num / den) == (x * CONVERT_RECIPROCAL(num, den)) >> 32 holds as
+ * long as x < 2^32 / den, with den reduced to lowest terms.
+ */
+#define SOIL_MOISTURE_RECIPROCAL        CONVERT_RECIPROCAL(100, SOIL_MOISTURE_ADC_DRY - SOIL_MOISTURE_ADC_WET)
+#define TEMP_SENSOR_MV_RECIPROCAL       CONVERT_RECIPROCAL(TEMP_SENSOR_VREF_MV, TEMP_SENSOR_ADC_STEPS)
+#define TEMP_SENSOR_DEGREE_RECIPROCAL   CONVERT_RECIPROCAL(1, TEMP_SENSOR_MV_PER_DEGREE)
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Calculate (ulValue * ulReciprocal) >> 32 with 32-bit multiplies.
+ * 
+ * @param   ulValue         16-bit value.
+ * 
+ * @param   ulReciprocal    CONVERT_RECIPROCAL() constant.
+ * 
+ * @return  High word of the product.
+ */
+__STATIC_INLINE uint32_t CONVERT_ulMultiplyHigh(const uint32_t ulValue, const uint32_t ulReciprocal)
+{
+    /* Split reciprocal so partial products fit in 32 bits */
+    return ((ulValue * (ulReciprocal >> 16)) + ((ulValue * (ulReciprocal & 0xFFFF)) >> 16)) >> 16;
+}
+
+
+/**
+ * @brief   Calculate (ulValue * ulFactor) >> 16 with 32-bit multiplies.
+ * 
+ * @param   ulValue     Value.
+ * 
+ * @param   ulFactor    Q16 fixed point factor.
+ * 
+ * @return  Product, must fit in 32 bits.
+ */
+__STATIC_INLINE uint32_t CONVERT_ulMultiplyQ16(const uint32_t ulValue, const uint32_t ulFactor)
+{
+    const uint32_t ulValueHigh = ulValue >> 16;
+    const uint32_t ulValueLow = ulValue & 0xFFFF;
+    const uint32_t ulFactorHigh = ulFactor >> 16;
+    const uint32_t ulFactorLow = ulFactor & 0xFFFF;
+    
+    /* Partial products of 16-bit halves */
+    return ((ulValueHigh * ulFactorHigh) << 16) + (ulValueHigh * ulFactorLow) + (ulValueLow * ulFactorHigh)
+         + ((ulValueLow * ulFactorLow) >> 16);
+}
+
+
+/**
+ * @brief   Convert SEN0193 ADC value to soil moisture.
+ * 
+ * @details multiplier = 100
+ *          calibratedSteps = SOIL_MOISTURE_ADC_DRY - SOIL_MOISTURE_ADC_WET
+ *          moisture = ((ADC - SOIL_MOISTURE_ADC_WET) * multiplier) / calibratedSteps
+ *          Sensor value is inverted, fix by subtracting moisture from 100.
+ *          Quotient truncates towards zero like C division, so readings
+ *          wetter than calibrated exceed 100 %.
+ * 
+ * @param   ulAdc   16-bit ADC value.
+ * 
+ * @return  Soil moisture in percent.
+ */
+__STATIC_INLINE uint32_t CONVERT_ulSoilMoisture(const uint32_t ulAdc)
+{
+    if (ulAdc >= SOIL_MOISTURE_ADC_WET)
+    {
+        return 100 - CONVERT_ulMultiplyHigh(ulAdc - SOIL_MOISTURE_ADC_WET, SOIL_MOISTURE_RECIPROCAL);
+    }
+    
+    return 100 + CONVERT_ulMultiplyHigh(SOIL_MOISTURE_ADC_WET - ulAdc, SOIL_MOISTURE_RECIPROCAL);
+}
+
+
+/**
+ * @brief   Convert TMP36 ADC value to temperature.
+ * 
+ * @details steps = 2^16 - 1 = 0xFFFF
+ *          Vref = 3300 mV
+ *          mVout = (Vref * ADC) / steps
+ *          scaleFactor = 10 mV/C
+ *          offsetVoltage = 500 mV
+ *          TempC = (mVout - offsetVoltage) / scaleFactor, truncated towards zero
+ * 
+ * @param   ulAdc   16-bit ADC value.
+ * 
+ * @return  Temperature in Celsius.
+ */
+__STATIC_INLINE int32_t CONVERT_lCelsius(const uint32_t ulAdc)
+{
+    const uint32_t ulMillivolts = CONVERT_ulMultiplyHigh(ulAdc, TEMP_SENSOR_MV_RECIPROCAL);
+    
+    if (ulMillivolts >= TEMP_SENSOR_OFFSET_MV)
+    {
+        return (int32_t)CONVERT_ulMultiplyHigh(ulMillivolts - TEMP_SENSOR_OFFSET_MV, TEMP_SENSOR_DEGREE_RECIPROCAL);
+    }
+    
+    return -(int32_t)CONVERT_ulMultiplyHigh(TEMP_SENSOR_OFFSET_MV - ulMillivolts, TEMP_SENSOR_DEGREE_RECIPROCAL);
+}
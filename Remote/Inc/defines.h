@@ -5,6 +5,9 @@
 
 #pragma once
 
+/* User headers */
+#include "board.h"
+
 
 /* Bit shifting */
 #define SIGNAL_SHIFT                    (5) /* For testing purposes */
@@ -23,9 +26,8 @@
 #define MOIST_SENSOR_PIN                (1UL)   /* SEN0193 */
 #define HUMID_SENSOR_PIN                (29UL)  /* HS1101 */
 
-/* IC Counts */
-#define SOIL_MOISTURE_SENSOR_COUNT      (2UL)
-#define MOTOR_COUNT                     (1UL)   /* Max 5 */
+/* Node identification, unique within one gateway */
+#define NODE_ID                         (1UL)
 
 /* Sensor thresholds */
 #define MIN_TEMPERATURE                 (-40L)
@@ -33,27 +35,21 @@
 #define MAX_HUMIDITY                    (100UL)
 #define MAX_SOIL_MOISTURE               (100UL)
 
-/* Sensor formulas */
-
-/**
- * multiplier = 100
- * calibratedSteps = 51000 - 25000
- * moisture = (ADC * multiplier) / calibratedSteps
- * Sensor value is inverted, fix by subtracting ADC from 100
- */
-#define SOIL_MOISTURE(adc)              (100 - ((adc) - 25000) * 100 / (51000 - 25000))
+/* Sensor calibration, conversions are in convert.h */
+#define SOIL_MOISTURE_ADC_WET           (25000L)    /* Reads 100 % */
+#define SOIL_MOISTURE_ADC_DRY           (51000L)    /* Reads 0 % */
+#define TEMP_SENSOR_VREF_MV             (3300L)
+#define TEMP_SENSOR_ADC_STEPS           (0xFFFFL)
+#define TEMP_SENSOR_OFFSET_MV           (500L)
+#define TEMP_SENSOR_MV_PER_DEGREE       (10L)
 
 
 /**
- * steps = 2^16 = 0xFFFF
- * Vref = 3300 mV
- * mVout = (Vref / steps) * ADC
- * scaleFactor = 10
- * offsetVoltage = 500 mV
- * TempC = (mVout - offsetVoltage) / scaleFactor
- * Formula is optimized to avoid floating point calculation
+ * Smallest ADC value for which soil moisture < moisture, for hardware compare.
+ * calibratedSteps = SOIL_MOISTURE_ADC_DRY - SOIL_MOISTURE_ADC_WET
+ * adc >= SOIL_MOISTURE_ADC_WET + ceil((101 - moisture) * calibratedSteps / 100)
  */
-#define CELSIUS_TEMPERATURE(adc)        ((((3300 * (adc)) / 0xFFFF) - 500) / 10)
+#define SOIL_MOISTURE_DRY_ADC(moisture) (SOIL_MOISTURE_ADC_WET + ((101 - (long)(moisture)) * (SOIL_MOISTURE_ADC_DRY - SOIL_MOISTURE_ADC_WET) + 99) / 100)
 
 
 /* Define alternative functions for pins. */
@@ -0,0 +1,47 @@
+/**
+ * filter.h
+ * This header declares streaming sample filters.
+ * 
+ * Shared with the gateway filter benchmark, so only standard C headers
+ * are used.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Global defines */
+#define FILTER_WINDOW                   (6UL)   /* Samples in sliding window */
+#define FILTER_TRIM                     (1UL)   /* Samples dropped from both ends for trimmed mean */
+#define FILTER_EMA_SHIFT                (2UL)   /* Smoothing factor 1/4 */
+#define FILTER_EMA_FRACTION_BITS        (8UL)
+
+/* Kept samples are averaged with a shift */
+#define FILTER_KEPT                     (FILTER_WINDOW - 2 * FILTER_TRIM)
+#if (FILTER_KEPT == 0) || ((FILTER_KEPT & (FILTER_KEPT - 1)) != 0)
+#error "FILTER_WINDOW - 2 * FILTER_TRIM must be a power of two"
+#endif
+
+/* One sensor's filter state, no heap */
+struct Filter
+{
+    int32_t lHistory[FILTER_WINDOW];    /* Ring buffer in arrival order */
+    int32_t lSorted[FILTER_WINDOW];     /* Same samples in ascending order */
+    uint32_t ulHead;                    /* Oldest sample in lHistory */
+    uint32_t ulPrimed;                  /* 0 until first sample */
+    int32_t lEma;                       /* Smoothed trimmed mean, Q8 */
+};
+
+/* Filter outputs after a sample */
+struct Filter_Output
+{
+    int32_t lMedian;
+    int32_t lTrimmedMean;
+    int32_t lSmoothed;                  /* Exponential smoothing of trimmed mean */
+};
+
+
+/* Global function prototypes */
+void FILTER_vInit(struct Filter *const pxFilter);
+void FILTER_vUpdate(struct Filter *const pxFilter, const int32_t lSample, struct Filter_Output *const pxOutput);
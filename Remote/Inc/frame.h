@@ -0,0 +1,176 @@
+/**
+ * frame.h
+ * This header declares the binary radio frame format.
+ * 
+ * Shared with the gateway decoder, so only standard C headers are used.
+ * 
+ * Frame layout, multibyte values little endian:
+ *  [0]         Version << 4 | frame type
+ *  [1]         Node ID
+ *  [2]         Sequence number, wraps at 256
+ *  [3...4]     Timestamp, seconds since boot modulo 65536
+ *  [5...]      Frame type specific
+ *  [n-2...n-1] CRC-16/CCITT of bytes 0...n-3
+ * 
+ * FRAME_TYPE_SAMPLE:
+ *  [5...]      Fields: type << 4 | index, value
+ * 
+ * FRAME_TYPE_KEY:
+ *  [5]         Field count
+ *  [6...]      Field tags: type << 4 | index
+ *  [...]       Values of first sample
+ *  [...]       Records of following samples
+ * 
+ * FRAME_TYPE_DELTA:
+ *  [5...]      Records, first one follows last sample of the frame
+ *              with previous sequence number
+ * 
+ * FRAME_TYPE_SCHEDULE:
+ *  [2]         Sequence number of previous data frame, not advanced
+ *  [5...]      Varint sensor task wake-ups since boot
+ *  [...]       Field count
+ *  [...]       Field tag and varint sample period in FRAME_PERIOD_UNIT_MS
+ *              of each field
+ * 
+ * Record is varint seconds since previous sample, mask of changed
+ * fields and varint change of each field in mask, lowest bit first.
+ * Values and changes are zig-zag encoded, so 0, -1, 1, -2... become
+ * 0, 1, 2, 3... Varint stores 7 bits per byte, least significant
+ * first, with bit 7 set when more bytes follow.
+ * 
+ * Delta frames can't be decoded after a lost frame, so every
+ * FRAME_KEY_INTERVAL:th frame is a key frame. Schedule frames report
+ * the adaptive sample periods and are outside the delta chain.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+
+/* Global defines */
+#define FRAME_VERSION                   (2UL)
+#define FRAME_TYPE_SAMPLE               (0UL)   /* Latest reading of each sensor */
+#define FRAME_TYPE_KEY                  (1UL)   /* Readings, first one absolute */
+#define FRAME_TYPE_DELTA                (2UL)   /* Readings following previous frame */
+#define FRAME_TYPE_SCHEDULE             (3UL)   /* Sample periods of the fields */
+#define FRAME_KEY_INTERVAL              (8UL)   /* Frames */
+
+#define FRAME_HEADER_SIZE               (5UL)
+#define FRAME_FIELD_SIZE                (2UL)
+#define FRAME_CRC_SIZE                  (2UL)
+#define FRAME_MAX_SIZE                  (31UL)  /* Max nRF24L01 driver payload */
+#define FRAME_MAX_FIELDS                ((FRAME_MAX_SIZE - FRAME_HEADER_SIZE - FRAME_CRC_SIZE) / FRAME_FIELD_SIZE)
+#define FRAME_SIZE(fields)              (FRAME_HEADER_SIZE + (fields) * FRAME_FIELD_SIZE + FRAME_CRC_SIZE)
+
+#define FRAME_BATCH_MAX_FIELDS          (8UL)   /* Bits in change mask */
+#define FRAME_VARINT_MAX_SIZE           (5UL)   /* 32-bit value */
+#define FRAME_VALUE_LIMIT               (8191L) /* Values within +-limit... */
+#define FRAME_VALUE_MAX_SIZE            (2UL)   /* ...take max 2 bytes... */
+#define FRAME_CHANGE_MAX_SIZE           (3UL)   /* ...and their changes 3 bytes */
+
+/* Frame with one sample of given number of fields, must fit FRAME_MAX_SIZE */
+#define FRAME_KEY_MAX_SIZE(fields)      (FRAME_HEADER_SIZE + 1 + (fields) * (1 + FRAME_VALUE_MAX_SIZE) + FRAME_CRC_SIZE)
+#define FRAME_DELTA_MAX_SIZE(fields)    (FRAME_HEADER_SIZE + FRAME_VARINT_MAX_SIZE + 1 + (fields) * FRAME_CHANGE_MAX_SIZE + FRAME_CRC_SIZE)
+#define FRAME_RECORD_MIN_SIZE           (2UL)   /* Nothing changed within 127 s */
+#define FRAME_RECORD_MAX_SIZE           (FRAME_VARINT_MAX_SIZE + 1 + FRAME_BATCH_MAX_FIELDS * FRAME_VARINT_MAX_SIZE)
+#define FRAME_MAX_SAMPLES               ((FRAME_MAX_SIZE - FRAME_HEADER_SIZE - FRAME_CRC_SIZE) / FRAME_RECORD_MIN_SIZE)
+
+#define FRAME_PERIOD_UNIT_MS            (100UL)
+#define FRAME_PERIOD_MAX_SIZE           (2UL)   /* Periods below 16384 units */
+#define FRAME_SCHEDULE_MAX_SIZE(fields) (FRAME_HEADER_SIZE + FRAME_VARINT_MAX_SIZE + 1 + (fields) * (1 + FRAME_PERIOD_MAX_SIZE) + FRAME_CRC_SIZE)
+
+#define FRAME_CRC_POLYNOMIAL            (0x1021U)
+#define FRAME_CRC_INITIAL               (0xFFFFU)
+
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE                 static inline
+#endif
+
+/* Field types, value is one byte */
+enum Frame_Field_Types
+{
+    FRAME_FIELD_TEMPERATURE = 1,        /* int8_t, Celsius */
+    FRAME_FIELD_HUMIDITY,               /* uint8_t, %RH */
+    FRAME_FIELD_SOIL_MOISTURE,          /* uint8_t, %, index is probe */
+    FRAME_FIELD_COUNT
+};
+
+/* Encoder state of a node, frame being built and last encoded sample */
+struct Frame_Encoder
+{
+    uint8_t ucFrame[FRAME_MAX_SIZE];
+    uint32_t ulLength;                  /* Bytes written, CRC excluded */
+    uint32_t ulSamples;                 /* Samples in frame, 0 when none started */
+    const uint8_t *pucTags;
+    uint32_t ulFields;
+    int32_t lPrevious[FRAME_BATCH_MAX_FIELDS];
+    uint32_t ulPreviousSeconds;
+    uint32_t ulKeyCountdown;            /* Delta frames until next key frame */
+    uint8_t ucNode;
+    uint8_t ucSequence;
+};
+
+
+/* Global function prototypes */
+void FRAME_vEncoderInit(struct Frame_Encoder *const pxEncoder, const uint8_t ucNode, const uint8_t *const pucTags, const uint32_t ulFields);
+uint32_t FRAME_ulEncoderAppend(struct Frame_Encoder *const pxEncoder, const uint32_t ulSeconds, const int32_t *const plValues);
+uint32_t FRAME_ulEncoderFinish(struct Frame_Encoder *const pxEncoder);
+void FRAME_vEncoderResync(struct Frame_Encoder *const pxEncoder);
+void FRAME_vEncoderDiscard(struct Frame_Encoder *const pxEncoder);
+uint32_t FRAME_ulEncodeSchedule(const struct Frame_Encoder *const pxEncoder, uint8_t *const pucFrame, const uint32_t ulSeconds,
+                                const uint32_t ulWakeups, const uint32_t *const pulPeriods);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Calculate CRC-16/CCITT of a frame.
+ * 
+ * @param   pucData     Frame bytes.
+ * 
+ * @param   ulLength    Number of bytes.
+ * 
+ * @return  CRC-16
+ */
+__STATIC_INLINE uint16_t FRAME_usChecksum(const uint8_t *const pucData, const uint32_t ulLength)
+{
+    uint16_t usCrc = FRAME_CRC_INITIAL;
+    
+    for (uint32_t i = 0; i < ulLength; i++)
+    {
+        usCrc ^= (uint16_t)(pucData[i] << 8);
+        for (uint32_t ulBit = 0; ulBit < 8; ulBit++)
+        {
+            usCrc = (usCrc & 0x8000) ? (uint16_t)((usCrc << 1) ^ FRAME_CRC_POLYNOMIAL) : (uint16_t)(usCrc << 1);
+        }
+    }
+    
+    return usCrc;
+}
+
+
+/**
+ * @brief   Zig-zag encode signed value.
+ * 
+ * @param   lValue      Value.
+ * 
+ * @return  Encoded value, small for small magnitudes.
+ */
+__STATIC_INLINE uint32_t FRAME_ulZigZag(const int32_t lValue)
+{
+    return ((uint32_t)lValue << 1) ^ (uint32_t)(lValue >> 31);
+}
+
+
+/**
+ * @brief   Decode zig-zag encoded value.
+ * 
+ * @param   ulValue     Encoded value.
+ * 
+ * @return  Signed value.
+ */
+__STATIC_INLINE int32_t FRAME_lUnZigZag(const uint32_t ulValue)
+{
+    return (int32_t)(ulValue >> 1) ^ -(int32_t)(ulValue & 1);
+}
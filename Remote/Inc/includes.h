@@ -17,3 +17,9 @@
 #include "spi.h"
 #include "HS1101.h"
 #include "nrf24l01.h"
+#include "pit.h"
+#include "benchmark.h"
+#include "lptmr.h"
+#include "flash.h"
+#include "convert.h"
+#include "filter.h"
@@ -19,6 +19,7 @@
 #include "defines.h"
 #include "system.h"
 #include "HS1101.h"
+#include "benchmark.h"
 
 /* Global defines */
 
@@ -0,0 +1,51 @@
+/**
+ * pool.h
+ * This header declares fixed-block memory pools. Blocks are passed
+ * between tasks through queues of pointers, so the block is owned by
+ * exactly one task at a time.
+ */
+
+#pragma once
+
+/* System headers */
+#include <stdint.h>
+#include <stddef.h>
+
+/* Device vendor headers */
+#include "MKL25Z4.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* User headers */
+#include "defines.h"
+#include "system.h"
+
+
+/* Block size of a type, rounded up so that a free block holds its link */
+#define POOL_BLOCK_SIZE(type)           ((sizeof(type) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* Word aligned storage for blocks of a type */
+#define POOL_STORAGE(name, type, blocks)    void *name[(POOL_BLOCK_SIZE(type) * (blocks)) / sizeof(void *)]
+
+
+/* Fixed-block pool, free blocks are linked through their first word */
+struct Pool
+{
+    void *pvFree;                       /* First free block, NULL when empty */
+    uint8_t *pucStart;                  /* Storage, for ownership checks */
+    uint32_t ulBlockSize;
+    uint32_t ulBlocks;
+    uint32_t ulFree;
+    uint32_t ulMinFree;                 /* Low-water mark of ulFree */
+    uint32_t ulFailures;                /* Allocations with no free block */
+};
+
+
+/* Global function prototypes */
+void POOL_vInit(struct Pool *const pxPool, void *const pvStorage, const uint32_t ulBlockSize, const uint32_t ulBlocks);
+void *POOL_pvAlloc(struct Pool *const pxPool);
+void POOL_vFree(struct Pool *const pxPool, void *const pvBlock);
+uint32_t POOL_ulHighWater(const struct Pool *const pxPool);
+BaseType_t POOL_xSend(const QueueHandle_t xQueue, void **const ppvBlock, const TickType_t xTicksToWait);
+BaseType_t POOL_xSendToFront(const QueueHandle_t xQueue, void **const ppvBlock, const TickType_t xTicksToWait);
+BaseType_t POOL_xReceive(const QueueHandle_t xQueue, void **const ppvBlock, const TickType_t xTicksToWait);
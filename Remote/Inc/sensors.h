@@ -17,20 +17,90 @@
 #include "defines.h"
 #include "system.h"
 #include "motor.h"
+#include "benchmark.h"
+#include "convert.h"
+#include "filter.h"
+#include "command.h"
 
 /* Global defines */
 #define SOIL_MOISTURE_THRESHOLD                 (30UL)
 
+/**
+ * Low power monitoring. While all soil is moist, sensor task sleeps until
+ * ADC0 compare detects dry soil or next sensor is due.
+ */
+#define SENSOR_LOW_POWER_MONITORING             (TRUE)
+
+/**
+ * Adaptive sampling. Each sensor has own period which is halved when the
+ * value changes fast and doubled while it stays still. Soil moisture is
+ * sampled at minimum period while its pump runs.
+ * Periods are power of two multiples of the minimum period, so every
+ * sensor stays on its own phase and acquisitions never share a tick.
+ * Max period must stay below 32768 ticks as 16-bit tick counts are
+ * compared modulo.
+ */
+#define SENSOR_MIN_PERIOD_MS                    (100UL)
+#define SENSOR_MAX_PERIOD_MS                    (SENSOR_MIN_PERIOD_MS << 10)   /* 102.4 s */
+#define SENSOR_FAST_CHANGE                      (2L)    /* Change per sample in sensor units */
+#define SENSOR_STAGGER_MS                       (5UL)   /* Phase step between acquisitions */
+#define SENSOR_MS_TO_TICKS(ms)                  ((uint32_t)(ms) / portTICK_PERIOD_MS)
+
+/**
+ * Hashed timer wheel. Due ticks are hashed to slots of 2^SHIFT ticks,
+ * so only slots that have passed are walked on wake up.
+ */
+#define SENSOR_WHEEL_SLOTS                      (32UL)  /* Power of two */
+#define SENSOR_WHEEL_SHIFT                      (3UL)   /* 8 ticks per slot */
+
+/* Sampled sensors */
+enum Sensor_Index
+{
+    SENSOR_HUMIDITY,
+    SENSOR_TEMPERATURE,
+    SENSOR_POTENTIOMETER,
+    SENSOR_SOIL_MOISTURE,
+    SENSOR_COUNT = SENSOR_SOIL_MOISTURE + SOIL_MOISTURE_SENSOR_COUNT
+};
+
+/* Outcomes of Sensor_Read */
+#define SENSOR_READ_DONE                        (0UL)   /* Sample taken */
+#define SENSOR_READ_FAST                        (1UL)   /* Sample taken, sample at minimum period */
+#define SENSOR_READ_FAILED                      (2UL)   /* No sample, previous result kept */
+
+/**
+ * Sensor read function. Acquires the sensor, stores result and returns
+ * one of SENSOR_READ_DONE...SENSOR_READ_FAILED.
+ * Value used for period adaptation is returned in plValue.
+ */
+typedef uint32_t (*Sensor_Read)(const uint32_t ulArg, int32_t *const plValue);
+
+/* Sampling scheduler state, read with debugger and sent in schedule frames */
+struct Sensor_Schedule_Stats
+{
+    uint32_t ulPeriodMs;        /* Current sample period */
+    uint32_t ulSamples;         /* Samples taken since boot */
+    uint32_t ulFailures;        /* Reads that returned SENSOR_READ_FAILED */
+};
+
 
 struct Sensor
 {
     int32_t lTemperature;
     uint32_t ulHumidity;
+    uint32_t ulHumidityRange;   /* HS1101_RANGE() used for ulHumidity */
     uint32_t ulSoilMoisture[SOIL_MOISTURE_SENSOR_COUNT];
     uint32_t ulPotentiometer;
+    uint32_t ulTimestamp;       /* BENCH_ulTimestamp() when reading started */
+    uint32_t ulUptimeTicks;     /* Tick count extended to 32 bits when reading started */
+    uint32_t ulUrgent;          /* TRUE when reading started a pump */
+    uint32_t ulPeriodMs[SENSOR_COUNT];  /* Sample periods, reported in schedule frames */
+    uint32_t ulWakeups;         /* ulSensorWakeups when reading started */
 };
 
 extern QueueHandle_t xAnalogQueue;
+extern struct Sensor_Schedule_Stats xSensorSchedule[SENSOR_COUNT];
+extern uint32_t ulSensorWakeups;
 
 
 /* Global function prototypes */
@@ -16,17 +16,29 @@
 #include "tpm.h"
 #include "dma.h"
 #include "nrf24l01.h"
+#include "pit.h"
+#include "benchmark.h"
+#include "pool.h"
 
 
 /* Global defines */
 #define MAX_QUEUE_SIZE          (32UL)
 
+/**
+ * Pipeline pools, queues between the tasks get one slot per block.
+ * Size from POOL_ulHighWater() of xSensorPool and xMessagePool.
+ */
+#define SENSOR_POOL_BLOCKS      (8UL)       /* Readings waiting for frame task */
+#define MESSAGE_POOL_BLOCKS     (4UL)       /* Frames waiting for comm task */
+#define COMMAND_QUEUE_SIZE      (2UL * COMMAND_MAX_COUNT)   /* Gateway commands waiting for sensor task */
+
 /* Task priorities */
 #define ANALOGTASKPRIORITY      (4UL)
 #define FRAMETASKPRIORITY       (5UL)
 #define COMMTASKPRIORITY        (7UL)
 #define MOTORTASKPRIORITY       (6UL)
 #define STARTUPTASKPRIORITY     (10UL)
+#define BENCHMARKTASKPRIORITY   (1UL)
 
 /* Task sizes */
 #define ANALOGTASKSIZE          (2048UL)    
@@ -34,14 +46,18 @@
 #define COMMTASKSIZE            (2048UL)    
 #define MOTORTASKSIZE           (1024UL)    
 #define STARTUPTASKSIZE         (4096UL)
+#define BENCHMARKTASKSIZE       (512UL)
 
     
 /* Global variables */
 extern QueueHandle_t xCommQueue;
 extern QueueHandle_t xAnalogQueue;
 extern QueueHandle_t xMotorQueue;
+extern QueueHandle_t xCommandQueue;
 extern EventGroupHandle_t xMotorEventGroup;
 extern SemaphoreHandle_t xCommSemaphore;
+extern struct Pool xSensorPool;
+extern struct Pool xMessagePool;
     
 
 /* Global function prototypes */
@@ -2,13 +2,80 @@
 #include  "HS1101.h"
 
 /* Local defines */
-#define HUMIDITY_FORMULA(x) ((x))
+#define CURVE_MIN_CAPACITANCE   (162L << 8)     /* Q8 pF */
+#define CURVE_STEP_SHIFT        (9UL)           /* 2 pF steps */
+#define CURVE_POINTS            (20UL)
+#define Q8_SHIFT                (8UL)
+#define BURST_CAPTURES          (2 * HS1101_BURST_CYCLES)
+#define BURST_TIMEOUT_MS        (100UL)
+#define TPM1_COUNTER_RANGE      (0x10000UL)
+#define MAX_PRESCALER           (7UL)
+#define FASTEST_THRESHOLD       (0UL)
+
+/* Board calibration, stored in reserved flash sector */
+struct HS1101_Calibration
+{
+    uint32_t ulMagic;
+    uint32_t ulGain;                    /* Q8 pF per count, scaled by 2^16 */
+    int32_t lOffset;                    /* Q8 pF */
+    uint32_t ulCrc;                     /* CRC-32 of preceding fields */
+};
+
+/* Global variables */
+uint32_t ulHumidityBurstErrors = 0;     /* Bursts discarded due to counter wrap */
 
 /* Local variables */
-TaskHandle_t xAnalogNotification = NULL;
+static TaskHandle_t xBurstTask = NULL;
+static volatile uint32_t ulBurstEnd;
+static uint16_t usBurstCaptures[BURST_CAPTURES];
+static uint32_t ulBurstPinControl[BURST_CAPTURES];
+
+/* Start from the safest range, first sample adjusts it */
+static uint32_t ulPrescaler = MAX_PRESCALER;
+static uint32_t ulThreshold = FASTEST_THRESHOLD;
+
+/**
+ * CMP0 DAC thresholds, fastest discharge first. Higher threshold shortens
+ * the discharge by ln(64 / (VOSEL + 1)) without changing the prescaler.
+ */
+static const uint8_t ucThresholdVosel[HS1101_THRESHOLD_COUNT] = {31, 15, 6};
+
+/* ln(64 / 7) / ln(64 / (VOSEL + 1)) in Q16, normalizes counts to reference threshold */
+static const uint32_t ulThresholdGain[HS1101_THRESHOLD_COUNT] = {209233, 104617, 65536};
+
+/* Inverse of ulThresholdGain in Q16, predicts counts in another threshold */
+static const uint32_t ulThresholdScale[HS1101_THRESHOLD_COUNT] = {20527, 41054, 65536};
+
+static struct HS1101_Calibration xCalibration =
+{
+    .ulMagic = HS1101_CAL_MAGIC,
+    .ulGain = HS1101_DEFAULT_GAIN,
+    .lOffset = HS1101_DEFAULT_OFFSET
+};
+
+static uint32_t ulCalibrationCounts[HS1101_CAL_POINT_HIGH + 1];
+static int32_t lCalibrationCapacitance[HS1101_CAL_POINT_HIGH + 1];
+
+/**
+ * Relative humidity in Q8 % at 162, 164 ... 200 pF, inverted from the
+ * HS1101 response curve at 25 C:
+ * C = 180 pF * (1.25e-7 RH^3 - 1.36e-5 RH^2 + 2.19e-3 RH + 0.9)
+ */
+static const uint16_t usHumidityCurve[CURVE_POINTS] =
+{
+    0,     1340,  2765,  4271,  5851,  7489,  9159,  10831, 12475, 14065,
+    15583, 17020, 18373, 19644, 20837, 21958, 23014, 24010, 24952, 25846
+};
 
 /* Local function prototypes */
-static void HS1101_vSendSignal(void);
+static BaseType_t HS1101_xReadCapture(uint32_t *const pulCount);
+static BaseType_t HS1101_xMeasure(uint32_t *const pulCount, uint32_t *const pulRange);
+static void HS1101_vApplyRange(void);
+static void HS1101_vSelectRange(const uint32_t ulNormalized);
+static void HS1101_vBurstDone(const uint32_t ulStatus, BaseType_t *const pxHigherPriorityTaskWoken);
+static int32_t HS1101_lCompensate(const uint32_t ulCount, const int32_t lTemperature);
+static uint32_t HS1101_ulCurveHumidity(const int32_t lCapacitance);
+static int32_t HS1101_lCurveCapacitance(const uint32_t ulHumidity);
 
 
 /* Function descriptions */
@@ -23,69 +90,406 @@ static void HS1101_vSendSignal(void);
  */
 void HS1101_vInit(void)
 {
+    const struct HS1101_Calibration *const pxStored = (const struct HS1101_Calibration *)HS1101_CAL_ADDRESS;
+    const uint32_t ulCrcLength = offsetof(struct HS1101_Calibration, ulCrc) / sizeof(uint32_t);
+    
     FGPIOE->PDDR |= MASK(HUMID_SENSOR_PIN);
     FGPIOE->PSOR |= MASK(HUMID_SENSOR_PIN);
+    
+    /* Use nominal values until board is calibrated */
+    if ((pxStored->ulMagic == HS1101_CAL_MAGIC) && (pxStored->ulCrc == FTFA_ulChecksum((const uint32_t *)pxStored, ulCrcLength)))
+    {
+        xCalibration = *pxStored;
+    }
 }
 
 
 /**
- * @brief   Start measuring HS1101 capacitance using CMP0 and TPM0 Input Capture mode.
- *          This function disables context switches for few cycles, because timer and
- *          comparator must be started at the same time.
+ * @brief   Measure average HS1101 discharge time over a burst of cycles.
  * 
- * @param   None
+ * @details Sequence starts with a discharged sensor and CMP0 output high:
+ *          1. CPU charges sensor, CMP0 output falls
+ *          2. Falling edge is captured, DMA switches pin to analog input
+ *             and the sensor discharges through the resistor
+ *          3. CMP0 output rises when voltage drops below DAC threshold,
+ *             capture and DMA switches pin back to charging
+ *          Steps 2-3 repeat HS1101_BURST_CYCLES times, the last capture
+ *          leaves the pin analog.
  * 
- * @return  None
+ *          Counter is never reset, discharge time is the 16-bit difference
+ *          of rising and falling captures. That holds while a discharge is
+ *          shorter than the counter range, which is verified against PIT.
+ * 
+ * @param   pulCount    Average discharge time in Q4 TPM1 counts.
+ * 
+ * @return  pdPASS on success, pdFAIL if a discharge didn't fit the counter.
  */
-static void HS1101_vSendSignal(void)
-{    
-    /* Charge capacitor */
-    BME_OR32(&PORTE->PCR[HUMID_SENSOR_PIN], PORT_PCR_MUX(ALT1));
+static BaseType_t HS1101_xReadCapture(uint32_t *const pulCount)
+{
+    uint32_t ulDone;
+    uint32_t ulStart;
+    uint32_t ulElapsed;
+    uint32_t ulSum = 0;
+    const uint32_t ulPinControl = PORTE->PCR[HUMID_SENSOR_PIN] & ~(PORT_PCR_MUX_MASK | PORT_PCR_ISF_MASK);
+    
+    /* No conversion should be in progress */
+    configASSERT(xBurstTask == NULL);
+    xBurstTask = xTaskGetCurrentTaskHandle();
     
-    /* Start atomic operations */
-    taskENTER_CRITICAL();
+    /* Discharge after falling edges, charge after rising edges */
+    for (uint32_t i = 0; i < BURST_CAPTURES; i++)
+    {
+        ulBurstPinControl[i] = ulPinControl | PORT_PCR_MUX(((i % 2) == 0) ? ALT0 : ALT1);
+    }
+    ulBurstPinControl[BURST_CAPTURES - 1] = ulPinControl | PORT_PCR_MUX(ALT0);
     
-    /* Start timer */
+    /* DMA channels are shared with ADC scan, claim them for this burst */
+    DMAMUX0_vInit(HS1101_DMA_CHANNEL, DMAMUX0_CHCFG_SOURCE_FTM1_C1);
+    DMA0_vSetCallback(HS1101_DMA_CHANNEL, HS1101_vBurstDone);
+    
+    /**
+     * Configure capture channel:
+     * Interrupt when done
+     * Peripheral request, disabled after last capture
+     * 16-bit transfers to incrementing address
+     * Link to pin channel after every capture
+     */
+    DMA0_vConfigureChannel(HS1101_DMA_CHANNEL, DMA_DCR_EINT(1) | DMA_DCR_ERQ(1) | DMA_DCR_D_REQ(1) | DMA_DCR_CS(1)
+                                             | DMA_DCR_SSIZE(DMA_DCR_SIZE_16BIT) | DMA_DCR_DSIZE(DMA_DCR_SIZE_16BIT) | DMA_DCR_DINC(1)
+                                             | DMA_DCR_LINKCC(DMA_DCR_LINKCC_CYCLE_STEAL) | DMA_DCR_LCH1(HS1101_LINK_DMA_CHANNEL));
+    DMA0_vInitTransaction(HS1101_DMA_CHANNEL, (uint32_t *)&TPM1->CONTROLS[1].CnV, (uint32_t *)usBurstCaptures, sizeof(usBurstCaptures));
+    
+    /**
+     * Configure pin channel:
+     * Started by link only
+     * 32-bit transfers from incrementing address
+     */
+    DMA0_vConfigureChannel(HS1101_LINK_DMA_CHANNEL, DMA_DCR_CS(1) | DMA_DCR_SSIZE(DMA_DCR_SIZE_32BIT) | DMA_DCR_DSIZE(DMA_DCR_SIZE_32BIT) | DMA_DCR_SINC(1));
+    DMA0_vInitTransaction(HS1101_LINK_DMA_CHANNEL, ulBurstPinControl, (uint32_t *)&PORTE->PCR[HUMID_SENSOR_PIN], sizeof(ulBurstPinControl));
+    
+    /* Clear stale capture and start counter */
+    BME_OR32(&TPM1->CONTROLS[1].CnSC, TPM_CnSC_CHF(1));
+    DMA0_vStart(HS1101_DMA_CHANNEL);
     BME_OR32(&TPM1->SC, TPM_SC_CMOD(1));
     
-    /* Set IO to inverted comparator mode */
-    BME_BFI32(&PORTE->PCR[HUMID_SENSOR_PIN], ALT0 << PORT_PCR_MUX_SHIFT, PORT_PCR_MUX_SHIFT, 1);
+    /* Charge capacitor to start the burst */
+    ulStart = PIT_ulReadTimestamp();
+    PORTE->PCR[HUMID_SENSOR_PIN] = ulPinControl | PORT_PCR_MUX(ALT1);
+    
+    /* Sleep until all edges are captured */
+    ulDone = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BURST_TIMEOUT_MS));
+    configASSERT(ulDone == 1);
     
-    /* Stop atomic operations */
-    taskEXIT_CRITICAL();
+    /* Stop TPM1 and leave sensor discharging */
+    BME_AND32(&TPM1->SC, ~TPM_SC_CMOD(3));
+    DMA0_vStop(HS1101_DMA_CHANNEL);
+    PORTE->PCR[HUMID_SENSOR_PIN] = ulPinControl | PORT_PCR_MUX(ALT0);
+    
+    /* Single pass over the burst, modular differences handle counter wrap */
+    for (uint32_t i = 0; i < BURST_CAPTURES; i += 2)
+    {
+        ulSum += (uint16_t)(usBurstCaptures[i + 1] - usBurstCaptures[i]);
+    }
+    
+    /**
+     * Burst time from PIT converted to TPM1 counts. Charging takes only
+     * microseconds, so a difference of a full counter range means that
+     * at least one discharge wrapped past its falling capture.
+     */
+    ulElapsed = ((ulBurstEnd - ulStart) * (TPM_CLOCK_HZ / PIT_TICKS_PER_SECOND)) >> ulPrescaler;
+    if ((ulElapsed > ulSum) && (ulElapsed - ulSum >= TPM1_COUNTER_RANGE))
+    {
+        ulHumidityBurstErrors++;
+        return pdFAIL;
+    }
+    
+    /* Cycle count is a power of two, division is a shift */
+    *pulCount = (ulSum << HS1101_CAPTURE_FRACTION_BITS) / HS1101_BURST_CYCLES;
+    return pdPASS;
 }
 
 
 /**
- * @brief   Read variable capacitor HS1101 using CMP0 and TMP0.
+ * @brief   Write current range to TPM1 and CMP0. TPM1 must be stopped.
  * 
  * @param   None
  * 
- * @return  ulHumid     Air humidity value.
+ * @return  None
+ */
+static void HS1101_vApplyRange(void)
+{
+    BME_BFI32(&TPM1->SC, ulPrescaler << TPM_SC_PS_SHIFT, TPM_SC_PS_SHIFT, TPM_SC_PS_WIDTH);
+    CMP0->DACCR = CMP_DACCR_DACEN(1) | CMP_DACCR_VOSEL(ucThresholdVosel[ulThreshold]);
+}
+
+
+/**
+ * @brief   Pick range for next measurement. Fastest threshold that still
+ *          gives HS1101_RANGE_MIN_COUNTS at full clock, then the smallest
+ *          prescaler that keeps counts under HS1101_RANGE_MAX_COUNTS.
  * 
- * @todo    Calibrate humidity sensor
+ * @param   ulNormalized    Last measurement, normalized Q4 counts.
+ * 
+ * @return  None
  */
-uint32_t HS1101_ulReadHumidity(void)
+static void HS1101_vSelectRange(const uint32_t ulNormalized)
 {
-    BaseType_t xAssert;
-    const TickType_t xTicksToWait = 100 / portTICK_PERIOD_MS;
-    uint32_t HS1101_ulValue = 0;
-    uint32_t ulHumid = 0;
+    uint32_t ulExpected = 0;
     
-    /* No conversion should be in progress */
-    configASSERT(xAnalogNotification == NULL);
+    /* Slowest threshold is used if none gives enough resolution */
+    for (ulThreshold = 0; ulThreshold < HS1101_THRESHOLD_COUNT; ulThreshold++)
+    {
+        ulExpected = CONVERT_ulMultiplyQ16(ulNormalized, ulThresholdScale[ulThreshold]) >> HS1101_CAPTURE_FRACTION_BITS;
+        if (ulExpected >= HS1101_RANGE_MIN_COUNTS)
+        {
+            break;
+        }
+    }
+    
+    if (ulThreshold == HS1101_THRESHOLD_COUNT)
+    {
+        ulThreshold = HS1101_REFERENCE_THRESHOLD;
+    }
+    
+    for (ulPrescaler = 0; ulPrescaler < MAX_PRESCALER; ulPrescaler++)
+    {
+        if ((ulExpected >> ulPrescaler) <= HS1101_RANGE_MAX_COUNTS)
+        {
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief   Measure in current range and adapt range for the next one.
+ *          Falls back to the safest range if the counter wrapped.
+ * 
+ * @param   pulCount    Normalized Q4 counts.
+ * 
+ * @param   pulRange    Range used, see HS1101_RANGE().
+ * 
+ * @return  pdPASS on success, pdFAIL if even the safest range failed.
+ */
+static BaseType_t HS1101_xMeasure(uint32_t *const pulCount, uint32_t *const pulRange)
+{
+    uint32_t ulCount;
+    
+    for (uint32_t i = 0; i < HS1101_RANGE_RETRIES; i++)
+    {
+        HS1101_vApplyRange();
+        
+        if (HS1101_xReadCapture(&ulCount) == pdPASS)
+        {
+            *pulRange = HS1101_RANGE(ulPrescaler, ulThreshold);
+            
+            /* Scale to 48 MHz and reference threshold */
+            *pulCount = CONVERT_ulMultiplyQ16(ulCount << ulPrescaler, ulThresholdGain[ulThreshold]);
+            
+            HS1101_vSelectRange(*pulCount);
+            return pdPASS;
+        }
+        
+        /* Discharge took longer than expected */
+        ulPrescaler = MAX_PRESCALER;
+        ulThreshold = FASTEST_THRESHOLD;
+    }
+    
+    return pdFAIL;
+}
+
+
+/**
+ * @brief   DMA callback for completed burst. Notifies measuring task.
+ * 
+ * @param   ulStatus                    DMA channel status.
+ * 
+ * @param   pxHigherPriorityTaskWoken   Set to pdTRUE if context switch is needed.
+ * 
+ * @return  None
+ */
+static void HS1101_vBurstDone(const uint32_t ulStatus, BaseType_t *const pxHigherPriorityTaskWoken)
+{
+    ulBurstEnd = PIT_ulReadTimestamp();
+    
+    /* Bus and configuration errors should not happen */
+    configASSERT((ulStatus & (DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK | DMA_DSR_BCR_CE_MASK)) == 0);
+    
+    /* Burst should have been in progress */
+    configASSERT(xBurstTask != NULL);
+    
+    vTaskNotifyGiveFromISR(xBurstTask, pxHigherPriorityTaskWoken);
+    
+    /* No burst in progress */
+    xBurstTask = NULL;
+}
+
+
+/**
+ * @brief   Convert capture count to capacitance at reference temperature.
+ * 
+ * @param   ulCount         Normalized discharge time, see HS1101_xMeasure().
+ * 
+ * @param   lTemperature    Sensor temperature in Celsius.
+ * 
+ * @return  Capacitance in Q8 pF.
+ */
+static int32_t HS1101_lCompensate(const uint32_t ulCount, const int32_t lTemperature)
+{
+    const int32_t lCapacitance = (int32_t)CONVERT_ulMultiplyQ16(ulCount, xCalibration.ulGain) + xCalibration.lOffset;
+    
+    return lCapacitance - HS1101_TEMP_COEFF * (lTemperature - HS1101_REFERENCE_TEMPERATURE);
+}
+
+
+/**
+ * @brief   Look up humidity from response curve with linear interpolation.
+ * 
+ * @param   lCapacitance    Capacitance at 25 C in Q8 pF.
+ * 
+ * @return  Relative humidity in Q8 %.
+ */
+static uint32_t HS1101_ulCurveHumidity(const int32_t lCapacitance)
+{
+    uint32_t ulOffset;
+    uint32_t ulIndex;
+    uint32_t ulFraction;
+    
+    if (lCapacitance <= CURVE_MIN_CAPACITANCE)
+    {
+        return usHumidityCurve[0];
+    }
+    
+    ulOffset = (uint32_t)(lCapacitance - CURVE_MIN_CAPACITANCE);
+    ulIndex = ulOffset >> CURVE_STEP_SHIFT;
+    if (ulIndex >= CURVE_POINTS - 1)
+    {
+        return usHumidityCurve[CURVE_POINTS - 1];
+    }
+    
+    /* Table steps are a power of two, so interpolation needs no division */
+    ulFraction = ulOffset & ((1UL << CURVE_STEP_SHIFT) - 1);
+    return usHumidityCurve[ulIndex] 
+         + (((usHumidityCurve[ulIndex + 1] - usHumidityCurve[ulIndex]) * ulFraction) >> CURVE_STEP_SHIFT);
+}
+
+
+/**
+ * @brief   Inverse of HS1101_ulCurveHumidity(), used for calibration only.
+ * 
+ * @param   ulHumidity  Relative humidity in percent.
+ * 
+ * @return  Capacitance at 25 C in Q8 pF.
+ */
+static int32_t HS1101_lCurveCapacitance(const uint32_t ulHumidity)
+{
+    const uint32_t ulTarget = ulHumidity << Q8_SHIFT;
+    uint32_t ulIndex = 0;
+    uint32_t ulRise;
+    
+    configASSERT(ulHumidity <= MAX_HUMIDITY);
+    
+    while (usHumidityCurve[ulIndex + 1] < ulTarget)
+    {
+        ulIndex++;
+    }
+    
+    ulRise = usHumidityCurve[ulIndex + 1] - usHumidityCurve[ulIndex];
+    return CURVE_MIN_CAPACITANCE + (int32_t)(ulIndex << CURVE_STEP_SHIFT) 
+         + (int32_t)(((ulTarget - usHumidityCurve[ulIndex]) << CURVE_STEP_SHIFT) / ulRise);
+}
+
+
+/**
+ * @brief   Read variable capacitor HS1101 using CMP0 and TPM1.
+ * 
+ * @param   lTemperature    Air temperature in Celsius, for compensation.
+ * 
+ * @param   pulHumidity     Relative humidity in percent.
+ * 
+ * @param   pulRange        Measurement range used, see HS1101_RANGE().
+ * 
+ * @return  pdPASS on success, pdFAIL if no range gave a reading. Outputs
+ *          are only written on success.
+ */
+BaseType_t HS1101_xReadHumidity(const int32_t lTemperature, uint32_t *const pulHumidity, uint32_t *const pulRange)
+{
+    uint32_t ulCount;
+    uint32_t ulRange;
+    uint32_t ulHumid;
+    
+    if (HS1101_xMeasure(&ulCount, &ulRange) != pdPASS)
+    {
+        return pdFAIL;
+    }
+    
+    /* Round Q8 to whole percents */
+    ulHumid = (HS1101_ulCurveHumidity(HS1101_lCompensate(ulCount, lTemperature)) + (1UL << (Q8_SHIFT - 1))) >> Q8_SHIFT;
+    
+    *pulHumidity = (ulHumid > MAX_HUMIDITY) ? MAX_HUMIDITY : ulHumid;
+    *pulRange = ulRange;
+    return pdPASS;
+}
+
+
+/**
+ * @brief   Record one calibration point. After the high point, gain and
+ *          offset are calculated and stored in flash.
+ * 
+ * @param   ulPoint                 HS1101_CAL_POINT_LOW or HS1101_CAL_POINT_HIGH.
+ * 
+ * @param   ulReferenceHumidity     Known relative humidity in percent.
+ * 
+ * @param   lTemperature            Air temperature in Celsius.
+ * 
+ * @return  pdPASS on success, pdFAIL if points are unusable or flash write failed.
+ */
+BaseType_t HS1101_xCalibratePoint(const uint32_t ulPoint, const uint32_t ulReferenceHumidity, const int32_t lTemperature)
+{
+    const uint32_t ulCrcLength = offsetof(struct HS1101_Calibration, ulCrc) / sizeof(uint32_t);
+    struct HS1101_Calibration xNew;
+    uint32_t ulCountSpan;
+    int32_t lCapacitanceSpan;
+    uint32_t ulRange;
+    
+    configASSERT(ulPoint <= HS1101_CAL_POINT_HIGH);
+    
+    if (HS1101_xMeasure(&ulCalibrationCounts[ulPoint], &ulRange) != pdPASS)
+    {
+        return pdFAIL;
+    }
+    
+    /* Capacitance the sensor should have at this temperature */
+    lCalibrationCapacitance[ulPoint] = HS1101_lCurveCapacitance(ulReferenceHumidity) 
+                                     + HS1101_TEMP_COEFF * (lTemperature - HS1101_REFERENCE_TEMPERATURE);
+    
+    if (ulPoint == HS1101_CAL_POINT_LOW)
+    {
+        return pdPASS;
+    }
+    
+    /* Higher humidity must charge longer */
+    if (ulCalibrationCounts[HS1101_CAL_POINT_HIGH] <= ulCalibrationCounts[HS1101_CAL_POINT_LOW] 
+     || lCalibrationCapacitance[HS1101_CAL_POINT_HIGH] <= lCalibrationCapacitance[HS1101_CAL_POINT_LOW])
+    {
+        return pdFAIL;
+    }
     
-    /* Update status */
-    xAnalogNotification = xTaskGetCurrentTaskHandle();
+    ulCountSpan = ulCalibrationCounts[HS1101_CAL_POINT_HIGH] - ulCalibrationCounts[HS1101_CAL_POINT_LOW];
+    lCapacitanceSpan = lCalibrationCapacitance[HS1101_CAL_POINT_HIGH] - lCalibrationCapacitance[HS1101_CAL_POINT_LOW];
     
-    /* Start conversion */
-    HS1101_vSendSignal();
+    xNew.ulMagic = HS1101_CAL_MAGIC;
+    xNew.ulGain = (uint32_t)(((uint64_t)lCapacitanceSpan << 16) / ulCountSpan);
+    xNew.lOffset = lCalibrationCapacitance[HS1101_CAL_POINT_LOW] 
+                 - (int32_t)CONVERT_ulMultiplyQ16(ulCalibrationCounts[HS1101_CAL_POINT_LOW], xNew.ulGain);
+    xNew.ulCrc = FTFA_ulChecksum((const uint32_t *)&xNew, ulCrcLength);
     
-    /* Wait until conversion done */
-    xAssert = xTaskNotifyWait(0x00, 0xFFFFFFFF, &HS1101_ulValue, xTicksToWait);
-    configASSERT(xAssert == pdPASS);
+    if ((FTFA_xEraseSector(HS1101_CAL_ADDRESS) != pdPASS)
+     || (FTFA_xProgram(HS1101_CAL_ADDRESS, (const uint32_t *)&xNew, sizeof(xNew) / sizeof(uint32_t)) != pdPASS))
+    {
+        return pdFAIL;
+    }
     
-    /* Convert analog value and return it */
-    ulHumid = HUMIDITY_FORMULA(HS1101_ulValue);
-    return (ulHumid);
+    xCalibration = xNew;
+    return pdPASS;
 }
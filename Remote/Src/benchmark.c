@@ -0,0 +1,206 @@
+/**
+ * benchmark.c
+ * This file handles on-target latency measurements.
+ */
+
+#include "benchmark.h"
+
+
+/* Local defines */
+
+/* Local variables */
+struct Benchmark_Accumulator
+{
+    uint32_t ulCount;
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint64_t ullTotal;
+    uint32_t ulBytes;
+};
+
+static struct Benchmark_Accumulator xAccumulators[BENCH_POINT_COUNT];
+
+static TaskHandle_t xIdleTask = NULL;
+static uint32_t ulIdleStart;
+static uint32_t ulIdleTicks;
+
+/* Global variables */
+struct Benchmark_Stats xBenchmarkReport[BENCH_POINT_COUNT];
+uint32_t ulBenchmarkIdlePercent;
+uint32_t ulBenchmarkSpiPercent;     /* SPI1 chip selects low */
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Read timestamp for a measurement.
+ * 
+ * @param   None
+ * 
+ * @return  Bus clock ticks.
+ */
+uint32_t BENCH_ulTimestamp(void)
+{
+    return PIT_ulReadTimestamp();
+}
+
+
+/**
+ * @brief   Record time elapsed since ulStart to the given measurement point.
+ * 
+ * @param   ulPoint     Measurement point, see enum Benchmark_Points.
+ * 
+ * @param   ulStart     Timestamp from BENCH_ulTimestamp().
+ * 
+ * @return  None
+ */
+void BENCH_vRecord(const uint32_t ulPoint, const uint32_t ulStart)
+{
+    BENCH_vRecordSpan(ulPoint, ulStart, BENCH_ulTimestamp(), 0);
+}
+
+
+/**
+ * @brief   Record time between two timestamps and the amount of bytes
+ *          transferred during it to the given measurement point.
+ * 
+ * @note    Must not be called from ISR.
+ * 
+ * @param   ulPoint     Measurement point, see enum Benchmark_Points.
+ * 
+ * @param   ulStart     Timestamp from BENCH_ulTimestamp().
+ * 
+ * @param   ulEnd       Timestamp from BENCH_ulTimestamp().
+ * 
+ * @param   ulBytes     Bytes transferred, 0 if not applicable.
+ * 
+ * @return  None
+ */
+void BENCH_vRecordSpan(const uint32_t ulPoint, const uint32_t ulStart, const uint32_t ulEnd, const uint32_t ulBytes)
+{
+    configASSERT(ulPoint < BENCH_POINT_COUNT);
+    
+    const uint32_t ulElapsed = ulEnd - ulStart;
+    struct Benchmark_Accumulator *pxAcc = &xAccumulators[ulPoint];
+    
+    /* Report task reads and resets the accumulators */
+    taskENTER_CRITICAL();
+    
+    if ((pxAcc->ulCount == 0) || (ulElapsed < pxAcc->ulMin))
+    {
+        pxAcc->ulMin = ulElapsed;
+    }
+    
+    if (ulElapsed > pxAcc->ulMax)
+    {
+        pxAcc->ulMax = ulElapsed;
+    }
+    
+    pxAcc->ullTotal += ulElapsed;
+    pxAcc->ulBytes += ulBytes;
+    pxAcc->ulCount++;
+    
+    taskEXIT_CRITICAL();
+}
+
+
+/**
+ * @brief   Store idle task handle. Called from vApplicationIdleHook().
+ * 
+ * @param   None
+ * 
+ * @return  None
+ */
+void BENCH_vIdleHook(void)
+{
+    if (xIdleTask == NULL)
+    {
+        xIdleTask = xTaskGetCurrentTaskHandle();
+        ulIdleStart = BENCH_ulTimestamp();
+    }
+}
+
+
+/**
+ * @brief   Kernel trace hook, called from scheduler with interrupts masked.
+ * 
+ * @param   pvTask      Task being switched in.
+ * 
+ * @return  None
+ */
+void BENCH_vTaskSwitchedIn(void *const pvTask)
+{
+    if ((pvTask == xIdleTask) && (xIdleTask != NULL))
+    {
+        ulIdleStart = BENCH_ulTimestamp();
+    }
+}
+
+
+/**
+ * @brief   Kernel trace hook, called from scheduler with interrupts masked.
+ *          Idle time includes tickless sleep.
+ * 
+ * @param   pvTask      Task being switched out.
+ * 
+ * @return  None
+ */
+void BENCH_vTaskSwitchedOut(void *const pvTask)
+{
+    if ((pvTask == xIdleTask) && (xIdleTask != NULL))
+    {
+        ulIdleTicks += BENCH_ulTimestamp() - ulIdleStart;
+    }
+}
+
+
+/**
+ * @brief   FreeRTOS benchmark task. Periodically converts the accumulated
+ *          measurements to xBenchmarkReport and starts a new period.
+ * 
+ * @note    Read xBenchmarkReport with debugger.
+ * 
+ * @param   pvParam     Unused.
+ * 
+ * @return  None
+ */
+void vBenchmarkTask(void *const pvParam)
+{
+    (void)pvParam;
+    struct Benchmark_Accumulator xSnapshot;
+    uint32_t ulIdle;
+    uint32_t ulSpiBusy;
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    
+    for (;;)
+    {
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(BENCHMARK_REPORT_PERIOD_MS));
+        
+        taskENTER_CRITICAL();
+        ulIdle = ulIdleTicks;
+        ulIdleTicks = 0;
+        taskEXIT_CRITICAL();
+        
+        ulSpiBusy = SPI1_ulTakeBusyTicks();
+        
+        ulBenchmarkIdlePercent = (uint32_t)(((uint64_t)ulIdle * 100) / ((uint64_t)BENCHMARK_REPORT_PERIOD_MS * 1000 * PIT_TICKS_PER_MICROSECOND));
+        ulBenchmarkSpiPercent = (uint32_t)(((uint64_t)ulSpiBusy * 100) / ((uint64_t)BENCHMARK_REPORT_PERIOD_MS * 1000 * PIT_TICKS_PER_MICROSECOND));
+        
+        for (uint32_t i = 0; i < BENCH_POINT_COUNT; i++)
+        {
+            taskENTER_CRITICAL();
+            xSnapshot = xAccumulators[i];
+            xAccumulators[i].ulCount = 0;
+            xAccumulators[i].ulMax = 0;
+            xAccumulators[i].ullTotal = 0;
+            xAccumulators[i].ulBytes = 0;
+            taskEXIT_CRITICAL();
+            
+            xBenchmarkReport[i].ulCount = xSnapshot.ulCount;
+            xBenchmarkReport[i].ulMin = PIT_TICKS_TO_US(xSnapshot.ulMin);
+            xBenchmarkReport[i].ulMax = PIT_TICKS_TO_US(xSnapshot.ulMax);
+            xBenchmarkReport[i].ulAverage = (xSnapshot.ulCount != 0) ? PIT_TICKS_TO_US((uint32_t)(xSnapshot.ullTotal / xSnapshot.ulCount)) : 0;
+            xBenchmarkReport[i].ulBytesPerSecond = (xSnapshot.ullTotal != 0) ? (uint32_t)(((uint64_t)xSnapshot.ulBytes * PIT_TICKS_PER_SECOND) / xSnapshot.ullTotal) : 0;
+        }
+    }
+}
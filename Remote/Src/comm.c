@@ -3,15 +3,73 @@
 
 /* Local defines */
 
+/* Temperature, humidity and one soil moisture field per probe of the board */
+#define FRAME_PROBE_FIELD(probe, channel, profile, convert, zone)       + 1
+#define FRAME_PROBE_TAG(probe, channel, profile, convert, zone)         , (FRAME_FIELD_SOIL_MOISTURE << 4) | (probe)
+#define FRAME_SAMPLE_FIELDS             (2 BOARD_SOIL_PROBES(FRAME_PROBE_FIELD))
+
+#if (FRAME_SAMPLE_FIELDS > FRAME_BATCH_MAX_FIELDS) || (FRAME_KEY_MAX_SIZE(FRAME_SAMPLE_FIELDS) > FRAME_MAX_SIZE) \
+    || (FRAME_DELTA_MAX_SIZE(FRAME_SAMPLE_FIELDS) > FRAME_MAX_SIZE)
+#error "Board has too many sensors for one frame"
+#endif
+
+#if (FRAME_SCHEDULE_MAX_SIZE(FRAME_SAMPLE_FIELDS) > FRAME_MAX_SIZE) \
+    || ((SENSOR_MAX_PERIOD_MS / FRAME_PERIOD_UNIT_MS) >> (7 * FRAME_PERIOD_MAX_SIZE)) != 0
+#error "Schedule frame doesn't fit"
+#endif
+
+#if FRAME_MAX_SIZE > NRF24L01_MAX_TX_PAYLOAD
+#error "Frames don't fit nRF24L01 payload"
+#endif
+
+
 /* Global variables */
 QueueHandle_t xCommQueue;
 SemaphoreHandle_t xCommSemaphore;
-TaskHandle_t xCommTask = NULL;
+QueueHandle_t xCommandQueue;
+EventGroupHandle_t xCommEventGroup;
 
-struct AMessage
+struct Comm_Batch_Stats xBatchStats;
+struct Comm_Tx_Stats xTxStats;
+struct Comm_Command_Stats xCommandStats;
+struct Comm_Tx_Record xTxLog[COMM_TX_LOG_SIZE];
+uint32_t ulTxLogIndex = 0;      /* Next record to write */
+
+
+/* Local variables */
+
+/* Field tags in the order of vFrameValues() */
+static const uint8_t ucFrameTags[FRAME_SAMPLE_FIELDS] = 
 {
-    char ucFrame[MAX_FRAME_SIZE];
-} xMessage;
+    FRAME_FIELD_TEMPERATURE << 4, 
+    FRAME_FIELD_HUMIDITY << 4 
+    BOARD_SOIL_PROBES(FRAME_PROBE_TAG)
+};
+
+/* Samples of the frame being built, for vFrameFlush() to rebuild it */
+static uint32_t ulFrameSeconds[FRAME_MAX_SAMPLES];
+static int32_t lFrameValues[FRAME_MAX_SAMPLES][FRAME_SAMPLE_FIELDS];
+
+/* Latest sample periods in FRAME_PERIOD_UNIT_MS in ucFrameTags order, and the ones last reported */
+static uint32_t ulPeriods[FRAME_SAMPLE_FIELDS];
+static uint32_t ulReportedPeriods[FRAME_SAMPLE_FIELDS];
+static uint32_t ulWakeups;
+static uint32_t ulLatestSeconds;
+
+
+/* Local function prototypes */
+static void vFrameValues(const struct Sensor *const pxSensor, int32_t *const plValues);
+static uint32_t ulFrameAppend(struct Frame_Encoder *const pxEncoder, const uint32_t ulSeconds, const int32_t *const plValues);
+static void vFrameFlush(struct Frame_Encoder *const pxEncoder, const uint32_t ulTimestamp);
+static void vFrameSend(struct Frame_Encoder *const pxEncoder, const uint32_t ulTimestamp);
+static void vFramePeriods(const struct Sensor *const pxSensor);
+static void vFrameSchedule(const struct Frame_Encoder *const pxEncoder, const uint32_t ulTimestamp);
+static uint32_t ulTransmit(struct AMessage *const pxMessage);
+static uint32_t ulStream(struct AMessage *pxMessage);
+static void vTxStart(struct AMessage *const pxMessage);
+static uint32_t ulTxOutcome(struct AMessage *pxMessage, const uint32_t ulDelivered);
+static void vTxRecord(const struct AMessage *const pxMessage, const uint32_t ulOutcome);
+static void vCommandReceive(void);
 
     
 /* Function descriptions */
@@ -28,96 +86,663 @@ void vCommTask(void *const pvParam)
     (void)pvParam;
     BaseType_t xAssert;
     struct AMessage *pxMessage;
+    uint32_t ulRequeued;
     const TickType_t xTicksToWait = 100 / portTICK_PERIOD_MS;
     
     for (;;)
     {
-        if (xQueueReceive(xCommQueue, &(pxMessage), (TickType_t) 10))
+        const uint32_t ulLoopStart = BENCH_ulTimestamp();
+        ulRequeued = FALSE;
+        
+        if (POOL_xReceive(xCommQueue, (void **)&pxMessage, (TickType_t) 10))
         {
             /* Guard nRF24L01 */
             if (xSemaphoreTake(xCommSemaphore, (TickType_t)xTicksToWait))
             {
-                nRF24L01_vSendPayload(pxMessage->ucFrame, strlen(pxMessage->ucFrame));
-
+                /* Backlog goes through TX FIFO back to back, a lone frame on its own */
+                if (uxQueueMessagesWaiting(xCommQueue) > 0)
+                {
+                    ulRequeued = ulStream(pxMessage);
+                }
+                else
+                {
+                    ulRequeued = ulTxOutcome(pxMessage, ulTransmit(pxMessage));
+                }
+                
                 /* This call should not fail in any circumstance */
                 xAssert = xSemaphoreGive(xCommSemaphore);
                 configASSERT(xAssert == pdTRUE);
             }
+            else
+            {
+                ulRequeued = ulTxOutcome(pxMessage, FALSE);
+            }
         }
         
-        vTaskDelay(pdMS_TO_TICKS(50));
+        BENCH_vRecord(BENCH_COMM_LOOP, ulLoopStart);
+        
+        /* Give the link time to recover before requeued frames */
+        if (ulRequeued == TRUE)
+        {
+            vTaskDelay(pdMS_TO_TICKS(COMM_TX_BACKOFF_MS));
+        }
     }
 }
 
 
 /**
- * @brief   FreeRTOS frame task. Builds the message to send.
+ * @brief   Transmit frame, retransmitting it right away after MAX_RT.
  * 
- * @param   pvParam     Unused.
+ * @note    Caller must hold xCommSemaphore.
  * 
- * @return  None
+ * @param   pxMessage   Frame to transmit.
+ * 
+ * @return  TRUE if frame was acked, else FALSE and TX FIFO is flushed.
  */
-void vFrameTask(void *const pvParam)
+static uint32_t ulTransmit(struct AMessage *const pxMessage)
 {
-    (void)pvParam;
-    int32_t lBytesWritten;
-    BaseType_t xAssert;
+    const TickType_t xTimeout = pdMS_TO_TICKS(COMM_TX_TIMEOUT_MS);
+    uint32_t ulResult;
     
-    struct Sensor *pxSensor;
-    struct AMessage *pxMessage;
-    pxMessage = &xMessage;
+    vTxStart(pxMessage);
+    nRF24L01_vSendPayload((const char *)pxMessage->ucFrame, pxMessage->ulLength);
+    ulResult = nRF24L01_ulWaitForTransmit(xTimeout);
+    
+    /* Payload is kept in TX FIFO after MAX_RT */
+    for (uint32_t i = 0; (i < COMM_TX_RETRIES) && (ulResult == NRF24L01_TX_MAX_RT); i++)
+    {
+        xTxStats.ulRetransmits++;
+        pxMessage->ulTransmissions++;
+        nRF24L01_vRetransmit();
+        ulResult = nRF24L01_ulWaitForTransmit(xTimeout);
+    }
+    
+    if (ulResult == NRF24L01_TX_ACKED)
+    {
+        vCommandReceive();
+        return TRUE;
+    }
+    
+    /* Next payload needs empty TX FIFO */
+    nRF24L01_vFlushTx();
+    
+    /* No IRQ at all may mean radio lost its registers in a power cycle */
+    if (ulResult == NRF24L01_TX_TIMEOUT)
+    {
+        (void)nRF24L01_ulShadowVerify();
+    }
+    
+    return FALSE;
+}
+
+
+/**
+ * @brief   Stream frames waiting in xCommQueue through nRF24L01 TX FIFO,
+ *          refilling it on every ACK, until the queue is empty or a
+ *          frame fails. Retry policy is the same as in ulTransmit().
+ * 
+ * @note    Caller must hold xCommSemaphore.
+ * 
+ * @param   pxMessage   First frame of the burst.
+ * 
+ * @return  TRUE if frames were requeued.
+ */
+static uint32_t ulStream(struct AMessage *pxMessage)
+{
+    struct AMessage *pxInFlight[NRF24L01_TX_FIFO_SIZE];    /* Loaded frames, oldest at head */
+    const TickType_t xTimeout = pdMS_TO_TICKS(COMM_TX_TIMEOUT_MS);
+    const uint32_t ulStart = BENCH_ulTimestamp();
+    uint32_t ulHead = 0;
+    uint32_t ulCount = 0;
+    uint32_t ulRetries = 0;
+    uint32_t ulDelivered = 0;
+    uint32_t ulRequeued = FALSE;
+    uint32_t ulAcked;
+    uint32_t ulResult = NRF24L01_TX_ACKED;
+    
+    xTxStats.ulBursts++;
+    nRF24L01_vStreamStart();
     
     for (;;)
     {
-        if (xAnalogQueue != 0)
+        /* Keep TX FIFO full while frames are waiting */
+        while (pxMessage != NULL)
         {
-            if (xQueueReceive(xAnalogQueue, &pxSensor, (TickType_t)50))
-            {
-                /* Build the frame */
-                lBytesWritten = csnprintf(pxMessage->ucFrame, MAX_FRAME_SIZE, "tmp=%ldhum=%lumst=%lu", pxSensor->lTemperature, pxSensor->ulHumidity, pxSensor->ulSoilMoisture);
-                configASSERT(lBytesWritten >= 0);
+            vTxStart(pxMessage);
+            nRF24L01_vLoadPayload((const char *)pxMessage->ucFrame, pxMessage->ulLength);
+            pxInFlight[(ulHead + ulCount) % NRF24L01_TX_FIFO_SIZE] = pxMessage;
+            ulCount++;
             
-                /* Transmit */
-                xAssert = xQueueSend(xCommQueue, (void *)&pxMessage, (TickType_t)10);
-                configASSERT(xAssert);
+            pxMessage = NULL;
+            if (ulCount < NRF24L01_TX_FIFO_SIZE)
+            {
+                (void)POOL_xReceive(xCommQueue, (void **)&pxMessage, (TickType_t)0);
+            }
+        }
+        
+        if (ulCount == 0)
+        {
+            break; /* Backlog sent */
+        }
+        
+        ulResult = nRF24L01_ulStreamWait(xTimeout, &ulAcked);
+        
+        /* RX FIFO holds three ACK payloads, empty it before one is lost */
+        vCommandReceive();
+        
+        for (; ulAcked > 0; ulAcked--)
+        {
+            (void)ulTxOutcome(pxInFlight[ulHead], TRUE);
+            ulHead = (ulHead + 1) % NRF24L01_TX_FIFO_SIZE;
+            ulCount--;
+            ulDelivered++;
+            ulRetries = 0;
+        }
+        
+        if (ulResult == NRF24L01_TX_MAX_RT)
+        {
+            if (ulRetries == COMM_TX_RETRIES)
+            {
+                break;
             }
+            
+            ulRetries++;
+            xTxStats.ulRetransmits++;
+            pxInFlight[ulHead]->ulTransmissions++;
+            nRF24L01_vStreamResume();
+        }
+        else if (ulResult == NRF24L01_TX_TIMEOUT)
+        {
+            break;
         }
         
-        vTaskDelay(pdMS_TO_TICKS(100));
+        if (ulCount < NRF24L01_TX_FIFO_SIZE)
+        {
+            (void)POOL_xReceive(xCommQueue, (void **)&pxMessage, (TickType_t)0);
+        }
+    }
+    
+    nRF24L01_vStreamStop();
+    
+    if (ulResult == NRF24L01_TX_TIMEOUT)
+    {
+        (void)nRF24L01_ulShadowVerify();
+    }
+    
+    /**
+     * Frames left were flushed. An ACK missed by nRF24L01_ulStreamWait()
+     * sends a frame twice, gateway drops the copy by its sequence number.
+     * Requeue newest first to keep frame order.
+     */
+    for (uint32_t i = ulCount; i > 0; i--)
+    {
+        ulRequeued |= ulTxOutcome(pxInFlight[(ulHead + i - 1) % NRF24L01_TX_FIFO_SIZE], FALSE);
+    }
+    
+    /* Byte count is frames, so the report gives frames per second */
+    BENCH_vRecordSpan(BENCH_RADIO_STREAM, ulStart, BENCH_ulTimestamp(), ulDelivered);
+    
+    return ulRequeued;
+}
+
+
+/**
+ * @brief   Mark frame handed to nRF24L01.
+ * 
+ * @param   pxMessage   Frame about to be written to TX FIFO.
+ * 
+ * @return  None
+ */
+static void vTxStart(struct AMessage *const pxMessage)
+{
+    if (pxMessage->ulTransmissions == 0)
+    {
+        pxMessage->ulSendTimestamp = BENCH_ulTimestamp();
+        BENCH_vRecordSpan(BENCH_SENSOR_TO_RADIO, pxMessage->ulTimestamp, pxMessage->ulSendTimestamp, 0);
+    }
+    
+    pxMessage->ulTransmissions++;
+}
+
+
+/**
+ * @brief   Apply transmit policy to a frame that was sent or failed.
+ *          Failed frame is requeued or, after COMM_TX_REQUEUES, dropped.
+ * 
+ * @param   pxMessage   Frame owned by caller, passed on or freed.
+ * 
+ * @param   ulDelivered TRUE if frame was acked.
+ * 
+ * @return  TRUE if frame was requeued.
+ */
+static uint32_t ulTxOutcome(struct AMessage *pxMessage, const uint32_t ulDelivered)
+{
+    BaseType_t xAssert;
+    
+    if (ulDelivered == TRUE)
+    {
+        vTxRecord(pxMessage, COMM_TX_DELIVERED);
+        POOL_vFree(&xMessagePool, pxMessage);
+    }
+    else if (pxMessage->ulRequeues < COMM_TX_REQUEUES)
+    {
+        /* Front of queue keeps frame order */
+        pxMessage->ulRequeues++;
+        xTxStats.ulRequeues++;
+        
+        /* Queue has a slot for every block, so send can't fail */
+        xAssert = POOL_xSendToFront(xCommQueue, (void **)&pxMessage, (TickType_t)0);
+        configASSERT(xAssert);
+        
+        return TRUE;
+    }
+    else
+    {
+        vTxRecord(pxMessage, COMM_TX_DROPPED);
+        POOL_vFree(&xMessagePool, pxMessage);
+    }
+    
+    return FALSE;
+}
+
+
+/**
+ * @brief   Count frame outcome and add it to xTxLog.
+ * 
+ * @param   pxMessage   Frame that was delivered or dropped.
+ * 
+ * @param   ulOutcome   COMM_TX_DELIVERED or COMM_TX_DROPPED.
+ * 
+ * @return  None
+ */
+static void vTxRecord(const struct AMessage *const pxMessage, const uint32_t ulOutcome)
+{
+    struct Comm_Tx_Record *const pxRecord = &xTxLog[ulTxLogIndex];
+    const uint32_t ulEnd = BENCH_ulTimestamp();
+    
+    pxRecord->ucSequence = pxMessage->ucFrame[2];   /* See frame.h */
+    pxRecord->ucOutcome = (uint8_t)ulOutcome;
+    pxRecord->ucTransmissions = (uint8_t)pxMessage->ulTransmissions;
+    pxRecord->ulLatencyUs = (pxMessage->ulTransmissions > 0) ? PIT_TICKS_TO_US(ulEnd - pxMessage->ulSendTimestamp) : 0;
+    ulTxLogIndex = (ulTxLogIndex + 1) % COMM_TX_LOG_SIZE;
+    
+    if (ulOutcome == COMM_TX_DELIVERED)
+    {
+        xTxStats.ulDelivered++;
+        BENCH_vRecordSpan(BENCH_RADIO_DELIVERY, pxMessage->ulSendTimestamp, ulEnd, pxMessage->ulLength);
+    }
+    else
+    {
+        xTxStats.ulDropped++;
+        
+        /* Schedule frames are outside the delta chain */
+        if ((pxMessage->ucFrame[0] & 0x0F) != FRAME_TYPE_SCHEDULE)
+        {
+            (void)xEventGroupSetBits(xCommEventGroup, COMM_EVENT_FRAME_DROPPED);
+        }
     }
 }
 
 
 /**
- * @brief   Sets SPI1 SS line high and stops DMA0.
+ * @brief   Pass commands of ACK payloads received from the gateway to
+ *          sensor task.
+ * 
+ * @note    Caller must hold xCommSemaphore.
  * 
  * @param   None
  * 
  * @return  None
  */
-void TPM2_IRQHandler(void)
+static void vCommandReceive(void)
+{
+    static uint32_t ulPrevSequence;
+    static uint32_t ulSequenceValid = FALSE;
+    struct Command xCommands[COMMAND_MAX_COUNT];
+    uint8_t ucPayload[COMMAND_PAYLOAD_MAX_SIZE];
+    uint32_t ulLength;
+    uint32_t ulSequence;
+    int32_t lCount;
+    
+    while ((ulLength = nRF24L01_ulReadAckPayload(ucPayload)) > 0)
+    {
+        lCount = COMMAND_lDecode(ucPayload, ulLength, NODE_ID, &ulSequence, xCommands);
+        if (lCount < 0)
+        {
+            xCommandStats.ulErrors++;
+            continue;
+        }
+        
+        /* Gateway loads a payload again if it didn't see it delivered */
+        if ((ulSequenceValid == TRUE) && (ulSequence == ulPrevSequence))
+        {
+            xCommandStats.ulDuplicates++;
+            continue;
+        }
+        ulPrevSequence = ulSequence;
+        ulSequenceValid = TRUE;
+        xCommandStats.ulPayloads++;
+        
+        for (int32_t i = 0; i < lCount; i++)
+        {
+            if (xQueueSend(xCommandQueue, &xCommands[i], (TickType_t)0) == pdTRUE)
+            {
+                xCommandStats.ulCommands++;
+            }
+            else
+            {
+                xCommandStats.ulDropped++;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief   Collect frame field values of a sensor reading. Sensor
+ *          ranges fit one byte, see MIN_TEMPERATURE...MAX_SOIL_MOISTURE.
+ * 
+ * @param   pxSensor    Sensor reading.
+ * 
+ * @param   plValues    FRAME_SAMPLE_FIELDS values in ucFrameTags order.
+ * 
+ * @return  None
+ */
+static void vFrameValues(const struct Sensor *const pxSensor, int32_t *const plValues)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    plValues[0] = pxSensor->lTemperature;
+    plValues[1] = (int32_t)pxSensor->ulHumidity;
     
-    if (BME_UBFX32(&TPM2->STATUS, TPM_STATUS_TOF_SHIFT, TPM_STATUS_TOF_WIDTH))
+    for (uint32_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
     {
-        /* Cleanup */
-        SPI1_vSetSlave(HIGH);
-        TPM2_vStop();
+        plValues[2 + i] = (int32_t)pxSensor->ulSoilMoisture[i];
+    }
+}
 
-        /* Should not be NULL as transmission was in progress */
-        configASSERT(xCommTask != NULL);
 
-        /* Notify task */
-        vTaskNotifyGiveFromISR(xCommTask, &xHigherPriorityTaskWoken);
+/**
+ * @brief   Collect sample periods of a sensor reading in field order.
+ * 
+ * @param   pxSensor    Sensor reading.
+ * 
+ * @return  None
+ */
+static void vFramePeriods(const struct Sensor *const pxSensor)
+{
+    ulPeriods[0] = pxSensor->ulPeriodMs[SENSOR_TEMPERATURE] / FRAME_PERIOD_UNIT_MS;
+    ulPeriods[1] = pxSensor->ulPeriodMs[SENSOR_HUMIDITY] / FRAME_PERIOD_UNIT_MS;
+    
+    for (uint32_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
+    {
+        ulPeriods[2 + i] = pxSensor->ulPeriodMs[SENSOR_SOIL_MOISTURE + i] / FRAME_PERIOD_UNIT_MS;
+    }
+    
+    ulWakeups = pxSensor->ulWakeups;
+}
+
+
+/**
+ * @brief   Append sample to frame and keep it for vFrameFlush().
+ * 
+ * @param   pxEncoder   Encoder.
+ * 
+ * @param   ulSeconds   Seconds since boot when sample was read.
+ * 
+ * @param   plValues    FRAME_SAMPLE_FIELDS values in ucFrameTags order.
+ * 
+ * @return  1 if sample was added, 0 if frame must be finished first.
+ */
+static uint32_t ulFrameAppend(struct Frame_Encoder *const pxEncoder, const uint32_t ulSeconds, const int32_t *const plValues)
+{
+    const uint32_t ulIndex = pxEncoder->ulSamples;
+    
+    if (FRAME_ulEncoderAppend(pxEncoder, ulSeconds, plValues) == 0)
+    {
+        return 0;
+    }
+    
+    ulFrameSeconds[ulIndex] = ulSeconds;
+    for (uint32_t i = 0; i < FRAME_SAMPLE_FIELDS; i++)
+    {
+        lFrameValues[ulIndex][i] = plValues[i];
+    }
+    
+    return 1;
+}
+
+
+/**
+ * @brief   Finish frame and pass it to communication task. A delta frame
+ *          started before comm task dropped a frame can't be decoded,
+ *          so it is rebuilt as a key frame first.
+ * 
+ * @note    Key frame header takes more room, samples that no longer fit
+ *          are sent in a delta frame following it.
+ * 
+ * @param   pxEncoder       Encoder with started frame.
+ * 
+ * @param   ulTimestamp     BENCH_ulTimestamp() of first sample.
+ * 
+ * @return  None
+ */
+static void vFrameFlush(struct Frame_Encoder *const pxEncoder, const uint32_t ulTimestamp)
+{
+    const uint32_t ulSamples = pxEncoder->ulSamples;
+    EventBits_t uxBits;
+    uint32_t ulAdded;
+    
+    uxBits = xEventGroupClearBits(xCommEventGroup, COMM_EVENT_FRAME_DROPPED);
+    
+    if (((uxBits & COMM_EVENT_FRAME_DROPPED) != 0) && ((pxEncoder->ucFrame[0] & 0x0F) == FRAME_TYPE_DELTA))
+    {
+        xBatchStats.ulRekeyedFrames++;
+        FRAME_vEncoderDiscard(pxEncoder);
         
-        /* Transmission no longer in progress */
-        xCommTask = NULL;
+        for (uint32_t i = 0; i < ulSamples; i++)
+        {
+            /* Appended samples are kept at or before index i, so unread ones stay intact */
+            if (ulFrameAppend(pxEncoder, ulFrameSeconds[i], lFrameValues[i]) == 0)
+            {
+                vFrameSend(pxEncoder, ulTimestamp);
+                
+                /* Any sample fits an empty frame, checked at top of file */
+                ulAdded = ulFrameAppend(pxEncoder, ulFrameSeconds[i], lFrameValues[i]);
+                configASSERT(ulAdded == 1);
+            }
+        }
     }
+    
+    vFrameSend(pxEncoder, ulTimestamp);
+}
 
-    /* Clear Timer Overflow Flag */
-    BME_OR32(&TPM2->STATUS, TPM_STATUS_TOF(1));
 
-    /* Force context switch if xHigherPriorityTaskWoken is set pdTRUE */
-    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+/**
+ * @brief   Finish frame and pass it to communication task.
+ * 
+ * @param   pxEncoder       Encoder with started frame.
+ * 
+ * @param   ulTimestamp     BENCH_ulTimestamp() of first sample.
+ * 
+ * @return  None
+ */
+static void vFrameSend(struct Frame_Encoder *const pxEncoder, const uint32_t ulTimestamp)
+{
+    BaseType_t xAssert;
+    struct AMessage *pxMessage;
+    const uint32_t ulSamples = pxEncoder->ulSamples;
+    uint32_t ulLength;
+    
+    if ((pxEncoder->ucFrame[0] & 0x0F) == FRAME_TYPE_KEY)
+    {
+        xBatchStats.ulKeyFrames++;
+    }
+    
+    ulLength = FRAME_ulEncoderFinish(pxEncoder);
+    
+    /* Comm task is behind, drop frame and resync gateway with next one */
+    pxMessage = POOL_pvAlloc(&xMessagePool);
+    if (pxMessage == NULL)
+    {
+        xBatchStats.ulDroppedFrames++;
+        FRAME_vEncoderResync(pxEncoder);
+        return;
+    }
+    
+    for (uint32_t i = 0; i < ulLength; i++)
+    {
+        pxMessage->ucFrame[i] = pxEncoder->ucFrame[i];
+    }
+    pxMessage->ulLength = ulLength;
+    pxMessage->ulTimestamp = ulTimestamp;
+    pxMessage->ulTransmissions = 0;
+    pxMessage->ulRequeues = 0;
+    
+    xBatchStats.ulFrames++;
+    xBatchStats.ulSamples += ulSamples;
+    xBatchStats.ulBytes += ulLength;
+    
+    /* Transmit */
+    /* Queue has a slot for every block, so send can't fail */
+    xAssert = POOL_xSend(xCommQueue, (void **)&pxMessage, (TickType_t)10);
+    configASSERT(xAssert);
+    
+    /* Encoder still holds the finished frame */
+    if ((pxEncoder->ucFrame[0] & 0x0F) == FRAME_TYPE_KEY)
+    {
+        vFrameSchedule(pxEncoder, ulTimestamp);
+    }
+}
+
+
+/**
+ * @brief   Send schedule frame if sample periods changed since the last
+ *          one. Called after key frames, so periods are reported at most
+ *          once per FRAME_KEY_INTERVAL frames.
+ * 
+ * @param   pxEncoder       Encoder of data frames.
+ * 
+ * @param   ulTimestamp     BENCH_ulTimestamp() of the key frame.
+ * 
+ * @return  None
+ */
+static void vFrameSchedule(const struct Frame_Encoder *const pxEncoder, const uint32_t ulTimestamp)
+{
+    BaseType_t xAssert;
+    struct AMessage *pxMessage;
+    uint32_t ulChanged = FALSE;
+    
+    for (uint32_t i = 0; i < FRAME_SAMPLE_FIELDS; i++)
+    {
+        if (ulPeriods[i] != ulReportedPeriods[i])
+        {
+            ulChanged = TRUE;
+        }
+    }
+    
+    if (ulChanged == FALSE)
+    {
+        return;
+    }
+    
+    /* Tried again after next key frame */
+    pxMessage = POOL_pvAlloc(&xMessagePool);
+    if (pxMessage == NULL)
+    {
+        return;
+    }
+    
+    pxMessage->ulLength = FRAME_ulEncodeSchedule(pxEncoder, pxMessage->ucFrame, ulLatestSeconds, ulWakeups, ulPeriods);
+    pxMessage->ulTimestamp = ulTimestamp;
+    pxMessage->ulTransmissions = 0;
+    pxMessage->ulRequeues = 0;
+    
+    for (uint32_t i = 0; i < FRAME_SAMPLE_FIELDS; i++)
+    {
+        ulReportedPeriods[i] = ulPeriods[i];
+    }
+    xBatchStats.ulScheduleFrames++;
+    
+    /* Queue has a slot for every block, so send can't fail */
+    xAssert = POOL_xSend(xCommQueue, (void **)&pxMessage, (TickType_t)10);
+    configASSERT(xAssert);
+}
+
+
+/**
+ * @brief   FreeRTOS frame task. Builds the message to send.
+ * 
+ * @param   pvParam     Unused.
+ * 
+ * @return  None
+ */
+void vFrameTask(void *const pvParam)
+{
+    (void)pvParam;
+    
+    struct Sensor *pxSensor;
+    struct Frame_Encoder xEncoder;
+    int32_t lValues[FRAME_SAMPLE_FIELDS];
+    uint32_t ulSeconds;
+    uint32_t ulAdded;
+    uint32_t ulBatchTimestamp = 0;
+    TickType_t xBatchStart = 0;
+    
+    FRAME_vEncoderInit(&xEncoder, (uint8_t)NODE_ID, ucFrameTags, FRAME_SAMPLE_FIELDS);
+    
+    for (;;)
+    {
+        const uint32_t ulLoopStart = BENCH_ulTimestamp();
+        
+        /* Wait for next reading, drains the queue at the rate readings arrive */
+        if (xAnalogQueue != 0)
+        {
+            if (POOL_xReceive(xAnalogQueue, (void **)&pxSensor, pdMS_TO_TICKS(100)))
+            {
+                vFrameValues(pxSensor, lValues);
+                vFramePeriods(pxSensor);
+                ulSeconds = pxSensor->ulUptimeTicks / configTICK_RATE_HZ;
+                ulLatestSeconds = ulSeconds;
+                
+                /* Full frame is sent and sample starts the next one */
+                if (ulFrameAppend(&xEncoder, ulSeconds, lValues) == 0)
+                {
+                    vFrameFlush(&xEncoder, ulBatchTimestamp);
+                    xBatchStats.ulSizeFlushes++;
+                    
+                    /* Any sample fits an empty frame, checked at top of file */
+                    ulAdded = ulFrameAppend(&xEncoder, ulSeconds, lValues);
+                    configASSERT(ulAdded == 1);
+                }
+                
+                if (xEncoder.ulSamples == 1)
+                {
+                    ulBatchTimestamp = pxSensor->ulTimestamp;
+                    xBatchStart = xTaskGetTickCount();
+                }
+                
+                /* Pump start is reported right away */
+                if (pxSensor->ulUrgent == TRUE)
+                {
+                    vFrameFlush(&xEncoder, ulBatchTimestamp);
+                    xBatchStats.ulUrgentFlushes++;
+                }
+                
+                POOL_vFree(&xSensorPool, pxSensor);
+            }
+        }
+        else
+        {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+        
+        /* Task runs at least every 100 ms, so 16-bit tick difference can't wrap unseen */
+        if ((xEncoder.ulSamples > 0) && ((TickType_t)(xTaskGetTickCount() - xBatchStart) >= SENSOR_MS_TO_TICKS(COMM_BATCH_LATENCY_MS)))
+        {
+            vFrameFlush(&xEncoder, ulBatchTimestamp);
+            xBatchStats.ulDeadlineFlushes++;
+        }
+        
+        BENCH_vRecord(BENCH_FRAME_LOOP, ulLoopStart);
+    }
 }
+
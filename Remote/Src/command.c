@@ -0,0 +1,68 @@
+/**
+ * command.c
+ * This file decodes downlink commands. Only standard C is used so the
+ * decoder can be checked against the gateway encoder on a host.
+ */
+
+#include "command.h"
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Decode ACK payload received from the gateway.
+ * 
+ * @param   pucPayload      Received ACK payload.
+ * 
+ * @param   ulLength        Payload length.
+ * 
+ * @param   ulNode          Own node ID.
+ * 
+ * @param   pulSequence     Payload sequence number.
+ * 
+ * @param   pxCommands      Room for COMMAND_MAX_COUNT commands.
+ * 
+ * @return  Number of commands or negative error code. Unknown command
+ *          types are passed on, receiver ignores them.
+ */
+int32_t COMMAND_lDecode(const uint8_t *const pucPayload, const uint32_t ulLength, const uint32_t ulNode,
+                        uint32_t *const pulSequence, struct Command *const pxCommands)
+{
+    uint32_t ulCount;
+    uint16_t usCrc;
+    
+    if ((ulLength < COMMAND_SIZE(0)) || (ulLength > COMMAND_PAYLOAD_MAX_SIZE))
+    {
+        return COMMAND_TOO_SHORT;
+    }
+    
+    usCrc = (uint16_t)(pucPayload[ulLength - 2] | (pucPayload[ulLength - 1] << 8));
+    if (FRAME_usChecksum(pucPayload, ulLength - COMMAND_CRC_SIZE) != usCrc)
+    {
+        return COMMAND_BAD_CRC;
+    }
+    
+    ulCount = pucPayload[0] & 0x0F;
+    if (((pucPayload[0] >> 4) != COMMAND_VERSION) || (ulLength != COMMAND_SIZE(ulCount)))
+    {
+        return COMMAND_BAD_VERSION;
+    }
+    
+    if (pucPayload[1] != (uint8_t)ulNode)
+    {
+        return COMMAND_OTHER_NODE;
+    }
+    
+    *pulSequence = pucPayload[2];
+    
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        const uint8_t *const pucRecord = &pucPayload[COMMAND_HEADER_SIZE + i * COMMAND_RECORD_SIZE];
+        
+        pxCommands[i].ucType = pucRecord[0];
+        pxCommands[i].ucTarget = pucRecord[1];
+        pxCommands[i].usValue = (uint16_t)(pucRecord[2] | (pucRecord[3] << 8));
+    }
+    
+    return (int32_t)ulCount;
+}
@@ -0,0 +1,98 @@
+/**
+ * filter.c
+ * This file handles streaming sample filters. Only standard C is used
+ * so the filters can be benchmarked on a host.
+ */
+
+#include "filter.h"
+
+
+/* Local defines */
+#define MEDIAN_LOW              ((FILTER_WINDOW - 1) / 2)
+#define MEDIAN_HIGH             (FILTER_WINDOW / 2)
+
+/* Shift that divides by FILTER_KEPT */
+#define KEPT_SHIFT              ((FILTER_KEPT >= 16) ? 4 : (FILTER_KEPT >= 8) ? 3 : (FILTER_KEPT >= 4) ? 2 : (FILTER_KEPT >= 2) ? 1 : 0)
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Reset filter. Next sample fills the whole window.
+ * 
+ * @param   pxFilter    Filter state.
+ * 
+ * @return  None
+ */
+void FILTER_vInit(struct Filter *const pxFilter)
+{
+    pxFilter->ulHead = 0;
+    pxFilter->ulPrimed = 0;
+    pxFilter->lEma = 0;
+}
+
+
+/**
+ * @brief   Add sample and calculate outputs. Cost depends only on
+ *          FILTER_WINDOW, not on sample values or history.
+ * 
+ * @param   pxFilter    Filter state.
+ * 
+ * @param   lSample     New sample.
+ * 
+ * @param   pxOutput    Median, trimmed mean and smoothed value.
+ * 
+ * @return  None
+ */
+void FILTER_vUpdate(struct Filter *const pxFilter, const int32_t lSample, struct Filter_Output *const pxOutput)
+{
+    int32_t lOldest;
+    int32_t lSum = 0;
+    uint32_t i;
+    
+    if (pxFilter->ulPrimed == 0)
+    {
+        /* Start from a steady state instead of zeros */
+        for (i = 0; i < FILTER_WINDOW; i++)
+        {
+            pxFilter->lHistory[i] = lSample;
+            pxFilter->lSorted[i] = lSample;
+        }
+        pxFilter->lEma = lSample << FILTER_EMA_FRACTION_BITS;
+        pxFilter->ulPrimed = 1;
+    }
+    
+    /* Replace oldest sample in ring buffer */
+    lOldest = pxFilter->lHistory[pxFilter->ulHead];
+    pxFilter->lHistory[pxFilter->ulHead] = lSample;
+    pxFilter->ulHead = (pxFilter->ulHead + 1) % FILTER_WINDOW;
+    
+    /* Remove oldest from sorted window */
+    for (i = 0; pxFilter->lSorted[i] != lOldest; i++)
+    {
+        ;
+    }
+    for (; i < FILTER_WINDOW - 1; i++)
+    {
+        pxFilter->lSorted[i] = pxFilter->lSorted[i + 1];
+    }
+    
+    /* Insertion sort step for the new sample */
+    for (i = FILTER_WINDOW - 1; (i > 0) && (pxFilter->lSorted[i - 1] > lSample); i--)
+    {
+        pxFilter->lSorted[i] = pxFilter->lSorted[i - 1];
+    }
+    pxFilter->lSorted[i] = lSample;
+    
+    for (i = FILTER_TRIM; i < FILTER_WINDOW - FILTER_TRIM; i++)
+    {
+        lSum += pxFilter->lSorted[i];
+    }
+    
+    /* Arithmetic shifts floor negative values */
+    pxOutput->lMedian = (pxFilter->lSorted[MEDIAN_LOW] + pxFilter->lSorted[MEDIAN_HIGH]) >> 1;
+    pxOutput->lTrimmedMean = lSum >> KEPT_SHIFT;
+    
+    pxFilter->lEma += ((lSum << (FILTER_EMA_FRACTION_BITS - KEPT_SHIFT)) - pxFilter->lEma) >> FILTER_EMA_SHIFT;
+    pxOutput->lSmoothed = (pxFilter->lEma + (1L << (FILTER_EMA_FRACTION_BITS - 1))) >> FILTER_EMA_FRACTION_BITS;
+}
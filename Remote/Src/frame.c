@@ -0,0 +1,306 @@
+/**
+ * frame.c
+ * This file encodes radio frames. Only standard C is used so the encoder
+ * can be checked against the gateway decoder on a host.
+ */
+
+#include "frame.h"
+
+
+/* Local function prototypes */
+static uint32_t ulPutVarint(uint8_t *const pucBuffer, uint32_t ulLength, uint32_t ulValue);
+static void vFrameStart(struct Frame_Encoder *const pxEncoder, const uint32_t ulSeconds);
+static uint32_t ulPutHeader(const struct Frame_Encoder *const pxEncoder, uint8_t *const pucFrame, const uint32_t ulType,
+                            const uint32_t ulSequence, const uint32_t ulSeconds);
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Initialize encoder. First frame is a key frame.
+ * 
+ * @param   pxEncoder   Encoder to initialize.
+ * 
+ * @param   ucNode      Node ID.
+ * 
+ * @param   pucTags     Type << 4 | index of each field, must stay valid.
+ * 
+ * @param   ulFields    Number of fields, max FRAME_BATCH_MAX_FIELDS.
+ * 
+ * @return  None
+ */
+void FRAME_vEncoderInit(struct Frame_Encoder *const pxEncoder, const uint8_t ucNode, const uint8_t *const pucTags, const uint32_t ulFields)
+{
+    pxEncoder->ulLength = 0;
+    pxEncoder->ulSamples = 0;
+    pxEncoder->pucTags = pucTags;
+    pxEncoder->ulFields = ulFields;
+    pxEncoder->ulPreviousSeconds = 0;
+    pxEncoder->ulKeyCountdown = 0;
+    pxEncoder->ucNode = ucNode;
+    pxEncoder->ucSequence = 0;
+    
+    for (uint32_t i = 0; i < ulFields; i++)
+    {
+        pxEncoder->lPrevious[i] = 0;
+    }
+}
+
+
+/**
+ * @brief   Append sample to frame, starting one if needed.
+ * 
+ * @param   pxEncoder   Encoder.
+ * 
+ * @param   ulSeconds   Seconds since boot when sample was read.
+ * 
+ * @param   plValues    Field values in tag order, within FRAME_VALUE_LIMIT.
+ * 
+ * @return  1 if sample was added, 0 if it doesn't fit and frame must be
+ *          finished first.
+ */
+uint32_t FRAME_ulEncoderAppend(struct Frame_Encoder *const pxEncoder, const uint32_t ulSeconds, const int32_t *const plValues)
+{
+    uint8_t ucRecord[FRAME_RECORD_MAX_SIZE];
+    uint32_t ulLength = 0;
+    uint32_t ulMaskIndex;
+    uint32_t ulMask = 0;
+    
+    if (pxEncoder->ulSamples == 0)
+    {
+        vFrameStart(pxEncoder, ulSeconds);
+    }
+    
+    if ((pxEncoder->ulSamples == 0) && (pxEncoder->ulKeyCountdown == 0))
+    {
+        /* Key frame starts with absolute values */
+        for (uint32_t i = 0; i < pxEncoder->ulFields; i++)
+        {
+            ulLength = ulPutVarint(ucRecord, ulLength, FRAME_ulZigZag(plValues[i]));
+        }
+    }
+    else
+    {
+        ulLength = ulPutVarint(ucRecord, ulLength, ulSeconds - pxEncoder->ulPreviousSeconds);
+        ulMaskIndex = ulLength++;
+        for (uint32_t i = 0; i < pxEncoder->ulFields; i++)
+        {
+            if (plValues[i] != pxEncoder->lPrevious[i])
+            {
+                ulMask |= 1UL << i;
+                ulLength = ulPutVarint(ucRecord, ulLength, FRAME_ulZigZag(plValues[i] - pxEncoder->lPrevious[i]));
+            }
+        }
+        ucRecord[ulMaskIndex] = (uint8_t)ulMask;
+    }
+    
+    if (pxEncoder->ulLength + ulLength + FRAME_CRC_SIZE > FRAME_MAX_SIZE)
+    {
+        return 0;
+    }
+    
+    for (uint32_t i = 0; i < ulLength; i++)
+    {
+        pxEncoder->ucFrame[pxEncoder->ulLength + i] = ucRecord[i];
+    }
+    pxEncoder->ulLength += ulLength;
+    
+    for (uint32_t i = 0; i < pxEncoder->ulFields; i++)
+    {
+        pxEncoder->lPrevious[i] = plValues[i];
+    }
+    pxEncoder->ulPreviousSeconds = ulSeconds;
+    pxEncoder->ulSamples++;
+    
+    return 1;
+}
+
+
+/**
+ * @brief   Append CRC to frame. Next sample starts a new frame.
+ * 
+ * @param   pxEncoder   Encoder with at least one sample in frame.
+ * 
+ * @return  Frame length.
+ */
+uint32_t FRAME_ulEncoderFinish(struct Frame_Encoder *const pxEncoder)
+{
+    const uint16_t usCrc = FRAME_usChecksum(pxEncoder->ucFrame, pxEncoder->ulLength);
+    
+    pxEncoder->ucFrame[pxEncoder->ulLength++] = (uint8_t)usCrc;
+    pxEncoder->ucFrame[pxEncoder->ulLength++] = (uint8_t)(usCrc >> 8);
+    
+    pxEncoder->ulSamples = 0;
+    pxEncoder->ucSequence++;
+    if (pxEncoder->ulKeyCountdown == 0)
+    {
+        pxEncoder->ulKeyCountdown = FRAME_KEY_INTERVAL - 1;
+    }
+    else
+    {
+        pxEncoder->ulKeyCountdown--;
+    }
+    
+    return pxEncoder->ulLength;
+}
+
+
+/**
+ * @brief   Make next started frame a key frame, e.g. after a lost frame.
+ * 
+ * @param   pxEncoder   Encoder.
+ * 
+ * @return  None
+ */
+void FRAME_vEncoderResync(struct Frame_Encoder *const pxEncoder)
+{
+    if (pxEncoder->ulSamples == 0)
+    {
+        pxEncoder->ulKeyCountdown = 0;
+    }
+    else
+    {
+        pxEncoder->ulKeyCountdown = 1; /* Frame being built is finished first */
+    }
+}
+
+
+/**
+ * @brief   Discard started frame without using its sequence number, e.g.
+ *          a delta frame following a lost frame. Samples appended next
+ *          start a key frame.
+ * 
+ * @param   pxEncoder   Encoder.
+ * 
+ * @return  None
+ */
+void FRAME_vEncoderDiscard(struct Frame_Encoder *const pxEncoder)
+{
+    pxEncoder->ulLength = 0;
+    pxEncoder->ulSamples = 0;
+    pxEncoder->ulKeyCountdown = 0;
+}
+
+
+/**
+ * @brief   Encode schedule frame. Data frame being built is not affected.
+ * 
+ * @param   pxEncoder   Encoder whose node and fields are reported.
+ * 
+ * @param   pucFrame    Room for FRAME_SCHEDULE_MAX_SIZE() bytes.
+ * 
+ * @param   ulSeconds   Seconds since boot.
+ * 
+ * @param   ulWakeups   Sensor task wake-ups since boot.
+ * 
+ * @param   pulPeriods  Sample period of each field in FRAME_PERIOD_UNIT_MS,
+ *                      tag order.
+ * 
+ * @return  Frame length.
+ */
+uint32_t FRAME_ulEncodeSchedule(const struct Frame_Encoder *const pxEncoder, uint8_t *const pucFrame, const uint32_t ulSeconds,
+                                const uint32_t ulWakeups, const uint32_t *const pulPeriods)
+{
+    uint32_t ulLength;
+    uint16_t usCrc;
+    
+    /* Previous data frame keeps the delta chain intact */
+    ulLength = ulPutHeader(pxEncoder, pucFrame, FRAME_TYPE_SCHEDULE, (uint8_t)(pxEncoder->ucSequence - 1), ulSeconds);
+    ulLength = ulPutVarint(pucFrame, ulLength, ulWakeups);
+    
+    pucFrame[ulLength++] = (uint8_t)pxEncoder->ulFields;
+    for (uint32_t i = 0; i < pxEncoder->ulFields; i++)
+    {
+        pucFrame[ulLength++] = pxEncoder->pucTags[i];
+        ulLength = ulPutVarint(pucFrame, ulLength, pulPeriods[i]);
+    }
+    
+    usCrc = FRAME_usChecksum(pucFrame, ulLength);
+    pucFrame[ulLength++] = (uint8_t)usCrc;
+    pucFrame[ulLength++] = (uint8_t)(usCrc >> 8);
+    
+    return ulLength;
+}
+
+
+/**
+ * @brief   Write frame header, and field tags for a key frame.
+ * 
+ * @param   pxEncoder   Encoder with no samples in frame.
+ * 
+ * @param   ulSeconds   Seconds since boot when first sample was read.
+ * 
+ * @return  None
+ */
+static void vFrameStart(struct Frame_Encoder *const pxEncoder, const uint32_t ulSeconds)
+{
+    const uint32_t ulType = (pxEncoder->ulKeyCountdown == 0) ? FRAME_TYPE_KEY : FRAME_TYPE_DELTA;
+    uint32_t ulLength;
+    
+    ulLength = ulPutHeader(pxEncoder, pxEncoder->ucFrame, ulType, pxEncoder->ucSequence, ulSeconds);
+    
+    if (ulType == FRAME_TYPE_KEY)
+    {
+        pxEncoder->ucFrame[ulLength++] = (uint8_t)pxEncoder->ulFields;
+        for (uint32_t i = 0; i < pxEncoder->ulFields; i++)
+        {
+            pxEncoder->ucFrame[ulLength++] = pxEncoder->pucTags[i];
+        }
+    }
+    
+    pxEncoder->ulLength = ulLength;
+}
+
+
+/**
+ * @brief   Write frame header.
+ * 
+ * @param   pxEncoder   Encoder of the node.
+ * 
+ * @param   pucFrame    Frame buffer.
+ * 
+ * @param   ulType      Frame type.
+ * 
+ * @param   ulSequence  Sequence number.
+ * 
+ * @param   ulSeconds   Seconds since boot.
+ * 
+ * @return  FRAME_HEADER_SIZE
+ */
+static uint32_t ulPutHeader(const struct Frame_Encoder *const pxEncoder, uint8_t *const pucFrame, const uint32_t ulType,
+                            const uint32_t ulSequence, const uint32_t ulSeconds)
+{
+    uint32_t ulLength = 0;
+    
+    pucFrame[ulLength++] = (uint8_t)((FRAME_VERSION << 4) | ulType);
+    pucFrame[ulLength++] = pxEncoder->ucNode;
+    pucFrame[ulLength++] = (uint8_t)ulSequence;
+    pucFrame[ulLength++] = (uint8_t)ulSeconds;
+    pucFrame[ulLength++] = (uint8_t)(ulSeconds >> 8);
+    
+    return ulLength;
+}
+
+
+/**
+ * @brief   Write varint.
+ * 
+ * @param   pucBuffer   Buffer with FRAME_VARINT_MAX_SIZE bytes free.
+ * 
+ * @param   ulLength    Bytes already in buffer.
+ * 
+ * @param   ulValue     Value to write.
+ * 
+ * @return  Bytes in buffer after varint.
+ */
+static uint32_t ulPutVarint(uint8_t *const pucBuffer, uint32_t ulLength, uint32_t ulValue)
+{
+    while (ulValue > 0x7F)
+    {
+        pucBuffer[ulLength++] = (uint8_t)(ulValue | 0x80);
+        ulValue >>= 7;
+    }
+    pucBuffer[ulLength++] = (uint8_t)ulValue;
+    
+    return ulLength;
+}
@@ -10,7 +10,6 @@
 
 /* Global variables */
 QueueHandle_t xMotorQueue;
-TaskHandle_t xAnalogNotification;
 
 
 /**
@@ -71,6 +70,8 @@ void vMotorTask(void *const pvMotorTimers)
     
     for (;;)
     {
+        const uint32_t ulLoopStart = BENCH_ulTimestamp();
+        
         if (xQueueReceive(xMotorQueue, &pxMotors, (TickType_t)10))
         {
             for (uint32_t i = 0; i < MOTOR_COUNT; i++)
@@ -92,6 +93,8 @@ void vMotorTask(void *const pvMotorTimers)
             }
         }
         
+        BENCH_vRecord(BENCH_MOTOR_LOOP, ulLoopStart);
+        
         vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
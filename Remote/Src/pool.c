@@ -0,0 +1,209 @@
+/**
+ * pool.c
+ * This file handles fixed-block memory pools.
+ */
+
+#include "pool.h"
+
+
+/* Function descriptions */
+
+/**
+ * @brief   Initialize pool. Call before any task uses it.
+ * 
+ * @param   pxPool          Pool to initialize.
+ * 
+ * @param   pvStorage       Storage for all blocks, word aligned.
+ * 
+ * @param   ulBlockSize     Block size, multiple of word size.
+ * 
+ * @param   ulBlocks        Number of blocks.
+ * 
+ * @return  None
+ */
+void POOL_vInit(struct Pool *const pxPool, void *const pvStorage, const uint32_t ulBlockSize, const uint32_t ulBlocks)
+{
+    uint8_t *pucBlock = (uint8_t *)pvStorage;
+    
+    configASSERT(pxPool != NULL);
+    configASSERT(pvStorage != NULL);
+    configASSERT((ulBlockSize >= sizeof(void *)) && ((ulBlockSize % sizeof(void *)) == 0));
+    configASSERT(((uint32_t)pvStorage % sizeof(void *)) == 0);
+    
+    pxPool->pvFree = NULL;
+    pxPool->pucStart = pucBlock;
+    pxPool->ulBlockSize = ulBlockSize;
+    pxPool->ulBlocks = ulBlocks;
+    pxPool->ulFree = ulBlocks;
+    pxPool->ulMinFree = ulBlocks;
+    pxPool->ulFailures = 0;
+    
+    /* Link blocks so the first one is allocated first */
+    pucBlock += ulBlocks * ulBlockSize;
+    for (uint32_t i = 0; i < ulBlocks; i++)
+    {
+        pucBlock -= ulBlockSize;
+        *(void **)pucBlock = pxPool->pvFree;
+        pxPool->pvFree = pucBlock;
+    }
+}
+
+
+/**
+ * @brief   Take a block. Can be called from tasks and interrupts.
+ * 
+ * @param   pxPool      Pool.
+ * 
+ * @return  Block owned by caller, NULL if pool is empty.
+ */
+void *POOL_pvAlloc(struct Pool *const pxPool)
+{
+    const uint32_t ulPrimask = __get_PRIMASK();
+    void *pvBlock;
+    
+    __disable_irq();
+    
+    pvBlock = pxPool->pvFree;
+    if (pvBlock != NULL)
+    {
+        pxPool->pvFree = *(void **)pvBlock;
+        pxPool->ulFree--;
+        if (pxPool->ulFree < pxPool->ulMinFree)
+        {
+            pxPool->ulMinFree = pxPool->ulFree;
+        }
+    }
+    else
+    {
+        pxPool->ulFailures++;
+    }
+    
+    if (ulPrimask == 0)
+    {
+        __enable_irq();
+    }
+    
+    return pvBlock;
+}
+
+
+/**
+ * @brief   Return a block. Can be called from tasks and interrupts.
+ * 
+ * @param   pxPool      Pool the block was taken from.
+ * 
+ * @param   pvBlock     Block owned by caller, not used after the call.
+ * 
+ * @return  None
+ */
+void POOL_vFree(struct Pool *const pxPool, void *const pvBlock)
+{
+    const uint32_t ulPrimask = __get_PRIMASK();
+    
+    configASSERT(((uint8_t *)pvBlock >= pxPool->pucStart)
+                 && ((uint8_t *)pvBlock < pxPool->pucStart + pxPool->ulBlocks * pxPool->ulBlockSize));
+    
+    __disable_irq();
+    
+    /* More frees than allocations means a block was freed twice */
+    configASSERT(pxPool->ulFree < pxPool->ulBlocks);
+    
+    *(void **)pvBlock = pxPool->pvFree;
+    pxPool->pvFree = pvBlock;
+    pxPool->ulFree++;
+    
+    if (ulPrimask == 0)
+    {
+        __enable_irq();
+    }
+}
+
+
+/**
+ * @brief   Get the most blocks that have been in use at once. Size pools
+ *          and their queues with this.
+ * 
+ * @param   pxPool      Pool.
+ * 
+ * @return  High-water mark in blocks.
+ */
+uint32_t POOL_ulHighWater(const struct Pool *const pxPool)
+{
+    return pxPool->ulBlocks - pxPool->ulMinFree;
+}
+
+
+/**
+ * @brief   Pass block to the task receiving from queue. Queue holds
+ *          block pointers.
+ * 
+ * @param   xQueue          Queue to send to.
+ * 
+ * @param   ppvBlock        Block owned by caller, set to NULL when sent.
+ * 
+ * @param   xTicksToWait    Max time to wait for free queue space.
+ * 
+ * @return  pdPASS when receiver owns the block, else errQUEUE_FULL and
+ *          caller still owns it.
+ */
+BaseType_t POOL_xSend(const QueueHandle_t xQueue, void **const ppvBlock, const TickType_t xTicksToWait)
+{
+    const BaseType_t xStatus = xQueueSend(xQueue, (const void *)ppvBlock, xTicksToWait);
+    
+    if (xStatus == pdPASS)
+    {
+        *ppvBlock = NULL;
+    }
+    
+    return xStatus;
+}
+
+
+/**
+ * @brief   Pass block back to the front of queue, e.g. when its
+ *          processing has to be retried before the blocks after it.
+ * 
+ * @param   xQueue          Queue to send to.
+ * 
+ * @param   ppvBlock        Block owned by caller, set to NULL when sent.
+ * 
+ * @param   xTicksToWait    Max time to wait for free queue space.
+ * 
+ * @return  pdPASS when receiver owns the block, else errQUEUE_FULL and
+ *          caller still owns it.
+ */
+BaseType_t POOL_xSendToFront(const QueueHandle_t xQueue, void **const ppvBlock, const TickType_t xTicksToWait)
+{
+    const BaseType_t xStatus = xQueueSendToFront(xQueue, (const void *)ppvBlock, xTicksToWait);
+    
+    if (xStatus == pdPASS)
+    {
+        *ppvBlock = NULL;
+    }
+    
+    return xStatus;
+}
+
+
+/**
+ * @brief   Take ownership of a block sent with POOL_xSend().
+ * 
+ * @param   xQueue          Queue to receive from.
+ * 
+ * @param   ppvBlock        Received block, NULL if none.
+ * 
+ * @param   xTicksToWait    Max time to wait for a block.
+ * 
+ * @return  pdPASS when caller owns a block, else pdFAIL.
+ */
+BaseType_t POOL_xReceive(const QueueHandle_t xQueue, void **const ppvBlock, const TickType_t xTicksToWait)
+{
+    const BaseType_t xStatus = xQueueReceive(xQueue, (void *)ppvBlock, xTicksToWait);
+    
+    if (xStatus != pdPASS)
+    {
+        *ppvBlock = NULL;
+    }
+    
+    return xStatus;
+}
@@ -3,127 +3,785 @@
 
 /* Local defines */
 
+/* Modulo tick comparison, true when xTick is not in the future */
+#define TICK_REACHED(xTick, xNow)       ((TickType_t)((xNow) - (xTick)) < (TickType_t)0x8000)
+
+/* Expands one BOARD_SOIL_PROBES entry */
+#define SOIL_PROBE_ENTRY(probe, channel, profile, convert, zone)    [probe] = {channel, profile, zone, convert},
+
+#define WHEEL_MASK                      (SENSOR_WHEEL_SLOTS - 1)
+#define WHEEL_SLOT(xTick)               (((xTick) >> SENSOR_WHEEL_SHIFT) & WHEEL_MASK)
+#define WHEEL_END                       (0xFFU)     /* Empty slot or last entry */
+
+#if (SENSOR_WHEEL_SLOTS & WHEEL_MASK) != 0
+#error "SENSOR_WHEEL_SLOTS must be a power of two"
+#endif
+
 
 /* Global variables */
 QueueHandle_t xAnalogQueue;
-QueueHandle_t xMotorQueue;
+struct Sensor_Schedule_Stats xSensorSchedule[SENSOR_COUNT];
+uint32_t ulSensorWakeups = 0;   /* Sensor task loops since boot */
+
+
+/* Local variables */
+static struct Sensor xSensor;
+static struct Motor_States xMotors;
+static struct Filter xFilters[SENSOR_COUNT];
+static int32_t lSoilMedian[SOIL_MOISTURE_SENSOR_COUNT];
+static uint32_t ulSoilThreshold[SOIL_MOISTURE_SENSOR_COUNT];  /* Dry below %, set by gateway */
+static uint8_t ucWaterOverride[MOTOR_COUNT];                    /* enum Command_Water */
+
+/* Soil moisture probes of this board */
+static const struct
+{
+    uint8_t ucChannel;          /* enum ADC_Channels */
+    uint8_t ucProfile;          /* enum ADC_Profiles */
+    uint8_t ucZone;             /* Motor watering this probe */
+    uint32_t (*pulConvert)(const uint32_t ulAdc);
+} xSoilProbes[SOIL_MOISTURE_SENSOR_COUNT] = 
+{
+    BOARD_SOIL_PROBES(SOIL_PROBE_ENTRY)
+};
+
+/* Sensor registry */
+static struct
+{
+    Sensor_Read pxRead;
+    uint32_t ulArg;             /* Passed to pxRead */
+    uint32_t ulPeriod;          /* Ticks */
+    uint32_t ulMaxPeriod;       /* Ticks, set by gateway */
+    TickType_t xDue;            /* Tick of next sample */
+    int32_t lPrevious;          /* Value of previous sample */
+    uint8_t ucNext;             /* Next entry in same wheel slot */
+} xRegistry[SENSOR_COUNT];
+
+/* First registry entry of each slot */
+static uint8_t ucWheel[SENSOR_WHEEL_SLOTS];
+static TickType_t xWheelTick;   /* Slots before this tick are processed */
+static TickType_t xUptimeTick;  /* Tick count when ulUptimeTicks was updated */
+
+
+/* Local function prototypes */
+static void vSensorRegister(const uint32_t ulSensor, const Sensor_Read pxRead, const uint32_t ulArg, const uint32_t ulPeriodMs, const uint32_t ulPhaseMs);
+static void vWheelInsert(const uint32_t ulSensor);
+static void vWheelRemove(const uint32_t ulSensor);
+static uint32_t ulWheelRun(const TickType_t xNow);
+static TickType_t xWheelNext(const TickType_t xNow);
+static void vScheduleAdapt(const uint32_t ulSensor, const int32_t lValue, const uint32_t ulForceFast);
+static void vScheduleNext(const uint32_t ulSensor);
+static void vScheduleLimit(const uint32_t ulSensor, const uint32_t ulPeriodMs);
+static void vSensorCommand(const struct Command *const pxCommand);
+static BaseType_t xSensorConvert(const uint8_t ucChannel, const uint8_t ucProfile, uint16_t *const pusResult);
+static uint32_t ulReadHumidity(const uint32_t ulArg, int32_t *const plValue);
+static uint32_t ulReadTemperature(const uint32_t ulArg, int32_t *const plValue);
+static uint32_t ulReadPotentiometer(const uint32_t ulArg, int32_t *const plValue);
+static uint32_t ulReadSoilMoisture(const uint32_t ulArg, int32_t *const plValue);
 
 
 /* Function descriptions */
 
+/**
+ * @brief   Add sensor to registry and timer wheel.
+ * 
+ * @param   ulSensor    enum Sensor_Index.
+ * 
+ * @param   pxRead      Read function.
+ * 
+ * @param   ulArg       Argument for pxRead.
+ * 
+ * @param   ulPeriodMs  Initial period, power of two multiple of
+ *                      SENSOR_MIN_PERIOD_MS.
+ * 
+ * @param   ulPhaseMs   Offset of first sample within minimum period.
+ * 
+ * @return  None
+ */
+static void vSensorRegister(const uint32_t ulSensor, const Sensor_Read pxRead, const uint32_t ulArg, const uint32_t ulPeriodMs, const uint32_t ulPhaseMs)
+{
+    const uint32_t ulMinPeriod = SENSOR_MS_TO_TICKS(SENSOR_MIN_PERIOD_MS);
+    uint32_t ulPeriod = ulMinPeriod;
+    
+    configASSERT(ulSensor < SENSOR_COUNT);
+    configASSERT(pxRead != NULL);
+    
+    while (ulPeriod < SENSOR_MS_TO_TICKS(ulPeriodMs))
+    {
+        ulPeriod <<= 1;
+    }
+    configASSERT(ulPeriod == SENSOR_MS_TO_TICKS(ulPeriodMs));
+    configASSERT(ulPeriod <= SENSOR_MS_TO_TICKS(SENSOR_MAX_PERIOD_MS));
+    
+    xRegistry[ulSensor].pxRead = pxRead;
+    xRegistry[ulSensor].ulArg = ulArg;
+    xRegistry[ulSensor].ulPeriod = ulPeriod;
+    xRegistry[ulSensor].ulMaxPeriod = SENSOR_MS_TO_TICKS(SENSOR_MAX_PERIOD_MS);
+    xRegistry[ulSensor].xDue = xWheelTick + (TickType_t)(SENSOR_MS_TO_TICKS(ulPhaseMs) % ulMinPeriod);
+    xRegistry[ulSensor].lPrevious = 0;
+    
+    xSensorSchedule[ulSensor].ulPeriodMs = ulPeriod * portTICK_PERIOD_MS;
+    xSensorSchedule[ulSensor].ulSamples = 0;
+    xSensorSchedule[ulSensor].ulFailures = 0;
+    
+    vWheelInsert(ulSensor);
+}
+
 
 /**
- * @brief   FreeRTOS sensor task.
+ * @brief   Link sensor to the slot of its due tick.
  * 
- * @param   pvParam     Unused.
+ * @param   ulSensor    enum Sensor_Index.
  * 
  * @return  None
  */
-void vSensorTask(void *const pvParam)
+static void vWheelInsert(const uint32_t ulSensor)
 {
-    (void)pvParam;
-    BaseType_t xAssert;
+    const uint32_t ulSlot = WHEEL_SLOT(xRegistry[ulSensor].xDue);
     
-    struct Sensor xSensor;
-    struct Sensor *pxSensor = &xSensor;
+    xRegistry[ulSensor].ucNext = ucWheel[ulSlot];
+    ucWheel[ulSlot] = (uint8_t)ulSensor;
+}
 
-    struct Motor_States xMotors;
-    struct Motor_States *pxMotors = &xMotors;
+
+/**
+ * @brief   Unlink sensor from its slot.
+ * 
+ * @param   ulSensor    enum Sensor_Index.
+ * 
+ * @return  None
+ */
+static void vWheelRemove(const uint32_t ulSensor)
+{
+    uint8_t *pucLink = &ucWheel[WHEEL_SLOT(xRegistry[ulSensor].xDue)];
+    
+    while (*pucLink != ulSensor)
+    {
+        configASSERT(*pucLink != WHEEL_END);
+        pucLink = &xRegistry[*pucLink].ucNext;
+    }
+    *pucLink = xRegistry[ulSensor].ucNext;
+}
+
+
+/**
+ * @brief   Read all sensors that are due. Walks only the slots passed
+ *          since previous call, or the whole wheel after a long sleep.
+ * 
+ * @param   xNow    Current tick count.
+ * 
+ * @return  Number of sensors read successfully.
+ */
+static uint32_t ulWheelRun(const TickType_t xNow)
+{
+    uint32_t ulSlots = ((TickType_t)(xNow - xWheelTick) >> SENSOR_WHEEL_SHIFT) + 2;
+    uint32_t ulSlot = WHEEL_SLOT(xWheelTick);
+    uint32_t ulRead = 0;
+    uint8_t ucFired = WHEEL_END;
+    uint8_t ucSensor;
+    uint8_t *pucLink;
+    uint32_t ulOutcome;
+    int32_t lValue;
     
-    const uint8_t ucSoilMoistureChannels[] = {ADC_CH_AD9, ADC_CH_AD9}; /* Same channel to simulate multiple sensors */
+    if (ulSlots > SENSOR_WHEEL_SLOTS)
+    {
+        ulSlots = SENSOR_WHEEL_SLOTS;
+    }
     
-    for (;;)
+    /* Collect due sensors first, reading reorders the slots */
+    for (; ulSlots > 0; ulSlots--)
     {
-        /* Read all sensor values */
-        xSensor.ulPotentiometer = ADC0_usReadPolling(ADC_CH_AD12); /* Not printed */
-        
-        xSensor.ulHumidity = HS1101_ulReadHumidity();
-        //configASSERT(xSensor.ulHumidity <= MAX_HUMIDITY); /* Calibrate sensor first */
-        
-        xSensor.lTemperature = CELSIUS_TEMPERATURE(ADC0_usReadPolling(ADC_CH_AD8));
-        configASSERT(xSensor.lTemperature >= MIN_TEMPERATURE && (xSensor.lTemperature <= MAX_TEMPERATURE));
-        
-        for (uint8_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
+        pucLink = &ucWheel[ulSlot];
+        while (*pucLink != WHEEL_END)
         {
-            xSensor.ulSoilMoisture[i] = SOIL_MOISTURE(ADC0_usReadPolling(ucSoilMoistureChannels[i]));
-            configASSERT(xSensor.ulSoilMoisture[i] <= MAX_SOIL_MOISTURE);
+            ucSensor = *pucLink;
+            if (TICK_REACHED(xRegistry[ucSensor].xDue, xNow))
+            {
+                *pucLink = xRegistry[ucSensor].ucNext;
+                xRegistry[ucSensor].ucNext = ucFired;
+                ucFired = ucSensor;
+            }
+            else
+            {
+                pucLink = &xRegistry[ucSensor].ucNext;
+            }
         }
+        ulSlot = (ulSlot + 1) & WHEEL_MASK;
+    }
+    xWheelTick = xNow;
+    
+    while (ucFired != WHEEL_END)
+    {
+        ucSensor = ucFired;
+        ucFired = xRegistry[ucSensor].ucNext;
         
-        if (xAnalogQueue != 0)
+        ulOutcome = xRegistry[ucSensor].pxRead(xRegistry[ucSensor].ulArg, &lValue);
+        if (ulOutcome == SENSOR_READ_FAILED)
         {
-            xAssert = xQueueSend(xAnalogQueue, (void *)&pxSensor, (TickType_t)10);
-            configASSERT(xAssert);
+            /* Retry after current period, failed read tells nothing of the rate of change */
+            xSensorSchedule[ucSensor].ulFailures++;
+            vScheduleNext(ucSensor);
         }
-        
-        for (uint8_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
+        else
         {
-            if (xSensor.ulSoilMoisture[i] < SOIL_MOISTURE_THRESHOLD)
+            vScheduleAdapt(ucSensor, lValue, (ulOutcome == SENSOR_READ_FAST) ? TRUE : FALSE);
+            ulRead++;
+        }
+        vWheelInsert(ucSensor);
+    }
+    
+    return ulRead;
+}
+
+
+/**
+ * @brief   Find time until next sensor is due. Slots are walked in
+ *          time order, so the first slot with a sensor due during this
+ *          revolution holds the answer.
+ * 
+ * @param   xNow    Current tick count.
+ * 
+ * @return  Ticks to sleep, 0 if a sensor is already due.
+ */
+static TickType_t xWheelNext(const TickType_t xNow)
+{
+    TickType_t xSleep = (TickType_t)SENSOR_MS_TO_TICKS(SENSOR_MAX_PERIOD_MS);
+    TickType_t xSlotEnd = ((xNow >> SENSOR_WHEEL_SHIFT) + 1) << SENSOR_WHEEL_SHIFT;
+    TickType_t xDelta;
+    uint32_t ulSlot = WHEEL_SLOT(xNow);
+    uint8_t ucSensor;
+    
+    for (uint32_t i = 0; i < SENSOR_WHEEL_SLOTS; i++)
+    {
+        for (ucSensor = ucWheel[ulSlot]; ucSensor != WHEEL_END; ucSensor = xRegistry[ucSensor].ucNext)
+        {
+            if (TICK_REACHED(xRegistry[ucSensor].xDue, xNow))
             {
-                xMotors.ucMotorState[i] = TRUE;
+                return 0;
+            }
+            
+            xDelta = xRegistry[ucSensor].xDue - xNow;
+            if (xDelta < xSleep)
+            {
+                xSleep = xDelta;
             }
         }
         
-        if (xMotorQueue != 0)
+        /* Due within this revolution, later slots can't be earlier */
+        if (xSleep < (TickType_t)(xSlotEnd - xNow))
         {
-            xAssert = xQueueSend(xMotorQueue, (void *)&pxMotors, (TickType_t)10);
-            configASSERT(xAssert);
+            break;
         }
         
-        vTaskDelay(pdMS_TO_TICKS(100));
+        xSlotEnd += 1U << SENSOR_WHEEL_SHIFT;
+        ulSlot = (ulSlot + 1) & WHEEL_MASK;
     }
+    
+    return xSleep;
 }
 
 
 /**
- * @brief   TPM1 IRQ Handler used to capture CMP0 output.
+ * @brief   Adapt sensor period to its rate of change and schedule
+ *          next sample. Period is doubled when the value didn't change,
+ *          halved at SENSOR_FAST_CHANGE and quartered at twice that,
+ *          within minimum and maximum period.
+ * 
+ * @param   ulSensor        enum Sensor_Index.
+ * 
+ * @param   lValue          Value of this sample.
  * 
- * @param   None
+ * @param   ulForceFast     TRUE to use minimum period.
  * 
  * @return  None
- * @todo    Convert capacitor value (HS1101_ulValue) to humidity.
  */
-void TPM1_IRQHandler(void)
+static void vScheduleAdapt(const uint32_t ulSensor, const int32_t lValue, const uint32_t ulForceFast)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    static uint32_t ulOverflows = 0;
-    uint32_t HS1101_ulValue = 0;
-    BaseType_t xAssert;
+    const uint32_t ulMinPeriod = SENSOR_MS_TO_TICKS(SENSOR_MIN_PERIOD_MS);
+    const uint32_t ulMaxPeriod = xRegistry[ulSensor].ulMaxPeriod;
+    uint32_t ulPeriod = xRegistry[ulSensor].ulPeriod;
+    int32_t lChange = lValue - xRegistry[ulSensor].lPrevious;
+    
+    if (lChange < 0)
+    {
+        lChange = -lChange;
+    }
+    
+    if (xSensorSchedule[ulSensor].ulSamples == 0)
+    {
+        /* Nothing to compare against yet */
+    }
+    else if (lChange == 0)
+    {
+        ulPeriod <<= 1;
+    }
+    else if (lChange >= 2 * SENSOR_FAST_CHANGE)
+    {
+        ulPeriod >>= 2;
+    }
+    else if (lChange >= SENSOR_FAST_CHANGE)
+    {
+        ulPeriod >>= 1;
+    }
+    
+    if ((ulForceFast == TRUE) || (ulPeriod < ulMinPeriod))
+    {
+        ulPeriod = ulMinPeriod;
+    }
+    else if (ulPeriod > ulMaxPeriod)
+    {
+        ulPeriod = ulMaxPeriod;
+    }
+    
+    xRegistry[ulSensor].ulPeriod = ulPeriod;
+    xRegistry[ulSensor].lPrevious = lValue;
+    vScheduleNext(ulSensor);
+    
+    xSensorSchedule[ulSensor].ulPeriodMs = ulPeriod * portTICK_PERIOD_MS;
+    xSensorSchedule[ulSensor].ulSamples++;
+}
 
-    if (BME_UBFX32(&TPM1->STATUS, TPM_STATUS_TOF_SHIFT, TPM_STATUS_TOF_WIDTH))
+
+/**
+ * @brief   Schedule next sample one period after the previous due tick.
+ * 
+ * @param   ulSensor    enum Sensor_Index.
+ * 
+ * @return  None
+ */
+static void vScheduleNext(const uint32_t ulSensor)
+{
+    const uint32_t ulMinPeriod = SENSOR_MS_TO_TICKS(SENSOR_MIN_PERIOD_MS);
+    TickType_t xNow;
+    
+    /* Advance from previous due tick so that periods don't drift */
+    xRegistry[ulSensor].xDue += (TickType_t)xRegistry[ulSensor].ulPeriod;
+    
+    xNow = xTaskGetTickCount();
+    if (TICK_REACHED(xRegistry[ulSensor].xDue, xNow))
     {
-        ulOverflows++;
+        /* Running late, skip to next tick of own phase */
+        xRegistry[ulSensor].xDue += (TickType_t)((((TickType_t)(xNow - xRegistry[ulSensor].xDue) / ulMinPeriod) + 1) * ulMinPeriod);
     }
+}
+
 
-    if (BME_UBFX32(&TPM1->STATUS, TPM_STATUS_CH1F_SHIFT, TPM_STATUS_CH1F_WIDTH))
+/**
+ * @brief   Limit sensor period. Sample due later than the new limit is
+ *          moved earlier on its own phase.
+ * 
+ * @param   ulSensor    enum Sensor_Index.
+ * 
+ * @param   ulPeriodMs  Max period, rounded down to power of two multiple
+ *                      of SENSOR_MIN_PERIOD_MS. 0 restores
+ *                      SENSOR_MAX_PERIOD_MS.
+ * 
+ * @return  None
+ */
+static void vScheduleLimit(const uint32_t ulSensor, const uint32_t ulPeriodMs)
+{
+    const uint32_t ulMinPeriod = SENSOR_MS_TO_TICKS(SENSOR_MIN_PERIOD_MS);
+    const uint32_t ulLimit = SENSOR_MS_TO_TICKS(ulPeriodMs);
+    uint32_t ulMaxPeriod = ulMinPeriod;
+    TickType_t xLeft;
+    
+    while (((ulMaxPeriod << 1) <= ulLimit) && (ulMaxPeriod < SENSOR_MS_TO_TICKS(SENSOR_MAX_PERIOD_MS)))
     {
-        /* Overflows should not happen */
-        configASSERT(ulOverflows == 0);
+        ulMaxPeriod <<= 1;
+    }
+    
+    if (ulPeriodMs == 0)
+    {
+        ulMaxPeriod = SENSOR_MS_TO_TICKS(SENSOR_MAX_PERIOD_MS);
+    }
+    
+    xRegistry[ulSensor].ulMaxPeriod = ulMaxPeriod;
+    
+    if (xRegistry[ulSensor].ulPeriod > ulMaxPeriod)
+    {
+        xRegistry[ulSensor].ulPeriod = ulMaxPeriod;
+        xSensorSchedule[ulSensor].ulPeriodMs = ulMaxPeriod * portTICK_PERIOD_MS;
+        
+        xLeft = xRegistry[ulSensor].xDue - xWheelTick;
+        if ((TICK_REACHED(xRegistry[ulSensor].xDue, xWheelTick) == FALSE) && (xLeft > ulMaxPeriod))
+        {
+            vWheelRemove(ulSensor);
+            xRegistry[ulSensor].xDue -= (TickType_t)(((xLeft - ulMaxPeriod) / ulMinPeriod) * ulMinPeriod);
+            vWheelInsert(ulSensor);
+        }
+    }
+}
 
-        /* Stop TPM1 */
-        BME_AND32(&TPM1->SC, ~TPM_SC_CMOD(1));
 
-        /* Read humidity */
-        HS1101_ulValue = TPM1->CONTROLS[1].CnV;
+/**
+ * @brief   Apply command received from the gateway.
+ * 
+ * @param   pxCommand   Decoded command, unknown ones are ignored.
+ * 
+ * @return  None
+ */
+static void vSensorCommand(const struct Command *const pxCommand)
+{
+    const uint32_t ulTarget = pxCommand->ucTarget;
+    
+    switch (pxCommand->ucType)
+    {
+        case COMMAND_THRESHOLD:
+            for (uint32_t i = 0; (i < SOIL_MOISTURE_SENSOR_COUNT) && (pxCommand->usValue <= MAX_SOIL_MOISTURE); i++)
+            {
+                if ((ulTarget == i) || (ulTarget == COMMAND_TARGET_ALL))
+                {
+                    ulSoilThreshold[i] = pxCommand->usValue;
+                }
+            }
+            break;
+        
+        case COMMAND_PERIOD:
+            /* Target is the field tag the gateway sees in frames */
+            if ((ulTarget == (FRAME_FIELD_TEMPERATURE << 4)) || (ulTarget == COMMAND_TARGET_ALL))
+            {
+                vScheduleLimit(SENSOR_TEMPERATURE, pxCommand->usValue * COMMAND_PERIOD_UNIT_MS);
+            }
+            if ((ulTarget == (FRAME_FIELD_HUMIDITY << 4)) || (ulTarget == COMMAND_TARGET_ALL))
+            {
+                vScheduleLimit(SENSOR_HUMIDITY, pxCommand->usValue * COMMAND_PERIOD_UNIT_MS);
+            }
+            for (uint32_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
+            {
+                if ((ulTarget == ((FRAME_FIELD_SOIL_MOISTURE << 4) | i)) || (ulTarget == COMMAND_TARGET_ALL))
+                {
+                    vScheduleLimit(SENSOR_SOIL_MOISTURE + i, pxCommand->usValue * COMMAND_PERIOD_UNIT_MS);
+                }
+            }
+            break;
+        
+        case COMMAND_WATER:
+            for (uint32_t i = 0; (i < MOTOR_COUNT) && (pxCommand->usValue < COMMAND_WATER_COUNT); i++)
+            {
+                if ((ulTarget == i) || (ulTarget == COMMAND_TARGET_ALL))
+                {
+                    ucWaterOverride[i] = (uint8_t)pxCommand->usValue;
+                }
+            }
+            break;
+        
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief   Convert one ADC channel.
+ * 
+ * @param   ucChannel   enum ADC_Channels.
+ * 
+ * @param   ucProfile   enum ADC_Profiles.
+ * 
+ * @param   pusResult   16-bit result.
+ * 
+ * @return  pdPASS, or pdFAIL if the scan timed out.
+ */
+static BaseType_t xSensorConvert(const uint8_t ucChannel, const uint8_t ucProfile, uint16_t *const pusResult)
+{
+    /* Sleeps until channel is converted */
+    return ADC0_xScan(&ucChannel, &ucProfile, pusResult, 1);
+}
 
-        /* Conversion should have been in progress */
-        configASSERT(xAnalogNotification != NULL);
 
-        /* Notify task */
-        xAssert = xTaskNotifyFromISR(xAnalogNotification, HS1101_ulValue, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
-        configASSERT(xAssert == pdPASS);
+/**
+ * @brief   Read HS1101 humidity, compensated with latest air temperature.
+ * 
+ * @param   ulArg       Unused.
+ * 
+ * @param   plValue     Filtered humidity.
+ * 
+ * @return  SENSOR_READ_DONE, or SENSOR_READ_FAILED if HS1101 gave no
+ *          reading in any range.
+ */
+static uint32_t ulReadHumidity(const uint32_t ulArg, int32_t *const plValue)
+{
+    struct Filter_Output xFiltered;
+    uint32_t ulHumidity;
+    (void)ulArg;
+    
+    if (HS1101_xReadHumidity(xSensor.lTemperature, &ulHumidity, &xSensor.ulHumidityRange) != pdPASS)
+    {
+        return SENSOR_READ_FAILED;
+    }
+    configASSERT(ulHumidity <= MAX_HUMIDITY);
+    
+    FILTER_vUpdate(&xFilters[SENSOR_HUMIDITY], (int32_t)ulHumidity, &xFiltered);
+    xSensor.ulHumidity = (uint32_t)xFiltered.lSmoothed;
+    *plValue = xFiltered.lSmoothed;
+    
+    return SENSOR_READ_DONE;
+}
+
+
+/**
+ * @brief   Read air temperature.
+ * 
+ * @param   ulArg       Unused.
+ * 
+ * @param   plValue     Filtered temperature.
+ * 
+ * @return  SENSOR_READ_DONE, or SENSOR_READ_FAILED if conversion timed out.
+ */
+static uint32_t ulReadTemperature(const uint32_t ulArg, int32_t *const plValue)
+{
+    struct Filter_Output xFiltered;
+    int32_t lTemperature;
+    uint16_t usResult;
+    (void)ulArg;
+    
+    /* Temperature is fine with 12 bits */
+    if (xSensorConvert(BOARD_TEMPERATURE_CHANNEL, ADC_PROFILE_FAST, &usResult) != pdPASS)
+    {
+        return SENSOR_READ_FAILED;
+    }
+    lTemperature = CONVERT_lCelsius(usResult);
+    configASSERT(lTemperature >= MIN_TEMPERATURE && (lTemperature <= MAX_TEMPERATURE));
+    
+    /* Report smoothed values, single outliers are trimmed away */
+    FILTER_vUpdate(&xFilters[SENSOR_TEMPERATURE], lTemperature, &xFiltered);
+    xSensor.lTemperature = xFiltered.lSmoothed;
+    *plValue = xFiltered.lSmoothed;
+    
+    return SENSOR_READ_DONE;
+}
+
+
+/**
+ * @brief   Read potentiometer.
+ * 
+ * @param   ulArg       Unused.
+ * 
+ * @param   plValue     Filtered position in 64 steps.
+ * 
+ * @return  SENSOR_READ_DONE, or SENSOR_READ_FAILED if conversion timed out.
+ */
+static uint32_t ulReadPotentiometer(const uint32_t ulArg, int32_t *const plValue)
+{
+    struct Filter_Output xFiltered;
+    uint16_t usResult;
+    (void)ulArg;
+    
+    if (xSensorConvert(BOARD_POTENTIOMETER_CHANNEL, ADC_PROFILE_BALANCED, &usResult) != pdPASS)
+    {
+        return SENSOR_READ_FAILED;
+    }
+    
+    FILTER_vUpdate(&xFilters[SENSOR_POTENTIOMETER], usResult, &xFiltered);
+    xSensor.ulPotentiometer = (uint32_t)xFiltered.lSmoothed; /* Not framed */
+    
+    /* LSB noise must not keep the period short */
+    *plValue = xFiltered.lSmoothed >> 10;
+    
+    return SENSOR_READ_DONE;
+}
 
-        /* No conversion in progress, so no tasks to notify */
-        xAnalogNotification = NULL;
 
-        /* Reset counters */
-        TPM1->CNT = 0;
-        ulOverflows = 0;
+/**
+ * @brief   Read one soil moisture probe.
+ * 
+ * @param   ulArg       Probe number.
+ * 
+ * @param   plValue     Filtered soil moisture.
+ * 
+ * @return  SENSOR_READ_FAST while soil is dry, so watering is followed
+ *          closely, SENSOR_READ_FAILED if conversion timed out, else
+ *          SENSOR_READ_DONE.
+ */
+static uint32_t ulReadSoilMoisture(const uint32_t ulArg, int32_t *const plValue)
+{
+    struct Filter_Output xFiltered;
+    uint32_t ulMoisture;
+    uint16_t usResult;
+    
+    configASSERT(ulArg < SOIL_MOISTURE_SENSOR_COUNT);
+    
+    /* Pumps keep following the previous median */
+    if (xSensorConvert(xSoilProbes[ulArg].ucChannel, xSoilProbes[ulArg].ucProfile, &usResult) != pdPASS)
+    {
+        return SENSOR_READ_FAILED;
     }
+    ulMoisture = xSoilProbes[ulArg].pulConvert(usResult);
+    configASSERT(ulMoisture <= MAX_SOIL_MOISTURE);
+    
+    FILTER_vUpdate(&xFilters[SENSOR_SOIL_MOISTURE + ulArg], (int32_t)ulMoisture, &xFiltered);
+    xSensor.ulSoilMoisture[ulArg] = (uint32_t)xFiltered.lSmoothed;
+    *plValue = xFiltered.lSmoothed;
+    
+    /* Pumps follow the median, a single noisy reading can't start one */
+    lSoilMedian[ulArg] = xFiltered.lMedian;
+    
+    return (lSoilMedian[ulArg] < (int32_t)ulSoilThreshold[ulArg]) ? SENSOR_READ_FAST : SENSOR_READ_DONE;
+}
 
-    /* Reset all flags */
-    BME_OR32(&TPM1->STATUS, TPM_STATUS_TOF(1) | TPM_STATUS_CH1F(1));
-    BME_OR32(&TPM1->CONTROLS[1].CnSC, TPM_CnSC_CHF(1));
 
-    /* Force context switch if xHigherPriorityTaskWoken is set to pdTRUE */
-    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+/**
+ * @brief   FreeRTOS sensor task. Sleeps until next sensor is due.
+ * 
+ * @param   pvParam     Unused.
+ * 
+ * @return  None
+ */
+void vSensorTask(void *const pvParam)
+{
+    (void)pvParam;
+    BaseType_t xAssert;
+    
+    struct Sensor *pxSensor;
+    struct Motor_States *pxMotors = &xMotors;
+    struct Command xCommand;
+    
+    uint32_t ulDryMask;
+    uint32_t ulPreviousDryMask = 0;
+    uint8_t ucMonitoredSensor = 0;
+    TickType_t xLastWake;
+    TickType_t xSleep;
+    TickType_t xNow;
+    
+    /* Longest sleep must stay comparable with 16-bit tick counts */
+    configASSERT(SENSOR_MS_TO_TICKS(SENSOR_MAX_PERIOD_MS) < 0x8000);
+    
+    for (uint32_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        FILTER_vInit(&xFilters[i]);
+    }
+    
+    /* Moist until measured */
+    for (uint32_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
+    {
+        configASSERT(xSoilProbes[i].ucZone < MOTOR_COUNT);
+        lSoilMedian[i] = MAX_SOIL_MOISTURE;
+        ulSoilThreshold[i] = SOIL_MOISTURE_THRESHOLD;
+    }
+    
+    for (uint32_t i = 0; i < SENSOR_WHEEL_SLOTS; i++)
+    {
+        ucWheel[i] = WHEEL_END;
+    }
+    
+    xLastWake = xTaskGetTickCount();
+    xWheelTick = xLastWake;
+    
+    /* HS1101 burst and ADC conversions get their own ticks, humidity after temperature */
+    vSensorRegister(SENSOR_TEMPERATURE, ulReadTemperature, 0, SENSOR_MIN_PERIOD_MS, 0);
+    vSensorRegister(SENSOR_HUMIDITY, ulReadHumidity, 0, SENSOR_MIN_PERIOD_MS, SENSOR_STAGGER_MS);
+    vSensorRegister(SENSOR_POTENTIOMETER, ulReadPotentiometer, 0, SENSOR_MIN_PERIOD_MS, 2 * SENSOR_STAGGER_MS);
+    for (uint32_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
+    {
+        vSensorRegister(SENSOR_SOIL_MOISTURE + i, ulReadSoilMoisture, i, SENSOR_MIN_PERIOD_MS, (3 + i) * SENSOR_STAGGER_MS);
+    }
+    
+    for (;;)
+    {
+        const uint32_t ulLoopStart = BENCH_ulTimestamp();
+        xSensor.ulTimestamp = ulLoopStart;
+        
+        /* Task wakes at least every SENSOR_MAX_PERIOD_MS, so 16-bit tick count can't wrap unseen */
+        xNow = xTaskGetTickCount();
+        xSensor.ulUptimeTicks += (TickType_t)(xNow - xUptimeTick);
+        xUptimeTick = xNow;
+        ulSensorWakeups++;
+        
+        /* Gateway commands arrive with radio ACKs */
+        while (xQueueReceive(xCommandQueue, &xCommand, (TickType_t)0) == pdTRUE)
+        {
+            vSensorCommand(&xCommand);
+        }
+        
+        if (ulWheelRun(xLastWake) > 0)
+        {
+            ulDryMask = 0;
+            for (uint8_t i = 0; i < SOIL_MOISTURE_SENSOR_COUNT; i++)
+            {
+                if (lSoilMedian[i] < (int32_t)ulSoilThreshold[i])
+                {
+                    if (ucWaterOverride[xSoilProbes[i].ucZone] != COMMAND_WATER_OFF)
+                    {
+                        xMotors.ucMotorState[xSoilProbes[i].ucZone] = TRUE;
+                    }
+                    ulDryMask |= 1UL << i;
+                }
+            }
+            
+            /* Watering requested by gateway runs once */
+            for (uint32_t i = 0; i < MOTOR_COUNT; i++)
+            {
+                if (ucWaterOverride[i] == COMMAND_WATER_ON)
+                {
+                    xMotors.ucMotorState[i] = TRUE;
+                    ucWaterOverride[i] = COMMAND_WATER_AUTO;
+                }
+            }
+            
+            /* Newly dry probe starts a pump */
+            xSensor.ulUrgent = (ulDryMask & ~ulPreviousDryMask) ? TRUE : FALSE;
+            ulPreviousDryMask = ulDryMask;
+            
+            /* Periods go to the gateway in schedule frames */
+            for (uint32_t i = 0; i < SENSOR_COUNT; i++)
+            {
+                xSensor.ulPeriodMs[i] = xSensorSchedule[i].ulPeriodMs;
+            }
+            xSensor.ulWakeups = ulSensorWakeups;
+            
+            /* Frame task gets a copy, xSensor keeps collecting readings. Reading is dropped if frame task is behind */
+            if (xAnalogQueue != 0)
+            {
+                pxSensor = POOL_pvAlloc(&xSensorPool);
+                if (pxSensor != NULL)
+                {
+                    *pxSensor = xSensor;
+                    
+                    /* Queue has a slot for every block, so send can't fail */
+                    xAssert = POOL_xSend(xAnalogQueue, (void **)&pxSensor, (TickType_t)10);
+                    configASSERT(xAssert);
+                }
+            }
+            
+            /* Motor task reads xMotors when it takes the pointer, so one queued is enough */
+            if ((xMotorQueue != 0) && (uxQueueMessagesWaiting(xMotorQueue) == 0))
+            {
+                xAssert = xQueueSend(xMotorQueue, (void *)&pxMotors, (TickType_t)10);
+                configASSERT(xAssert);
+            }
+        }
+        
+        BENCH_vRecord(BENCH_SENSOR_LOOP, ulLoopStart);
+        
+        /* Sleep until next sensor is due */
+        xSleep = xWheelNext(xLastWake);
+        if ((SENSOR_LOW_POWER_MONITORING == TRUE) && (ulPreviousDryMask == 0) && (xSleep > 0))
+        {
+            const uint32_t ulProbe = SENSOR_SOIL_MOISTURE + ucMonitoredSensor;
+            const TickType_t xWake = xLastWake + xSleep;
+            
+            xNow = xTaskGetTickCount();
+            
+            /**
+             * Compare watches one channel, so take turns between sensors.
+             * Others are still read when their period elapses.
+             */
+            if (TICK_REACHED(xWake, xNow) == FALSE)
+            {
+                if (ADC0_xWaitForCompare(xSoilProbes[ucMonitoredSensor].ucChannel, SOIL_MOISTURE_DRY_ADC(ulSoilThreshold[ucMonitoredSensor]), xWake - xNow) == pdTRUE)
+                {
+                    /* Soil went dry, read it on next tick of its phase */
+                    xSleep = xTaskGetTickCount() - xLastWake;
+                    vWheelRemove(ulProbe);
+                    xRegistry[ulProbe].xDue -= (TickType_t)(((TickType_t)(xRegistry[ulProbe].xDue - xLastWake - xSleep) / SENSOR_MS_TO_TICKS(SENSOR_MIN_PERIOD_MS)) * SENSOR_MS_TO_TICKS(SENSOR_MIN_PERIOD_MS));
+                    vWheelInsert(ulProbe);
+                }
+            }
+            ucMonitoredSensor = (ucMonitoredSensor + 1) % SOIL_MOISTURE_SENSOR_COUNT;
+            xLastWake += xSleep;
+        }
+        else if (xSleep > 0)
+        {
+            vTaskDelayUntil(&xLastWake, xSleep);
+        }
+    }
 }
@@ -3,12 +3,19 @@
 
 /* Global variables */
 EventGroupHandle_t xMotorEventGroup;
+struct Pool xSensorPool;
+struct Pool xMessagePool;
 
 
 /* Local defines */
 #define TIMER_NAME_LEN          (32UL)
 
 
+/* Local variables */
+static POOL_STORAGE(xSensorBlocks, struct Sensor, SENSOR_POOL_BLOCKS);
+static POOL_STORAGE(xMessageBlocks, struct AMessage, MESSAGE_POOL_BLOCKS);
+
+
 /* Local function prototypes */
 static void vSystemInit(void);
 static void vEnableClockGating(void);
@@ -32,8 +39,12 @@ static void vSystemInit(void)
     /* Power up all necessary peripherals */
     vEnableClockGating();
 
+    /* Timestamps for benchmarks */
+    PIT_vInit();
+
     /* Analog functionalities */
     ADC0_vInit();
+    ADC0_vMeasureProfiles(ADC_CH_AD8);
     TPM0_vInit();
     TPM1_vInit();
     TPM2_vInit();
@@ -41,12 +52,11 @@ static void vSystemInit(void)
     HS1101_vInit();
     
     /* Communications */
-    DMA0_vInit();
-    DMAMUX0_vInit(DMA_CHANNEL0, DMAMUX_CHCFG_SOURCE_SPI1_TX);
-    DMAMUX0_vInit(DMA_CHANNEL1, DMAMUX_CHCFG_SOURCE_SPI1_RX);
-    DMA0_vLinkChannel(DMA_CHANNEL0, DMA_CHANNEL1);
     SPI1_vInit();
     nRF24L01_vInit();
+    
+    /* Sensor scans, needs DMA */
+    ADC0_vInitScan(SIM_SOPT7_ADC0TRGSEL_PIT_TRIG0);
 }
 
 
@@ -60,14 +70,14 @@ static void vSystemInit(void)
 static void vEnableClockGating(void)
 {
     SIM->SCGC4 |= SIM_SCGC4_SPI1(1);
-    SIM->SCGC5 |= SIM_SCGC5_PORTA(1) | SIM_SCGC5_PORTB(1) | SIM_SCGC5_PORTD(1) | SIM_SCGC5_PORTE(1);
-    SIM->SCGC6 |= SIM_SCGC6_TPM0(1) | SIM_SCGC6_TPM1(1) | SIM_SCGC6_TPM2(1) | SIM_SCGC6_ADC0(1) | SIM_SCGC6_DMAMUX(1);
+    SIM->SCGC5 |= SIM_SCGC5_PORTA(1) | SIM_SCGC5_PORTB(1) | SIM_SCGC5_PORTD(1) | SIM_SCGC5_PORTE(1) | SIM_SCGC5_LPTMR(1);
+    SIM->SCGC6 |= SIM_SCGC6_TPM0(1) | SIM_SCGC6_TPM1(1) | SIM_SCGC6_TPM2(1) | SIM_SCGC6_ADC0(1) | SIM_SCGC6_DMAMUX(1) | SIM_SCGC6_PIT(1);
     SIM->SCGC7 |= SIM_SCGC7_DMA(1);
 }
 
 
 /**
- * @brief   Create FreeRTOS queues.
+ * @brief   Create FreeRTOS queues and the pools of the blocks they pass.
  * 
  * @param   None
  * 
@@ -75,12 +85,17 @@ static void vEnableClockGating(void)
  */
 static void vCreateQueues(void)
 {
-    xAnalogQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(struct Sensor));
+    POOL_vInit(&xSensorPool, xSensorBlocks, POOL_BLOCK_SIZE(struct Sensor), SENSOR_POOL_BLOCKS);
+    xAnalogQueue = xQueueCreate(SENSOR_POOL_BLOCKS, sizeof(struct Sensor *));
     configASSERT(xAnalogQueue);
     
-    xCommQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(char *));
+    POOL_vInit(&xMessagePool, xMessageBlocks, POOL_BLOCK_SIZE(struct AMessage), MESSAGE_POOL_BLOCKS);
+    xCommQueue = xQueueCreate(MESSAGE_POOL_BLOCKS, sizeof(struct AMessage *));
     configASSERT(xCommQueue);
     
+    xCommandQueue = xQueueCreate(COMMAND_QUEUE_SIZE, sizeof(struct Command));
+    configASSERT(xCommandQueue);
+    
     xMotorQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(char *));
     configASSERT(xMotorQueue);
 }
@@ -97,6 +112,9 @@ static void vCreateEvents(void)
 {
     xMotorEventGroup = xEventGroupCreate();
     configASSERT(xMotorEventGroup);
+    
+    xCommEventGroup = xEventGroupCreate();
+    configASSERT(xCommEventGroup);
 }
 
 
@@ -125,6 +143,9 @@ static void vCreateTasks(void *const pvMotorTimers)
     
     xAssert = xTaskCreate(vMotorTask, (const char *)"Motor", MOTORTASKSIZE / sizeof(portSTACK_TYPE), pvMotorTimers, MOTORTASKPRIORITY, &xHandle);
     configASSERT(xAssert);
+    
+    xAssert = xTaskCreate(vBenchmarkTask, (const char *)"Benchmark", BENCHMARKTASKSIZE / sizeof(portSTACK_TYPE), 0, BENCHMARKTASKPRIORITY, &xHandle);
+    configASSERT(xAssert);
 }
 
 
@@ -195,9 +216,6 @@ static void vMotorTimerCallback(const TimerHandle_t xTimer)
  */
 void vStartupTask(void *const pvMotorTimers)
 {
-    /* Initialize hardware */
-    vSystemInit();
-    
     /* Initialize FreeRTOS components */
     vCreateQueues();
     vCreateSemaphores();
@@ -224,7 +242,7 @@ void vStartupTask(void *const pvMotorTimers)
  */
 void vApplicationIdleHook(void)
 {
-    ; /* Do nothing */
+    BENCH_vIdleHook();
 }
 
 